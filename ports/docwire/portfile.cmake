@@ -13,6 +13,7 @@ vcpkg_check_features(OUT_FEATURE_OPTIONS FEATURE_OPTIONS
 		asan ADDRESS_SANITIZER
 		tsan THREAD_SANITIZER
 		helgrind HELGRIND_ENABLED
+		benchmarks DOCWIRE_BUILD_BENCHMARKS
 		local-ai-ct2 DOCWIRE_CT2
         local-ai-llama DOCWIRE_LLAMA
 )
@@ -0,0 +1,198 @@
+/*********************************************************************************************************************************************/
+/*  DocWire SDK: Award-winning modern data processing in C++20. SourceForge Community Choice & Microsoft support. AI-driven processing.      */
+/*  Supports nearly 100 data formats, including email boxes and OCR. Boost efficiency in text extraction, web data extraction, data mining,  */
+/*  document analysis. Offline processing possible for security and confidentiality                                                          */
+/*                                                                                                                                           */
+/*  Copyright (c) SILVERCODERS Ltd, http://silvercoders.com                                                                                  */
+/*  Project homepage: https://github.com/docwire/docwire                                                                                     */
+/*                                                                                                                                           */
+/*  SPDX-License-Identifier: AGPL-3.0-only OR LicenseRef-DocWire-Commercial                                                                  */
+/*********************************************************************************************************************************************/
+
+#include "batch_runner.h"
+
+#include <atomic>
+#include <deque>
+#include "input.h"
+#include "log_scope.h"
+#include <map>
+#include <mutex>
+#include "output.h"
+#include <thread>
+
+namespace docwire
+{
+
+namespace
+{
+
+struct work_queue
+{
+	std::mutex mutex;
+	std::deque<size_t> indices;
+
+	std::optional<size_t> pop_front()
+	{
+		std::lock_guard<std::mutex> lock{mutex};
+		if (indices.empty())
+			return std::nullopt;
+		size_t index = indices.front();
+		indices.pop_front();
+		return index;
+	}
+
+	std::optional<size_t> steal_back()
+	{
+		std::lock_guard<std::mutex> lock{mutex};
+		if (indices.empty())
+			return std::nullopt;
+		size_t index = indices.back();
+		indices.pop_back();
+		return index;
+	}
+};
+
+} // anonymous namespace
+
+template<>
+struct pimpl_impl<batch_runner> : pimpl_impl_base
+{
+	batch_runner::chain_factory m_factory;
+	size_t m_worker_count;
+	result_order m_order;
+	std::vector<std::unique_ptr<parsing_chain>> m_chains;
+
+	pimpl_impl(batch_runner::chain_factory factory, worker_count workers, result_order order)
+		: m_factory{std::move(factory)},
+		  m_worker_count{workers.v > 0 ? workers.v : std::max(1u, std::thread::hardware_concurrency())},
+		  m_order{order},
+		  m_chains(m_worker_count)
+	{}
+
+	struct batch_state
+	{
+		batch_state(std::vector<data_source>& inputs, const batch_runner::result_handler& on_result, size_t worker_num)
+			: inputs{inputs}, on_result{on_result}, queues(worker_num)
+		{}
+
+		std::vector<data_source>& inputs;
+		const batch_runner::result_handler& on_result;
+		std::vector<work_queue> queues;
+		std::mutex delivery_mutex;
+		std::map<size_t, std::vector<message_ptr>> pending_results;
+		size_t next_to_deliver = 0;
+		std::atomic<bool> cancelled = false;
+		std::exception_ptr handler_error;
+	};
+
+	std::vector<message_ptr> process(size_t worker, data_source& input)
+	{
+		log_scope(worker);
+		std::vector<message_ptr> output;
+		try
+		{
+			if (!m_chains[worker])
+				m_chains[worker] = std::make_unique<parsing_chain>(m_factory());
+			input_chain_element{std::move(input)} | *m_chains[worker] | output_chain_element{output};
+		}
+		catch (...)
+		{
+			output.push_back(make_message(std::current_exception()));
+		}
+		return output;
+	}
+
+	void deliver(batch_state& state, size_t index, std::vector<message_ptr>&& output)
+	{
+		std::lock_guard<std::mutex> lock{state.delivery_mutex};
+		if (state.cancelled)
+			return;
+		try
+		{
+			if (m_order == result_order::completion)
+			{
+				state.on_result(index, std::move(output));
+				return;
+			}
+			state.pending_results.emplace(index, std::move(output));
+			for (auto it = state.pending_results.find(state.next_to_deliver); it != state.pending_results.end();
+				it = state.pending_results.find(state.next_to_deliver))
+			{
+				state.on_result(it->first, std::move(it->second));
+				state.pending_results.erase(it);
+				state.next_to_deliver++;
+			}
+		}
+		catch (...)
+		{
+			state.handler_error = std::current_exception();
+			state.cancelled = true;
+		}
+	}
+
+	std::optional<size_t> next_index(batch_state& state, size_t worker)
+	{
+		if (auto index = state.queues[worker].pop_front())
+			return index;
+		for (size_t i = 1; i < state.queues.size(); ++i)
+		{
+			work_queue& victim = state.queues[(worker + i) % state.queues.size()];
+			if (auto index = m_order == result_order::input ? victim.pop_front() : victim.steal_back())
+				return index;
+		}
+		return std::nullopt;
+	}
+
+	void run_worker(batch_state& state, size_t worker)
+	{
+		while (!state.cancelled)
+		{
+			std::optional<size_t> index = next_index(state, worker);
+			if (!index)
+				break;
+			deliver(state, *index, process(worker, state.inputs[*index]));
+		}
+	}
+
+	void run(std::vector<data_source>& inputs, const batch_runner::result_handler& on_result)
+	{
+		log_scope(inputs.size(), m_worker_count);
+		size_t worker_num = std::min(m_worker_count, std::max<size_t>(inputs.size(), 1));
+		batch_state state{inputs, on_result, worker_num};
+		// In input order workers take inputs round-robin and steal the oldest ones, so inputs are processed
+		// roughly in order and only results completed ahead of the oldest unfinished input wait for delivery.
+		// Otherwise contiguous blocks keep related inputs (e.g. files from the same directory) on one worker
+		// and make stealing from the back take the work that is furthest from being reached.
+		for (size_t i = 0; i < inputs.size(); ++i)
+		{
+			size_t worker = m_order == result_order::input ? i % worker_num : i * worker_num / inputs.size();
+			state.queues[worker].indices.push_back(i);
+		}
+		{
+			std::vector<std::jthread> threads;
+			threads.reserve(worker_num);
+			for (size_t worker = 0; worker < worker_num; ++worker)
+				threads.emplace_back([this, &state, worker]() { run_worker(state, worker); });
+		}
+		if (state.handler_error)
+			std::rethrow_exception(state.handler_error);
+	}
+};
+
+batch_runner::batch_runner(chain_factory factory, worker_count workers, result_order order)
+	: with_pimpl<batch_runner>(std::move(factory), workers, order)
+{}
+
+batch_runner::~batch_runner() = default;
+
+batch_runner::batch_runner(batch_runner&&) = default;
+
+batch_runner& batch_runner::operator=(batch_runner&&) = default;
+
+void batch_runner::operator()(std::vector<data_source> inputs, const result_handler& on_result)
+{
+	log_scope();
+	impl().run(inputs, on_result);
+}
+
+} // namespace docwire
@@ -0,0 +1,105 @@
+/*********************************************************************************************************************************************/
+/*  DocWire SDK: Award-winning modern data processing in C++20. SourceForge Community Choice & Microsoft support. AI-driven processing.      */
+/*  Supports nearly 100 data formats, including email boxes and OCR. Boost efficiency in text extraction, web data extraction, data mining,  */
+/*  document analysis. Offline processing possible for security and confidentiality                                                          */
+/*                                                                                                                                           */
+/*  Copyright (c) SILVERCODERS Ltd, http://silvercoders.com                                                                                  */
+/*  Project homepage: https://github.com/docwire/docwire                                                                                     */
+/*                                                                                                                                           */
+/*  SPDX-License-Identifier: AGPL-3.0-only OR LicenseRef-DocWire-Commercial                                                                  */
+/*********************************************************************************************************************************************/
+
+#ifndef DOCWIRE_BATCH_RUNNER_H
+#define DOCWIRE_BATCH_RUNNER_H
+
+#include "core_export.h"
+#include "data_source.h"
+#include "message.h"
+#include "parsing_chain.h"
+#include "pimpl.h"
+#include <functional>
+#include <ranges>
+#include <vector>
+
+namespace docwire
+{
+
+/// Number of worker threads (0 selects std::thread::hardware_concurrency()).
+struct worker_count { size_t v; };
+
+/// Order in which batch_runner delivers the results.
+enum class result_order { input, completion };
+
+/**
+ * @brief Processes many data sources in parallel using one parsing chain instance per worker thread.
+ *
+ * Inputs are distributed over a work-stealing pool: every worker owns a queue of input indices
+ * and steals from the other queues when its own queue is exhausted, so a few large documents
+ * do not leave the remaining cores idle. Chains are created by the factory once per worker
+ * and reused for subsequent inputs and subsequent batches, the same way `http::server` reuses
+ * per-thread pipelines.
+ *
+ * @code
+ * batch_runner runner{[]() { return office_formats_parser{} | plain_text_exporter{}; }};
+ * runner(std::vector<std::filesystem::path>{"1.docx", "2.pdf"}, [](size_t index, std::vector<message_ptr>&& output)
+ * {
+ *   // output contains all messages emitted by the chain for input number index
+ * });
+ * @endcode
+ */
+class DOCWIRE_CORE_EXPORT batch_runner : public with_pimpl<batch_runner>
+{
+public:
+	/// A factory function that creates a `parsing_chain` for one worker (same shape as `http::server::pipeline_factory`).
+	using chain_factory = std::function<parsing_chain()>;
+
+	/**
+	 * @brief Callback receiving all output messages produced for one input.
+	 *
+	 * Calls are serialized, so the handler does not need to be thread-safe. Exceptions thrown
+	 * by the chain are delivered as a `std::exception_ptr` message.
+	 */
+	using result_handler = std::function<void(size_t index, std::vector<message_ptr>&& output)>;
+
+	/**
+	 * @param factory Creates the parsing chain (without input and output elements) for each worker.
+	 * @param workers Number of worker threads.
+	 * @param order Whether results are delivered in input order or as soon as they complete.
+	 *   In input order inputs are taken in order, and results completed after an unfinished input are kept
+	 *   in memory until it completes. While one input takes very long the other workers keep going, so in
+	 *   the worst case results of all remaining inputs are held at once; use result_order::completion
+	 *   if that is too much.
+	 */
+	explicit batch_runner(chain_factory factory, worker_count workers = {0}, result_order order = result_order::input);
+	~batch_runner();
+	batch_runner(batch_runner&&);
+	batch_runner& operator=(batch_runner&&);
+
+	/**
+	 * @brief Processes all inputs and blocks until every result was delivered.
+	 *
+	 * If the result handler throws, remaining inputs are abandoned and the exception is rethrown
+	 * after all workers have finished.
+	 */
+	void operator()(std::vector<data_source> inputs, const result_handler& on_result);
+
+	/// Processes any range of data sources or types accepted by the data_source constructor.
+	template <std::ranges::input_range R>
+	requires (!std::same_as<std::remove_cvref_t<R>, std::vector<data_source>>)
+	void operator()(R&& inputs, const result_handler& on_result)
+	{
+		std::vector<data_source> sources;
+		if constexpr (std::ranges::sized_range<R>)
+			sources.reserve(std::ranges::size(inputs));
+		for (auto&& input : inputs)
+			sources.emplace_back(std::forward<decltype(input)>(input));
+		operator()(std::move(sources), on_result);
+	}
+
+private:
+	using with_pimpl<batch_runner>::impl;
+};
+
+} // namespace docwire
+
+#endif //DOCWIRE_BATCH_RUNNER_H
@@ -72,9 +72,16 @@ charset_converter::charset_converter(const std::string &from, const std::string
 charset_converter::~charset_converter() = default;
 
 std::string charset_converter::convert(std::string_view input) const
+{
+	std::string output;
+	convert(input, output);
+	return output;
+}
+
+void charset_converter::convert(std::string_view input, std::string& output) const
 {	
 	if (input.empty())
-		return "";
+		return;
 
 	// iconv API is not const-correct for the input buffer.
 	const char* inptr = input.data();
@@ -85,9 +92,10 @@ std::string charset_converter::convert(std::string_view input) const
 	iconv(descriptor, nullptr, nullptr, nullptr, nullptr);
 
 	// A reasonable starting point for most conversions. UTF-8 can take up to 4 bytes per character.
+	size_t output_begin = output.size();
 	size_t output_size = input.length() * 2;
-	std::string output(output_size, '\0');
-	size_t total_written = 0;
+	output.resize(output_begin + output_size);
+	size_t total_written = output_begin;
 
 	while (inbytesleft > 0)
 	{
@@ -102,14 +110,16 @@ std::string charset_converter::convert(std::string_view input) const
 			if (errno == E2BIG) // Output buffer is full.
 			{
 				// Double the buffer size and continue.
-				output.resize(output.size() * 2);
+				output.resize(output_begin + (output.size() - output_begin) * 2);
 			}
 			else // A non-recoverable error occurred.
+			{
+				output.resize(output_begin);
 				throw make_error("iconv() failed", strerror(errno));
+			}
 		}
 	}
 	output.resize(total_written);
-	return output;
 }
 
 } // namespace docwire
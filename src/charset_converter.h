@@ -26,6 +26,9 @@ class DOCWIRE_CORE_EXPORT charset_converter : public with_pimpl<charset_converte
 		charset_converter(const std::string &from, const std::string &to);
 		~charset_converter();
 		std::string convert(std::string_view input) const;
+
+		/// Appends the converted input to the output, so that one buffer can collect many strings.
+		void convert(std::string_view input, std::string& output) const;
 };
 
 } // namespace docwire
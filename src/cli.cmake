@@ -9,3 +9,7 @@ if(DOCWIRE_CT2 OR DOCWIRE_LLAMA)
 endif()
 
 install(TARGETS docwire DESTINATION bin)
+
+add_executable(docwire_log_to_json log_to_json.cpp)
+target_link_libraries(docwire_log_to_json PRIVATE docwire_core)
+install(TARGETS docwire_log_to_json DESTINATION bin)
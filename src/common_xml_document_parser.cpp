@@ -15,17 +15,21 @@
 #include <functional>
 #include <type_traits>
 #include <stack>
+#include "error_tags.h"
 #include "log_scope.h"
 #include "make_error.h"
 #include "misc.h"
 #include "nested_exception.h"
+#include "throw_if.h"
 #include "xml_fixer.h"
 #include "xml_root_element.h"
 #include "document_elements.h"
 #include "convert_chrono.h" // IWYU pragma: keep
 #include "convert_numeric.h" // IWYU pragma: keep 
 #include <algorithm>
+#include <array>
 #include "odf_ooxml_export.h"
+#include "perfect_hash_index.h"
 #include "xml_attributes.h"
 
 namespace docwire
@@ -51,6 +55,29 @@ struct context
 	bool m_disabled_text = false;
 };
 
+// Local names of the tags handled by common_xml_document_parser and the parsers derived from it. Handlers are looked up
+// by local name, so OOXML (w:p) and ODF (text:p) tags with the same name share a handler, and a name is interned to its
+// position in this list by one perfect hash lookup instead of a search in a map of strings.
+constexpr auto known_tags = std::to_array<std::string_view>({
+	"#text", "b", "i", "u", "p", "rPr", "pPr", "r", "tbl", "tr", "tc", "t", "text", "tab", "space", "s", "a",
+	"list-style", "list", "table", "table-row", "table-cell", "annotation", "line-break", "h", "object", "fldData",
+	// odf_ooxml_parser
+	"attrName", "c", "row", "sheetData", "headerFooter", "commentReference", "hyperlink", "br", "document-styles",
+	"instrText", "tableStyleId",
+	// odfxml_parser
+	"body", "binary-data"
+});
+
+constexpr perfect_hash_index<known_tags.size()> known_tag_index { known_tags };
+
+consteval size_t tag_id(std::string_view tag)
+{
+	size_t id = known_tag_index.find(tag);
+	if (id == known_tag_index.npos)
+		throw "Tag is not in known_tags";
+	return id;
+}
+
 } // anonymous namespace
 
 template <safety_policy safety_level>
@@ -73,36 +100,38 @@ struct pimpl_impl<common_xml_document_parser<safety_level>> : with_pimpl_owner<c
   pimpl_impl(common_xml_document_parser<safety_level>& owner)
   : with_pimpl_owner<common_xml_document_parser<safety_level>>{owner}
   {
-    m_command_handlers["#text"] = add_command_handler<>(&pimpl_impl::onODFOOXMLText);
-    m_command_handlers["b"] = add_command_handler<>(&pimpl_impl::onODFOOXMLBold);
-    m_command_handlers["i"] = add_command_handler<>(&pimpl_impl::onODFOOXMLItalic);
-    m_command_handlers["u"] = add_command_handler<>(&pimpl_impl::onODFOOXMLUnderline);
-    m_command_handlers["p"] = add_command_handler<>(&pimpl_impl::onODFOOXMLPara);
-    m_command_handlers["rPr"] = add_command_handler<>(&pimpl_impl::onrPr);
-    m_command_handlers["pPr"] = add_command_handler<>(&pimpl_impl::onpPr);
-    m_command_handlers["r"] = add_command_handler<>(&pimpl_impl::onR);
-    m_command_handlers["tbl"] = add_command_handler<>(&pimpl_impl::onODFOOXMLTable);
-    m_command_handlers["tr"] = add_command_handler<>(&pimpl_impl::onODFOOXMLTableRow);
-    m_command_handlers["tc"] = add_command_handler<>(&pimpl_impl::onODFOOXMLTableCell);
-    m_command_handlers["t"] = add_command_handler<>(&pimpl_impl::onODFOOXMLTextTag);
-	m_command_handlers["text"] = add_command_handler<>(&pimpl_impl::onODFText);
-	m_command_handlers["tab"] = add_command_handler<>(&pimpl_impl::onODFOOXMLTab);
-	m_command_handlers["space"] = add_command_handler<>(&pimpl_impl::onODFOOXMLSpace);
-	m_command_handlers["s"] = add_command_handler<>(&pimpl_impl::onODFOOXMLSpace);
-	m_command_handlers["a"] = add_command_handler<>(&pimpl_impl::onODFUrl);
-	m_command_handlers["list-style"] = add_command_handler<>(&pimpl_impl::onODFOOXMLListStyle);
-	m_command_handlers["list"] = add_command_handler<>(&pimpl_impl::onODFOOXMLList);
-	m_command_handlers["table"] = add_command_handler<>(&pimpl_impl::onODFOOXMLTable);
-	m_command_handlers["table-row"] = add_command_handler<>(&pimpl_impl::onODFOOXMLTableRow);
-	m_command_handlers["table-cell"] = add_command_handler<>(&pimpl_impl::onODFOOXMLTableCell);
-	m_command_handlers["annotation"] = add_command_handler<>(&pimpl_impl::onODFAnnotation);
-	m_command_handlers["line-break"] = add_command_handler<>(&pimpl_impl::onODFLineBreak);
-	m_command_handlers["h"] = add_command_handler<>(&pimpl_impl::onODFHeading);
-	m_command_handlers["object"] = add_command_handler<>(&pimpl_impl::onODFObject);
-	m_command_handlers["fldData"] = add_command_handler<>(&pimpl_impl::onOOXMLFldData);
+    m_command_handlers[tag_id("#text")] = add_command_handler<>(&pimpl_impl::onODFOOXMLText);
+    m_command_handlers[tag_id("b")] = add_command_handler<>(&pimpl_impl::onODFOOXMLBold);
+    m_command_handlers[tag_id("i")] = add_command_handler<>(&pimpl_impl::onODFOOXMLItalic);
+    m_command_handlers[tag_id("u")] = add_command_handler<>(&pimpl_impl::onODFOOXMLUnderline);
+    m_command_handlers[tag_id("p")] = add_command_handler<>(&pimpl_impl::onODFOOXMLPara);
+    m_command_handlers[tag_id("rPr")] = add_command_handler<>(&pimpl_impl::onrPr);
+    m_command_handlers[tag_id("pPr")] = add_command_handler<>(&pimpl_impl::onpPr);
+    m_command_handlers[tag_id("r")] = add_command_handler<>(&pimpl_impl::onR);
+    m_command_handlers[tag_id("tbl")] = add_command_handler<>(&pimpl_impl::onODFOOXMLTable);
+    m_command_handlers[tag_id("tr")] = add_command_handler<>(&pimpl_impl::onODFOOXMLTableRow);
+    m_command_handlers[tag_id("tc")] = add_command_handler<>(&pimpl_impl::onODFOOXMLTableCell);
+    m_command_handlers[tag_id("t")] = add_command_handler<>(&pimpl_impl::onODFOOXMLTextTag);
+	m_command_handlers[tag_id("text")] = add_command_handler<>(&pimpl_impl::onODFText);
+	m_command_handlers[tag_id("tab")] = add_command_handler<>(&pimpl_impl::onODFOOXMLTab);
+	m_command_handlers[tag_id("space")] = add_command_handler<>(&pimpl_impl::onODFOOXMLSpace);
+	m_command_handlers[tag_id("s")] = add_command_handler<>(&pimpl_impl::onODFOOXMLSpace);
+	m_command_handlers[tag_id("a")] = add_command_handler<>(&pimpl_impl::onODFUrl);
+	m_command_handlers[tag_id("list-style")] = add_command_handler<>(&pimpl_impl::onODFOOXMLListStyle);
+	m_command_handlers[tag_id("list")] = add_command_handler<>(&pimpl_impl::onODFOOXMLList);
+	m_command_handlers[tag_id("table")] = add_command_handler<>(&pimpl_impl::onODFOOXMLTable);
+	m_command_handlers[tag_id("table-row")] = add_command_handler<>(&pimpl_impl::onODFOOXMLTableRow);
+	m_command_handlers[tag_id("table-cell")] = add_command_handler<>(&pimpl_impl::onODFOOXMLTableCell);
+	m_command_handlers[tag_id("annotation")] = add_command_handler<>(&pimpl_impl::onODFAnnotation);
+	m_command_handlers[tag_id("line-break")] = add_command_handler<>(&pimpl_impl::onODFLineBreak);
+	m_command_handlers[tag_id("h")] = add_command_handler<>(&pimpl_impl::onODFHeading);
+	m_command_handlers[tag_id("object")] = add_command_handler<>(&pimpl_impl::onODFObject);
+	m_command_handlers[tag_id("fldData")] = add_command_handler<>(&pimpl_impl::onOOXMLFldData);
   }
 
-	std::map<std::string, command_handler> m_command_handlers;
+	std::array<command_handler, known_tags.size()> m_command_handlers;
+	// Handlers of tags that are not in known_tags, registered by other derived parsers.
+	std::map<std::string, command_handler, std::less<>> m_other_command_handlers;
 	xml::reader_blanks m_blanks = xml::reader_blanks::keep;
   	std::stack<context<safety_level>> m_context_stack;
 
@@ -210,12 +239,12 @@ struct pimpl_impl<common_xml_document_parser<safety_level>> : with_pimpl_owner<c
     log_scope();
     if (m_context_stack.top().m_disabled_text == false)
     {
-      std::string content { xml_node.content() };
+      std::string_view content = xml_node.content();
 	  log_entry(content);
 	  text += content;
       children_processed = true;
       if (m_context_stack.top().space_preserve || !std::all_of(content.begin(), content.end(), [](auto c){return isspace(static_cast<unsigned char>(c));}))
-        emit_message(document::text{.text = content});
+        emit_message(document::text{.text = std::string{content}});
     }
   }
 
@@ -303,15 +332,34 @@ struct pimpl_impl<common_xml_document_parser<safety_level>> : with_pimpl_owner<c
 		}
 	}
 
-	void executeCommand(const std::string& command, xml::node_ref<safety_level>& xml_node, xml_parse_mode mode,
+	const command_handler* find_command_handler(std::string_view xml_tag) const
+	{
+		size_t id = known_tag_index.find(xml_tag);
+		if (id != known_tag_index.npos)
+			return m_command_handlers[id] ? &m_command_handlers[id] : nullptr;
+		if (m_other_command_handlers.empty())
+			return nullptr;
+		auto it = m_other_command_handlers.find(xml_tag);
+		return it != m_other_command_handlers.end() ? &it->second : nullptr;
+	}
+
+	void register_command_handler(std::string_view xml_tag, const command_handler& handler)
+	{
+		size_t id = known_tag_index.find(xml_tag);
+		if (id != known_tag_index.npos)
+			m_command_handlers[id] = handler;
+		else
+			m_other_command_handlers[std::string{xml_tag}] = handler;
+	}
+
+	void executeCommand(std::string_view command, xml::node_ref<safety_level>& xml_node, xml_parse_mode mode,
 						zip_reader* zipfile, std::string& text,
 						bool& children_processed, std::string& level_suffix, bool first_on_level)
 	{
 		log_scope(command);
 		children_processed = false;
-		typename std::map<std::string, command_handler>::iterator it = m_command_handlers.find(command);
-		if (it != m_command_handlers.end())
-			it->second(xml_node, mode, zipfile, text, children_processed, level_suffix, first_on_level);
+		if (const command_handler* handler = find_command_handler(command))
+			(*handler)(xml_node, mode, zipfile, text, children_processed, level_suffix, first_on_level);
 		else
 			onUnregisteredCommand(xml_node, mode, zipfile, text, children_processed, level_suffix, first_on_level);
 	}
@@ -524,7 +572,7 @@ void common_xml_document_parser<safety_level>::activeEmittingSignals(bool flag)
 template <safety_policy safety_level>
 void common_xml_document_parser<safety_level>::registerODFOOXMLCommandHandler(const std::string& xml_tag, const CommandHandler& handler)
 {
-	impl().m_command_handlers[xml_tag] = handler;
+	impl().register_command_handler(xml_tag, handler);
 }
 
 template <safety_policy safety_level>
@@ -547,7 +595,7 @@ std::string common_xml_document_parser<safety_level>::parseXmlData(xml::children
 				impl().m_context_stack.top().space_preserve = false;
 		}
 		bool children_processed;
-		impl().executeCommand(std::string{node.name()}, node, mode, zipfile, text,
+		impl().executeCommand(node.name(), node, mode, zipfile, text,
 			children_processed, level_suffix, first_on_level);
 		if (!children_processed)
 		{
@@ -613,6 +661,23 @@ void common_xml_document_parser<safety_level>::extractText(std::string_view xml_
 	}
 }
 
+template <safety_policy safety_level>
+void common_xml_document_parser<safety_level>::extractText(xml::reader_input input, xml_parse_mode mode, zip_reader* zipfile,
+	std::string& text)
+{
+	log_scope();
+	throw_if (mode != PARSE_XML, "XML can be read part by part only in PARSE_XML mode", errors::program_logic{});
+	try
+	{
+		xml::reader<safety_level> xml_reader(std::move(input), blanks());
+		text = parseXmlData(children(xml_reader), mode, zipfile);
+	}
+	catch (const std::exception& e)
+	{
+		std::throw_with_nested(make_error("Parsing XML failed"));
+	}
+}
+
 template <safety_policy safety_level>
 void common_xml_document_parser<safety_level>::parseODFMetadata(std::string_view xml_content, attributes::metadata& metadata) const
 {
@@ -104,8 +104,10 @@ class common_xml_document_parser: public chain_element, public with_pimpl<common
 		 * @brief Registers a handler for a specific XML tag.
 		 * 
 		 * Derived classes can use this to add or override behavior for specific XML tags.
+		 * Tags are matched by local name, without the namespace prefix. Handlers of the tags used by the parsers
+		 * of this library are kept in a table indexed by a perfect hash of the name; other tags fall back to a map.
 		 * 
-		 * @param xml_tag The XML tag name to handle.
+		 * @param xml_tag The local name of the XML tag to handle.
 		 * @param handler The function to execute when the tag is encountered.
 		 */
 		void registerODFOOXMLCommandHandler(const std::string& xml_tag, const CommandHandler& handler);
@@ -144,6 +146,18 @@ class common_xml_document_parser: public chain_element, public with_pimpl<common
 		 */
 		void extractText(std::string_view xml_contents, xml_parse_mode mode, zip_reader* zipfile, std::string& text);
 
+		/**
+		 * @brief Extracts text from XML content read part by part, without keeping the whole content in memory.
+		 *
+		 * Only PARSE_XML mode is supported, because fixing and stripping XML need the whole content.
+		 *
+		 * @param input The function supplying the XML content.
+		 * @param mode The parsing mode.
+		 * @param zipfile Pointer to the zip_reader if applicable.
+		 * @param text Output parameter where the extracted text will be appended.
+		 */
+		void extractText(xml::reader_input input, xml_parse_mode mode, zip_reader* zipfile, std::string& text);
+
 		/**
 		 * @brief Parses ODF metadata from XML content.
 		 * @param xml_content The raw XML content of the metadata file.
@@ -13,6 +13,7 @@ add_library(docwire_content_type SHARED
 
 find_package(unofficial-libmagic REQUIRED)
 target_link_libraries(docwire_content_type PRIVATE unofficial::libmagic::libmagic docwire_core)
+docwire_perfect_hash_index_sources(content_type_by_file_extension.cpp)
 
 install(TARGETS docwire_content_type EXPORT docwire_targets)
 if(MSVC)
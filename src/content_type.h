@@ -35,6 +35,8 @@
  * To fix this, heuristic detectors are used. **Rule:** Heuristic detectors must prioritize performance 
  * by reading only a small initial buffer (e.g., 4KB) to check for local file headers before falling back 
  * to deep inspection (like ZIP parsing), preventing massive files from being downloaded into memory.
+ * The ZIP central directory read by deep inspection is cached in the data source (see data_source::cached),
+ * so the ZIP-based detectors and the parser that follows them read it only once.
  */
 namespace docwire::content_type
 {
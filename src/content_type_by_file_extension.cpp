@@ -11,7 +11,9 @@
 
 #include "content_type_by_file_extension.h"
 
-#include <unordered_map>
+#include "perfect_hash_index.h"
+#include <string_view>
+#include <utility>
 
 namespace docwire::content_type::by_file_extension
 {
@@ -19,7 +21,7 @@ namespace docwire::content_type::by_file_extension
 namespace
 {
 
-const std::vector<std::pair<const char*, const char*>> file_extension_to_mime_type_list = {
+constexpr std::pair<std::string_view, std::string_view> file_extension_to_mime_type_list[] = {
 	// this part is generated by tools/convert_mime_db_json_to_cpp.cmake
 	// from https://github.com/jshttp/mime-db (MIT license)
 	{".ez", "application/andrew-inset"},
@@ -1309,19 +1311,29 @@ const std::vector<std::pair<const char*, const char*>> file_extension_to_mime_ty
 	{".wsf", "application/xml"}
 };
 
-const std::unordered_multimap<std::string, std::string> file_extension_to_mime_type(
-	file_extension_to_mime_type_list.begin(),
-	file_extension_to_mime_type_list.end()
-);
+constexpr size_t list_size = std::size(file_extension_to_mime_type_list);
 
-const std::unordered_map<std::string, std::string> mime_type_to_file_extension = []{
-	std::unordered_map<std::string, std::string> reverse_map;
-	for (const auto& pair : file_extension_to_mime_type_list) {
-		// just take the first one, don't overwrite if one already exists
-		reverse_map.try_emplace(pair.second, pair.first);
-	}
-	return reverse_map;
-}();
+// Both indexes are built by the compiler, so lookups do not allocate and there is nothing to initialize at startup.
+constexpr perfect_hash_index<list_size> file_extension_index {
+	[]()
+	{
+		std::array<std::string_view, list_size> file_extensions;
+		for (size_t i = 0; i < list_size; ++i)
+			file_extensions[i] = file_extension_to_mime_type_list[i].first;
+		return file_extensions;
+	}()
+};
+
+// find() returns the first file extension of a mime type in the list.
+constexpr perfect_hash_index<list_size> mime_type_index {
+	[]()
+	{
+		std::array<std::string_view, list_size> mime_types;
+		for (size_t i = 0; i < list_size; ++i)
+			mime_types[i] = file_extension_to_mime_type_list[i].second;
+		return mime_types;
+	}()
+};
 
 } // anonymous namespace
 
@@ -1329,21 +1341,23 @@ void detect(data_source& data)
 {
 	if (!data.file_extension() || data.highest_mime_type_confidence() >= confidence::high)
 		return;
-	auto range = file_extension_to_mime_type.equal_range(data.file_extension()->string());
-	for (auto it = range.first; it != range.second; ++it)
+	for (size_t i = file_extension_index.find(data.file_extension()->string()); i != file_extension_index.npos; i = file_extension_index.next(i))
+	{
+		std::string_view mt = file_extension_to_mime_type_list[i].second;
 		data.add_mime_type(
-			mime_type { it->second },
-			it->second == "application/msword" || it->second == "application/vnd.ms-excel" ?
+			mime_type { std::string{mt} },
+			mt == "application/msword" || mt == "application/vnd.ms-excel" ?
 				confidence::medium :
 				confidence::high);
+	}
 }
 
 std::optional<file_extension> to_extension(const mime_type& mt)
 {
-	auto it = mime_type_to_file_extension.find(mt.v);
-	if (it != mime_type_to_file_extension.end())
+	size_t i = mime_type_index.find(mt.v);
+	if (i != mime_type_index.npos)
 	{
-		return file_extension{it->second};
+		return file_extension{std::string{file_extension_to_mime_type_list[i].first}};
 	}
 
 	return std::nullopt;
@@ -11,40 +11,215 @@
 
 #include "content_type_by_signature.h"
 
+#include <algorithm>
 #include <boost/algorithm/string/classification.hpp>
 #include <boost/algorithm/string/compare.hpp>
 #include <boost/algorithm/string/split.hpp>
+#include <cstdint>
 #include "error_tags.h"
 #include <filesystem>
+#include <fstream>
 #include <magic.h>
+#include <mutex>
 #include "resource_path.h"
 #include "throw_if.h"
+#include <vector>
 
 namespace docwire
 {
 
-template<>
-struct pimpl_impl<content_type::by_signature::database> : public pimpl_impl_base
+namespace
 {
-    pimpl_impl()
-        : magic_cookie(magic_open(MAGIC_NONE))
+
+using namespace std::string_view_literals;
+
+// Enough to see the first members of a ZIP archive and the header of a tar archive.
+constexpr size_t prefilter_bytes = 4096;
+
+// Formats identified by fixed bytes at fixed offsets. MIME types are the ones libmagic reports for them.
+struct signature
+{
+    size_t offset;
+    std::string_view bytes;
+    std::string_view mime_type;
+};
+
+constexpr signature fixed_signatures[] =
+{
+    { 0, "%PDF-"sv, "application/pdf"sv },
+    { 0, "{\\rtf"sv, "application/rtf"sv },
+    { 0, "!BDN"sv, "application/vnd.ms-outlook"sv },
+    { 0, "\x89PNG\r\n\x1a\n"sv, "image/png"sv },
+    { 0, "\xff\xd8\xff"sv, "image/jpeg"sv },
+    { 0, "GIF87a"sv, "image/gif"sv },
+    { 0, "GIF89a"sv, "image/gif"sv },
+    { 0, "II*\0"sv, "image/tiff"sv },
+    { 0, "MM\0*"sv, "image/tiff"sv },
+    { 8, "WEBPVP8"sv, "image/webp"sv },
+    { 0, "\x1f\x8b"sv, "application/gzip"sv },
+    { 0, "BZh"sv, "application/x-bzip2"sv },
+    { 0, "\xfd" "7zXZ\0"sv, "application/x-xz"sv },
+    { 0, "7z\xbc\xaf\x27\x1c"sv, "application/x-7z-compressed"sv },
+    { 257, "ustar"sv, "application/x-tar"sv }
+};
+
+uint16_t read_u16(std::string_view data, size_t offset)
+{
+    return static_cast<uint8_t>(data[offset]) | (static_cast<uint8_t>(data[offset + 1]) << 8);
+}
+
+uint32_t read_u32(std::string_view data, size_t offset)
+{
+    return read_u16(data, offset) | (static_cast<uint32_t>(read_u16(data, offset + 2)) << 16);
+}
+
+// Recognizes ZIP archives by their first members, as libmagic does.
+std::optional<std::string_view> match_zip(std::string_view header)
+{
+    constexpr std::string_view local_header_signature = "PK\x03\x04"sv;
+    constexpr size_t local_header_size = 30;
+    if (!header.starts_with(local_header_signature) || header.size() < local_header_size)
+        return std::nullopt;
+    std::string_view name = header.substr(local_header_size, read_u16(header, 26));
+    // ODF documents start with a stored "mimetype" member containing their MIME type.
+    if (name == "mimetype" && read_u16(header, 8) == 0 && read_u16(header, 28) == 0)
+    {
+        constexpr std::string_view odf_prefix = "application/vnd.oasis.opendocument."sv;
+        std::string_view content = header.substr(local_header_size + name.size(), read_u32(header, 18));
+        if (content.size() > odf_prefix.size() && content.starts_with(odf_prefix) &&
+            std::all_of(content.begin() + odf_prefix.size(), content.end(), [](char c) { return (c >= 'a' && c <= 'z') || c == '-'; }))
+            return content;
+        return std::nullopt;
+    }
+    // OOXML documents are reported as generic ZIP archives, as libmagic >= 5.47 does for buffers.
+    // content_type::odf_ooxml and content_type::xlsb resolve them.
+    if (name != "[Content_Types].xml" && name != "_rels/.rels")
+        return std::nullopt;
+    for (size_t pos = header.find(local_header_signature, local_header_size + name.size());
+        pos != std::string_view::npos && header.size() - pos >= local_header_size;
+        pos = header.find(local_header_signature, pos + local_header_size))
+    {
+        name = header.substr(pos + local_header_size, read_u16(header, pos + 26));
+        if (name.starts_with("word/") || name.starts_with("xl/") || name.starts_with("ppt/"))
+            return "application/zip"sv;
+    }
+    return std::nullopt;
+}
+
+// First stage of detection for formats DocWire parses that can be identified by their first bytes without doubt.
+// Everything else, including OLE compound files that need their directory to be examined, is left to libmagic.
+std::optional<std::string_view> match_common_signature(std::string_view header)
+{
+    for (const signature& s : fixed_signatures)
+        if (header.size() >= s.offset + s.bytes.size() && header.substr(s.offset, s.bytes.size()) == s.bytes)
+            return s.mime_type;
+    return match_zip(header);
+}
+
+// Compiled signatures loaded once per process. libmagic handles are not thread-safe, so every thread using
+// the signatures at the same time gets its own handle. Handles share the loaded signatures and are reused.
+class shared_signatures
+{
+public:
+    static shared_signatures& instance()
+    {
+        static shared_signatures signatures;
+        return signatures;
+    }
+
+    ~shared_signatures()
+    {
+        for (magic_t handle : m_idle_handles)
+            magic_close(handle);
+    }
+
+    class handle_lease
     {
-        throw_if (magic_cookie == nullptr);
+    public:
+        handle_lease(shared_signatures& signatures)
+            : m_signatures(signatures), m_handle(signatures.acquire())
+        {}
+        ~handle_lease() { m_signatures.release(m_handle); }
+        handle_lease(const handle_lease&) = delete;
+        handle_lease& operator=(const handle_lease&) = delete;
+        magic_t get() const { return m_handle; }
+    private:
+        shared_signatures& m_signatures;
+        magic_t m_handle;
+    };
 
+    size_t bytes_max() const { return m_bytes_max; }
+
+private:
+    shared_signatures()
+    {
         try
         {
             const std::filesystem::path main_db_path = resource_path("libmagic/misc/magic.mgc");
-            const std::string magic_db_path = main_db_path.string();
-            throw_if (magic_load(magic_cookie, magic_db_path.c_str()) != 0, magic_error(magic_cookie));
-            throw_if (magic_getparam(magic_cookie, MAGIC_PARAM_BYTES_MAX, &bytes_max) != 0, magic_error(magic_cookie));
+            std::ifstream file { main_db_path, std::ios::binary };
+            throw_if (!file, "Could not open signatures file", main_db_path);
+            m_buffer.assign(std::istreambuf_iterator<char>{file}, std::istreambuf_iterator<char>{});
+            magic_t handle = create_handle();
+            int get_param_result = magic_getparam(handle, MAGIC_PARAM_BYTES_MAX, &m_bytes_max);
+            std::string error = get_param_result != 0 ? magic_error(handle) : "";
+            m_idle_handles.push_back(handle);
+            throw_if (get_param_result != 0, error);
         } catch (const std::exception&) {
             std::throw_with_nested(make_error("Failed to initialize content type signatures database", errors::program_corrupted{}));
         }
     }
-    ~pimpl_impl() { magic_close(magic_cookie); }
-    content_type::by_signature::allow_multiple allow_multiple;
-    magic_t magic_cookie;
-    size_t bytes_max;
+
+    magic_t create_handle()
+    {
+        magic_t handle = magic_open(MAGIC_NONE);
+        throw_if (handle == nullptr);
+        void* buffer = m_buffer.data();
+        size_t size = m_buffer.size();
+        if (magic_load_buffers(handle, &buffer, &size, 1) != 0)
+        {
+            std::string error = magic_error(handle);
+            magic_close(handle);
+            throw make_error(error);
+        }
+        return handle;
+    }
+
+    magic_t acquire()
+    {
+        {
+            std::lock_guard<std::mutex> lock{m_mutex};
+            if (!m_idle_handles.empty())
+            {
+                magic_t handle = m_idle_handles.back();
+                m_idle_handles.pop_back();
+                return handle;
+            }
+        }
+        return create_handle();
+    }
+
+    void release(magic_t handle)
+    {
+        std::lock_guard<std::mutex> lock{m_mutex};
+        m_idle_handles.push_back(handle);
+    }
+
+    // libmagic uses the compiled signatures in place, so the buffer is kept for the lifetime of the handles.
+    std::vector<char> m_buffer;
+    size_t m_bytes_max;
+    std::mutex m_mutex;
+    std::vector<magic_t> m_idle_handles;
+};
+
+} // anonymous namespace
+
+template<>
+struct pimpl_impl<content_type::by_signature::database> : public pimpl_impl_base
+{
+    pimpl_impl()
+        : signatures(shared_signatures::instance())
+    {}
+    shared_signatures& signatures;
 };
 
 } // namespace docwire
@@ -57,12 +232,21 @@ database::database() = default;
 void detect(data_source& data, const database& database_to_use, allow_multiple allow_multiple)
 {
     if (data.highest_mime_type_confidence() >= confidence::high)
-		return;
-    magic_setflags(database_to_use.impl().magic_cookie,
-        allow_multiple.v ? MAGIC_MIME_TYPE | MAGIC_CONTINUE : MAGIC_MIME_TYPE);
-    std::span<const std::byte> span = data.span(length_limit{database_to_use.impl().bytes_max});
-    const char* file_types = magic_buffer(database_to_use.impl().magic_cookie, span.data(), span.size());
-    throw_if (file_types == NULL, magic_error(database_to_use.impl().magic_cookie));
+        return;
+    if (!allow_multiple.v)
+    {
+        if (std::optional<std::string_view> mt = match_common_signature(data.string_view(length_limit{prefilter_bytes})))
+        {
+            data.add_mime_type(mime_type { std::string{*mt} }, confidence::very_high);
+            return;
+        }
+    }
+    shared_signatures& signatures = database_to_use.impl().signatures;
+    shared_signatures::handle_lease magic_cookie { signatures };
+    magic_setflags(magic_cookie.get(), allow_multiple.v ? MAGIC_MIME_TYPE | MAGIC_CONTINUE : MAGIC_MIME_TYPE);
+    std::span<const std::byte> span = data.span(length_limit{signatures.bytes_max()});
+    const char* file_types = magic_buffer(magic_cookie.get(), span.data(), span.size());
+    throw_if (file_types == NULL, magic_error(magic_cookie.get()));
     std::string file_types_str { file_types };
     auto splitIt = boost::make_split_iterator(file_types_str, boost::first_finder("\\012- "));
     while (splitIt != boost::split_iterator<std::string::iterator>()) 
@@ -26,6 +26,15 @@
  * 
  * This module wraps `libmagic`. 
  * 
+ * ### Fast Path
+ * Formats that can be identified by their first bytes without doubt (PDF, RTF, PST, ODF and OOXML packages,
+ * common images and compressed archives) are recognized by a built-in matcher that looks only at the first 4 KB
+ * of data. `libmagic` is used for everything else, for example for OLE compound files and text formats.
+ * 
+ * ### Thread Safety
+ * The signatures are loaded once per process and shared by all `database` objects. A `database` can be used
+ * by many threads at once, each of them gets its own `libmagic` handle for the time of detection.
+ * 
  * ### Quirks and Normalization
  * `libmagic` occasionally returns obsolete or non-standard MIME types (e.g., returning `text/xml` 
  * instead of `application/xml`, or `image/x-ms-bmp` instead of `image/bmp`). This module automatically 
@@ -48,7 +57,8 @@ struct allow_multiple
  * @brief Database of signatures
  *
  * This class represents a database of signatures used for content type detection.
- * Database is loaded from a file during initialization and provides a list of file signatures along with their associated mime types.
+ * Signatures are loaded from a file when the first database is created and are shared by all databases,
+ * so creating a database is cheap and a single database can be used from many threads at once.
  *
  * @see content_type::detect
  * @see content_type::detector
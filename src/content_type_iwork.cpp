@@ -11,11 +11,31 @@
 
 #include "content_type_iwork.h"
 
+#include <optional>
 #include "zip_reader.h"
 
 namespace docwire::content_type::iwork
 {
 
+namespace
+{
+
+constexpr size_t root_element_search_size = 4096;
+
+std::optional<mime_type> document_type_from_root_element(const std::string& contents)
+{
+    if (contents.find("<sl:document") != std::string::npos)
+        return mime_type { "application/vnd.apple.pages" };
+    else if (contents.find("<ls:document") != std::string::npos)
+        return mime_type { "application/vnd.apple.numbers" };
+    else if (contents.find("<key:presentation") != std::string::npos)
+        return mime_type { "application/vnd.apple.keynote" };
+    else
+        return std::nullopt;
+}
+
+} // anonymous namespace
+
 void detect(data_source& data)
 {
     if (data.highest_mime_type_confidence() >= confidence::highest)
@@ -34,17 +54,18 @@ void detect(data_source& data)
             data.add_mime_type(mime_type { "application/vnd.apple.keynote" }, confidence::highest);
         else if (unzip.exists("index.xml") || unzip.exists("index.apxl"))
         {
+            std::string file_name = unzip.exists("index.xml") ? "index.xml" : "index.apxl";
+            // The root element is at the beginning of the file, so usually only the beginning has to be decompressed.
             std::string contents;
-            if (unzip.exists("index.xml"))
-                unzip.read("index.xml", &contents);
-            else
-                unzip.read("index.apxl", &contents);
-            if (contents.find("<sl:document") != std::string::npos)
-                data.add_mime_type(mime_type { "application/vnd.apple.pages" }, confidence::highest);
-            else if (contents.find("<ls:document") != std::string::npos)
-                data.add_mime_type(mime_type { "application/vnd.apple.numbers" }, confidence::highest);
-            else if (contents.find("<key:presentation") != std::string::npos)
-                data.add_mime_type(mime_type { "application/vnd.apple.keynote" }, confidence::highest);
+            unzip.read(file_name, &contents, root_element_search_size);
+            std::optional<mime_type> document_type = document_type_from_root_element(contents);
+            if (!document_type && contents.size() == root_element_search_size)
+            {
+                unzip.read(file_name, &contents);
+                document_type = document_type_from_root_element(contents);
+            }
+            if (document_type)
+                data.add_mime_type(*document_type, confidence::highest);
             else
             {
                 data.add_mime_type(mime_type { "application/vnd.apple.pages" }, confidence::low);
@@ -11,8 +11,10 @@ add_library(docwire_core SHARED
     error.cpp
     json_serialization.cpp
     log_core.cpp
+    log_async_binary_sink.cpp
     log_cerr_redirection.cpp
     log_json_stream_sink.cpp
+    message.cpp
     misc.cpp
     thread_safe_ole_storage.cpp
     thread_safe_ole_stream_reader.cpp
@@ -28,15 +30,23 @@ add_library(docwire_core SHARED
     meta_data_writer.cpp
     chain_element.cpp
     parsing_chain.cpp
+    mime_type_dispatcher.cpp
+    batch_runner.cpp
     resource_path.cpp
+    result_cache.cpp
     serialization_thread_id.cpp
     serialization_typeindex.cpp
     type_name.cpp
+    tracing.cpp
     unique_identifier.cpp
     zip_reader.cpp
     input.cpp)
 
 target_compile_features(docwire_core PUBLIC cxx_std_20)
+if(NOT MSVC)
+    # Tracing hooks must not be instrumented themselves when DOCWIRE_TRACE is enabled.
+    set_source_files_properties(tracing.cpp PROPERTIES COMPILE_OPTIONS -fno-instrument-functions)
+endif()
 if(MSVC)
     add_definitions(-DMSVC_BUILD)
     target_compile_options(docwire_core PUBLIC /Zc:__cplusplus /Zc:preprocessor)
@@ -46,12 +56,12 @@ target_include_directories(docwire_core PUBLIC $<BUILD_INTERFACE:${CMAKE_CURRENT
 
 find_package(Boost REQUIRED COMPONENTS filesystem system json)
 find_package(magic_enum CONFIG REQUIRED)
-find_package(unofficial-minizip CONFIG REQUIRED)
 find_package(ZLIB REQUIRED)
 find_package(Iconv REQUIRED)
+find_package(OpenSSL REQUIRED)
 target_link_libraries(docwire_core PRIVATE
-    docwire_wv2 Boost::filesystem Boost::system Boost::json magic_enum::magic_enum unofficial::minizip::minizip
-    ZLIB::ZLIB Iconv::Iconv)
+    docwire_wv2 Boost::filesystem Boost::system Boost::json magic_enum::magic_enum
+    ZLIB::ZLIB Iconv::Iconv OpenSSL::Crypto)
 target_link_libraries(docwire_core PUBLIC magic_enum::magic_enum)
 if(${CMAKE_SYSTEM_NAME} MATCHES "Linux")
     target_link_libraries(docwire_core PRIVATE dl)
@@ -11,8 +11,11 @@
 
 #include "data_source.h"
 
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
 #include "error_tags.h"
 #include <fstream>
+#include "log_entry.h"
 #include "memorystream.h"
 #include "serialization_filesystem.h" // IWYU pragma: keep
 #include "throw_if.h"
@@ -20,6 +23,67 @@
 namespace docwire
 {
 
+class data_source::memory_map
+{
+public:
+	explicit memory_map(const std::filesystem::path& path)
+		: m_mapping{path.c_str(), boost::interprocess::read_only}, // native (wide on Windows) path, no lossy narrowing
+		  m_region{m_mapping, boost::interprocess::read_only}
+	{}
+
+	std::span<const std::byte> span() const
+	{
+		return {static_cast<const std::byte*>(m_region.get_address()), m_region.get_size()};
+	}
+
+	void advise(access_pattern pattern) const
+	{
+		using boost::interprocess::mapped_region;
+		switch (pattern)
+		{
+			case access_pattern::normal:
+				m_region.advise(mapped_region::advice_normal);
+				break;
+			case access_pattern::sequential:
+				m_region.advise(mapped_region::advice_sequential);
+				break;
+			case access_pattern::random:
+				m_region.advise(mapped_region::advice_random);
+				break;
+		}
+	}
+
+private:
+	boost::interprocess::file_mapping m_mapping;
+	mutable boost::interprocess::mapped_region m_region;
+};
+
+std::optional<std::span<const std::byte>> data_source::mapped_span(const std::filesystem::path& path) const
+{
+	if (!m_memory_map)
+	{
+		if (m_memory_cache)
+			return std::nullopt;
+		try
+		{
+			m_memory_map = std::make_shared<const memory_map>(path);
+		}
+		catch (const boost::interprocess::interprocess_exception& e)
+		{
+			// Empty files and special files cannot be mapped, they are read into memory instead.
+			log_entry(path, e.what());
+			return std::nullopt;
+		}
+	}
+	return m_memory_map->span();
+}
+
+void data_source::advise(access_pattern pattern) const
+{
+	if (m_memory_map)
+		m_memory_map->advise(pattern);
+}
+
 std::span<const std::byte> data_source::span(std::optional<length_limit> limit) const
 {
 	return std::visit(
@@ -44,6 +108,14 @@ std::span<const std::byte> data_source::span(std::optional<length_limit> limit)
 				size_t size = limit ? std::min(source.size(), limit->v) : source.size();
 				return std::span{reinterpret_cast<const std::byte*>(source.data()), size};
 			},
+			[this, limit](const std::filesystem::path& source)
+			{
+				if (std::optional<std::span<const std::byte>> mapped = mapped_span(source))
+					return limit ? mapped->first(std::min(mapped->size(), limit->v)) : *mapped;
+				fill_memory_cache(limit);
+				size_t size = limit ? std::min(m_memory_cache->size(), limit->v) : m_memory_cache->size();
+				return std::span<const std::byte>(m_memory_cache->data(), size);
+			},
 			[this, limit](auto source)
 			{
 				fill_memory_cache(limit);
@@ -87,11 +159,8 @@ std::string data_source::string(std::optional<length_limit> limit) const
 			},
 			[this, limit](auto source)
 			{
-				fill_memory_cache(limit);
-				if (limit)
-					return std::string{reinterpret_cast<const char*>(m_memory_cache->data()), std::min(m_memory_cache->size(), limit->v)};
-				else
-					return std::string{reinterpret_cast<const char*>(m_memory_cache->data()), m_memory_cache->size()}; // TODO: avoid copying			
+				std::span<const std::byte> data_span = span(limit);
+				return std::string{reinterpret_cast<const char*>(data_span.data()), data_span.size()};
 			}
 		}, m_source);
 }
@@ -111,7 +180,7 @@ std::string_view data_source::string_view(std::optional<length_limit> limit) con
 			[this, limit](const auto& source)
 			{
 				// For all other types (path, stream, span<byte>, vector<byte>),
-				// we rely on the span() method which handles caching.
+				// we rely on the span() method which handles mapping and caching.
 				std::span<const std::byte> data_span = span(limit);
 				return std::string_view{reinterpret_cast<const char*>(data_span.data()), data_span.size()};
 			}
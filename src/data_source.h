@@ -20,6 +20,7 @@
 #include "memory_buffer.h"
 #include <optional>
 #include <string_view>
+#include <typeindex>
 #include "unique_identifier.h"
 #include <unordered_map>
 #include <variant>
@@ -85,6 +86,16 @@ enum class confidence
 	highest
 };
 
+/**
+ * @brief Expected pattern of accessing the data, used as a hint for memory-mapped file sources.
+ */
+enum class access_pattern
+{
+	normal,
+	sequential,
+	random
+};
+
 /**
  * @brief Concept matching types that can be used to initialize a data_source.
  */
@@ -123,6 +134,8 @@ template<class... Ts> overloaded(Ts...) -> overloaded<Ts...>;
 	Converting data from one storage form to other should be possible in all combinations but performed only
 	as required (lazy) and cached inside the class, for example file should be read to memory only once.
 	Performance is very important, for example we should not duplicate memory buffer that is passed to class.
+	File sources are memory-mapped, so span() and string_view() return views straight into the page cache
+	instead of reading the whole file into a private buffer.
 **/
 class DOCWIRE_CORE_EXPORT data_source
 {
@@ -218,6 +231,30 @@ class DOCWIRE_CORE_EXPORT data_source
 		/// Returns an input stream for reading the data.
 		std::shared_ptr<std::istream> istream() const;
 
+		/**
+		 * @brief Hints how the data returned by span() and string_view() is going to be accessed.
+		 *
+		 * Has effect only for memory-mapped file sources, where it controls read-ahead of the operating system.
+		 * @param pattern The expected access pattern.
+		 */
+		void advise(access_pattern pattern) const;
+
+		/**
+		 * @brief Returns a structure of type T built from the content, building it only on the first call.
+		 *
+		 * Lets content type detectors and parsers share work done on the same data, for example reading the
+		 * central directory of a ZIP archive. Copies of the data_source made after the structure is built share it.
+		 * @param build Function returning std::shared_ptr<const T>, called only if the structure is not built yet.
+		 */
+		template <typename T, typename Build>
+		std::shared_ptr<const T> cached(Build&& build) const
+		{
+			std::shared_ptr<const void>& structure = m_cached[std::type_index{typeid(T)}];
+			if (!structure)
+				structure = std::shared_ptr<const T>{std::forward<Build>(build)()};
+			return std::static_pointer_cast<const T>(structure);
+		}
+
 		/// Returns the file path if the source is a file, otherwise std::nullopt.
 		std::optional<std::filesystem::path> path() const;
 
@@ -310,12 +347,16 @@ class DOCWIRE_CORE_EXPORT data_source
 	private:
 		std::variant<std::filesystem::path, std::vector<std::byte>, std::span<const std::byte>, std::string, std::string_view, seekable_stream_ptr, unseekable_stream_ptr> m_source;
 		std::optional<docwire::file_extension> m_file_extension;
+		class memory_map;
+		mutable std::shared_ptr<const memory_map> m_memory_map;
 		mutable std::shared_ptr<memory_buffer> m_memory_cache;
 		mutable std::shared_ptr<std::istream> m_path_stream;
 		mutable std::optional<size_t> m_stream_size;
+		mutable std::unordered_map<std::type_index, std::shared_ptr<const void>> m_cached;
 		unique_identifier m_id;
 
 		void fill_memory_cache(std::optional<length_limit> limit) const;
+		std::optional<std::span<const std::byte>> mapped_span(const std::filesystem::path& path) const;
 };
 
 } // namespace docwire
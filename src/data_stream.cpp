@@ -225,4 +225,9 @@ data_stream* buffer_stream::clone()
 	return new buffer_stream(impl().m_buffer, impl().m_size);
 }
 
+std::span<const std::byte> buffer_stream::span()
+{
+	return { reinterpret_cast<const std::byte*>(impl().m_buffer), impl().m_size };
+}
+
 } // namespace docwire
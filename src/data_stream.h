@@ -13,6 +13,8 @@
 #define DOCWIRE_DATA_STREAM_H
 
 #include "core_export.h"
+#include <cstddef>
+#include <span>
 #include <stdio.h>
 #include <string>
 #include "pimpl.h"
@@ -35,6 +37,9 @@ class data_stream
 		virtual size_t tell() = 0;
 		virtual std::string name() = 0;
 		virtual data_stream* clone() = 0;
+
+		/// Whole content of the stream if it is stored in memory, empty span otherwise.
+		virtual std::span<const std::byte> span() { return {}; }
 };
 
 class DOCWIRE_CORE_EXPORT file_stream : public data_stream, public with_pimpl<file_stream>
@@ -70,6 +75,7 @@ class DOCWIRE_CORE_EXPORT buffer_stream : public data_stream, public with_pimpl<
 		size_t tell();
 		std::string name();
 		data_stream* clone();
+		std::span<const std::byte> span() override;
 };
 
 } // namespace docwire
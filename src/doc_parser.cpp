@@ -11,6 +11,7 @@
 
 #include "doc_parser.h"
 
+#include <algorithm>
 #include "document_elements.h"
 #include "error_tags.h"
 #include "log_cerr_redirection.h"
@@ -25,6 +26,7 @@
 #include "wv2/src/handlers.h"
 #include <mutex>
 #include "oshared.h"
+#include <optional>
 #include "wv2/src/paragraphproperties.h"
 #include "wv2/src/parserfactory.h"
 #include <stdio.h>
@@ -51,11 +53,6 @@ namespace
 	std::mutex parser_factory_mutex_1;
 	std::mutex parser_factory_mutex_2;
 
-const std::vector<mime_type> supported_mime_types =
-{
-    mime_type{"application/msword"}
-};
-
 } // anonymous namespace
 
 template<>
@@ -158,7 +155,7 @@ static void parse_comments(const wvWare::Parser* parser, std::vector<comment>& c
 
 		U32 atn_part_cp = parser->fib().ccpText + parser->fib().ccpFtn + parser->fib().ccpHdd + parser->fib().ccpMcr;
 		log_entry(atn_part_cp);
-		std::unique_ptr<OLEStreamReader> reader { parser->storage()->createStreamReader("WordDocument") };
+		std::unique_ptr<thread_safe_ole_stream_reader> reader { static_cast<thread_safe_ole_stream_reader*>(parser->storage()->createStreamReader("WordDocument")) };
 		throw_if (!reader, "Error opening WordDocument stream.", errors::uninterpretable_data{});
 		const Parser9x* parser9 = dynamic_cast<const Parser9x*>(parser);
 		std::unique_ptr<OLEStreamReader> table_reader { parser->storage()->createStreamReader(parser9->tableStream()) };
@@ -169,6 +166,7 @@ static void parse_comments(const wvWare::Parser* parser, std::vector<comment>& c
 		table_reader->seek(annotation_txts_offset);
 		U32 annotation_begin_cp = table_reader->readU32();
 		std::vector<std::string> annotations;
+		std::vector<U8> annotation_buffer;
 		for (;;)
 		{
 			U32 annotation_end_cp = table_reader->readU32();
@@ -196,14 +194,18 @@ static void parse_comments(const wvWare::Parser* parser, std::vector<comment>& c
 			reader->seek(stream_begin_offset);
 			U8 annotation_mark = reader->readU8();
 			throw_if (annotation_mark != 0x05, "Incorrect annotation mark.", errors::uninterpretable_data{});
+			size_t text_len = stream_end_offset - 1 > reader->tell() ? stream_end_offset - 1 - reader->tell() : 0;
+			std::optional<std::span<const U8>> chars = reader->read_span(std::min<size_t>(text_len + (unicode ? 1 : 0), reader->size() - reader->tell()), annotation_buffer);
+			throw_if (!chars, reader->getLastError(), errors::uninterpretable_data{});
 			std::string annotation;
-			while (reader->tell() < stream_end_offset - 1)
+			for (size_t i = 0; i < text_len;)
 			{
-				log_scope(reader->tell());
 				// warning TODO: Unicode support in comments
 				if (unicode)
-					reader->seek(1, SEEK_CUR); // skip unicode byte
-				S8 ch = reader->readS8();
+					++i; // skip unicode byte
+				if (i >= chars->size())
+					break;
+				S8 ch = static_cast<S8>((*chars)[i++]);
 				if (ch >= 32 || (ch >= 8 && ch <= 13))
 				{
 					if (ch == '\r')
@@ -617,6 +619,7 @@ void pimpl_impl<doc_parser>::parse(const data_source& data, const message_callba
 
 	current_state curr_state;
 	auto storage = std::make_unique<thread_safe_ole_storage>(data.span());
+	data.advise(access_pattern::random);
 	throw_if (!storage->isValid(), storage->getLastError(), errors::uninterpretable_data{});
 	emit_message(document::document
 		{
@@ -685,6 +688,15 @@ void pimpl_impl<doc_parser>::parse(const data_source& data, const message_callba
 	emit_message(document::close_document{});
 }
 
+const std::vector<mime_type>& doc_parser::supported_mime_types()
+{
+    static const std::vector<mime_type> mime_types =
+    {
+        mime_type{"application/msword"}
+    };
+    return mime_types;
+}
+
 continuation doc_parser::operator()(message_ptr msg, const message_callbacks& emit_message)
 {
     if (!msg->is<data_source>())
@@ -693,7 +705,7 @@ continuation doc_parser::operator()(message_ptr msg, const message_callbacks& em
     auto& data = msg->get<data_source>();
     data.assert_not_encrypted();
 
-    if (!data.has_highest_confidence_mime_type_in(supported_mime_types))
+    if (!data.has_highest_confidence_mime_type_in(supported_mime_types()))
         return emit_message(std::move(msg));
 
     try
@@ -15,15 +15,20 @@
 #include "ole_office_formats_export.h"
 #include "chain_element.h"
 #include "pimpl.h"
+#include <vector>
 
 namespace docwire
 {
 
+struct mime_type;
+
 class DOCWIRE_OLE_OFFICE_FORMATS_EXPORT doc_parser : public chain_element, public with_pimpl<doc_parser>
 {
 public:
     doc_parser();
     continuation operator()(message_ptr msg, const message_callbacks& emit_message) override;
+    /// MIME types of the data sources parsed by this parser. Other data sources are passed on.
+    static const std::vector<mime_type>& supported_mime_types();
     bool is_leaf() const override { return false; }
 private:
     using with_pimpl<doc_parser>::impl;
@@ -40,6 +40,7 @@
 #include "find.h"
 #include "html_exporter.h"
 #include "language.h"
+#include "log_async_binary_sink.h"
 #include "log_json_stream_sink.h"
 #include "log_core.h"
 #include "log_entry.h"
@@ -55,6 +56,7 @@
 #include "standard_filter.h"
 #include "summarize.h"
 #include "text_to_speech.h"
+#include "tracing.h"
 #include "transcribe.h"
 #include "translate_to.h"
 #include "version.h"
@@ -207,8 +209,10 @@ int main(int argc, char* argv[])
 		("folder_name", po::value<std::string>(), "filter emails by folder name")
 		("attachment_extension", po::value<std::string>(), "filter by attachment type")
 		("log_file", po::value<std::string>(), "set path to log file")
+		("log-format", po::value<std::string>()->default_value("json"), "Format of the log file: json or binary. Binary logs are written by a background thread and can be converted to JSON with docwire_log_to_json.")
 		("log-filter", po::value<std::string>(), "Set a custom log filter. Filters are comma-separated and can include tags (e.g., 'audit'), function names (e.g., '@func:my_func'), and file names (e.g., '@file:*_parser.cpp'). Prepend '-' to exclude.")
 		("verbose,v", "Enable verbose logging (equivalent to --log-filter='*').")
+		("trace-file", po::value<std::string>(), "Write a timeline of log scopes (and of all functions in builds with DOCWIRE_TRACE) to a Chrome trace event file, viewable in Perfetto UI or chrome://tracing.")
 	;
 
 	po::positional_options_description pos_desc;
@@ -259,15 +263,27 @@ int main(int argc, char* argv[])
 
 	if (vm.count("log_file"))
 	{
-		std::ofstream log_file(vm["log_file"].as<std::string>());
+		std::string log_format = vm["log-format"].as<std::string>();
+		if (log_format != "json" && log_format != "binary")
+		{
+			std::cerr << "Error: Unknown log format: " << log_format << std::endl;
+			return 1;
+		}
+		std::ofstream log_file(vm["log_file"].as<std::string>(), log_format == "binary" ? std::ios::binary : std::ios::out);
 		if (!log_file.is_open())
 		{
 			std::cerr << "Error: Unable to open log file: " << vm["log_file"].as<std::string>() << std::endl;
 			return 1;
 		}
-		log::set_sink(log::json_stream_sink(std::move(log_file)));
+		if (log_format == "binary")
+			log::set_sink(log::async_binary_sink(std::move(log_file)));
+		else
+			log::set_sink(log::json_stream_sink(std::move(log_file)));
 	}
 
+	if (vm.count("trace-file"))
+		tracing::start(vm["trace-file"].as<std::string>(), tracing::trace_log_scopes{true});
+
 	std::string file_name = vm["input-file"].as<std::string>();
 
 	log_entry(use_stream, file_name);
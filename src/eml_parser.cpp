@@ -29,6 +29,7 @@
 #include <mailio/message.hpp>
 #include <mailio/mime.hpp>
 #include "make_error.h"
+#include "mime_scanner.h"
 #include "nested_exception.h"
 #include "serialization_data_source.h" // IWYU pragma: keep
 #include "serialization_message.h" // IWYU pragma: keep
@@ -49,6 +50,78 @@ struct context
 	const message_callbacks& emit_message;
 };
 
+void normalize_line(std::string& line)
+{
+	log_scope(line);
+	if (!line.empty() && line.back() == '\r')
+		line.pop_back();
+}
+
+void parse_header(mime& mime_entity, std::string_view header)
+{
+	log_scope(header.size());
+	mime_entity.line_policy(codec::line_len_policy_t::NONE);
+	std::string line;
+	for (size_t pos = 0; pos < header.size();)
+	{
+		size_t line_end = std::min(header.find('\n', pos), header.size());
+		line.assign(header.substr(pos, line_end - pos));
+		normalize_line(line);
+		mime_entity.parse_by_line(line);
+		pos = line_end + 1;
+	}
+	mime_entity.parse_by_line("");
+}
+
+/**
+ * Message split into entities by mime_scanner, with headers parsed by mailio. Bodies are views into the data
+ * and are decoded only when they are used.
+ */
+class scanned_message
+{
+public:
+	scanned_message(std::string_view data, const std::function<void(std::exception_ptr)>& non_fatal_error_handler);
+
+	const mailio::message& message() const { return m_message; }
+
+	const mime& header(size_t entity_index) const
+	{
+		if (entity_index == 0)
+			return m_message;
+		return *m_headers[entity_index];
+	}
+
+	const std::vector<size_t>& parts(size_t entity_index) const { return m_entities[entity_index].parts; }
+
+	std::string content(size_t entity_index) const
+	{
+		return mime_scanner::decode(m_entities[entity_index].body, transfer_encoding(entity_index));
+	}
+
+	size_t content_size(size_t entity_index) const
+	{
+		return mime_scanner::decoded_size(m_entities[entity_index].body, transfer_encoding(entity_index));
+	}
+
+private:
+	mime_scanner::transfer_encoding transfer_encoding(size_t entity_index) const
+	{
+		switch (header(entity_index).content_transfer_encoding())
+		{
+			case mime::content_transfer_encoding_t::BASE_64:
+				return mime_scanner::transfer_encoding::base64;
+			case mime::content_transfer_encoding_t::QUOTED_PRINTABLE:
+				return mime_scanner::transfer_encoding::quoted_printable;
+			default:
+				return mime_scanner::transfer_encoding::identity;
+		}
+	}
+
+	mailio::message m_message;
+	std::vector<std::unique_ptr<mime>> m_headers; ///< Headers of the entities, except the message itself.
+	std::vector<mime_scanner::entity> m_entities;
+};
+
 } // anonymous namespace
 
 template<>
@@ -108,14 +181,15 @@ struct pimpl_impl<eml_parser> : pimpl_impl_base
 		return mime_type{ static_cast<const mime_wrapper&>(mime_entity).mime_type_as_str(ct.media_type()) + "/" + ct.media_subtype() };
 	}
 
-	void extractPlainText(const mime& mime_entity)
+	void extractPlainText(const scanned_message& message, size_t entity_index)
 	{
+		const mime& mime_entity = message.header(entity_index);
 		const mime::content_type_t& ct = content_type_from_mime_entity(mime_entity);
 		log_scope(std::string(mime_entity.name()), ct.boundary(), mime_type_from_mime_entity(mime_entity));
 		if (ct.media_type() == mime::media_type_t::TEXT && (mime_entity.content_disposition() != mime::content_disposition_t::ATTACHMENT || std::string(mime_entity.name()).empty()))
 		{
 			log_scope();
-			std::string plain = mime_entity.content();
+			std::string plain = message.content(entity_index);
 
 			plain.erase(std::remove(plain.begin(), plain.end(), '\r'), plain.end());
 
@@ -164,7 +238,6 @@ struct pimpl_impl<eml_parser> : pimpl_impl_base
 		else if (ct.media_type() != mime::media_type_t::MULTIPART)
 		{
 			log_scope();
-			std::string plain = mime_entity.content();
 			std::string file_name = mime_entity.name();
 			std::optional<std::string> attachment_name;
 			std::optional<file_extension> extension;
@@ -176,12 +249,13 @@ struct pimpl_impl<eml_parser> : pimpl_impl_base
 			}
 
 			log_entry(attachment_name);
-			auto result = emit_message(mail::attachment{.name = attachment_name, .size = plain.length(), .extension = extension});
+			// The size is counted without decoding, so attachments skipped by the chain are never decoded.
+			auto result = emit_message(mail::attachment{.name = attachment_name, .size = message.content_size(entity_index), .extension = extension});
 			if (result != continuation::skip)
 			{
 				try
 				{
-					emit_message_back(data_source { plain, mime_type_from_mime_entity(mime_entity), confidence::very_high});
+					emit_message_back(data_source { message.content(entity_index), mime_type_from_mime_entity(mime_entity), confidence::very_high});
 				}
 				catch (std::exception&)
 				{
@@ -194,55 +268,56 @@ struct pimpl_impl<eml_parser> : pimpl_impl_base
 		if (ct.media_subtype() == "alternative")
 		{
 			log_scope();
-			const auto& parts = mime_entity.parts();
+			const auto& parts = message.parts(entity_index);
 
-			auto is_body_text = [](const mime& m, const std::vector<std::string>& subtypes) {
+			auto is_body_text = [&message](size_t part, const std::vector<std::string>& subtypes) {
+				const mime& m = message.header(part);
 				const mime::content_type_t& ct = content_type_from_mime_entity(m);
 				if (ct.media_type() != mime::media_type_t::TEXT) return false;
 				if (std::find(subtypes.begin(), subtypes.end(), ct.media_subtype()) == subtypes.end()) return false;
-				if (m.content().empty()) return false;
+				if (message.content_size(part) == 0) return false;
 				// Ensure it's not a named attachment, matching logic at the start of extractPlainText
 				if (m.content_disposition() == mime::content_disposition_t::ATTACHMENT && !std::string(m.name()).empty()) return false;
 				return true;
 			};
 
-			auto is_html_branch = [&](const mime& m) {
-				if (is_body_text(m, {"html", "xhtml"})) return true;
+			auto is_html_branch = [&](size_t part) {
+				if (is_body_text(part, {"html", "xhtml"})) return true;
 				// Check for multipart/related wrapping the HTML
-				const mime::content_type_t& ct = content_type_from_mime_entity(m);
-				if (ct.media_type() == mime::media_type_t::MULTIPART && ct.media_subtype() == "related" && !m.parts().empty())
-					return is_body_text(m.parts()[0], {"html", "xhtml"});
+				const mime::content_type_t& ct = content_type_from_mime_entity(message.header(part));
+				if (ct.media_type() == mime::media_type_t::MULTIPART && ct.media_subtype() == "related" && !message.parts(part).empty())
+					return is_body_text(message.parts(part)[0], {"html", "xhtml"});
 				return false;
 			};
 
-			auto is_plain_text = [&](const mime& m) {
-				return is_body_text(m, {"plain"});
+			auto is_plain_text = [&](size_t part) {
+				return is_body_text(part, {"plain"});
 			};
 
-			const mime* selected_part = nullptr;
+			std::optional<size_t> selected_part;
 
 			// 1. Prioritize HTML branches (including multipart/related)
 			auto it = std::find_if(parts.begin(), parts.end(), is_html_branch);
-			if (it != parts.end()) selected_part = &(*it);
+			if (it != parts.end()) selected_part = *it;
 
 			// 2. Fallback to non-attachment plain text
 			if (!selected_part) {
 				it = std::find_if(parts.begin(), parts.end(), is_plain_text);
-				if (it != parts.end()) selected_part = &(*it);
+				if (it != parts.end()) selected_part = *it;
 			}
 
 			// 3. Ultimate Fallback: use the first part if nothing else matched
 			if (!selected_part && !parts.empty())
-				selected_part = &parts[0];
+				selected_part = parts[0];
 
 			if (selected_part)
-				extractPlainText(*selected_part);
+				extractPlainText(message, *selected_part);
 		}
 		else
 		{
-			log_scope(mime_entity.parts().size());
-			for (const mime& m: mime_entity.parts())
-				extractPlainText(m);
+			log_scope(message.parts(entity_index).size());
+			for (size_t part : message.parts(entity_index))
+				extractPlainText(message, part);
 		}
 	}
 };
@@ -252,155 +327,28 @@ eml_parser::eml_parser() = default;
 namespace
 {
 
-constexpr std::string_view boundary_delimiter = "--";
-
-void normalize_line(std::string& line)
-{
-	log_scope(line);
-	if (!line.empty() && line.back() == '\r')
-		line.pop_back();
-}
-
-// Helper class to expose protected members of mailio::mime.
-// We derive from mailio::mime to access the protected parse_header_line() method.
-// This allows us to incrementally parse headers line-by-line and leverage mailio's
-// existing logic for handling header folding and parameter extraction (like the boundary),
-// without having to reimplement a full MIME header parser.
-class header_parser : public mailio::mime
-{
-public:
-	using mailio::mime::parse_header_line;
-	using mailio::mime::content_type;
-};
-
-class boundary_tracker
+scanned_message::scanned_message(std::string_view data, const std::function<void(std::exception_ptr)>& non_fatal_error_handler)
 {
-public:
-	void process_line(const std::string& line, mailio::message& mime_entity)
+	log_scope(data.size());
+	m_entities = mime_scanner::scan(data, [&](size_t entity_index, std::string_view header) -> std::string
 	{
-		if (is_boundary_line(line) && handle_boundary_line(line, mime_entity))
-			return;
-
-		if (m_in_headers)
-			handle_header_line(line);
-	}
-
-private:
-	bool is_boundary_line(const std::string& line) const
-	{
-		return line.starts_with(boundary_delimiter);
-	}
-
-	bool handle_boundary_line(const std::string& line, mailio::message& mime_entity)
-	{
-		for (size_t i = m_boundaries.size(); i > 0; --i)
+		if (entity_index > 0)
 		{
-			const auto current_boundary_index = i - 1;
-			const std::string& boundary = m_boundaries[current_boundary_index];
-
-			if (boundary.empty())
-				continue;
-			
-			const std::string boundary_prefix = std::string(boundary_delimiter) + boundary;
-			const bool is_closing = line == boundary_prefix + std::string(boundary_delimiter);
-			const bool is_new_part = !is_closing && (line == boundary_prefix);
-
-			if (is_closing || is_new_part)
-			{
-				inject_missing_closers(current_boundary_index, mime_entity);
-				m_boundaries.resize(is_closing ? current_boundary_index : current_boundary_index + 1);
-				m_in_headers = is_new_part;
-				if (is_new_part)
-				{
-					m_current_header_parser = header_parser{};
-					m_current_header_accumulator.clear();
-				}
-				return true;
-			}
-		}
-		return false;
-	}
-
-	void inject_missing_closers(size_t active_boundary_index, mailio::message& mime_entity)
-	{
-		for (size_t j = m_boundaries.size() - 1; j > active_boundary_index; --j)
-		{
-			std::string missing_closer = std::string(boundary_delimiter) + m_boundaries[j] + std::string(boundary_delimiter);
-			mime_entity.parse_by_line(missing_closer);
+			m_headers.resize(entity_index + 1);
+			m_headers[entity_index] = std::make_unique<mime>();
 		}
-	}
-
-	void handle_header_line(const std::string& line)
-	{
-		if (line.empty())
-		{
-			flush_header();
-			m_in_headers = false;
-			const auto& ct = m_current_header_parser.content_type();
-			if (ct.media_type() == mailio::mime::media_type_t::MULTIPART && !ct.boundary().empty())
-			{
-				m_boundaries.push_back(ct.boundary());
-			}
-			m_current_header_parser = header_parser{};
-			m_current_header_accumulator.clear();
-		}
-		else if (std::isspace(static_cast<unsigned char>(line[0])))
-		{
-			if (!m_current_header_accumulator.empty())
-				m_current_header_accumulator += line;
-		}
-		else
-		{
-			flush_header();
-			m_current_header_accumulator = line;
-		}
-	}
-
-	void flush_header()
-	{
-		if (!m_current_header_accumulator.empty())
+		mime& mime_entity = entity_index == 0 ? static_cast<mime&>(m_message) : *m_headers[entity_index];
+		try
 		{
-			try
-			{
-				m_current_header_parser.parse_header_line(m_current_header_accumulator);
-			}
-			catch (const std::exception& e)
-			{
-				log_entry("Failed to parse header line", m_current_header_accumulator, e.what());
-			}
-			m_current_header_accumulator.clear();
+			parse_header(mime_entity, header);
 		}
-	}
-
-	std::vector<std::string> m_boundaries;
-	header_parser m_current_header_parser;
-	std::string m_current_header_accumulator;
-	bool m_in_headers = true;
-};
-
-mailio::message parse_message(const data_source& data, const std::function<void(std::exception_ptr)>& non_fatal_error_handler)
-{
-	log_scope(data);
-	std::shared_ptr<std::istream> stream = data.istream();
-	mailio::message mime_entity;
-	mime_entity.line_policy(codec::line_len_policy_t::NONE);
-	try {
-		std::string line;
-		boundary_tracker tracker;
-
-		while (std::getline(*stream, line))
+		catch (const std::exception&)
 		{
-			normalize_line(line);
-			log_entry(line);
-			tracker.process_line(line, mime_entity);
-			mime_entity.parse_by_line(line);
+			non_fatal_error_handler(std::current_exception());
 		}
-		mime_entity.parse_by_line("\r\n");
-	} catch (std::exception& e)
-	{
-		non_fatal_error_handler(std::current_exception());
-	}
-	return mime_entity;
+		const mime::content_type_t& ct = pimpl_impl<eml_parser>::content_type_from_mime_entity(mime_entity);
+		return ct.media_type() == mime::media_type_t::MULTIPART ? ct.boundary() : std::string{};
+	});
 }
 
 const std::vector<mime_type> supported_mime_types =
@@ -435,15 +383,15 @@ continuation eml_parser::operator()(message_ptr msg, const message_callbacks& em
 		message_counters counters;
 		auto counting_callbacks = make_counted_message_callbacks(emit_message, counters);
 		scoped::stack_push<context> context_guard{impl().m_context_stack, context{counting_callbacks}};
-		mailio::message mime_entity = parse_message(data, [emit_message](std::exception_ptr e) { emit_message(std::move(e)); });
+		scanned_message message{data.string_view(), [emit_message](std::exception_ptr e) { emit_message(std::move(e)); }};
 		emit_message(document::document
 			{
-				.metadata = [&mime_entity]()
+				.metadata = [&message]()
 				{
-					return metaData(mime_entity);
+					return metaData(message.message());
 				}
 			});
-		impl().extractPlainText(mime_entity);
+		impl().extractPlainText(message, 0);
 		if (counters.all_failed())
 			throw make_error("No parts were successfully processed", errors::uninterpretable_data{});
 		emit_message(document::close_document{});
@@ -344,13 +344,6 @@ struct context
 	char last_char_in_inline_formatting_context = '\0';
 };
 
-const std::vector<mime_type> supported_mime_types =
-{
-	mime_type{"text/html"},
-	mime_type{"application/xhtml+xml"},
-	mime_type{"application/vnd.pwg-xhtml-print+xml"}
-};
-
 data_source create_image_source(const std::string& src)
 {
 	if (boost::algorithm::starts_with(src, "data:"))
@@ -882,6 +875,17 @@ void pimpl_impl<html_parser>::parse(const data_source& data, const message_callb
 	emit_message(document::close_document{});
 }
 
+const std::vector<mime_type>& html_parser::supported_mime_types()
+{
+	static const std::vector<mime_type> mime_types =
+	{
+		mime_type{"text/html"},
+		mime_type{"application/xhtml+xml"},
+		mime_type{"application/vnd.pwg-xhtml-print+xml"}
+	};
+	return mime_types;
+}
+
 continuation html_parser::operator()(message_ptr msg, const message_callbacks& emit_message)
 {
 	log_scope(msg);
@@ -891,7 +895,7 @@ continuation html_parser::operator()(message_ptr msg, const message_callbacks& e
 	auto& data = msg->get<data_source>();
 	data.assert_not_encrypted();
 
-	if (!data.has_highest_confidence_mime_type_in(supported_mime_types))
+	if (!data.has_highest_confidence_mime_type_in(supported_mime_types()))
 		return emit_message(std::move(msg));
 
 	try
@@ -15,9 +15,12 @@
 #include "html_export.h"
 #include "chain_element.h"
 #include "pimpl.h"
+#include <vector>
 
 namespace docwire
 {
+struct mime_type;
+
 class DOCWIRE_HTML_EXPORT html_parser : public chain_element, public with_pimpl<html_parser>
 {
 	private:
@@ -28,6 +31,8 @@ class DOCWIRE_HTML_EXPORT html_parser : public chain_element, public with_pimpl<
 
 		html_parser();
 		continuation operator()(message_ptr msg, const message_callbacks& emit_message) override;
+		/// MIME types of the data sources parsed by this parser. Other data sources are passed on.
+		static const std::vector<mime_type>& supported_mime_types();
 		bool is_leaf() const override { return false; }
 		///turns off charset decoding. It may be useful, if we want to decode data ourself (EML parser is an example).
 		void skipCharsetDecoding();
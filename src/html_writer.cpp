@@ -21,7 +21,7 @@
 #include <numeric>
 #include "document_elements.h"
 #include <sstream>
-#include <typeindex>
+#include <cstdint>
 #include <functional>
 
 namespace docwire
@@ -95,53 +95,53 @@ struct pimpl_impl<html_writer> : pimpl_impl_base
   bool m_header_is_open { false };
   int m_nested_docs_counter { 0 };
   using handler_func = std::function<std::shared_ptr<text_element>(const message_ptr&)>;
-  const boost::container::flat_map<std::type_index, handler_func> m_handlers;
+  const boost::container::flat_map<std::uint32_t, handler_func> m_handlers;
 
   pimpl_impl()
     : m_handlers{
-        {typeid(document::paragraph), [](const message_ptr& msg) { return tag_with_attributes("p", styling_attributes(msg->get<document::paragraph>())); }},
-        {typeid(document::close_paragraph), [](const message_ptr&) { return std::make_shared<text_element>("</p>"); }},
-        {typeid(document::section), [](const message_ptr& msg) { return tag_with_attributes("div", styling_attributes(msg->get<document::section>())); }},
-        {typeid(document::close_section), [](const message_ptr&) { return std::make_shared<text_element>("</div>"); }},
-        {typeid(document::span), [](const message_ptr& msg) { return tag_with_attributes("span", styling_attributes(msg->get<document::span>())); }},
-        {typeid(document::close_span), [](const message_ptr&) { return std::make_shared<text_element>("</span>"); }},
-        {typeid(document::bold), [](const message_ptr& msg) { return tag_with_attributes("b", styling_attributes(msg->get<document::bold>())); }},
-        {typeid(document::close_bold), [](const message_ptr&) { return std::make_shared<text_element>("</b>"); }},
-        {typeid(document::italic), [](const message_ptr& msg) { return tag_with_attributes("i", styling_attributes(msg->get<document::italic>())); }},
-        {typeid(document::close_italic), [](const message_ptr&) { return std::make_shared<text_element>("</i>"); }},
-        {typeid(document::underline), [](const message_ptr& msg) { return tag_with_attributes("u", styling_attributes(msg->get<document::underline>())); }},
-        {typeid(document::close_underline), [](const message_ptr&) { return std::make_shared<text_element>("</u>"); }},
-        {typeid(document::table), [](const message_ptr& msg) { return tag_with_attributes("table", styling_attributes(msg->get<document::table>())); }},
-        {typeid(document::close_table), [](const message_ptr&) { return std::make_shared<text_element>("</table>"); }},
-        {typeid(document::table_row), [](const message_ptr& msg) { return tag_with_attributes("tr", styling_attributes(msg->get<document::table_row>())); }},
-        {typeid(document::close_table_row), [](const message_ptr&) { return std::make_shared<text_element>("</tr>"); }},
-        {typeid(document::table_cell), [](const message_ptr& msg) { return tag_with_attributes("td", styling_attributes(msg->get<document::table_cell>())); }},
-        {typeid(document::close_table_cell), [](const message_ptr&) { return std::make_shared<text_element>("</td>"); }},
-        {typeid(document::caption), [](const message_ptr& msg) { return tag_with_attributes("caption", styling_attributes(msg->get<document::caption>())); }},
-        {typeid(document::close_caption), [](const message_ptr&) { return std::make_shared<text_element>("</caption>"); }},
-        {typeid(document::break_line), [](const message_ptr& msg) { return tag_with_attributes("br", styling_attributes(msg->get<document::break_line>())); }},
-        {typeid(document::text), [](const message_ptr& msg) { return std::make_shared<text_element>(encoded(msg->get<document::text>().text)); }},
-        {typeid(document::link), [this](const message_ptr& msg) { return this->write_link(msg->get<document::link>()); }},
-        {typeid(document::close_link), [](const message_ptr&) { return std::make_shared<text_element>("</a>"); }},
-        {typeid(document::image), [this](const message_ptr& msg) { return this->write_image(msg->get<document::image>()); }},
-        {typeid(document::list), [this](const message_ptr& msg) { return this->write_list(msg->get<document::list>()); }},
-        {typeid(document::close_list), [](const message_ptr&) { return std::make_shared<text_element>("</ul>"); }},
-        {typeid(document::list_item), [](const message_ptr&) { return std::make_shared<text_element>("<li>"); }},
-        {typeid(document::close_list_item), [](const message_ptr&) { return std::make_shared<text_element>("</li>"); }},
-        {typeid(document::header), [](const message_ptr&) { return std::make_shared<text_element>("<header>"); }},
-        {typeid(document::close_header), [](const message_ptr&) { return std::make_shared<text_element>("</header>"); }},
-        {typeid(document::footer), [](const message_ptr&) { return std::make_shared<text_element>("<footer>"); }},
-        {typeid(document::close_footer), [](const message_ptr&) { return std::make_shared<text_element>("</footer>"); }},
-        {typeid(document::document), [this](const message_ptr& msg) {
+        {message_type_id<document::paragraph>(), [](const message_ptr& msg) { return tag_with_attributes("p", styling_attributes(msg->get<document::paragraph>())); }},
+        {message_type_id<document::close_paragraph>(), [](const message_ptr&) { return std::make_shared<text_element>("</p>"); }},
+        {message_type_id<document::section>(), [](const message_ptr& msg) { return tag_with_attributes("div", styling_attributes(msg->get<document::section>())); }},
+        {message_type_id<document::close_section>(), [](const message_ptr&) { return std::make_shared<text_element>("</div>"); }},
+        {message_type_id<document::span>(), [](const message_ptr& msg) { return tag_with_attributes("span", styling_attributes(msg->get<document::span>())); }},
+        {message_type_id<document::close_span>(), [](const message_ptr&) { return std::make_shared<text_element>("</span>"); }},
+        {message_type_id<document::bold>(), [](const message_ptr& msg) { return tag_with_attributes("b", styling_attributes(msg->get<document::bold>())); }},
+        {message_type_id<document::close_bold>(), [](const message_ptr&) { return std::make_shared<text_element>("</b>"); }},
+        {message_type_id<document::italic>(), [](const message_ptr& msg) { return tag_with_attributes("i", styling_attributes(msg->get<document::italic>())); }},
+        {message_type_id<document::close_italic>(), [](const message_ptr&) { return std::make_shared<text_element>("</i>"); }},
+        {message_type_id<document::underline>(), [](const message_ptr& msg) { return tag_with_attributes("u", styling_attributes(msg->get<document::underline>())); }},
+        {message_type_id<document::close_underline>(), [](const message_ptr&) { return std::make_shared<text_element>("</u>"); }},
+        {message_type_id<document::table>(), [](const message_ptr& msg) { return tag_with_attributes("table", styling_attributes(msg->get<document::table>())); }},
+        {message_type_id<document::close_table>(), [](const message_ptr&) { return std::make_shared<text_element>("</table>"); }},
+        {message_type_id<document::table_row>(), [](const message_ptr& msg) { return tag_with_attributes("tr", styling_attributes(msg->get<document::table_row>())); }},
+        {message_type_id<document::close_table_row>(), [](const message_ptr&) { return std::make_shared<text_element>("</tr>"); }},
+        {message_type_id<document::table_cell>(), [](const message_ptr& msg) { return tag_with_attributes("td", styling_attributes(msg->get<document::table_cell>())); }},
+        {message_type_id<document::close_table_cell>(), [](const message_ptr&) { return std::make_shared<text_element>("</td>"); }},
+        {message_type_id<document::caption>(), [](const message_ptr& msg) { return tag_with_attributes("caption", styling_attributes(msg->get<document::caption>())); }},
+        {message_type_id<document::close_caption>(), [](const message_ptr&) { return std::make_shared<text_element>("</caption>"); }},
+        {message_type_id<document::break_line>(), [](const message_ptr& msg) { return tag_with_attributes("br", styling_attributes(msg->get<document::break_line>())); }},
+        {message_type_id<document::text>(), [](const message_ptr& msg) { return std::make_shared<text_element>(encoded(msg->get<document::text>().text)); }},
+        {message_type_id<document::link>(), [this](const message_ptr& msg) { return this->write_link(msg->get<document::link>()); }},
+        {message_type_id<document::close_link>(), [](const message_ptr&) { return std::make_shared<text_element>("</a>"); }},
+        {message_type_id<document::image>(), [this](const message_ptr& msg) { return this->write_image(msg->get<document::image>()); }},
+        {message_type_id<document::list>(), [this](const message_ptr& msg) { return this->write_list(msg->get<document::list>()); }},
+        {message_type_id<document::close_list>(), [](const message_ptr&) { return std::make_shared<text_element>("</ul>"); }},
+        {message_type_id<document::list_item>(), [](const message_ptr&) { return std::make_shared<text_element>("<li>"); }},
+        {message_type_id<document::close_list_item>(), [](const message_ptr&) { return std::make_shared<text_element>("</li>"); }},
+        {message_type_id<document::header>(), [](const message_ptr&) { return std::make_shared<text_element>("<header>"); }},
+        {message_type_id<document::close_header>(), [](const message_ptr&) { return std::make_shared<text_element>("</header>"); }},
+        {message_type_id<document::footer>(), [](const message_ptr&) { return std::make_shared<text_element>("<footer>"); }},
+        {message_type_id<document::close_footer>(), [](const message_ptr&) { return std::make_shared<text_element>("</footer>"); }},
+        {message_type_id<document::document>(), [this](const message_ptr& msg) {
             this->m_nested_docs_counter++;
             return this->m_nested_docs_counter == 1 ? this->write_open_header(msg->get<document::document>()) : std::shared_ptr<text_element>();
         }},
-        {typeid(document::close_document), [this](const message_ptr& msg) {
+        {message_type_id<document::close_document>(), [this](const message_ptr& msg) {
             throw_if(this->m_nested_docs_counter <= 0, errors::program_logic{});
             this->m_nested_docs_counter--;
             return this->m_nested_docs_counter == 0 ? this->write_footer() : std::shared_ptr<text_element>();
         }},
-        {typeid(document::style), [this](const message_ptr& msg) { return this->write_style(msg->get<document::style>()); }},
+        {message_type_id<document::style>(), [this](const message_ptr& msg) { return this->write_style(msg->get<document::style>()); }},
     }
   {}
 
@@ -250,7 +250,7 @@ struct pimpl_impl<html_writer> : pimpl_impl_base
     if (!is_header_content && m_header_is_open)
       write_close_header_open_body()->write_to(stream);
 
-    auto it = m_handlers.find(std::type_index(msg->object_type()));
+    auto it = m_handlers.find(msg->type_id());
     std::shared_ptr<text_element> text_element = (it != m_handlers.end())
                                                     ? it->second(msg)
                                                     : std::shared_ptr<docwire::text_element>();
@@ -29,6 +29,11 @@
 #include <openssl/rsa.h>
 #include <openssl/x509.h>
 #include <openssl/ssl.h>
+#include <condition_variable>
+#include <deque>
+#include <istream>
+#include <mutex>
+#include <thread>
 #include <vector>
 
 namespace docwire
@@ -47,6 +52,222 @@ struct ossl_deleter {
 template<typename T, auto F>
 using ossl_unique_ptr = std::unique_ptr<T, ossl_deleter<F>>;
 
+// Maximum number of bytes buffered between the connection and the pipeline in each direction in streaming mode.
+constexpr size_t streaming_buffer_size = 1024 * 1024;
+
+void add_mime_type_from_header(data_source& request_data_source, const httplib::Request& req)
+{
+    if (req.has_header("Content-Type"))
+    {
+        std::string content_type_header = req.get_header_value("Content-Type");
+        auto semicolon_pos = content_type_header.find(';');
+        std::string media_type_str = (semicolon_pos != std::string::npos)
+            ? content_type_header.substr(0, semicolon_pos)
+            : content_type_header;
+        boost::algorithm::trim(media_type_str);
+        if (!media_type_str.empty())
+            request_data_source.add_mime_type(mime_type{media_type_str}, confidence::high);
+    }
+}
+
+/**
+ * Bounded pipe between the thread receiving the request body and the pipeline reading it as a stream.
+ * Writing blocks while more than the capacity is buffered. Closing the read end unblocks the writer.
+ */
+class body_pipe : public std::streambuf
+{
+public:
+    explicit body_pipe(size_t capacity)
+        : m_capacity{capacity}
+    {}
+
+    bool write(const char* data, size_t size)
+    {
+        std::unique_lock lock{m_mutex};
+        m_space_available.wait(lock, [this]() { return m_read_closed || m_buffered < m_capacity; });
+        if (m_read_closed)
+            return false;
+        m_chunks.emplace_back(data, size);
+        m_buffered += size;
+        m_data_available.notify_one();
+        return true;
+    }
+
+    void close_write()
+    {
+        std::lock_guard lock{m_mutex};
+        m_write_closed = true;
+        m_data_available.notify_one();
+    }
+
+    void close_read()
+    {
+        std::lock_guard lock{m_mutex};
+        m_read_closed = true;
+        m_chunks.clear();
+        m_data_available.notify_one();
+        m_space_available.notify_one();
+    }
+
+protected:
+    int_type underflow() override
+    {
+        std::unique_lock lock{m_mutex};
+        m_buffered -= m_current.size();
+        m_current.clear();
+        m_space_available.notify_one();
+        m_data_available.wait(lock, [this]() { return !m_chunks.empty() || m_write_closed || m_read_closed; });
+        if (m_chunks.empty())
+            return traits_type::eof();
+        m_current = std::move(m_chunks.front());
+        m_chunks.pop_front();
+        setg(m_current.data(), m_current.data(), m_current.data() + m_current.size());
+        return traits_type::to_int_type(*gptr());
+    }
+
+private:
+    std::mutex m_mutex;
+    std::condition_variable m_data_available;
+    std::condition_variable m_space_available;
+    std::deque<std::string> m_chunks;
+    std::string m_current;
+    size_t m_buffered = 0;
+    size_t m_capacity;
+    bool m_write_closed = false;
+    bool m_read_closed = false;
+};
+
+struct response_part
+{
+    std::string content;
+    std::optional<mime_type> content_type;
+    std::exception_ptr error;
+};
+
+/**
+ * Queue of response parts produced by the pipeline thread and written to the connection.
+ * The response cannot be sent before the whole request body is received, so the queue is bounded only
+ * after that. Blocking the pipeline earlier would stop it from reading the body and deadlock the request.
+ */
+class response_queue
+{
+public:
+    explicit response_queue(size_t capacity)
+        : m_capacity{capacity}
+    {}
+
+    bool push(response_part&& part)
+    {
+        std::unique_lock lock{m_mutex};
+        m_space_available.wait(lock, [this]() { return m_closed || !m_bounded || m_buffered < m_capacity; });
+        if (m_closed)
+            return false;
+        m_buffered += part.content.size();
+        m_parts.push_back(std::move(part));
+        m_part_available.notify_one();
+        return true;
+    }
+
+    /// Returns std::nullopt when the pipeline has finished and all parts were taken.
+    std::optional<response_part> pop()
+    {
+        std::unique_lock lock{m_mutex};
+        m_part_available.wait(lock, [this]() { return !m_parts.empty() || m_finished || m_closed; });
+        if (m_parts.empty())
+            return std::nullopt;
+        response_part part = std::move(m_parts.front());
+        m_parts.pop_front();
+        m_buffered -= part.content.size();
+        m_space_available.notify_one();
+        return part;
+    }
+
+    /// Called when the request body is received and the parts can be sent to the connection.
+    void bound()
+    {
+        std::lock_guard lock{m_mutex};
+        m_bounded = true;
+    }
+
+    void finish()
+    {
+        std::lock_guard lock{m_mutex};
+        m_finished = true;
+        m_part_available.notify_one();
+    }
+
+    void close()
+    {
+        std::lock_guard lock{m_mutex};
+        m_closed = true;
+        m_parts.clear();
+        m_part_available.notify_one();
+        m_space_available.notify_one();
+    }
+
+private:
+    std::mutex m_mutex;
+    std::condition_variable m_part_available;
+    std::condition_variable m_space_available;
+    std::deque<response_part> m_parts;
+    size_t m_buffered = 0;
+    size_t m_capacity;
+    bool m_bounded = false;
+    bool m_finished = false;
+    bool m_closed = false;
+};
+
+/// Leaf of a streaming pipeline: passes every produced data_source to the response queue.
+class response_queue_writer : public chain_element
+{
+public:
+    explicit response_queue_writer(response_queue& queue)
+        : m_queue{queue}
+    {}
+
+    continuation operator()(message_ptr msg, const message_callbacks& /*emit_message*/) override
+    {
+        response_part part;
+        if (msg->is<data_source>())
+        {
+            const data_source& data = msg->get<data_source>();
+            part.content = data.string();
+            part.content_type = data.highest_confidence_mime_type();
+        }
+        else if (msg->is<std::exception_ptr>())
+            part.error = msg->get<std::exception_ptr>();
+        else
+            part.error = make_error_ptr("The processing pipeline produced an unsupported message type as output.");
+        return m_queue.push(std::move(part)) ? continuation::proceed : continuation::stop;
+    }
+
+    bool is_leaf() const override { return true; }
+
+private:
+    response_queue& m_queue;
+};
+
+/**
+ * State of one request in streaming mode. The pipeline runs on its own thread, so it can read the body
+ * while it is being received and produce output while the response is being sent.
+ */
+struct streaming_request
+{
+    body_pipe body { streaming_buffer_size };
+    std::istream body_stream { &body };
+    response_queue output { streaming_buffer_size };
+    std::optional<response_part> first_part;
+    std::jthread pipeline_thread; // Declared last, so it is joined before the buffers are destroyed.
+
+    streaming_request() = default;
+
+    ~streaming_request()
+    {
+        output.close();
+        body.close_read();
+    }
+};
+
 } // anonymous namespace
 
 template<>
@@ -59,10 +280,13 @@ struct pimpl_impl<http::server> : pimpl_impl_base
     size_t m_thread_num;
 	std::string m_addr;
 	uint16_t m_port;
+    std::mutex m_pipeline_pool_mutex;
+    // Pipelines for streaming requests are run on separate threads, so they are pooled instead of cached per thread.
+    boost::container::flat_map<std::string, std::vector<std::unique_ptr<parsing_chain>>> m_pipeline_pool;
 
-    void init(http::server::route_list& routes, http::thread_num thread_num, http::body_limit limit)
+    void init(http::server::route_list& routes, http::thread_num thread_num, http::body_limit limit, http::streaming streaming_mode)
     {
-        log_scope(thread_num, limit);
+        log_scope(thread_num, limit, streaming_mode);
         if (thread_num.v > 0)
         {
             m_thread_num = thread_num.v;
@@ -87,20 +311,30 @@ struct pimpl_impl<http::server> : pimpl_impl_base
         {
             std::visit(overloaded {
                 [&](const std::string& path) {
-                    m_svr->Post(path, [this, factory, path](const httplib::Request& req, httplib::Response& res){
-                        handle_request(req, res, factory, path);
-                    });
+                    if (streaming_mode.v)
+                        m_svr->Post(path, [this, factory, path](const httplib::Request& req, httplib::Response& res, const httplib::ContentReader& content_reader){
+                            handle_streaming_request(req, res, content_reader, factory, path);
+                        });
+                    else
+                        m_svr->Post(path, [this, factory, path](const httplib::Request& req, httplib::Response& res){
+                            handle_request(req, res, factory, path);
+                        });
                 },
                 [&](const http::regex_path& regex_p) {
-                    m_svr->Post(regex_p.pattern_string.c_str(), [this, factory, path_key = regex_p.pattern_string](const httplib::Request& req, httplib::Response& res){
-                        handle_request(req, res, factory, path_key);
-                    });
+                    if (streaming_mode.v)
+                        m_svr->Post(regex_p.pattern_string.c_str(), [this, factory, path_key = regex_p.pattern_string](const httplib::Request& req, httplib::Response& res, const httplib::ContentReader& content_reader){
+                            handle_streaming_request(req, res, content_reader, factory, path_key);
+                        });
+                    else
+                        m_svr->Post(regex_p.pattern_string.c_str(), [this, factory, path_key = regex_p.pattern_string](const httplib::Request& req, httplib::Response& res){
+                            handle_request(req, res, factory, path_key);
+                        });
                 }
             }, path_variant);
         }
     }
 
-	pimpl_impl(http::address addr, http::port port, http::server::route_list routes, http::thread_num thread_num, std::optional<http::certificate_info> cert_info, http::error_handler handler, http::body_limit limit)
+	pimpl_impl(http::address addr, http::port port, http::server::route_list routes, http::thread_num thread_num, std::optional<http::certificate_info> cert_info, http::error_handler handler, http::body_limit limit, http::streaming streaming_mode)
 		: m_error_handler(std::make_shared<http::error_handler_func>(std::move(handler.v))), m_addr(addr.v), m_port(port.v)
 	{
 		if (cert_info)
@@ -125,7 +359,7 @@ struct pimpl_impl<http::server> : pimpl_impl_base
 		{
 			m_svr = std::make_unique<httplib::Server>();
 		}
-        init(routes, thread_num, limit);
+        init(routes, thread_num, limit, streaming_mode);
 	}
 
     void handle_request(const httplib::Request& req, httplib::Response& res, const http::server::pipeline_factory& factory, const std::string& path_key)
@@ -142,17 +376,7 @@ struct pimpl_impl<http::server> : pimpl_impl_base
             auto response_messages = std::make_shared<std::vector<message_ptr>>();
 
             auto request_data_source = data_source(std::string(req.body));
-            if (req.has_header("Content-Type"))
-            {
-                std::string content_type_header = req.get_header_value("Content-Type");
-                auto semicolon_pos = content_type_header.find(';');
-                std::string media_type_str = (semicolon_pos != std::string::npos)
-                    ? content_type_header.substr(0, semicolon_pos)
-                    : content_type_header;
-                boost::algorithm::trim(media_type_str);
-                if (!media_type_str.empty())
-                    request_data_source.add_mime_type(mime_type{media_type_str}, confidence::high);
-            }
+            add_mime_type_from_header(request_data_source, req);
 
             input_chain_element{std::move(request_data_source)} | request_pipeline | output_chain_element{response_messages};
 
@@ -193,6 +417,105 @@ struct pimpl_impl<http::server> : pimpl_impl_base
         }
     }
 
+    std::unique_ptr<parsing_chain> acquire_pipeline(const http::server::pipeline_factory& factory, const std::string& path_key)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_pipeline_pool_mutex);
+            auto& pipelines = m_pipeline_pool[path_key];
+            if (!pipelines.empty())
+            {
+                std::unique_ptr<parsing_chain> pipeline = std::move(pipelines.back());
+                pipelines.pop_back();
+                return pipeline;
+            }
+        }
+        return std::make_unique<parsing_chain>(factory());
+    }
+
+    void release_pipeline(std::unique_ptr<parsing_chain> pipeline, const std::string& path_key)
+    {
+        std::lock_guard<std::mutex> lock(m_pipeline_pool_mutex);
+        m_pipeline_pool[path_key].push_back(std::move(pipeline));
+    }
+
+    void handle_streaming_request(const httplib::Request& req, httplib::Response& res, const httplib::ContentReader& content_reader, const http::server::pipeline_factory& factory, const std::string& path_key)
+    {
+        log_scope(path_key);
+        try
+        {
+            auto request = std::make_shared<streaming_request>();
+            auto request_data_source = data_source(unseekable_stream_ptr{std::shared_ptr<std::istream>(&request->body_stream, [](std::istream*) {})});
+            add_mime_type_from_header(request_data_source, req);
+            request->pipeline_thread = std::jthread([this, request = request.get(), request_data_source = std::move(request_data_source),
+                pipeline = acquire_pipeline(factory, path_key), path_key]() mutable
+            {
+                try
+                {
+                    input_chain_element{std::move(request_data_source)} | *pipeline | response_queue_writer{request->output};
+                    release_pipeline(std::move(pipeline), path_key);
+                }
+                catch (...)
+                {
+                    // Nothing may escape the thread, so any exception of a user pipeline is sent as the error part.
+                    response_part error_part;
+                    error_part.error = std::current_exception();
+                    request->output.push(std::move(error_part));
+                }
+                // Unblocks receiving of the body if the pipeline did not read all of it.
+                request->body.close_read();
+                request->output.finish();
+            });
+
+            content_reader([&](const char* data, size_t data_length)
+            {
+                return request->body.write(data, data_length);
+            });
+            request->body.close_write();
+            request->output.bound();
+
+            // Status and content type can only be set before the first chunk is sent, so they are taken from the first part.
+            request->first_part = request->output.pop();
+            if (!request->first_part)
+            {
+                res.status = httplib::StatusCode::InternalServerError_500;
+                res.set_content("Error: The processing pipeline did not produce any output message.", "text/plain");
+                return;
+            }
+            if (request->first_part->error)
+            {
+                (*m_error_handler)(request->first_part->error);
+                res.status = httplib::StatusCode::InternalServerError_500;
+                res.set_content("Pipeline Error: " + errors::diagnostic_message(request->first_part->error), "text/plain");
+                return;
+            }
+            res.status = httplib::StatusCode::OK_200;
+            std::string content_type = request->first_part->content_type ? request->first_part->content_type->v : "text/plain";
+            res.set_chunked_content_provider(content_type,
+                [this, request](size_t /*offset*/, httplib::DataSink& sink)
+                {
+                    std::optional<response_part> part = request->first_part ? std::exchange(request->first_part, std::nullopt) : request->output.pop();
+                    if (!part)
+                    {
+                        sink.done();
+                        return true;
+                    }
+                    if (part->error)
+                    {
+                        // Headers are already sent, so the only way to report the error is to abort the response.
+                        (*m_error_handler)(part->error);
+                        return false;
+                    }
+                    return part->content.empty() || sink.write(part->content.data(), part->content.size());
+                });
+        }
+        catch (const std::exception& e)
+        {
+            (*m_error_handler)(std::current_exception());
+            res.status = httplib::StatusCode::InternalServerError_500;
+            res.set_content("Internal Server Error: " + errors::diagnostic_message(e), "text/plain");
+        }
+    }
+
     BOOST_NOINLINE void httplib_listen_noninlined()
     {
         log_scope();
@@ -241,14 +564,14 @@ struct pimpl_impl<http::server> : pimpl_impl_base
 namespace http
 {
 
-server::server(address addr, port port, route_list routes, thread_num thread_num, error_handler handler, body_limit limit)
-	: with_pimpl<server>(addr, port, std::move(routes), thread_num, std::nullopt, std::move(handler), limit)
+server::server(address addr, port port, route_list routes, thread_num thread_num, error_handler handler, body_limit limit, streaming streaming_mode)
+	: with_pimpl<server>(addr, port, std::move(routes), thread_num, std::nullopt, std::move(handler), limit, streaming_mode)
 {
     log_scope(addr, port);
 }
 
-server::server(address addr, port port, certificate_info cert_info, route_list routes, thread_num thread_num, error_handler handler, body_limit limit)
-	: with_pimpl<server>(addr, port, std::move(routes), thread_num, std::move(cert_info), std::move(handler), limit)
+server::server(address addr, port port, certificate_info cert_info, route_list routes, thread_num thread_num, error_handler handler, body_limit limit, streaming streaming_mode)
+	: with_pimpl<server>(addr, port, std::move(routes), thread_num, std::move(cert_info), std::move(handler), limit, streaming_mode)
 {
     log_scope(addr, port);
 }
@@ -33,6 +33,18 @@ struct key_path { std::string v; };
 
 struct certificate_info { std::string key; std::string cert; };
 struct body_limit { uint64_t v; };
+/**
+ * @brief Enables streaming of request and response bodies.
+ *
+ * The request body is passed to the pipeline as an unseekable stream while it is still being received,
+ * and every `data_source` emitted by the pipeline is sent immediately using chunked transfer encoding.
+ * The request body goes through a small bounded buffer. The response can be sent only after the whole request
+ * body is received, so output emitted by the pipeline before that is buffered without a limit; afterwards the
+ * output buffer is bounded and the pipeline waits for the client. Memory used by the server per request does not
+ * grow with the size of the request or the response as long as the pipeline reads the body before emitting most
+ * of its output, as parsers do.
+ */
+struct streaming { bool v; };
 using error_handler_func = std::function<void(std::exception_ptr)>;
 struct error_handler { error_handler_func v = [](std::exception_ptr){}; };
 
@@ -72,8 +84,9 @@ public:
 	 * @param thread_num The number of threads for the server (0 for default)
 	 * @param handler A function to call for handling server errors.
 	 * @param limit The maximum size of the request body in bytes. Defaults to 1 GiB.
+	 * @param streaming_mode Whether request and response bodies are streamed (see `streaming`). Disabled by default.
 	 */
-	server(address addr, port port, route_list routes, thread_num thread_num = {0}, error_handler handler = {}, body_limit limit = {1024 * 1024 * 1024});
+	server(address addr, port port, route_list routes, thread_num thread_num = {0}, error_handler handler = {}, body_limit limit = {1024 * 1024 * 1024}, streaming streaming_mode = {false});
 	
 	/**
 	 * @brief Construct a new HTTPS server object
@@ -84,8 +97,9 @@ public:
 	 * @param thread_num The number of threads for the server (0 for default)
 	 * @param handler A function to call for handling server errors.
 	 * @param limit The maximum size of the request body in bytes. Defaults to 1 GiB.
+	 * @param streaming_mode Whether request and response bodies are streamed (see `streaming`). Disabled by default.
 	 */
-	server(address addr, port port, certificate_info cert_info, route_list routes, thread_num thread_num = {0}, error_handler handler = {}, body_limit limit = {1024 * 1024 * 1024});
+	server(address addr, port port, certificate_info cert_info, route_list routes, thread_num thread_num = {0}, error_handler handler = {}, body_limit limit = {1024 * 1024 * 1024}, streaming streaming_mode = {false});
 	~server();
 	server(server&&);
 	server& operator=(server&&);
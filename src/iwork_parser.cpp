@@ -250,16 +250,6 @@ struct context
 	std::string m_xml_file;
 };
 
-const std::vector<mime_type> supported_mime_types =
-{
-	mime_type{"application/vnd.apple.pages"},
-	mime_type{"application/vnd.apple.numbers"},
-	mime_type{"application/vnd.apple.keynote"},
-	mime_type{"application/x-iwork-pages-sffpages"},
-	mime_type{"application/x-iwork-numbers-sffnumbers"},
-	mime_type{"application/x-iwork-keynote-sffkey"}
-};
-
 } // anonymous namespace
 
 template<>
@@ -2152,6 +2142,20 @@ void pimpl_impl<iwork_parser>::parse(const docwire::data_source& data, const mes
 	}
 }
 
+const std::vector<mime_type>& iwork_parser::supported_mime_types()
+{
+	static const std::vector<mime_type> mime_types =
+	{
+		mime_type{"application/vnd.apple.pages"},
+		mime_type{"application/vnd.apple.numbers"},
+		mime_type{"application/vnd.apple.keynote"},
+		mime_type{"application/x-iwork-pages-sffpages"},
+		mime_type{"application/x-iwork-numbers-sffnumbers"},
+		mime_type{"application/x-iwork-keynote-sffkey"}
+	};
+	return mime_types;
+}
+
 continuation iwork_parser::operator()(message_ptr msg, const message_callbacks& emit_message)
 {
 	if (!msg->is<data_source>())
@@ -2160,7 +2164,7 @@ continuation iwork_parser::operator()(message_ptr msg, const message_callbacks&
 	auto& data = msg->get<data_source>();
 	data.assert_not_encrypted();
 
-	if (!data.has_highest_confidence_mime_type_in(supported_mime_types))
+	if (!data.has_highest_confidence_mime_type_in(supported_mime_types()))
 	{
 		return emit_message(std::move(msg));
 	}
@@ -14,16 +14,21 @@
 
 #include "iwork_export.h"
 #include "chain_element.h"
+#include <vector>
 
 namespace docwire
 {
 
+struct mime_type;
+
 class DOCWIRE_IWORK_EXPORT iwork_parser : public chain_element, public with_pimpl<iwork_parser>
 {
 	public:
 		iwork_parser();
 
 		continuation operator()(message_ptr msg, const message_callbacks& emit_message) override;
+		/// MIME types of the data sources parsed by this parser. Other data sources are passed on.
+		static const std::vector<mime_type>& supported_mime_types();
 		bool is_leaf() const override { return false; }
 
 	private:
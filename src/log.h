@@ -13,6 +13,7 @@
 #define DOCWIRE_LOG_H
 
 // IWYU pragma: begin_exports
+#include "log_async_binary_sink.h"
 #include "log_cerr_redirection.h"
 #include "log_entry.h"
 #include "log_forward.h"
@@ -0,0 +1,594 @@
+/*********************************************************************************************************************************************/
+/*  DocWire SDK: Award-winning modern data processing in C++20. SourceForge Community Choice & Microsoft support. AI-driven processing.      */
+/*  Supports nearly 100 data formats, including email boxes and OCR. Boost efficiency in text extraction, web data extraction, data mining,  */
+/*  document analysis. Offline processing possible for security and confidentiality                                                          */
+/*                                                                                                                                           */
+/*  Copyright (c) SILVERCODERS Ltd, http://silvercoders.com                                                                                  */
+/*  Project homepage: https://github.com/docwire/docwire                                                                                     */
+/*                                                                                                                                           */
+/*  SPDX-License-Identifier: AGPL-3.0-only OR LicenseRef-DocWire-Commercial                                                                  */
+/*********************************************************************************************************************************************/
+
+#include "log_async_binary_sink.h"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <condition_variable>
+#include <cstring>
+#include "error_tags.h"
+#include <iterator>
+#include "json_serialization.h"
+#include <map>
+#include <mutex>
+#include <optional>
+#include "serialization_thread_id.h" // IWYU pragma: keep
+#include <thread>
+#include "throw_if.h"
+#include <unordered_map>
+#include <vector>
+
+namespace docwire::log
+{
+
+namespace
+{
+
+// File layout: magic, format version, then frames. A frame is a varint payload size followed by the payload.
+// Payload starts with a frame kind and the index of the logging thread.
+constexpr std::string_view binary_log_magic{"DWLOG\0", 6};
+constexpr std::uint8_t binary_log_version = 1;
+
+enum class frame_kind : std::uint8_t
+{
+	thread, ///< thread index, thread id
+	location, ///< thread index, location index, file name, line, function name
+	record, ///< thread index, location index, time in nanoseconds since epoch, context
+	dropped ///< thread index, number of dropped records
+};
+
+enum class value_tag : std::uint8_t
+{
+	null, boolean_false, boolean_true, int64, uint64, real, string, array, object
+};
+
+constexpr std::chrono::milliseconds writer_interval{50};
+
+// Names in definition frames are truncated, so a definition frame always fits in the smallest buffer.
+constexpr size_t max_definition_string_size = 1024;
+constexpr size_t min_buffer_size = 4096;
+
+void write_varint(std::string& out, std::uint64_t v)
+{
+	while (v >= 0x80)
+	{
+		out.push_back(static_cast<char>(static_cast<std::uint8_t>(v) | 0x80));
+		v >>= 7;
+	}
+	out.push_back(static_cast<char>(v));
+}
+
+void write_string(std::string& out, std::string_view v)
+{
+	write_varint(out, v.size());
+	out.append(v);
+}
+
+void write_definition_string(std::string& out, std::string_view v)
+{
+	write_string(out, v.substr(0, max_definition_string_size));
+}
+
+void write_value(std::string& out, const serialization::value& value)
+{
+	std::visit([&out](const auto& v)
+	{
+		using T = std::decay_t<decltype(v)>;
+		if constexpr (std::is_same_v<T, std::nullptr_t>)
+			out.push_back(static_cast<char>(value_tag::null));
+		else if constexpr (std::is_same_v<T, bool>)
+			out.push_back(static_cast<char>(v ? value_tag::boolean_true : value_tag::boolean_false));
+		else if constexpr (std::is_same_v<T, std::int64_t>)
+		{
+			out.push_back(static_cast<char>(value_tag::int64));
+			write_varint(out, (static_cast<std::uint64_t>(v) << 1) ^ static_cast<std::uint64_t>(v >> 63));
+		}
+		else if constexpr (std::is_same_v<T, std::uint64_t>)
+		{
+			out.push_back(static_cast<char>(value_tag::uint64));
+			write_varint(out, v);
+		}
+		else if constexpr (std::is_same_v<T, double>)
+		{
+			out.push_back(static_cast<char>(value_tag::real));
+			write_varint(out, std::bit_cast<std::uint64_t>(v));
+		}
+		else if constexpr (std::is_same_v<T, std::string>)
+		{
+			out.push_back(static_cast<char>(value_tag::string));
+			write_string(out, v);
+		}
+		else if constexpr (std::is_same_v<T, serialization::array>)
+		{
+			out.push_back(static_cast<char>(value_tag::array));
+			write_varint(out, v.v.size());
+			for (const serialization::value& item : v.v)
+				write_value(out, item);
+		}
+		else
+		{
+			out.push_back(static_cast<char>(value_tag::object));
+			write_varint(out, v.v.size());
+			for (const auto& [key, item] : v.v)
+			{
+				write_string(out, key);
+				write_value(out, item);
+			}
+		}
+	}, value);
+}
+
+// Single producer (the logging thread), single consumer (the writer thread) ring of complete frames.
+struct thread_buffer
+{
+	thread_buffer(size_t capacity, std::uint64_t index)
+		: m_data(std::bit_ceil(std::max(capacity, min_buffer_size))), m_index{index}
+	{}
+
+	std::vector<char> m_data;
+	const std::uint64_t m_index;
+	std::atomic<std::uint64_t> m_head{0}; ///< Written by the logging thread.
+	std::atomic<std::uint64_t> m_tail{0}; ///< Written by the writer thread.
+	std::atomic<std::uint64_t> m_records{0};
+	std::atomic<std::uint64_t> m_dropped{0};
+	std::atomic<std::uint64_t> m_waits{0};
+	std::atomic<bool> m_abandoned{false}; ///< Set when the logging thread exits.
+	std::atomic<bool> m_closed{false}; ///< Set when the sink is destroyed.
+
+	// Used only by the logging thread.
+	std::map<std::pair<const char*, std::uint_least32_t>, std::uint64_t> m_locations;
+	std::string m_frame;
+	std::string m_payload;
+
+	// Used only by the writer thread.
+	std::uint64_t m_reported_dropped = 0;
+
+	size_t capacity() const { return m_data.size(); }
+
+	void copy_in(std::uint64_t position, const std::string& bytes)
+	{
+		size_t offset = position & (capacity() - 1);
+		size_t first_part = std::min(bytes.size(), capacity() - offset);
+		std::memcpy(m_data.data() + offset, bytes.data(), first_part);
+		std::memcpy(m_data.data(), bytes.data() + first_part, bytes.size() - first_part);
+	}
+
+	void copy_out(std::uint64_t from, std::uint64_t to, std::string& out) const
+	{
+		size_t offset = from & (capacity() - 1);
+		size_t size = to - from;
+		size_t first_part = std::min(size, capacity() - offset);
+		out.append(m_data.data() + offset, first_part);
+		out.append(m_data.data(), size - first_part);
+	}
+};
+
+} // anonymous namespace
+
+struct async_binary_sink::state
+{
+	state(ref_or_owned<std::ostream> stream, sink_buffer_size buffer_size, sink_overflow_policy policy)
+		: m_stream{std::move(stream)}, m_buffer_size{buffer_size.v}, m_policy{policy.v}, m_id{next_id()}
+	{
+		std::string header{binary_log_magic};
+		header.push_back(static_cast<char>(binary_log_version));
+		m_stream.get().write(header.data(), header.size());
+		m_writer = std::thread{[this]() { run_writer(); }};
+	}
+
+	~state()
+	{
+		{
+			std::lock_guard lock{m_mutex};
+			m_stop = true;
+		}
+		m_wake_writer.notify_one();
+		m_writer.join();
+		for (const std::shared_ptr<thread_buffer>& buffer : m_buffers)
+			buffer->m_closed.store(true, std::memory_order_release);
+	}
+
+	static std::uint64_t next_id()
+	{
+		static std::atomic<std::uint64_t> last_id{0};
+		return ++last_id;
+	}
+
+	thread_buffer& current_thread_buffer()
+	{
+		struct registration
+		{
+			std::uint64_t sink_id;
+			std::shared_ptr<thread_buffer> buffer;
+		};
+		struct registrations
+		{
+			std::vector<registration> v;
+			~registrations()
+			{
+				for (registration& r : v)
+					r.buffer->m_abandoned.store(true, std::memory_order_release);
+			}
+		};
+		thread_local registrations thread_registrations;
+		for (const registration& r : thread_registrations.v)
+			if (r.sink_id == m_id)
+				return *r.buffer;
+		std::erase_if(thread_registrations.v, [](const registration& r) { return r.buffer->m_closed.load(std::memory_order_acquire); });
+
+		std::shared_ptr<thread_buffer> buffer;
+		{
+			std::lock_guard lock{m_mutex};
+			buffer = std::make_shared<thread_buffer>(m_buffer_size, m_next_thread_index++);
+			m_buffers.push_back(buffer);
+		}
+		thread_registrations.v.push_back(registration{m_id, buffer});
+		std::string thread_id = std::get<std::string>(serialization::full(std::this_thread::get_id()));
+		buffer->m_payload.clear();
+		buffer->m_payload.push_back(static_cast<char>(frame_kind::thread));
+		write_varint(buffer->m_payload, buffer->m_index);
+		write_definition_string(buffer->m_payload, thread_id);
+		// The definition frame must not be dropped, because records refer to it.
+		push_frame(*buffer, overflow_policy::block);
+		return *buffer;
+	}
+
+	// Returns nothing if the location could not be written, records referring to it must be dropped then.
+	std::optional<std::uint64_t> location_index(thread_buffer& buffer, const source_location& location)
+	{
+		auto [it, inserted] = buffer.m_locations.try_emplace({location.function_name(), location.line()}, buffer.m_locations.size());
+		if (inserted)
+		{
+			buffer.m_payload.clear();
+			buffer.m_payload.push_back(static_cast<char>(frame_kind::location));
+			write_varint(buffer.m_payload, buffer.m_index);
+			write_varint(buffer.m_payload, it->second);
+			write_definition_string(buffer.m_payload, location.file_name());
+			write_varint(buffer.m_payload, location.line());
+			write_definition_string(buffer.m_payload, location.function_name());
+			if (!push_frame(buffer, overflow_policy::block))
+			{
+				buffer.m_locations.erase(it);
+				return std::nullopt;
+			}
+		}
+		return it->second;
+	}
+
+	// Copies m_payload of the buffer as a frame. Returns false if the frame was dropped.
+	bool push_frame(thread_buffer& buffer, overflow_policy policy)
+	{
+		buffer.m_frame.clear();
+		write_varint(buffer.m_frame, buffer.m_payload.size());
+		buffer.m_frame.append(buffer.m_payload);
+		const size_t size = buffer.m_frame.size();
+		if (size > buffer.capacity())
+			return false;
+		const std::uint64_t head = buffer.m_head.load(std::memory_order_relaxed);
+		bool waited = false;
+		while (head + size - buffer.m_tail.load(std::memory_order_acquire) > buffer.capacity())
+		{
+			if (policy == overflow_policy::drop)
+				return false;
+			if (!waited)
+			{
+				buffer.m_waits.fetch_add(1, std::memory_order_relaxed);
+				waited = true;
+			}
+			wake_writer();
+			std::this_thread::sleep_for(std::chrono::microseconds{100});
+		}
+		buffer.copy_in(head, buffer.m_frame);
+		buffer.m_head.store(head + size, std::memory_order_release);
+		// Wake the writer early if the buffer is getting full, otherwise it drains buffers periodically.
+		if (head + size - buffer.m_tail.load(std::memory_order_relaxed) > buffer.capacity() / 2)
+			wake_writer();
+		return true;
+	}
+
+	void wake_writer()
+	{
+		if (!m_wake_requested.exchange(true, std::memory_order_relaxed))
+			m_wake_writer.notify_one();
+	}
+
+	void run_writer()
+	{
+		std::string batch;
+		std::unique_lock lock{m_mutex};
+		for (;;)
+		{
+			// Notifications are sent without the mutex, so one may be missed. The timeout bounds the delay.
+			m_wake_writer.wait_for(lock, writer_interval,
+				[this]() { return m_stop || m_flush_requested || m_wake_requested.load(std::memory_order_relaxed); });
+			m_wake_requested.store(false, std::memory_order_relaxed);
+			const bool stop = m_stop;
+			m_flush_requested = false;
+			m_writing = true;
+			std::vector<std::shared_ptr<thread_buffer>> buffers = m_buffers;
+			lock.unlock();
+
+			for (const std::shared_ptr<thread_buffer>& buffer : buffers)
+				drain(*buffer, batch);
+			if (!batch.empty())
+			{
+				m_stream.get().write(batch.data(), batch.size());
+				m_stream.get().flush();
+				m_batches.fetch_add(1, std::memory_order_relaxed);
+				m_bytes.fetch_add(batch.size(), std::memory_order_relaxed);
+				batch.clear();
+			}
+
+			lock.lock();
+			std::erase_if(m_buffers, [this](const std::shared_ptr<thread_buffer>& buffer)
+			{
+				bool finished = buffer->m_abandoned.load(std::memory_order_acquire) &&
+					buffer->m_tail.load(std::memory_order_relaxed) == buffer->m_head.load(std::memory_order_acquire);
+				if (finished)
+					add_statistics(m_finished_buffers, *buffer);
+				return finished;
+			});
+			m_writing = false;
+			++m_cycles;
+			m_writer_cycle_done.notify_all();
+			if (stop)
+				return;
+		}
+	}
+
+	static void drain(thread_buffer& buffer, std::string& batch)
+	{
+		const std::uint64_t tail = buffer.m_tail.load(std::memory_order_relaxed);
+		const std::uint64_t head = buffer.m_head.load(std::memory_order_acquire);
+		buffer.copy_out(tail, head, batch);
+		buffer.m_tail.store(head, std::memory_order_release);
+		const std::uint64_t dropped = buffer.m_dropped.load(std::memory_order_relaxed);
+		if (dropped != buffer.m_reported_dropped)
+		{
+			std::string payload;
+			payload.push_back(static_cast<char>(frame_kind::dropped));
+			write_varint(payload, buffer.m_index);
+			write_varint(payload, dropped - buffer.m_reported_dropped);
+			write_varint(batch, payload.size());
+			batch.append(payload);
+			buffer.m_reported_dropped = dropped;
+		}
+	}
+
+	static void add_statistics(async_sink_statistics& statistics, const thread_buffer& buffer)
+	{
+		statistics.records += buffer.m_records.load(std::memory_order_relaxed);
+		statistics.dropped += buffer.m_dropped.load(std::memory_order_relaxed);
+		statistics.waits += buffer.m_waits.load(std::memory_order_relaxed);
+	}
+
+	ref_or_owned<std::ostream> m_stream;
+	const size_t m_buffer_size;
+	const overflow_policy m_policy;
+	const std::uint64_t m_id;
+	std::mutex m_mutex;
+	std::condition_variable m_wake_writer;
+	std::condition_variable m_writer_cycle_done;
+	std::atomic<bool> m_wake_requested{false};
+	bool m_flush_requested = false;
+	bool m_writing = false;
+	bool m_stop = false;
+	std::uint64_t m_cycles = 0;
+	std::uint64_t m_next_thread_index = 0;
+	std::vector<std::shared_ptr<thread_buffer>> m_buffers;
+	async_sink_statistics m_finished_buffers{};
+	std::atomic<std::uint64_t> m_batches{0};
+	std::atomic<std::uint64_t> m_bytes{0};
+	std::thread m_writer;
+};
+
+async_binary_sink::async_binary_sink(ref_or_owned<std::ostream> stream, sink_buffer_size buffer_size, sink_overflow_policy policy)
+	: m_state{std::make_shared<state>(std::move(stream), buffer_size, policy)}
+{}
+
+void async_binary_sink::operator()(const record& rec) const
+{
+	thread_buffer& buffer = m_state->current_thread_buffer();
+	std::optional<std::uint64_t> location = m_state->location_index(buffer, rec.m_location);
+	if (!location)
+	{
+		buffer.m_dropped.fetch_add(1, std::memory_order_relaxed);
+		return;
+	}
+	auto time = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+	buffer.m_payload.clear();
+	buffer.m_payload.push_back(static_cast<char>(frame_kind::record));
+	write_varint(buffer.m_payload, buffer.m_index);
+	write_varint(buffer.m_payload, *location);
+	write_varint(buffer.m_payload, static_cast<std::uint64_t>(time));
+	write_value(buffer.m_payload, rec.m_context);
+	if (m_state->push_frame(buffer, m_state->m_policy))
+		buffer.m_records.fetch_add(1, std::memory_order_relaxed);
+	else
+		buffer.m_dropped.fetch_add(1, std::memory_order_relaxed);
+}
+
+void async_binary_sink::flush() const
+{
+	std::unique_lock lock{m_state->m_mutex};
+	// A cycle in progress may have collected buffers before the call, so wait for the next one as well.
+	std::uint64_t target_cycle = m_state->m_cycles + (m_state->m_writing ? 2 : 1);
+	m_state->m_flush_requested = true;
+	m_state->m_wake_writer.notify_one();
+	m_state->m_writer_cycle_done.wait(lock, [&]() { return m_state->m_cycles >= target_cycle; });
+}
+
+async_sink_statistics async_binary_sink::statistics() const
+{
+	std::lock_guard lock{m_state->m_mutex};
+	async_sink_statistics statistics = m_state->m_finished_buffers;
+	for (const std::shared_ptr<thread_buffer>& buffer : m_state->m_buffers)
+		state::add_statistics(statistics, *buffer);
+	statistics.batches = m_state->m_batches.load(std::memory_order_relaxed);
+	statistics.bytes = m_state->m_bytes.load(std::memory_order_relaxed);
+	return statistics;
+}
+
+namespace
+{
+
+class binary_log_reader
+{
+public:
+	explicit binary_log_reader(std::string_view data) : m_data{data} {}
+
+	bool at_end() const { return m_position == m_data.size(); }
+
+	std::uint8_t byte()
+	{
+		return static_cast<std::uint8_t>(take(1)[0]);
+	}
+
+	std::uint64_t varint()
+	{
+		std::uint64_t v = 0;
+		for (int shift = 0; ; shift += 7)
+		{
+			throw_if(shift > 63, "Invalid number in binary log", errors::uninterpretable_data{});
+			std::uint8_t b = byte();
+			v |= std::uint64_t{b & 0x7fu} << shift;
+			if (!(b & 0x80))
+				return v;
+		}
+	}
+
+	std::string_view take(std::uint64_t size)
+	{
+		throw_if(size > m_data.size() - m_position, "Truncated binary log", errors::uninterpretable_data{});
+		std::string_view v = m_data.substr(m_position, size);
+		m_position += size;
+		return v;
+	}
+
+	std::string string() { return std::string{take(varint())}; }
+
+	serialization::value value()
+	{
+		value_tag tag = static_cast<value_tag>(byte());
+		switch (tag)
+		{
+			case value_tag::null: return nullptr;
+			case value_tag::boolean_false: return false;
+			case value_tag::boolean_true: return true;
+			case value_tag::int64:
+			{
+				std::uint64_t v = varint();
+				return static_cast<std::int64_t>(v >> 1) ^ -static_cast<std::int64_t>(v & 1);
+			}
+			case value_tag::uint64: return varint();
+			case value_tag::real: return std::bit_cast<double>(varint());
+			case value_tag::string: return string();
+			case value_tag::array:
+			{
+				serialization::array a;
+				for (std::uint64_t i = varint(); i > 0; --i)
+					a.v.push_back(value());
+				return a;
+			}
+			case value_tag::object:
+			{
+				serialization::object o;
+				for (std::uint64_t i = varint(); i > 0; --i)
+				{
+					std::string key = string();
+					o.v[key] = value();
+				}
+				return o;
+			}
+		}
+		throw make_error("Invalid value in binary log", static_cast<int>(tag), errors::uninterpretable_data{});
+	}
+
+private:
+	std::string_view m_data;
+	size_t m_position = 0;
+};
+
+struct logged_location
+{
+	std::string file_name;
+	std::uint_least32_t line;
+	std::string function_name;
+};
+
+} // anonymous namespace
+
+void binary_log_to_json(std::istream& binary_log, std::ostream& json_log)
+{
+	std::string data{std::istreambuf_iterator<char>{binary_log}, std::istreambuf_iterator<char>{}};
+	binary_log_reader reader{data};
+	throw_if(reader.take(binary_log_magic.size()) != binary_log_magic, "Not a binary log", errors::uninterpretable_data{});
+	std::uint8_t version = reader.byte();
+	throw_if(version != binary_log_version, "Unsupported binary log version", version, errors::uninterpretable_data{});
+
+	std::unordered_map<std::uint64_t, std::string> threads;
+	std::map<std::pair<std::uint64_t, std::uint64_t>, logged_location> locations;
+	bool first_record = true;
+	auto write_record = [&](const serialization::object& record_object)
+	{
+		json_log << (first_record ? "[" : ",") << std::endl << serialization::to_json(record_object);
+		first_record = false;
+	};
+
+	while (!reader.at_end())
+	{
+		binary_log_reader frame{reader.take(reader.varint())};
+		frame_kind kind = static_cast<frame_kind>(frame.byte());
+		std::uint64_t thread_index = frame.varint();
+		switch (kind)
+		{
+			case frame_kind::thread:
+				threads[thread_index] = frame.string();
+				break;
+			case frame_kind::location:
+			{
+				std::uint64_t location_index = frame.varint();
+				logged_location location;
+				location.file_name = frame.string();
+				location.line = static_cast<std::uint_least32_t>(frame.varint());
+				location.function_name = frame.string();
+				locations[{thread_index, location_index}] = std::move(location);
+				break;
+			}
+			case frame_kind::record:
+			{
+				auto location = locations.find({thread_index, frame.varint()});
+				throw_if(location == locations.end(), "Record refers to unknown location", errors::uninterpretable_data{});
+				std::chrono::system_clock::time_point time{std::chrono::duration_cast<std::chrono::system_clock::duration>(
+					std::chrono::nanoseconds{static_cast<std::int64_t>(frame.varint())})};
+				serialization::object record_object = create_base_metadata(time, location->second.file_name, location->second.line,
+					location->second.function_name, threads[thread_index]);
+				record_object.v["log"] = frame.value();
+				write_record(record_object);
+				break;
+			}
+			case frame_kind::dropped:
+				write_record(serialization::object{{
+					{"thread_id", threads[thread_index]},
+					{"dropped_records", frame.varint()}
+				}});
+				break;
+			default:
+				throw make_error("Unknown frame in binary log", static_cast<int>(kind), errors::uninterpretable_data{});
+		}
+	}
+	if (!first_record)
+		json_log << std::endl << "]" << std::endl;
+}
+
+} // namespace docwire::log
@@ -0,0 +1,88 @@
+/*********************************************************************************************************************************************/
+/*  DocWire SDK: Award-winning modern data processing in C++20. SourceForge Community Choice & Microsoft support. AI-driven processing.      */
+/*  Supports nearly 100 data formats, including email boxes and OCR. Boost efficiency in text extraction, web data extraction, data mining,  */
+/*  document analysis. Offline processing possible for security and confidentiality                                                          */
+/*                                                                                                                                           */
+/*  Copyright (c) SILVERCODERS Ltd, http://silvercoders.com                                                                                  */
+/*  Project homepage: https://github.com/docwire/docwire                                                                                     */
+/*                                                                                                                                           */
+/*  SPDX-License-Identifier: AGPL-3.0-only OR LicenseRef-DocWire-Commercial                                                                  */
+/*********************************************************************************************************************************************/
+
+#ifndef DOCWIRE_LOG_ASYNC_BINARY_SINK_H
+#define DOCWIRE_LOG_ASYNC_BINARY_SINK_H
+
+#include "core_export.h"
+#include <cstdint>
+#include <istream>
+#include "log_core.h"
+#include <memory>
+#include <ostream>
+#include "ref_or_owned.h"
+
+namespace docwire::log
+{
+
+/// What a logging thread does when its buffer in async_binary_sink is full.
+enum class overflow_policy
+{
+	drop, ///< The record is dropped and counted. The count is written to the log.
+	block ///< The logging thread waits until the writer thread makes room.
+};
+
+/// Size in bytes of the buffer allocated for every logging thread. Rounded up to a power of two, at least 4096.
+struct sink_buffer_size { size_t v; };
+
+struct sink_overflow_policy { overflow_policy v; };
+
+/// Counters of an async_binary_sink.
+struct async_sink_statistics
+{
+	std::uint64_t records; ///< Records accepted from logging threads.
+	std::uint64_t dropped; ///< Records dropped because a buffer was full or the record did not fit in a buffer.
+	std::uint64_t waits; ///< Times a logging thread waited for free space (overflow_policy::block).
+	std::uint64_t batches; ///< Writes to the output stream.
+	std::uint64_t bytes; ///< Bytes written to the output stream.
+};
+
+/**
+ * @brief Log sink that writes records in a compact binary format from a background thread.
+ *
+ * Every logging thread encodes its records into its own lock-free ring buffer. A writer thread collects them in
+ * batches and writes them to the stream, so logging threads do not format JSON, allocate or make system calls.
+ * File names, function names and thread identifiers are written once per thread and referenced by records.
+ *
+ * Records of different threads may be written out of order. The log can be converted to the format of
+ * json_stream_sink with binary_log_to_json() or the docwire_log_to_json tool.
+ *
+ * @code
+ * log::set_sink(log::async_binary_sink(std::ofstream{"docwire.log", std::ios::binary}));
+ * @endcode
+ */
+class DOCWIRE_CORE_EXPORT async_binary_sink
+{
+public:
+	explicit async_binary_sink(ref_or_owned<std::ostream> stream, sink_buffer_size buffer_size = {256 * 1024},
+		sink_overflow_policy policy = {overflow_policy::drop});
+
+	void operator()(const record& rec) const;
+
+	/// Waits until records logged before the call are written to the stream and the stream is flushed.
+	void flush() const;
+
+	async_sink_statistics statistics() const;
+
+private:
+	struct state;
+	std::shared_ptr<state> m_state;
+};
+
+/**
+ * @brief Converts a log written by async_binary_sink to the JSON format of json_stream_sink.
+ * @throws errors::uninterpretable_data if the input is not a valid binary log.
+ */
+DOCWIRE_CORE_EXPORT void binary_log_to_json(std::istream& binary_log, std::ostream& json_log);
+
+} // namespace docwire::log
+
+#endif // DOCWIRE_LOG_ASYNC_BINARY_SINK_H
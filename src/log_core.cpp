@@ -20,6 +20,9 @@
 #include <iomanip>
 #include "serialization_filesystem.h" // IWYU pragma: keep
 #include "serialization_thread_id.h" // IWYU pragma: keep
+#include <limits>
+#include "log_async_binary_sink.h"
+#include <memory>
 #include <mutex>
 #include <sstream>
 #include "type_name_base.h"
@@ -38,6 +41,8 @@ struct filter_spec
 {
 	std::vector<filter_rule> rules;
 	bool wildcard_enabled = false;
+	std::string spec;
+	std::uint32_t generation = 1;
 };
 
 static filter_spec parse_log_filter(const std::string& filter_str)
@@ -82,22 +87,33 @@ static filter_spec parse_log_filter(const std::string& filter_str)
 	return filter;
 }
 
+// Serializes set_filter() calls. Readers use the published filter without locking.
 static std::mutex g_log_filter_mutex;
 
-static filter_spec g_log_filter;
-static std::string g_log_filter_str;
+// Published filters are immutable and never freed, so readers do not need to synchronize with set_filter().
+// Filters are changed rarely, so the retained memory is negligible.
+static std::vector<std::unique_ptr<const filter_spec>> g_log_filters;
+static std::atomic<const filter_spec*> g_log_filter{nullptr};
+static std::atomic<std::uint32_t> g_log_filter_generation{1};
 
 void set_filter(const std::string& filter_spec)
 {
 	std::lock_guard lock(g_log_filter_mutex);
-	g_log_filter = parse_log_filter(filter_spec);
-	g_log_filter_str = filter_spec;
+	auto filter = std::make_unique<log::filter_spec>(parse_log_filter(filter_spec));
+	filter->spec = filter_spec;
+	filter->generation = g_log_filter_generation.load(std::memory_order_relaxed) + 1;
+	// Generation is stored in 31 bits of call site state.
+	if (filter->generation > (std::numeric_limits<std::uint32_t>::max() >> 1))
+		filter->generation = 1;
+	g_log_filter.store(filter.get(), std::memory_order_release);
+	g_log_filter_generation.store(filter->generation, std::memory_order_release);
+	g_log_filters.push_back(std::move(filter));
 }
 
 std::string get_filter()
 {
-	std::lock_guard lock(g_log_filter_mutex);
-	return g_log_filter_str;
+	const filter_spec* filter = g_log_filter.load(std::memory_order_acquire);
+	return filter ? filter->spec : std::string{};
 }
 
 static bool wildcard_match(const std::string_view& pattern, const std::string_view& text)
@@ -140,12 +156,11 @@ static bool wildcard_match(const std::string_view& pattern, const std::string_vi
 	return pattern_iter == pattern.end();
 }
 
-bool detail::is_enabled(const source_location& location, std::span<const std::string_view> tags)
+static bool is_enabled_by(const filter_spec& filter, const source_location& location, std::span<const std::string_view> tags)
 {
-	std::lock_guard lock(g_log_filter_mutex);
-	const auto& filter = g_log_filter;
-
-	std::string filename = std::filesystem::path(location.file_name()).filename().string();
+	std::string_view filename = location.file_name();
+	if (size_t separator = filename.find_last_of("/\\"); separator != std::string_view::npos)
+		filename.remove_prefix(separator + 1);
 	std::string funcname = docwire::type_name::pretty_function(location.function_name());
 
 	// 1. Process "deny" rules first. A single negative match immediately disables the log.
@@ -184,28 +199,60 @@ bool detail::is_enabled(const source_location& location, std::span<const std::st
 	return false; // Not enabled by any rule.
 }
 
+bool detail::is_enabled(const source_location& location, std::span<const std::string_view> tags)
+{
+	return evaluate_filter(location, tags) & 1;
+}
+
+std::uint32_t detail::filter_generation()
+{
+	return g_log_filter_generation.load(std::memory_order_relaxed);
+}
+
+std::uint32_t detail::evaluate_filter(const source_location& location, std::span<const std::string_view> tags)
+{
+	const filter_spec* filter = g_log_filter.load(std::memory_order_acquire);
+	if (!filter)
+		return 1 << 1;
+	return (filter->generation << 1) | (is_enabled_by(*filter, location, tags) ? 1 : 0);
+}
+
 static std::atomic<bool> g_logging_enabled{false};
-static std::function<void(const log::record&)> g_log_callback;
+static std::shared_ptr<const std::function<void(const log::record&)>> g_log_callback;
+static bool g_log_callback_concurrent = false;
 static std::mutex g_log_callback_mutex;
 
 static void write_log_record(const log::record& rec)
 {
-	std::lock_guard lock(g_log_callback_mutex);
-	if (g_log_callback)
-		g_log_callback(rec);
+	std::unique_lock lock(g_log_callback_mutex);
+	if (!g_log_callback)
+		return;
+	if (!g_log_callback_concurrent)
+	{
+		(*g_log_callback)(rec);
+		return;
+	}
+	// Thread-safe sinks are called without the lock, it is held only to copy the pointer.
+	std::shared_ptr<const std::function<void(const log::record&)>> callback = g_log_callback;
+	lock.unlock();
+	(*callback)(rec);
 }
 
 void set_sink(std::function<void(const log::record&)> callback)
 {
+	std::shared_ptr<const std::function<void(const log::record&)>> old_callback;
 	std::lock_guard lock(g_log_callback_mutex);
-	g_log_callback = std::move(callback);
+	old_callback = std::move(g_log_callback);
+	g_log_callback_concurrent = callback.target<async_binary_sink>() != nullptr;
+	if (callback)
+		g_log_callback = std::make_shared<const std::function<void(const log::record&)>>(std::move(callback));
 	g_logging_enabled.store(static_cast<bool>(g_log_callback), std::memory_order_release);
 }
 
 std::function<void(const record&)> get_sink()
 {
     std::lock_guard lock(g_log_callback_mutex);
-    return g_log_callback;
+    return g_log_callback ? *g_log_callback : std::function<void(const record&)>{};
 }
 
 bool detail::is_logging_enabled()
@@ -213,10 +260,11 @@ bool detail::is_logging_enabled()
 	return g_logging_enabled.load(std::memory_order_acquire);
 }
 
-serialization::object create_base_metadata(source_location location)
+serialization::object create_base_metadata(std::chrono::system_clock::time_point time, std::string_view file_name,
+	std::uint_least32_t line, std::string_view function_name, const std::string& thread_id)
 {
 	serialization::object metadata;
-	boost::posix_time::ptime utc_time = boost::posix_time::second_clock::universal_time();
+	boost::posix_time::ptime utc_time = boost::posix_time::from_time_t(std::chrono::system_clock::to_time_t(time));
 	boost::date_time::c_local_adjustor<boost::posix_time::ptime> local_adjustor;
 	boost::posix_time::ptime local_time = local_adjustor.utc_to_local(utc_time);
 	boost::posix_time::time_duration timezone_offset = local_time - utc_time;
@@ -229,14 +277,20 @@ serialization::object create_base_metadata(source_location location)
 
 	metadata.v = {
 		{"timestamp", time_stream.str()},
-		{"file", serialization::full(std::filesystem::path(location.file_name()).filename())},
-		{"line", static_cast<std::int64_t>(location.line())},
-		{"function", docwire::type_name::pretty_function(location.function_name())},
-		{"thread_id", serialization::full(std::this_thread::get_id())}
+		{"file", serialization::full(std::filesystem::path(file_name).filename())},
+		{"line", static_cast<std::int64_t>(line)},
+		{"function", docwire::type_name::pretty_function(std::string{function_name})},
+		{"thread_id", thread_id}
 	};
 	return metadata;
 }
 
+serialization::object create_base_metadata(source_location location)
+{
+	return create_base_metadata(std::chrono::system_clock::now(), location.file_name(), location.line(), location.function_name(),
+		std::get<std::string>(serialization::full(std::this_thread::get_id())));
+}
+
 record::record(source_location location, serialization::array&& context)
 	: m_location(location), m_context(std::move(context))
 {}
@@ -15,6 +15,9 @@
 #include "core_export.h"
 #include "serialization_base.h"
 #include "source_location.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
 #include <functional>
 #include <span>
 #include <string>
@@ -68,9 +71,16 @@ DOCWIRE_CORE_EXPORT std::string get_filter();
 
 /**
  * @brief Sets the global callback function that will receive all enabled log records.
+ *
+ * Calls of the sink are serialized, and once set_sink returns the previous sink is no longer being called,
+ * so its stream can be destroyed. An async_binary_sink is thread-safe and is called by many threads at once
+ * instead; calls that started before set_sink may still be running after it returns, and its state (including
+ * an owned stream) is kept alive until they finish.
+ *
  * @param callback A function that takes a `const serialization::object&` and processes it.
  *                 This is the primary mechanism for customizing the log sink.
  * @see json_stream_sink
+ * @see async_binary_sink
  */
 DOCWIRE_CORE_EXPORT void set_sink(std::function<void(const log::record&)> callback);
 
@@ -87,11 +97,56 @@ DOCWIRE_CORE_EXPORT std::function<void(const record&)> get_sink();
  */
 DOCWIRE_CORE_EXPORT serialization::object create_base_metadata(source_location location);
 
+/**
+ * @brief Creates a base serialization object with metadata of a record captured earlier.
+ *
+ * Used by sinks that store records in another form and convert them to the structured form later.
+ * @see create_base_metadata(source_location)
+ */
+DOCWIRE_CORE_EXPORT serialization::object create_base_metadata(std::chrono::system_clock::time_point time, std::string_view file_name,
+	std::uint_least32_t line, std::string_view function_name, const std::string& thread_id);
+
 namespace detail
 {
 // This is an internal helper function for the log_entry macro.
 DOCWIRE_CORE_EXPORT bool is_enabled(const source_location& location, std::span<const std::string_view> entry_tags);
 DOCWIRE_CORE_EXPORT bool is_logging_enabled();
+
+/// Returns a number changed by every set_filter() call.
+DOCWIRE_CORE_EXPORT std::uint32_t filter_generation();
+
+/// Evaluates the current filter. Returns the filter generation shifted left by one, with the lowest bit set if enabled.
+DOCWIRE_CORE_EXPORT std::uint32_t evaluate_filter(const source_location& location, std::span<const std::string_view> entry_tags);
+
+/**
+ * @brief Filter decision cached for a single log call site and set of tags.
+ *
+ * The decision is stored together with the filter generation it was evaluated for and is evaluated again
+ * after set_filter(). Checking a cached decision does not lock or allocate. The constructor is constexpr,
+ * so static instances declared by the logging macros are constant-initialized.
+ */
+class call_site_filter
+{
+public:
+	constexpr call_site_filter() noexcept = default;
+
+	call_site_filter(const call_site_filter&) = delete;
+	call_site_filter& operator=(const call_site_filter&) = delete;
+
+	bool is_enabled(const source_location& location, std::span<const std::string_view> entry_tags)
+	{
+		std::uint32_t state = m_state.load(std::memory_order_relaxed);
+		if ((state >> 1) != filter_generation())
+		{
+			state = evaluate_filter(location, entry_tags);
+			m_state.store(state, std::memory_order_relaxed);
+		}
+		return state & 1;
+	}
+
+private:
+	std::atomic<std::uint32_t> m_state{0};
+};
 }
 
 } // namespace docwire::log
@@ -116,18 +116,34 @@ constexpr auto collect_tags() {
 }
 } // namespace detail
 
+namespace detail
+{
+template<typename... Args>
+void write_entry(source_location location, std::tuple<Args...>&& args_tuple)
+{
+    serialization::array context_array;
+    std::apply([&](const auto&... items) {
+        (context_array.v.push_back(detail::to_log_value(items)), ...);
+    }, std::move(args_tuple));
+    record(location, std::move(context_array));
+}
+} // namespace detail
+
 template<typename... Args>
 void entry(source_location location, std::tuple<Args...>&& args_tuple)
 {
     constexpr auto tags = detail::collect_tags<Args...>();
     if (detail::is_enabled(location, std::span{tags}))
-    {
-        serialization::array context_array;
-        std::apply([&](const auto&... items) {
-            (context_array.v.push_back(detail::to_log_value(items)), ...);
-        }, std::move(args_tuple));
-        record(location, std::move(context_array));
-    }
+        detail::write_entry(location, std::move(args_tuple));
+}
+
+/// Same as entry(location, args_tuple), but the filter decision is cached in the call site object.
+template<typename... Args>
+void entry(detail::call_site_filter& call_site, source_location location, std::tuple<Args...>&& args_tuple)
+{
+    constexpr auto tags = detail::collect_tags<Args...>();
+    if (call_site.is_enabled(location, std::span{tags}))
+        detail::write_entry(location, std::move(args_tuple));
 }
 
 #ifdef NDEBUG
@@ -135,7 +151,8 @@ void entry(source_location location, std::tuple<Args...>&& args_tuple)
         do { \
             if constexpr (docwire::log::detail::should_log_in_release<DOCWIRE_LOG_GET_TYPES(__VA_ARGS__)>()) { \
                 if (docwire::log::detail::is_logging_enabled()) { \
-                    docwire::log::entry(docwire::source_location::current(), std::make_tuple(DOCWIRE_DIAGNOSTIC_CONTEXT_MAKE_TUPLE(__VA_ARGS__))); \
+                    static docwire::log::detail::call_site_filter docwire_log_call_site; \
+                    docwire::log::entry(docwire_log_call_site, docwire::source_location::current(), std::make_tuple(DOCWIRE_DIAGNOSTIC_CONTEXT_MAKE_TUPLE(__VA_ARGS__))); \
                 } else { \
                     (void)0; \
                 } \
@@ -144,8 +161,10 @@ void entry(source_location location, std::tuple<Args...>&& args_tuple)
 #else
     #define DOCWIRE_LOG_ENTRY(...) \
         do { \
-            if (docwire::log::detail::is_logging_enabled()) \
-                docwire::log::entry(docwire::source_location::current(), std::make_tuple(DOCWIRE_DIAGNOSTIC_CONTEXT_MAKE_TUPLE(__VA_ARGS__))); \
+            if (docwire::log::detail::is_logging_enabled()) { \
+                static docwire::log::detail::call_site_filter docwire_log_call_site; \
+                docwire::log::entry(docwire_log_call_site, docwire::source_location::current(), std::make_tuple(DOCWIRE_DIAGNOSTIC_CONTEXT_MAKE_TUPLE(__VA_ARGS__))); \
+            } \
         } while (false)
 #endif
 
@@ -24,6 +24,13 @@ T&& and_forward_value(const char* expr_str, T&& value, source_location location,
 	return std::forward<T>(value);
 }
 
+template<typename T, typename... Args>
+T&& and_forward_value(detail::call_site_filter& call_site, const char* expr_str, T&& value, source_location location, Args&&... args)
+{
+	docwire::log::entry(call_site, location, std::make_tuple(docwire::diagnostic_context::make_context_item(expr_str, value), std::forward<Args>(args)...));
+	return std::forward<T>(value);
+}
+
 } // namespace docwire::log
 
 #ifdef NDEBUG
@@ -31,7 +38,8 @@ T&& and_forward_value(const char* expr_str, T&& value, source_location location,
 		[]<typename T>(const auto& loc, T&& val) -> decltype(auto) { \
 			if constexpr (docwire::log::detail::should_log_in_release<decltype(docwire::diagnostic_context::make_context_item(#value, val)) __VA_OPT__(,) DOCWIRE_LOG_GET_TYPES(__VA_ARGS__)>()) { \
                 if (docwire::log::detail::is_logging_enabled()) { \
-				    return docwire::log::and_forward_value(#value, std::forward<T>(val), loc __VA_OPT__(,) __VA_ARGS__); \
+				    static docwire::log::detail::call_site_filter call_site; \
+				    return docwire::log::and_forward_value(call_site, #value, std::forward<T>(val), loc __VA_OPT__(,) __VA_ARGS__); \
                 } else { \
                     return std::forward<T>(val); \
                 } \
@@ -42,8 +50,10 @@ T&& and_forward_value(const char* expr_str, T&& value, source_location location,
 #else
 	#define DOCWIRE_LOG_FORWARD(value, ...) \
         []<typename T>(const auto& loc, T&& val) -> decltype(auto) { \
-            if (docwire::log::detail::is_logging_enabled()) \
-                return docwire::log::and_forward_value(#value, std::forward<T>(val), loc __VA_OPT__(,) __VA_ARGS__); \
+            if (docwire::log::detail::is_logging_enabled()) { \
+                static docwire::log::detail::call_site_filter call_site; \
+                return docwire::log::and_forward_value(call_site, #value, std::forward<T>(val), loc __VA_OPT__(,) __VA_ARGS__); \
+            } \
             return std::forward<T>(val); \
         }(docwire::source_location::current(), (value))
 #endif
@@ -13,11 +13,21 @@
 #define DOCWIRE_LOG_SCOPE_H
 
 #include "log_entry.h"
+#include "tracing.h"
 
 namespace docwire::log {
 
 namespace detail {
 
+/**
+ * @brief Filter decisions cached for a single log_scope call site.
+ */
+struct scope_call_site
+{
+    call_site_filter enter;
+    call_site_filter exit;
+};
+
 /**
  * @brief RAII class for logging scope entry and exit.
  */
@@ -27,23 +37,51 @@ public:
     scope(const Args&... args, const source_location& location = source_location::current()) noexcept
         : m_location(location), m_args_tuple(args...)
     {
-        if (detail::is_logging_enabled())
-        {
-            docwire::log::entry(m_location, std::tuple_cat(std::make_tuple(log::scope_enter{}), m_args_tuple));
-        }
+        log_enter();
+    }
+
+    scope(scope_call_site& call_site, const Args&... args, const source_location& location = source_location::current()) noexcept
+        : m_call_site(&call_site), m_location(location), m_args_tuple(args...)
+    {
+        log_enter();
     }
 
     ~scope() noexcept
     {
+        if (m_traced)
+            tracing::end();
         if (detail::is_logging_enabled())
         {
             try {
-                docwire::log::entry(m_location, std::tuple_cat(std::make_tuple(log::scope_exit{}), m_args_tuple));
+                auto args_tuple = std::tuple_cat(std::make_tuple(log::scope_exit{}), m_args_tuple);
+                if (m_call_site)
+                    docwire::log::entry(m_call_site->exit, m_location, std::move(args_tuple));
+                else
+                    docwire::log::entry(m_location, std::move(args_tuple));
             } catch(...) {}
         }
     }
 
 private:
+    void log_enter() noexcept
+    {
+        if (tracing::are_log_scopes_traced())
+        {
+            m_traced = true;
+            tracing::begin(m_location.function_name());
+        }
+        if (detail::is_logging_enabled())
+        {
+            auto args_tuple = std::tuple_cat(std::make_tuple(log::scope_enter{}), m_args_tuple);
+            if (m_call_site)
+                docwire::log::entry(m_call_site->enter, m_location, std::move(args_tuple));
+            else
+                docwire::log::entry(m_location, std::move(args_tuple));
+        }
+    }
+
+    scope_call_site* m_call_site = nullptr;
+    bool m_traced = false;
     source_location m_location;
     std::tuple<Args...> m_args_tuple;
 };
@@ -94,20 +132,31 @@ public:
     [[maybe_unused]] explicit scope(const Args&... args, const source_location& location = source_location::current()) noexcept
         : base(args..., location)
     {}
+    // Constructor used by the log_scope macro, with filter decisions cached per call site.
+    [[maybe_unused]] explicit scope(detail::scope_call_site& call_site, const Args&... args, const source_location& location = source_location::current()) noexcept
+        : base(call_site, args..., location)
+    {}
 };
 
-// Deduction guide to allow creating a scope object without explicitly specifying template arguments.
+// Deduction guides to allow creating a scope object without explicitly specifying template arguments.
 template<typename... Args>
 scope(const Args&...) -> scope<Args...>;
 
+template<typename... Args>
+scope(detail::scope_call_site&, const Args&...) -> scope<Args...>;
+
 } // namespace docwire::log
 
 #define DOCWIRE_LOG_SCOPE_CONCAT_IMPL(a, b) a##b
 #define DOCWIRE_LOG_SCOPE_CONCAT(a, b) DOCWIRE_LOG_SCOPE_CONCAT_IMPL(a, b)
 
 #define DOCWIRE_LOG_SCOPE(...) \
+    [[maybe_unused]] static docwire::log::detail::scope_call_site \
+    DOCWIRE_LOG_SCOPE_CONCAT(docwire_log_scope_call_site_at_line_, __LINE__); \
     [[maybe_unused]] docwire::log::scope \
-    DOCWIRE_LOG_SCOPE_CONCAT(docwire_log_scope_object_at_line_, __LINE__) {DOCWIRE_DIAGNOSTIC_CONTEXT_MAKE_TUPLE(__VA_ARGS__)}
+    DOCWIRE_LOG_SCOPE_CONCAT(docwire_log_scope_object_at_line_, __LINE__) { \
+        DOCWIRE_LOG_SCOPE_CONCAT(docwire_log_scope_call_site_at_line_, __LINE__) \
+        __VA_OPT__(, DOCWIRE_DIAGNOSTIC_CONTEXT_MAKE_TUPLE(__VA_ARGS__))}
 
 #ifdef DOCWIRE_ENABLE_SHORT_MACRO_NAMES
     #define log_scope(...) DOCWIRE_LOG_SCOPE(__VA_ARGS__)
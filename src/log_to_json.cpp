@@ -0,0 +1,51 @@
+/*********************************************************************************************************************************************/
+/*  DocWire SDK: Award-winning modern data processing in C++20. SourceForge Community Choice & Microsoft support. AI-driven processing.      */
+/*  Supports nearly 100 data formats, including email boxes and OCR. Boost efficiency in text extraction, web data extraction, data mining,  */
+/*  document analysis. Offline processing possible for security and confidentiality                                                          */
+/*                                                                                                                                           */
+/*  Copyright (c) SILVERCODERS Ltd, http://silvercoders.com                                                                                  */
+/*  Project homepage: https://github.com/docwire/docwire                                                                                     */
+/*                                                                                                                                           */
+/*  SPDX-License-Identifier: AGPL-3.0-only OR LicenseRef-DocWire-Commercial                                                                  */
+/*********************************************************************************************************************************************/
+
+#include "diagnostic_message.h"
+#include <fstream>
+#include <iostream>
+#include "log_async_binary_sink.h"
+
+// Converts a log written by log::async_binary_sink (docwire --log-format=binary) to JSON.
+int main(int argc, char* argv[])
+{
+	if (argc < 2 || argc > 3 || std::string{argv[1]} == "--help")
+	{
+		std::cerr << "Usage: docwire_log_to_json binary_log_file [json_log_file]" << std::endl;
+		return 1;
+	}
+	std::ifstream binary_log{argv[1], std::ios::binary};
+	if (!binary_log.is_open())
+	{
+		std::cerr << "Error: Unable to open log file: " << argv[1] << std::endl;
+		return 1;
+	}
+	std::ofstream json_log_file;
+	if (argc == 3)
+	{
+		json_log_file.open(argv[2]);
+		if (!json_log_file.is_open())
+		{
+			std::cerr << "Error: Unable to open output file: " << argv[2] << std::endl;
+			return 1;
+		}
+	}
+	try
+	{
+		docwire::log::binary_log_to_json(binary_log, argc == 3 ? json_log_file : std::cout);
+	}
+	catch (const std::exception& e)
+	{
+		std::cerr << "Error: " << docwire::errors::diagnostic_message(e) << std::endl;
+		return 1;
+	}
+	return 0;
+}
@@ -12,70 +12,218 @@
 #ifndef DOCWIRE_LRU_MEMORY_CACHE_H
 #define DOCWIRE_LRU_MEMORY_CACHE_H
 
+#include <algorithm>
+#include <atomic>
 #include <functional>
+#include <future>
 #include <limits>
 #include <list>
+#include <memory>
+#include <mutex>
+#include <optional>
 #include <unordered_map>
+#include <vector>
 
 namespace docwire
 {
 
 /**
- * @brief Least Recently Used (LRU) cache with fixed memory size.
+ * @brief Thread-safe Least Recently Used (LRU) cache with a global cost budget.
  *
- * Cache stores key-value pairs. If cache reaches its maximum size, it evicts least recently used
- * entry from the cache.
+ * Cache stores key-value pairs split into independently locked shards. Every entry has a cost
+ * computed by the cost function (1 by default, so the budget is a number of entries; return the
+ * size in bytes to make it a memory budget). If the total cost of all entries exceeds the budget,
+ * least recently used entries are evicted, starting with the shard that received the new entry.
+ *
+ * Values are produced outside of the locks and only once per key: concurrent misses on the same
+ * key wait for the first producer and receive its value (or its exception). Values are returned
+ * by copy, so heavy objects should be stored as `std::shared_ptr`.
  *
  * @tparam Key Key type
  * @tparam Value Value type
+ * @tparam Hash Hash function for keys
  */
-template<typename Key, typename Value>
+template<typename Key, typename Value, typename Hash = std::hash<Key>>
 class lru_memory_cache
 {
 public:
+    /// Function returning cost of a value, used to enforce the budget.
+    using cost_function = std::function<size_t(const Value&)>;
+
+    /// Snapshot of cache counters.
+    struct statistics
+    {
+        size_t hits;
+        size_t misses;
+        size_t evictions;
+        size_t total_cost;
+    };
+
     /**
-     * @brief Constructs LRU cache with specified maximum size.
-     * @param max_size Maximum size of the cache. Default is std::numeric_limits<size_t>::max(),
+     * @brief Constructs LRU cache with specified budget.
+     * @param max_cost Maximum total cost of all entries. Default is std::numeric_limits<size_t>::max(),
      *                 which means there is no limit.
+     * @param cost Function returning cost of a value. Default returns 1 for every value.
+     * @param shard_count Number of independently locked shards.
      */
-    explicit lru_memory_cache(size_t max_size = std::numeric_limits<size_t>::max())
-        : m_max_size(max_size)
+    explicit lru_memory_cache(size_t max_cost = std::numeric_limits<size_t>::max(),
+            cost_function cost = [](const Value&) { return size_t{1}; }, size_t shard_count = 16)
+        : m_max_cost(max_cost), m_cost(std::move(cost)), m_shards(std::max(shard_count, size_t{1}))
     {}
 
+    lru_memory_cache(const lru_memory_cache&) = delete;
+    lru_memory_cache& operator=(const lru_memory_cache&) = delete;
+
     /**
      * @brief Returns value for specified key. If key is not in the cache, it calls producer function
      *        to create value for the key.
      * @param key Key for which value is requested
      * @param producer Function that creates value for specified key if key is not in the cache
-     * @return Reference to value for specified key
+     * @return Copy of value for specified key
      */
-    Value& get_or_create(const Key& key, const std::function<Value(const Key&)>& producer)
+    Value get_or_create(const Key& key, const std::function<Value(const Key&)>& producer)
     {
-        auto it = m_entry_list_iter_map.find(key);
-        if (it != m_entry_list_iter_map.end()) {
-            m_entry_list.splice(m_entry_list.begin(), m_entry_list, it->second);
-        } else {
-            Value value = producer(key);
-            m_entry_list.emplace_front(key, value);
-            m_entry_list_iter_map.emplace(key, m_entry_list.begin());
-            if (m_entry_list.size() > m_max_size) {
-                m_entry_list_iter_map.erase(std::prev(m_entry_list.end())->key);
-                m_entry_list.pop_back();
+        shard& s = shard_for(key);
+        std::promise<Value> promise;
+        {
+            std::unique_lock<std::mutex> lock(s.mutex);
+            auto it = s.entry_list_iter_map.find(key);
+            if (it != s.entry_list_iter_map.end())
+            {
+                s.entry_list.splice(s.entry_list.begin(), s.entry_list, it->second);
+                m_hits.fetch_add(1, std::memory_order_relaxed);
+                return s.entry_list.begin()->value;
+            }
+            auto pending_it = s.pending.find(key);
+            if (pending_it != s.pending.end())
+            {
+                std::shared_future<Value> pending_value = pending_it->second;
+                lock.unlock();
+                m_hits.fetch_add(1, std::memory_order_relaxed);
+                return pending_value.get();
+            }
+            s.pending.emplace(key, promise.get_future().share());
+        }
+        m_misses.fetch_add(1, std::memory_order_relaxed);
+        std::optional<Value> value;
+        try
+        {
+            value.emplace(producer(key));
+        }
+        catch (...)
+        {
+            std::lock_guard<std::mutex> lock(s.mutex);
+            s.pending.erase(key);
+            promise.set_exception(std::current_exception());
+            throw;
+        }
+        size_t cost = m_cost(*value);
+        {
+            std::lock_guard<std::mutex> lock(s.mutex);
+            s.pending.erase(key);
+            if (cost <= m_max_cost)
+            {
+                s.entry_list.emplace_front(key, *value, cost);
+                s.entry_list_iter_map.emplace(key, s.entry_list.begin());
+                m_total_cost.fetch_add(cost, std::memory_order_relaxed);
             }
+            promise.set_value(*value);
+        }
+        evict(s);
+        return std::move(*value);
+    }
+
+    /// Returns current values of hit, miss and eviction counters and the total cost of cached entries.
+    statistics stats() const
+    {
+        return statistics
+        {
+            .hits = m_hits.load(std::memory_order_relaxed),
+            .misses = m_misses.load(std::memory_order_relaxed),
+            .evictions = m_evictions.load(std::memory_order_relaxed),
+            .total_cost = m_total_cost.load(std::memory_order_relaxed)
+        };
+    }
+
+    /// Removes all entries. Values being produced at the moment are still delivered to their callers.
+    void clear()
+    {
+        for (shard& s : m_shards)
+        {
+            std::lock_guard<std::mutex> lock(s.mutex);
+            for (const entry& e : s.entry_list)
+                m_total_cost.fetch_sub(e.cost, std::memory_order_relaxed);
+            s.entry_list.clear();
+            s.entry_list_iter_map.clear();
         }
-        return m_entry_list.begin()->value;
     }
 
 private:
-    size_t m_max_size;
     struct entry
     {
         Key key;
         Value value;
-        entry(const Key& key, const Value& value) : key(key), value(value) {}
+        size_t cost;
+        entry(const Key& key, const Value& value, size_t cost) : key(key), value(value), cost(cost) {}
     };
-    std::list<entry> m_entry_list;
-    std::unordered_map<Key, typename std::list<entry>::iterator> m_entry_list_iter_map;
+
+    struct shard
+    {
+        std::mutex mutex;
+        std::list<entry> entry_list;
+        std::unordered_map<Key, typename std::list<entry>::iterator, Hash> entry_list_iter_map;
+        std::unordered_map<Key, std::shared_future<Value>, Hash> pending;
+    };
+
+    shard& shard_for(const Key& key)
+    {
+        return m_shards[Hash{}(key) % m_shards.size()];
+    }
+
+    bool evict_one(shard& s, size_t entries_to_keep)
+    {
+        std::lock_guard<std::mutex> lock(s.mutex);
+        if (s.entry_list.size() <= entries_to_keep)
+            return false;
+        const entry& last = s.entry_list.back();
+        m_total_cost.fetch_sub(last.cost, std::memory_order_relaxed);
+        s.entry_list_iter_map.erase(last.key);
+        s.entry_list.pop_back();
+        m_evictions.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    bool over_budget() const
+    {
+        return m_total_cost.load(std::memory_order_relaxed) > m_max_cost;
+    }
+
+    // Evicts from the shard that received the new entry first, then from the other shards in turn.
+    // Only one shard is locked at a time, so the budget is enforced approximately under contention.
+    void evict(shard& inserted_to)
+    {
+        while (over_budget() && evict_one(inserted_to, 1))
+            ;
+        for (size_t failed = 0; over_budget() && failed < m_shards.size(); )
+        {
+            shard& victim = m_shards[m_next_victim_shard.fetch_add(1, std::memory_order_relaxed) % m_shards.size()];
+            if (!evict_one(victim, &victim == &inserted_to ? 1 : 0))
+                ++failed;
+            else
+                failed = 0;
+        }
+        while (over_budget() && evict_one(inserted_to, 0))
+            ;
+    }
+
+    size_t m_max_cost;
+    cost_function m_cost;
+    std::vector<shard> m_shards;
+    std::atomic<size_t> m_total_cost { 0 };
+    std::atomic<size_t> m_hits { 0 };
+    std::atomic<size_t> m_misses { 0 };
+    std::atomic<size_t> m_evictions { 0 };
+    std::atomic<size_t> m_next_victim_shard { 0 };
 };
 
 } // namespace docwire
@@ -0,0 +1,122 @@
+/*********************************************************************************************************************************************/
+/*  DocWire SDK: Award-winning modern data processing in C++20. SourceForge Community Choice & Microsoft support. AI-driven processing.      */
+/*  Supports nearly 100 data formats, including email boxes and OCR. Boost efficiency in text extraction, web data extraction, data mining,  */
+/*  document analysis. Offline processing possible for security and confidentiality                                                          */
+/*                                                                                                                                           */
+/*  Copyright (c) SILVERCODERS Ltd, http://silvercoders.com                                                                                  */
+/*  Project homepage: https://github.com/docwire/docwire                                                                                     */
+/*                                                                                                                                           */
+/*  SPDX-License-Identifier: AGPL-3.0-only OR LicenseRef-DocWire-Commercial                                                                  */
+/*********************************************************************************************************************************************/
+
+#include "message.h"
+
+#include <array>
+#include <mutex>
+#include <new>
+#include <typeindex>
+#include <unordered_map>
+#include <utility>
+
+namespace docwire
+{
+
+std::uint32_t register_message_type(std::type_info const& type)
+{
+	// Never destroyed: message types can be registered from static destructors of other libraries.
+	static std::mutex* mutex = new std::mutex;
+	static std::unordered_map<std::type_index, std::uint32_t>* ids = new std::unordered_map<std::type_index, std::uint32_t>;
+	std::lock_guard<std::mutex> lock{*mutex};
+	// type_index compares type names, so instances of message_type_id<T>() in different shared libraries get the same id.
+	return ids->try_emplace(std::type_index{type}, static_cast<std::uint32_t>(ids->size() + 1)).first->second;
+}
+
+namespace detail
+{
+
+namespace
+{
+
+constexpr std::size_t size_class_granularity = 16;
+constexpr std::size_t size_class_count = 32; // blocks up to 512 bytes are recycled
+constexpr std::size_t max_free_blocks_per_class = 4096;
+
+// Messages are usually destroyed on the thread that created them, shortly after being emitted.
+// Memory freed on another thread is simply kept by that thread.
+class message_memory_pool
+{
+public:
+	message_memory_pool() { state = alive; }
+
+	~message_memory_pool()
+	{
+		for (free_block* head : m_free_lists)
+			while (head)
+				::operator delete(std::exchange(head, head->next));
+		state = destroyed;
+	}
+
+	void* allocate(std::size_t size_class)
+	{
+		if (free_block* block = m_free_lists[size_class])
+		{
+			m_free_lists[size_class] = block->next;
+			--m_free_counts[size_class];
+			return block;
+		}
+		return ::operator new((size_class + 1) * size_class_granularity);
+	}
+
+	void deallocate(void* memory, std::size_t size_class) noexcept
+	{
+		if (m_free_counts[size_class] >= max_free_blocks_per_class)
+		{
+			::operator delete(memory);
+			return;
+		}
+		m_free_lists[size_class] = new (memory) free_block{m_free_lists[size_class]};
+		++m_free_counts[size_class];
+	}
+
+	enum lifetime_state { not_created, alive, destroyed };
+	static thread_local lifetime_state state;
+
+private:
+	struct free_block { free_block* next; };
+	std::array<free_block*, size_class_count> m_free_lists {};
+	std::array<std::size_t, size_class_count> m_free_counts {};
+};
+
+thread_local message_memory_pool::lifetime_state message_memory_pool::state = message_memory_pool::not_created;
+thread_local message_memory_pool pool;
+
+std::size_t size_class(std::size_t size)
+{
+	return size == 0 ? 0 : (size - 1) / size_class_granularity;
+}
+
+} // anonymous namespace
+
+void* allocate_message_memory(std::size_t size)
+{
+	std::size_t c = size_class(size);
+	if (c >= size_class_count || message_memory_pool::state == message_memory_pool::destroyed)
+		return ::operator new(size);
+	return pool.allocate(c);
+}
+
+void deallocate_message_memory(void* memory, std::size_t size) noexcept
+{
+	std::size_t c = size_class(size);
+	// Memory freed during thread exit, after the pool of this thread is gone, goes back to the heap.
+	if (c >= size_class_count || message_memory_pool::state == message_memory_pool::destroyed)
+	{
+		::operator delete(memory);
+		return;
+	}
+	pool.deallocate(memory, c);
+}
+
+} // namespace detail
+
+} // namespace docwire
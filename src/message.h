@@ -12,8 +12,12 @@
 #ifndef DOCWIRE_MESSAGE_H
 #define DOCWIRE_MESSAGE_H
 
+#include "core_export.h"
+#include <cstddef>
+#include <cstdint>
 #include <functional>
 #include <memory>
+#include <type_traits>
 #include <typeinfo>
 
 namespace docwire
@@ -23,18 +27,75 @@ enum class continuation { proceed, skip, stop };
 struct message_callbacks;
 using message_sequence_streamer = std::function<continuation(const message_callbacks&)>;
 
+/**
+ * @brief Returns a small integer identifying the type, the same in all shared libraries.
+ *
+ * Used as the type tag of messages, so checking the type of a message is an integer comparison.
+ */
+DOCWIRE_CORE_EXPORT std::uint32_t register_message_type(std::type_info const& type);
+
+template <typename T>
+std::uint32_t message_type_id() noexcept
+{
+  static const std::uint32_t id = register_message_type(typeid(T));
+  return id;
+}
+
+namespace detail
+{
+
+DOCWIRE_CORE_EXPORT void* allocate_message_memory(std::size_t size);
+DOCWIRE_CORE_EXPORT void deallocate_message_memory(void* memory, std::size_t size) noexcept;
+
+/// Recycles memory of destroyed messages through per-thread free lists, so steady-state emitting does not allocate.
+template <typename T>
+struct message_allocator
+{
+  using value_type = T;
+
+  message_allocator() noexcept = default;
+  template <typename U>
+  message_allocator(const message_allocator<U>&) noexcept {}
+
+  T* allocate(std::size_t n)
+  {
+    if constexpr (alignof(T) > __STDCPP_DEFAULT_NEW_ALIGNMENT__)
+      return std::allocator<T>{}.allocate(n);
+    else
+      return static_cast<T*>(allocate_message_memory(n * sizeof(T)));
+  }
+
+  void deallocate(T* memory, std::size_t n) noexcept
+  {
+    if constexpr (alignof(T) > __STDCPP_DEFAULT_NEW_ALIGNMENT__)
+      std::allocator<T>{}.deallocate(memory, n);
+    else
+      deallocate_message_memory(memory, n * sizeof(T));
+  }
+
+  template <typename U>
+  bool operator==(const message_allocator<U>&) const noexcept { return true; }
+};
+
+} // namespace detail
+
 template <typename T>
 struct message;
 
 struct message_base
 {
+  message_base(std::type_info const& object_type, std::uint32_t type_id) noexcept
+    : m_object_type{&object_type}, m_type_id{type_id}
+  {}
   virtual ~message_base() = default;
-  virtual std::type_info const& object_type() const noexcept = 0;
+
+  std::type_info const& object_type() const noexcept { return *m_object_type; }
+  std::uint32_t type_id() const noexcept { return m_type_id; }
 
   template <typename T>
   bool is() const noexcept
   {
-    return object_type() == typeid(T);
+    return m_type_id == message_type_id<std::remove_cvref_t<T>>();
   }
   template <typename T>
   const T& get() const
@@ -47,21 +108,30 @@ struct message_base
   {
     return static_cast<message<T>&>(*this).object;
   }
+
+private:
+  std::type_info const* m_object_type;
+  std::uint32_t m_type_id;
 };
 
 template <typename T>
 struct message : message_base
 {
   T object;
-  message(T&& object) : object(std::move(object)) {}
-  std::type_info const& object_type() const noexcept override
-	{
-		return typeid(T);
-	}
+  message(T&& object) : message_base{typeid(T), message_type_id<T>()}, object(std::move(object)) {}
+  message(const T& object) : message_base{typeid(T), message_type_id<T>()}, object(object) {}
 };
 
 using message_ptr = std::shared_ptr<message_base>;
 
+/// Creates a message holding the object in pooled memory. Prefer it to std::make_shared<message<T>>.
+template <typename T>
+message_ptr make_message(T&& object)
+{
+  using object_type = std::remove_cvref_t<T>;
+  return std::allocate_shared<message<object_type>>(detail::message_allocator<message<object_type>>{}, std::forward<T>(object));
+}
+
 struct message_callbacks
 {
   std::function<continuation(message_ptr)> m_further;
@@ -70,12 +140,12 @@ struct message_callbacks
   continuation further(message_ptr msg) const { return m_further(std::move(msg)); }
   
   template <typename T>
-  continuation further(T&& object) const { return m_further(std::make_shared<message<T>>(std::forward<T>(object))); }
+  continuation further(T&& object) const { return m_further(make_message(std::forward<T>(object))); }
 
   continuation back(message_ptr msg) const { return m_back(std::move(msg)); }
 
   template <typename T>
-  continuation back(T&& object) const { return m_back(std::make_shared<message<T>>(std::forward<T>(object))); }
+  continuation back(T&& object) const { return m_back(make_message(std::forward<T>(object))); }
 
   continuation operator()(message_ptr msg) const { return further(std::move(msg)); }
 
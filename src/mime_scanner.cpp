@@ -0,0 +1,273 @@
+/*********************************************************************************************************************************************/
+/*  DocWire SDK: Award-winning modern data processing in C++20. SourceForge Community Choice & Microsoft support. AI-driven processing.      */
+/*  Supports nearly 100 data formats, including email boxes and OCR. Boost efficiency in text extraction, web data extraction, data mining,  */
+/*  document analysis. Offline processing possible for security and confidentiality                                                          */
+/*                                                                                                                                           */
+/*  Copyright (c) SILVERCODERS Ltd, http://silvercoders.com                                                                                  */
+/*  Project homepage: https://github.com/docwire/docwire                                                                                     */
+/*                                                                                                                                           */
+/*  SPDX-License-Identifier: AGPL-3.0-only OR LicenseRef-DocWire-Commercial                                                                  */
+/*********************************************************************************************************************************************/
+
+
+#include "mime_scanner.h"
+
+#include <array>
+#include <cstdint>
+#include "log_scope.h"
+#include "serialization_enum.h" // IWYU pragma: keep
+
+namespace docwire::mime_scanner
+{
+
+namespace
+{
+
+constexpr std::string_view boundary_delimiter = "--";
+constexpr size_t none = std::string_view::npos;
+
+struct line
+{
+	std::string_view text; ///< Without the line break.
+	size_t begin;
+	size_t next; ///< Beginning of the next line.
+};
+
+line line_at(std::string_view message, size_t pos)
+{
+	size_t line_feed = message.find('\n', pos);
+	size_t end = line_feed == none ? message.size() : line_feed;
+	size_t next = line_feed == none ? message.size() : line_feed + 1;
+	if (end > pos && message[end - 1] == '\r')
+		--end;
+	return line{message.substr(pos, end - pos), pos, next};
+}
+
+// The line break before a boundary line belongs to the boundary, not to the body of the part.
+size_t end_before_line_break(std::string_view message, size_t body_begin, size_t line_begin)
+{
+	size_t end = line_begin;
+	if (end > body_begin && message[end - 1] == '\n')
+		--end;
+	if (end > body_begin && message[end - 1] == '\r')
+		--end;
+	return end;
+}
+
+enum class boundary_line { none, part, close };
+
+boundary_line match_boundary(std::string_view text, std::string_view boundary)
+{
+	while (!text.empty() && (text.back() == ' ' || text.back() == '\t'))
+		text.remove_suffix(1);
+	if (!text.starts_with(boundary_delimiter))
+		return boundary_line::none;
+	text.remove_prefix(boundary_delimiter.size());
+	if (!text.starts_with(boundary))
+		return boundary_line::none;
+	text.remove_prefix(boundary.size());
+	if (text.empty())
+		return boundary_line::part;
+	return text == boundary_delimiter ? boundary_line::close : boundary_line::none;
+}
+
+std::string_view trim_line_breaks(std::string_view body)
+{
+	while (!body.empty() && (body.back() == '\n' || body.back() == '\r'))
+		body.remove_suffix(1);
+	return body;
+}
+
+constexpr std::array<int8_t, 256> base64_values = []()
+{
+	std::array<int8_t, 256> values{};
+	values.fill(-1);
+	constexpr std::string_view alphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+	for (size_t i = 0; i < alphabet.size(); ++i)
+		values[static_cast<unsigned char>(alphabet[i])] = static_cast<int8_t>(i);
+	return values;
+}();
+
+// Both decoders pass decoded characters to the output function, so sizes are computed by the same code that decodes.
+template <typename Output>
+void decode_base64(std::string_view body, Output&& output)
+{
+	uint32_t bits = 0;
+	int bit_count = 0;
+	for (char c : body)
+	{
+		if (c == '=')
+			break;
+		int8_t value = base64_values[static_cast<unsigned char>(c)];
+		if (value < 0)
+			continue;
+		bits = (bits << 6) | static_cast<uint32_t>(value);
+		bit_count += 6;
+		if (bit_count >= 8)
+		{
+			bit_count -= 8;
+			output(static_cast<char>((bits >> bit_count) & 0xff));
+		}
+	}
+}
+
+int hex_value(char c)
+{
+	if (c >= '0' && c <= '9')
+		return c - '0';
+	if (c >= 'A' && c <= 'F')
+		return c - 'A' + 10;
+	if (c >= 'a' && c <= 'f')
+		return c - 'a' + 10;
+	return -1;
+}
+
+template <typename Output>
+void decode_quoted_printable(std::string_view body, Output&& output)
+{
+	for (size_t i = 0; i < body.size(); ++i)
+	{
+		if (body[i] != '=')
+		{
+			output(body[i]);
+			continue;
+		}
+		// Soft line break: "=" followed by optional whitespace and a line break or the end of the body.
+		size_t j = i + 1;
+		while (j < body.size() && (body[j] == ' ' || body[j] == '\t'))
+			++j;
+		if (j + 1 < body.size() && body[j] == '\r' && body[j + 1] == '\n')
+			++j;
+		if (j == body.size() || body[j] == '\n')
+		{
+			i = j;
+			continue;
+		}
+		int high = i + 1 < body.size() ? hex_value(body[i + 1]) : -1;
+		int low = i + 2 < body.size() ? hex_value(body[i + 2]) : -1;
+		if (high >= 0 && low >= 0)
+		{
+			output(static_cast<char>(high * 16 + low));
+			i += 2;
+		}
+		else
+			output('=');
+	}
+}
+
+} // anonymous namespace
+
+std::vector<entity> scan(std::string_view message, const boundary_of_entity& boundary_of)
+{
+	log_scope(message.size());
+	struct open_multipart
+	{
+		size_t entity_index;
+		std::string boundary;
+	};
+	std::vector<entity> entities(1);
+	std::vector<open_multipart> open_multiparts;
+	size_t current = 0; // Entity whose header or body is being read, none in preambles and epilogues.
+	bool in_header = true;
+	size_t begin = 0; // Beginning of the header or body of the current entity.
+
+	auto finish_current = [&](size_t end)
+	{
+		if (current == none)
+			return;
+		if (in_header)
+		{
+			entities[current].header = message.substr(begin, end - begin);
+			boundary_of(current, entities[current].header);
+		}
+		else
+			entities[current].body = message.substr(begin, end - begin);
+	};
+
+	for (size_t pos = 0; pos < message.size();)
+	{
+		line l = line_at(message, pos);
+		pos = l.next;
+		if (l.text.starts_with(boundary_delimiter))
+		{
+			size_t level = open_multiparts.size();
+			boundary_line type = boundary_line::none;
+			while (level > 0 && type == boundary_line::none)
+				type = match_boundary(l.text, open_multiparts[--level].boundary);
+			if (type != boundary_line::none)
+			{
+				finish_current(in_header ? l.begin : end_before_line_break(message, begin, l.begin));
+				// Inner multipart entities without closing boundary lines end here as well.
+				open_multiparts.resize(level + 1);
+				if (type == boundary_line::close)
+				{
+					open_multiparts.pop_back();
+					current = none;
+				}
+				else
+				{
+					current = entities.size();
+					entities.emplace_back();
+					entities[open_multiparts.back().entity_index].parts.push_back(current);
+					in_header = true;
+					begin = l.next;
+				}
+				continue;
+			}
+		}
+		if (current != none && in_header && l.text.empty())
+		{
+			entities[current].header = message.substr(begin, l.begin - begin);
+			std::string boundary = boundary_of(current, entities[current].header);
+			if (boundary.empty())
+			{
+				in_header = false;
+				begin = l.next;
+			}
+			else
+			{
+				open_multiparts.push_back(open_multipart{current, std::move(boundary)});
+				current = none;
+			}
+		}
+	}
+	finish_current(message.size());
+	return entities;
+}
+
+size_t decoded_size(std::string_view body, transfer_encoding encoding)
+{
+	size_t size = 0;
+	switch (encoding)
+	{
+		case transfer_encoding::base64:
+			decode_base64(body, [&size](char) { ++size; });
+			return size;
+		case transfer_encoding::quoted_printable:
+			decode_quoted_printable(trim_line_breaks(body), [&size](char) { ++size; });
+			return size;
+		default:
+			return body.size();
+	}
+}
+
+std::string decode(std::string_view body, transfer_encoding encoding)
+{
+	log_scope(body.size(), encoding);
+	std::string decoded;
+	switch (encoding)
+	{
+		case transfer_encoding::base64:
+			decoded.reserve(body.size() / 4 * 3);
+			decode_base64(body, [&decoded](char c) { decoded.push_back(c); });
+			return decoded;
+		case transfer_encoding::quoted_printable:
+			decoded.reserve(body.size());
+			decode_quoted_printable(trim_line_breaks(body), [&decoded](char c) { decoded.push_back(c); });
+			return decoded;
+		default:
+			return std::string{body};
+	}
+}
+
+} // namespace docwire::mime_scanner
@@ -0,0 +1,67 @@
+/*********************************************************************************************************************************************/
+/*  DocWire SDK: Award-winning modern data processing in C++20. SourceForge Community Choice & Microsoft support. AI-driven processing.      */
+/*  Supports nearly 100 data formats, including email boxes and OCR. Boost efficiency in text extraction, web data extraction, data mining,  */
+/*  document analysis. Offline processing possible for security and confidentiality                                                          */
+/*                                                                                                                                           */
+/*  Copyright (c) SILVERCODERS Ltd, http://silvercoders.com                                                                                  */
+/*  Project homepage: https://github.com/docwire/docwire                                                                                     */
+/*                                                                                                                                           */
+/*  SPDX-License-Identifier: AGPL-3.0-only OR LicenseRef-DocWire-Commercial                                                                  */
+/*********************************************************************************************************************************************/
+
+
+#ifndef DOCWIRE_MIME_SCANNER_H
+#define DOCWIRE_MIME_SCANNER_H
+
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace docwire::mime_scanner
+{
+
+/// Header and raw (still encoded) body of a MIME entity, as views into the scanned message.
+struct entity
+{
+	std::string_view header;
+	std::string_view body;
+	std::vector<size_t> parts; ///< Positions of the parts of a multipart entity in the result of scan().
+};
+
+/**
+ * @brief Returns the boundary of a multipart entity or an empty string for other entities.
+ *
+ * Called with the position of the entity in the result of scan() and its header, as soon as the header is found.
+ */
+using boundary_of_entity = std::function<std::string(size_t entity_index, std::string_view header)>;
+
+/**
+ * @brief Finds the entities of a MIME message in a single pass, without copying or decoding them.
+ *
+ * The message is the first entity of the result. A boundary line of an enclosing multipart entity also closes
+ * the inner multipart entities that were not closed. Preambles and epilogues of multipart entities are skipped.
+ */
+std::vector<entity> scan(std::string_view message, const boundary_of_entity& boundary_of);
+
+enum class transfer_encoding
+{
+	identity,
+	base64,
+	quoted_printable
+};
+
+/// Returns the size of the decoded body without decoding it.
+size_t decoded_size(std::string_view body, transfer_encoding encoding);
+
+/**
+ * @brief Decodes a body.
+ *
+ * Characters outside of the base64 alphabet are ignored, and invalid quoted-printable escapes are copied as is.
+ * Line breaks at the end of quoted-printable bodies are removed; identity bodies are returned unchanged.
+ */
+std::string decode(std::string_view body, transfer_encoding encoding);
+
+} // namespace docwire::mime_scanner
+
+#endif // DOCWIRE_MIME_SCANNER_H
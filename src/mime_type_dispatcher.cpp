@@ -0,0 +1,95 @@
+/*********************************************************************************************************************************************/
+/*  DocWire SDK: Award-winning modern data processing in C++20. SourceForge Community Choice & Microsoft support. AI-driven processing.      */
+/*  Supports nearly 100 data formats, including email boxes and OCR. Boost efficiency in text extraction, web data extraction, data mining,  */
+/*  document analysis. Offline processing possible for security and confidentiality                                                          */
+/*                                                                                                                                           */
+/*  Copyright (c) SILVERCODERS Ltd, http://silvercoders.com                                                                                  */
+/*  Project homepage: https://github.com/docwire/docwire                                                                                     */
+/*                                                                                                                                           */
+/*  SPDX-License-Identifier: AGPL-3.0-only OR LicenseRef-DocWire-Commercial                                                                  */
+/*********************************************************************************************************************************************/
+
+
+#include "mime_type_dispatcher.h"
+
+#include "error_tags.h"
+#include "log_scope.h"
+#include "serialization_message.h" // IWYU pragma: keep
+#include "throw_if.h"
+#include <algorithm>
+#include <unordered_map>
+
+namespace docwire
+{
+
+template<>
+struct pimpl_impl<mime_type_dispatcher> : pimpl_impl_base
+{
+  pimpl_impl(std::vector<mime_type_dispatcher::route> routes)
+    : m_routes{std::move(routes)}
+  {
+    for (size_t i = 0; i < m_routes.size(); ++i)
+      for (const mime_type& mt : m_routes[i].mime_types)
+      {
+        std::vector<size_t>& indices = m_route_indices[mt];
+        if (indices.empty() || indices.back() != i)
+          indices.push_back(i);
+      }
+  }
+
+  // Same result as passing the data source through the parsers from the given position on: the first of them
+  // supporting its MIME type parses it and the others pass it on.
+  continuation dispatch(message_ptr msg, size_t first_route, const message_callbacks& emit_message)
+  {
+    if (first_route == m_routes.size())
+      return emit_message(std::move(msg));
+    const data_source& data = msg->get<data_source>();
+    data.assert_not_encrypted();
+    std::optional<mime_type> mt = data.highest_confidence_mime_type();
+    throw_if(!mt, "Data source has no mime type", errors::uninterpretable_data{});
+    auto route_indices = m_route_indices.find(*mt);
+    if (route_indices == m_route_indices.end())
+      return emit_message(std::move(msg));
+    auto route_index = std::lower_bound(route_indices->second.begin(), route_indices->second.end(), first_route);
+    if (route_index == route_indices->second.end())
+      return emit_message(std::move(msg));
+    size_t index = *route_index;
+    return m_routes[index].parser.get()(std::move(msg),
+      {
+        [this, index, &emit_message](message_ptr msg)
+        {
+          if (msg->is<data_source>())
+            return dispatch(std::move(msg), index + 1, emit_message);
+          return emit_message(std::move(msg));
+        },
+        emit_message.m_back
+      });
+  }
+
+  std::vector<mime_type_dispatcher::route> m_routes;
+  std::unordered_map<mime_type, std::vector<size_t>> m_route_indices;
+};
+
+mime_type_dispatcher::mime_type_dispatcher(std::vector<route> routes)
+  : with_pimpl<mime_type_dispatcher>(std::move(routes))
+{}
+
+mime_type_dispatcher::mime_type_dispatcher(mime_type_dispatcher&& other)
+  : with_pimpl<mime_type_dispatcher>(std::move(static_cast<with_pimpl<mime_type_dispatcher>&>(other)))
+{}
+
+mime_type_dispatcher& mime_type_dispatcher::operator=(mime_type_dispatcher&& other)
+{
+  with_pimpl<mime_type_dispatcher>::operator=(std::move(static_cast<with_pimpl<mime_type_dispatcher>&>(other)));
+  return *this;
+}
+
+continuation mime_type_dispatcher::operator()(message_ptr msg, const message_callbacks& emit_message)
+{
+  log_scope(msg);
+  if (!msg->is<data_source>())
+    return emit_message(std::move(msg));
+  return impl().dispatch(std::move(msg), 0, emit_message);
+}
+
+} // namespace docwire
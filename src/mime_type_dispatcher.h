@@ -0,0 +1,73 @@
+/*********************************************************************************************************************************************/
+/*  DocWire SDK: Award-winning modern data processing in C++20. SourceForge Community Choice & Microsoft support. AI-driven processing.      */
+/*  Supports nearly 100 data formats, including email boxes and OCR. Boost efficiency in text extraction, web data extraction, data mining,  */
+/*  document analysis. Offline processing possible for security and confidentiality                                                          */
+/*                                                                                                                                           */
+/*  Copyright (c) SILVERCODERS Ltd, http://silvercoders.com                                                                                  */
+/*  Project homepage: https://github.com/docwire/docwire                                                                                     */
+/*                                                                                                                                           */
+/*  SPDX-License-Identifier: AGPL-3.0-only OR LicenseRef-DocWire-Commercial                                                                  */
+/*********************************************************************************************************************************************/
+
+
+#ifndef DOCWIRE_MIME_TYPE_DISPATCHER_H
+#define DOCWIRE_MIME_TYPE_DISPATCHER_H
+
+#include "chain_element.h"
+#include "core_export.h"
+#include "data_source.h"
+#include "pimpl.h"
+#include "ref_or_owned.h"
+#include <type_traits>
+#include <vector>
+
+namespace docwire
+{
+
+/**
+ * @brief Chain element that routes data sources straight to the parser of their MIME type.
+ *
+ * It behaves like the chain of its parsers joined with operator|, in the given order, but a data source is looked
+ * up once in a hash map from the highest confidence MIME type to the parsers supporting it, instead of passing
+ * through every parser. Messages emitted by the parser go straight to the next element, except data sources,
+ * which are dispatched again to the parsers following the one that emitted them.
+ *
+ * @code
+ * mime_type_dispatcher parser { html_parser{}, pdf_parser{}, txt_parser{} };
+ * @endcode
+ */
+class DOCWIRE_CORE_EXPORT mime_type_dispatcher : public chain_element, public with_pimpl<mime_type_dispatcher>
+{
+public:
+  /// Parser and the MIME types it is selected for.
+  struct route
+  {
+    std::vector<mime_type> mime_types;
+    ref_or_owned<chain_element> parser;
+  };
+
+  explicit mime_type_dispatcher(std::vector<route> routes);
+
+  /**
+   * @brief Constructs the dispatcher from parsers providing static supported_mime_types().
+   */
+  template <typename... Parsers>
+    requires (sizeof...(Parsers) > 0 && (std::is_base_of_v<chain_element, std::remove_cvref_t<Parsers>> && ...))
+  explicit mime_type_dispatcher(Parsers&&... parsers)
+    : mime_type_dispatcher{std::vector<route>{
+        route{std::remove_cvref_t<Parsers>::supported_mime_types(), std::forward<Parsers>(parsers)}...}}
+  {}
+
+  mime_type_dispatcher(mime_type_dispatcher&& other);
+  mime_type_dispatcher& operator=(mime_type_dispatcher&& other);
+
+  continuation operator()(message_ptr msg, const message_callbacks& emit_message) override;
+  bool is_leaf() const override { return false; }
+
+private:
+  using with_pimpl<mime_type_dispatcher>::impl;
+};
+
+} // namespace docwire
+
+#endif //DOCWIRE_MIME_TYPE_DISPATCHER_H
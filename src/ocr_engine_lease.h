@@ -0,0 +1,69 @@
+/*********************************************************************************************************************************************/
+/*  DocWire SDK: Award-winning modern data processing in C++20. SourceForge Community Choice & Microsoft support. AI-driven processing.      */
+/*  Supports nearly 100 data formats, including email boxes and OCR. Boost efficiency in text extraction, web data extraction, data mining,  */
+/*  document analysis. Offline processing possible for security and confidentiality                                                          */
+/*                                                                                                                                           */
+/*  Copyright (c) SILVERCODERS Ltd, http://silvercoders.com                                                                                  */
+/*  Project homepage: https://github.com/docwire/docwire                                                                                     */
+/*                                                                                                                                           */
+/*  SPDX-License-Identifier: AGPL-3.0-only OR LicenseRef-DocWire-Commercial                                                                  */
+/*********************************************************************************************************************************************/
+
+#ifndef DOCWIRE_OCR_ENGINE_LEASE_H
+#define DOCWIRE_OCR_ENGINE_LEASE_H
+
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include "language.h"
+#include "ocr_parser.h"
+#include <tesseract/publictypes.h>
+#include <vector>
+
+namespace tesseract
+{
+class TessBaseAPI;
+} // namespace tesseract
+
+namespace docwire::ocr::detail
+{
+
+/// Everything an engine is initialised with. Engines are shared only between leases of equal configurations.
+struct engine_configuration
+{
+	std::vector<language> languages;
+	std::filesystem::path data_path;
+	tesseract::OcrEngineMode engine_mode = tesseract::OEM_DEFAULT;
+	tesseract::PageSegMode page_seg_mode = tesseract::PSM_SINGLE_BLOCK; // Tesseract's default
+};
+
+/// Engine leased from the pool. Returns the engine to the pool on destruction.
+class engine_lease
+{
+public:
+	engine_lease(tesseract::TessBaseAPI* engine, std::function<void()> release)
+		: m_engine{engine}, m_release{std::move(release)}
+	{}
+	engine_lease(const engine_lease&) = delete;
+	engine_lease& operator=(const engine_lease&) = delete;
+	~engine_lease() { m_release(); }
+
+	tesseract::TessBaseAPI* operator->() const { return m_engine; }
+	tesseract::TessBaseAPI* get() const { return m_engine; }
+
+private:
+	tesseract::TessBaseAPI* m_engine;
+	std::function<void()> m_release;
+};
+
+std::unique_ptr<engine_lease> lease_engine(const engine_configuration& configuration);
+
+ocr_data_path default_tessdata_path();
+
+/// Mutex taken around Tesseract initialisation and Leptonica image loading.
+std::mutex& tesseract_libtiff_mutex();
+
+} // namespace docwire::ocr::detail
+
+#endif // DOCWIRE_OCR_ENGINE_LEASE_H
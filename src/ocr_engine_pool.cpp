@@ -0,0 +1,269 @@
+/*********************************************************************************************************************************************/
+/*  DocWire SDK: Award-winning modern data processing in C++20. SourceForge Community Choice & Microsoft support. AI-driven processing.      */
+/*  Supports nearly 100 data formats, including email boxes and OCR. Boost efficiency in text extraction, web data extraction, data mining,  */
+/*  document analysis. Offline processing possible for security and confidentiality                                                          */
+/*                                                                                                                                           */
+/*  Copyright (c) SILVERCODERS Ltd, http://silvercoders.com                                                                                  */
+/*  Project homepage: https://github.com/docwire/docwire                                                                                     */
+/*                                                                                                                                           */
+/*  SPDX-License-Identifier: AGPL-3.0-only OR LicenseRef-DocWire-Commercial                                                                  */
+/*********************************************************************************************************************************************/
+
+#include "ocr_engine_pool.h"
+
+#include "ocr_engine_lease.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <filesystem>
+#include "error_tags.h"
+#include "log_entry.h"
+#include "log_scope.h"
+#include <magic_enum/magic_enum.hpp>
+#include <map>
+#include <mutex>
+#include <numeric>
+#include "resource_path.h"
+#include "serialization_enum.h" // IWYU pragma: keep
+#include "serialization_filesystem.h" // IWYU pragma: keep
+#include <tesseract/baseapi.h>
+#include <thread>
+#include "throw_if.h"
+
+namespace docwire::ocr
+{
+
+namespace
+{
+
+auto tessAPIDeleter = [](tesseract::TessBaseAPI* tessAPI)
+{
+	tessAPI->End();
+	delete tessAPI;
+};
+using tessAPIWrapper = std::unique_ptr<tesseract::TessBaseAPI, decltype(tessAPIDeleter)>;
+
+struct engine_key
+{
+	std::string languages;
+	std::string data_path;
+	tesseract::OcrEngineMode engine_mode;
+	tesseract::PageSegMode page_seg_mode;
+	auto operator<=>(const engine_key&) const = default;
+};
+
+struct engine_slot
+{
+	std::vector<tessAPIWrapper> idle;
+	size_t count = 0; // leased and idle
+};
+
+class engine_pool
+{
+public:
+	std::unique_ptr<detail::engine_lease> lease(const engine_key& key)
+	{
+		log_scope(key.languages, key.data_path);
+		auto wait_start = std::chrono::steady_clock::now();
+		bool waited = false;
+		std::unique_lock<std::mutex> lock{m_mutex};
+		engine_slot& slot = m_slots[key];
+		tessAPIWrapper engine{nullptr, tessAPIDeleter};
+		for (;;)
+		{
+			if (!slot.idle.empty())
+			{
+				engine = std::move(slot.idle.back());
+				slot.idle.pop_back();
+				break;
+			}
+			if (slot.count < m_limit)
+			{
+				++slot.count;
+				lock.unlock();
+				try
+				{
+					engine = create_engine(key);
+				}
+				catch (...)
+				{
+					lock.lock();
+					--slot.count;
+					m_returned.notify_all();
+					throw;
+				}
+				lock.lock();
+				++m_stats.engines_created;
+				break;
+			}
+			waited = true;
+			m_returned.wait(lock);
+		}
+		++m_stats.leases;
+		if (waited)
+		{
+			auto wait_time = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - wait_start);
+			++m_stats.waits;
+			m_stats.total_wait_time += wait_time;
+			m_stats.max_wait_time = std::max(m_stats.max_wait_time, wait_time);
+			log_entry(wait_time.count());
+		}
+		tesseract::TessBaseAPI* raw_engine = engine.release();
+		return std::make_unique<detail::engine_lease>(raw_engine, [this, key, raw_engine]()
+		{
+			give_back(key, tessAPIWrapper{raw_engine, tessAPIDeleter});
+		});
+	}
+
+	void prewarm(const engine_key& key, size_t count)
+	{
+		log_scope(key.languages, key.data_path, count);
+		{
+			std::lock_guard<std::mutex> lock{m_mutex};
+			const engine_slot& slot = m_slots[key];
+			size_t leased = slot.count - slot.idle.size();
+			count = std::min(count, m_limit > leased ? m_limit - leased : 0);
+		}
+		// Leasing all of them at once makes the pool create the missing ones. They become idle when returned.
+		std::vector<std::unique_ptr<detail::engine_lease>> leases;
+		for (size_t i = 0; i < count; ++i)
+			leases.push_back(lease(key));
+	}
+
+	void set_limit(size_t limit)
+	{
+		std::lock_guard<std::mutex> lock{m_mutex};
+		m_limit = std::max(limit, size_t{1});
+		for (auto& [key, slot] : m_slots)
+			while (slot.count > m_limit && !slot.idle.empty())
+			{
+				slot.idle.pop_back();
+				--slot.count;
+			}
+		m_returned.notify_all();
+	}
+
+	engine_pool_statistics statistics()
+	{
+		std::lock_guard<std::mutex> lock{m_mutex};
+		engine_pool_statistics stats = m_stats;
+		stats.engines_idle = 0;
+		for (const auto& [key, slot] : m_slots)
+			stats.engines_idle += slot.idle.size();
+		return stats;
+	}
+
+	void clear()
+	{
+		std::lock_guard<std::mutex> lock{m_mutex};
+		for (auto& [key, slot] : m_slots)
+		{
+			slot.count -= slot.idle.size();
+			slot.idle.clear();
+		}
+		m_returned.notify_all();
+	}
+
+private:
+	tessAPIWrapper create_engine(const engine_key& key)
+	{
+		log_scope(key.languages, key.data_path);
+		tessAPIWrapper engine{new tesseract::TessBaseAPI{}, tessAPIDeleter};
+		std::lock_guard<std::mutex> init_lock{detail::tesseract_libtiff_mutex()};
+		throw_if (engine->Init(key.data_path.c_str(), key.languages.c_str(), key.engine_mode) != 0,
+			"Could not initialize tesseract", key.data_path, key.languages);
+		engine->SetPageSegMode(key.page_seg_mode);
+		return engine;
+	}
+
+	void give_back(const engine_key& key, tessAPIWrapper engine)
+	{
+		// Drops recognition results, but keeps loaded traineddata.
+		engine->Clear();
+		engine->SetPageSegMode(key.page_seg_mode);
+		std::lock_guard<std::mutex> lock{m_mutex};
+		engine_slot& slot = m_slots[key];
+		if (slot.count > m_limit)
+			--slot.count; // Limit was lowered while the engine was leased.
+		else
+			slot.idle.push_back(std::move(engine));
+		m_returned.notify_all();
+	}
+
+	std::mutex m_mutex;
+	std::condition_variable m_returned;
+	std::map<engine_key, engine_slot> m_slots;
+	size_t m_limit = std::max(std::thread::hardware_concurrency(), 1u);
+	engine_pool_statistics m_stats {};
+};
+
+engine_pool& pool()
+{
+	// Never destroyed: ending engines during static destruction could outlive Tesseract's own globals.
+	static engine_pool* instance = new engine_pool;
+	return *instance;
+}
+
+engine_key make_key(const detail::engine_configuration& configuration)
+{
+	std::string langs = std::accumulate(configuration.languages.begin(), configuration.languages.end(), std::string{},
+		[](const std::string& acc, const language& lang)
+		{
+			return acc + (acc.empty() ? "" : "+") + std::string{magic_enum::enum_name(lang)};
+		});
+	return engine_key{.languages = langs, .data_path = configuration.data_path.string(),
+		.engine_mode = configuration.engine_mode, .page_seg_mode = configuration.page_seg_mode};
+}
+
+} // anonymous namespace
+
+void set_engine_pool_limit(size_t max_engines_per_configuration)
+{
+	log_scope(max_engines_per_configuration);
+	pool().set_limit(max_engines_per_configuration);
+}
+
+void prewarm_engines(const std::vector<language>& languages, size_t count, ocr_data_path data_path)
+{
+	log_scope(languages, count, data_path);
+	pool().prewarm(make_key(detail::engine_configuration{.languages = languages,
+		.data_path = data_path.v.empty() ? detail::default_tessdata_path().v : data_path.v}), count);
+}
+
+engine_pool_statistics get_engine_pool_statistics()
+{
+	return pool().statistics();
+}
+
+void clear_engine_pool()
+{
+	log_scope();
+	pool().clear();
+}
+
+namespace detail
+{
+
+std::mutex& tesseract_libtiff_mutex()
+{
+	static std::mutex mutex;
+	return mutex;
+}
+
+std::unique_ptr<engine_lease> lease_engine(const engine_configuration& configuration)
+{
+	return pool().lease(make_key(configuration));
+}
+
+ocr_data_path default_tessdata_path()
+{
+	log_scope();
+	std::filesystem::path def_tessdata_path = resource_path("tessdata-fast").string();
+	throw_if (!std::filesystem::exists(def_tessdata_path),
+		"Could not find tessdata in default location", def_tessdata_path, errors::program_corrupted{});
+	return ocr_data_path{def_tessdata_path};
+}
+
+} // namespace detail
+
+} // namespace docwire::ocr
@@ -0,0 +1,68 @@
+/*********************************************************************************************************************************************/
+/*  DocWire SDK: Award-winning modern data processing in C++20. SourceForge Community Choice & Microsoft support. AI-driven processing.      */
+/*  Supports nearly 100 data formats, including email boxes and OCR. Boost efficiency in text extraction, web data extraction, data mining,  */
+/*  document analysis. Offline processing possible for security and confidentiality                                                          */
+/*                                                                                                                                           */
+/*  Copyright (c) SILVERCODERS Ltd, http://silvercoders.com                                                                                  */
+/*  Project homepage: https://github.com/docwire/docwire                                                                                     */
+/*                                                                                                                                           */
+/*  SPDX-License-Identifier: AGPL-3.0-only OR LicenseRef-DocWire-Commercial                                                                  */
+/*********************************************************************************************************************************************/
+
+#ifndef DOCWIRE_OCR_ENGINE_POOL_H
+#define DOCWIRE_OCR_ENGINE_POOL_H
+
+#include <chrono>
+#include <cstddef>
+#include "language.h"
+#include "ocr_export.h"
+#include "ocr_parser.h"
+#include <vector>
+
+namespace docwire::ocr
+{
+
+/*
+ * Process-wide pool of initialised Tesseract engines shared by all `ocr_parser` instances.
+ *
+ * Initialising an engine loads traineddata for all requested languages, which can take hundreds
+ * of milliseconds. Engines are therefore kept after use and leased again to any thread that needs
+ * the same configuration (language set, data path, OCR engine mode and page segmentation mode). The number of engines per
+ * configuration is limited; when all of them are in use, parsers wait for one to be returned.
+ */
+
+/// Counters describing the usage of the engine pool since the start of the process.
+struct engine_pool_statistics
+{
+	size_t engines_created; ///< Engines initialised (each one loaded its traineddata).
+	size_t engines_idle; ///< Initialised engines not leased at the moment.
+	size_t leases; ///< Number of times an engine was handed to a parser.
+	size_t waits; ///< Leases that had to wait because the limit was reached.
+	std::chrono::nanoseconds total_wait_time; ///< Total time spent waiting for engines.
+	std::chrono::nanoseconds max_wait_time; ///< Longest single wait for an engine.
+};
+
+/**
+ * @brief Sets maximum number of engines (leased and idle) per configuration.
+ *
+ * Default is std::thread::hardware_concurrency(). Lowering the limit does not destroy engines in use.
+ */
+DOCWIRE_OCR_EXPORT void set_engine_pool_limit(size_t max_engines_per_configuration);
+
+/**
+ * @brief Initialises engines in advance, so the first documents do not pay for loading traineddata.
+ * @param languages Languages the engines are initialised with (the same list as passed to `ocr_parser`).
+ * @param count Number of idle engines to have ready, capped by the pool limit.
+ * @param data_path Tesseract data path. Empty path selects the bundled tessdata.
+ */
+DOCWIRE_OCR_EXPORT void prewarm_engines(const std::vector<language>& languages, size_t count, ocr_data_path data_path = {});
+
+/// Returns current values of the pool counters.
+DOCWIRE_OCR_EXPORT engine_pool_statistics get_engine_pool_statistics();
+
+/// Destroys all idle engines, releasing their memory. Leased engines are destroyed when returned.
+DOCWIRE_OCR_EXPORT void clear_engine_pool();
+
+} // namespace docwire::ocr
+
+#endif // DOCWIRE_OCR_ENGINE_POOL_H
@@ -21,9 +21,13 @@
 #include <tesseract/ocrclass.h>
 
 #include <boost/algorithm/string/trim.hpp>
-#include <boost/lexical_cast.hpp>
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
 #include <filesystem>
+#include <future>
 #include <cstdlib>
 #include <magic_enum/magic_enum_iostream.hpp>
 #include "log_entry.h"
@@ -31,13 +35,13 @@
 #include "lru_memory_cache.h"
 #include <mutex>
 #include "nested_exception.h"
-#include <numeric>
-#include "resource_path.h"
+#include "ocr_engine_lease.h"
 #include "serialization_data_source.h" // IWYU pragma: keep
 #include "serialization_enum.h" // IWYU pragma: keep
 #include "serialization_message.h" // IWYU pragma: keep
 #include "scoped_stack_push.h"
 #include <tesseract/resultiterator.h>
+#include <thread>
 #include "throw_if.h"
 
 namespace docwire
@@ -91,6 +95,8 @@ struct pimpl_impl<ocr_parser> : with_pimpl_owner<ocr_parser>
     ocr_confidence_threshold m_ocr_confidence_threshold;
     ocr_timeout m_ocr_timeout;
     ocr_data_path m_ocr_data_path;
+    ocr_worker_count m_ocr_worker_count;
+    ocr_strip_height m_ocr_strip_height;
     std::stack<context> m_context_stack;
 
     template <typename T>
@@ -98,22 +104,25 @@ struct pimpl_impl<ocr_parser> : with_pimpl_owner<ocr_parser>
 	{
 		return m_context_stack.top().emit_message(std::forward<T>(object));
 	}
-
-    static bool cancel (void* data, int words)
-    {
-        auto context_ptr = reinterpret_cast<context*>(data);
-        return context_ptr->emit_message(ocr::please_wait{}) == continuation::stop;
-    }
 };  
 
+// Source image may be shared between threads through the image cache, so it is only read here.
+// pixRemoveColormap() and pixRemoveAlpha() are skipped when they would return pixClone() of the source,
+// because it modifies the reference count.
 Pix* pixToGrayscale(Pix* pix)
 {
     log_scope();
     Pix* output{};
     switch(pix->d)
     {
+    case 1:
+    case 2:
+    case 4:
+        // Bilevel and low depth frames are common in scanned multi-page TIFFs.
+        output = pixConvertTo8(pix, 0);
+        break;
     case 8:
-        output = pixRemoveColormap(pix, REMOVE_CMAP_TO_GRAYSCALE); 
+        output = pixGetColormap(pix) ? pixRemoveColormap(pix, REMOVE_CMAP_TO_GRAYSCALE) : pixCopy(nullptr, pix);
         break;
     case 16:
         {
@@ -124,9 +133,14 @@ Pix* pixToGrayscale(Pix* pix)
         }
     case 32:
         {
-            auto tmp = pixRemoveAlpha(pix);
-            output = pixConvertRGBToGrayFast(tmp);
-            pixDestroy(&tmp);
+            if (pixGetSpp(pix) == 4)
+            {
+                auto tmp = pixRemoveAlpha(pix);
+                output = pixConvertRGBToGrayFast(tmp);
+                pixDestroy(&tmp);
+            }
+            else
+                output = pixConvertRGBToGrayFast(pix);
             break;	
         }
     default:
@@ -167,60 +181,105 @@ Pix* scalePix(Pix* pix)
     return scaled;
 }
 
-namespace
-{
-    using tesseract::TessBaseAPI;
-    auto tessAPIDeleter = [](TessBaseAPI* tessAPI)
-    {
-        tessAPI->End();
-        delete tessAPI;
-    };
-    using tessAPIWrapper = std::unique_ptr<TessBaseAPI, decltype(tessAPIDeleter)>;
-}
-
 using magic_enum::ostream_operators::operator<<;
 
 namespace
 {
-    std::mutex tesseract_libtiff_mutex;
-
     using pix_unique_ptr = std::unique_ptr<PIX, decltype([](PIX* pix) { pixDestroy(&pix); })>;
+    using numa_unique_ptr = std::unique_ptr<NUMA, decltype([](NUMA* numa) { numaDestroy(&numa); })>;
 
-std::shared_ptr<PIX> load_pix(const data_source& data)
+size_t pix_cost(const std::shared_ptr<PIX>& pix)
 {
-    log_scope(data);
-    static thread_local lru_memory_cache<unique_identifier, std::shared_ptr<PIX>> pix_cache;
-    
-    return pix_cache.get_or_create(data.id(),
-        [&data](const unique_identifier& key)
-        {
-            std::lock_guard<std::mutex> lock { tesseract_libtiff_mutex };
-            leptonica_stderr_capturer leptonica_stderr_capturer;
-            std::optional<std::filesystem::path> path = data.path();
-            PIX* pix;
-            if (path)
-            {
-                pix = pixRead(path->string().c_str());
-            }
-            else
-            {
-                std::span<const std::byte> pic_data = data.span();
-                pix = pixReadMem((const unsigned char*)(pic_data.data()), pic_data.size());
-            }
-            throw_if(!pix, "Could not load image", errors::uninterpretable_data{}, leptonica_stderr_capturer.contents());
-            return std::shared_ptr<PIX>{pix, [](PIX* pix) { pixDestroy(&pix); }};
-        });
+    return static_cast<size_t>(pixGetWpl(pix.get())) * sizeof(l_uint32) * pixGetHeight(pix.get());
 }
 
-ocr_data_path default_tessdata_path()
+std::shared_ptr<PIX> make_shared_pix(PIX* pix)
 {
-    log_scope();
-    std::filesystem::path def_tessdata_path = resource_path("tessdata-fast").string();
-    throw_if (!std::filesystem::exists(def_tessdata_path),
-        "Could not find tessdata in default location", def_tessdata_path, errors::program_corrupted{});
-    return ocr_data_path{def_tessdata_path};
+    return std::shared_ptr<PIX>{pix, [](PIX* pix) { pixDestroy(&pix); }};
 }
 
+/*
+ * Decodes frames of the image one at a time, so frames of multi-page TIFFs that are never reached are not decoded.
+ * The first frame is cached together with the offset of the next one, which is zero for single images.
+ */
+class frame_reader
+{
+public:
+    explicit frame_reader(const data_source& data)
+        : m_data{data}, m_first{load_first_frame(data)}
+    {}
+
+    bool multi_frame() const { return m_first.next_offset != 0; }
+
+    // Returns nullptr after the last frame.
+    std::shared_ptr<PIX> next()
+    {
+        if (!m_first_taken)
+        {
+            m_first_taken = true;
+            m_next_offset = m_first.next_offset;
+            return m_first.pix;
+        }
+        if (m_next_offset == 0)
+            return nullptr;
+        log_scope(m_next_offset);
+        std::lock_guard<std::mutex> lock { ocr::detail::tesseract_libtiff_mutex() };
+        leptonica_stderr_capturer leptonica_stderr_capturer;
+        std::span<const std::byte> pic_data = m_data.span();
+        PIX* pix = pixReadMemFromMultipageTiff(reinterpret_cast<const l_uint8*>(pic_data.data()), pic_data.size(), &m_next_offset);
+        throw_if(!pix, "Could not load image frame", errors::uninterpretable_data{}, leptonica_stderr_capturer.contents());
+        return make_shared_pix(pix);
+    }
+
+private:
+    struct first_frame
+    {
+        std::shared_ptr<PIX> pix;
+        size_t next_offset;
+    };
+
+    static first_frame load_first_frame(const data_source& data)
+    {
+        log_scope(data);
+        // Shared by all threads and bounded by the size of decoded pixel data.
+        static lru_memory_cache<unique_identifier, first_frame> pix_cache{256 * 1024 * 1024,
+            [](const first_frame& frame) { return pix_cost(frame.pix); }};
+
+        return pix_cache.get_or_create(data.id(),
+            [&data](const unique_identifier& key)
+            {
+                std::lock_guard<std::mutex> lock { ocr::detail::tesseract_libtiff_mutex() };
+                leptonica_stderr_capturer leptonica_stderr_capturer;
+                if (data.has_highest_confidence_mime_type_in({mime_type{"image/tiff"}}))
+                {
+                    std::span<const std::byte> pic_data = data.span();
+                    size_t next_offset = 0;
+                    PIX* pix = pixReadMemFromMultipageTiff(reinterpret_cast<const l_uint8*>(pic_data.data()), pic_data.size(), &next_offset);
+                    throw_if(!pix, "Could not load image", errors::uninterpretable_data{}, leptonica_stderr_capturer.contents());
+                    return first_frame{make_shared_pix(pix), next_offset};
+                }
+                std::optional<std::filesystem::path> path = data.path();
+                PIX* pix;
+                if (path)
+                {
+                    pix = pixRead(path->string().c_str());
+                }
+                else
+                {
+                    std::span<const std::byte> pic_data = data.span();
+                    pix = pixReadMem((const unsigned char*)(pic_data.data()), pic_data.size());
+                }
+                throw_if(!pix, "Could not load image", errors::uninterpretable_data{}, leptonica_stderr_capturer.contents());
+                return first_frame{make_shared_pix(pix), 0};
+            });
+    }
+
+    const data_source& m_data;
+    first_frame m_first;
+    bool m_first_taken = false;
+    size_t m_next_offset = 0;
+};
+
 const std::vector<mime_type> supported_mime_types
 {
     mime_type{"image/tiff"},
@@ -233,112 +292,180 @@ const std::vector<mime_type> supported_mime_types
     mime_type{"image/webp"}
 };
 
-} // anonymous namespace
-
-ocr_parser::ocr_parser(const std::vector<language>& languages,
-                     ocr_confidence_threshold ocr_confidence_threshold_arg,
-                     ocr_timeout ocr_timeout_arg,
-                     ocr_data_path ocr_data_path_arg)
+// Converts the frame to a gray-scale image with dark text on light background.
+pix_unique_ptr prepare_pix(PIX* image)
 {
-    log_scope(languages, ocr_confidence_threshold_arg, ocr_timeout_arg, ocr_data_path_arg);
-    impl().m_languages = languages;
-    impl().m_ocr_confidence_threshold = ocr_confidence_threshold_arg;
-    impl().m_ocr_timeout = ocr_timeout_arg;
-    impl().m_ocr_data_path = ocr_data_path_arg.v.empty() ? default_tessdata_path() : ocr_data_path_arg;
+    log_scope();
+    pix_unique_ptr gray{ pixToGrayscale(image) };
+    numa_unique_ptr histogram{ pixGetGrayHistogram(gray.get(), 1) };
+
+    double weight_sum{ 0 };
+    double sum{ 0 };
+
+    constexpr int shadeScale{ 256 }; // where 0 - black, 255 - white
+    for(int i{ 0 }; i < shadeScale; ++i)
+    {
+        // calculating weighted average of shade
+        sum += (i+1) * histogram->array[i];
+        weight_sum += histogram->array[i];
+    }
+
+    if(static_cast<int>(sum / weight_sum) <= shadeScale / 2)
+        return pix_unique_ptr{ pixInvert(nullptr, gray.get()) };
+    else
+        return gray;
 }
 
-void ocr_parser::parse(const data_source& data, const std::vector<language>& languages)
+struct ocr_strip
 {
-    log_scope(data, languages);
+    pix_unique_ptr pix;
+    int top; // offset of the strip in the frame
+};
 
-    tessAPIWrapper api{ nullptr, tessAPIDeleter };
-    try
+// Rows where the strips are cut: centres of the widest blank gaps near every multiple of strip_height.
+std::vector<int> find_strip_cuts(PIX* gray, int strip_height)
+{
+    log_scope(strip_height);
+    const int width = pixGetWidth(gray);
+    const int height = pixGetHeight(gray);
+    std::vector<int> cuts;
+    if (strip_height <= 0 || height <= strip_height * 3 / 2)
+        return cuts;
+    pix_unique_ptr binary{ pixThresholdToBinary(gray, 128) };
+    numa_unique_ptr dark_pixels_by_row{ pixCountPixelsByRow(binary.get(), nullptr) };
+    throw_if(!dark_pixels_by_row, "Could not analyse page layout", errors::uninterpretable_data{});
+    const float noise = width / 1000.f; // isolated specks do not make a row part of the text
+    const int min_gap = std::max(4, height / 300);
+    int strip_top = 0;
+    while (height - strip_top > strip_height * 3 / 2)
     {
-        api.reset(new TessBaseAPI{});
+        const int target = strip_top + strip_height;
+        const int window_end = std::min(strip_top + strip_height * 3 / 2, height);
+        int best_cut = -1;
+        int best_gap = 0;
+        int gap_start = -1;
+        for (int y = strip_top + strip_height / 2; y <= window_end; ++y)
+        {
+            if (y < window_end && dark_pixels_by_row->array[y] <= noise)
+            {
+                if (gap_start < 0)
+                    gap_start = y;
+                continue;
+            }
+            if (gap_start >= 0)
+            {
+                int gap = y - gap_start;
+                int centre = gap_start + gap / 2;
+                if (gap >= min_gap && (gap > best_gap || (gap == best_gap && std::abs(centre - target) < std::abs(best_cut - target))))
+                {
+                    best_gap = gap;
+                    best_cut = centre;
+                }
+                gap_start = -1;
+            }
+        }
+        if (best_cut < 0)
+        {
+            // No blank band here, the strip grows until the next one.
+            strip_top = window_end - strip_height / 2;
+            continue;
+        }
+        cuts.push_back(best_cut);
+        strip_top = best_cut;
     }
-    catch(const std::bad_alloc& exc)
+    return cuts;
+}
+
+std::vector<ocr_strip> cut_into_strips(pix_unique_ptr gray, std::optional<int> strip_height)
+{
+    log_scope(strip_height);
+    std::vector<ocr_strip> strips;
+    std::vector<int> cuts = strip_height ? find_strip_cuts(gray.get(), *strip_height) : std::vector<int>{};
+    if (cuts.empty())
     {
-        throw;
+        strips.push_back(ocr_strip{std::move(gray), 0});
+        return strips;
     }
-
-    std::string langs = std::accumulate(languages.begin(), languages.end(), std::string{},
-      [](const std::string& acc, const language& lang)
-      {
-        return acc + (acc.empty() ? "" : "+") + boost::lexical_cast<std::string>(lang);
-      });
-    log_entry(langs);
-
+    cuts.push_back(pixGetHeight(gray.get()));
+    int top = 0;
+    for (int cut : cuts)
     {
-        std::lock_guard<std::mutex> tesseract_libtiff_mutex_lock{ tesseract_libtiff_mutex };
-        throw_if (api->Init(impl().m_ocr_data_path.v.string().c_str(), langs.c_str()) != 0,
-            "Could not initialize tesseract", impl().m_ocr_data_path.v.string(), langs);
+        std::unique_ptr<BOX, decltype([](BOX* box) { boxDestroy(&box); })> box{ boxCreate(0, top, pixGetWidth(gray.get()), cut - top) };
+        strips.push_back(ocr_strip{pix_unique_ptr{ pixClipRectangle(gray.get(), box.get(), nullptr) }, top});
+        throw_if(!strips.back().pix, "Could not cut page into strips", top, cut);
+        top = cut;
     }
+    return strips;
+}
 
-    // Read the image and convert to a gray-scale image
-    pix_unique_ptr gray{ nullptr };
-
-    std::shared_ptr<PIX> image = load_pix(data);
+struct recognition_settings
+{
+    std::vector<language> languages;
+    std::filesystem::path data_path;
+    float confidence_threshold;
+    std::optional<std::chrono::steady_clock::time_point> deadline;
+    std::optional<int> strip_height;
 
-    pix_unique_ptr inverted{ nullptr };
-    try
+    ocr::detail::engine_configuration engine_configuration() const
     {
-        gray.reset(pixToGrayscale(image.get()));
-        std::unique_ptr<NUMA, decltype([](NUMA* numa) { numaDestroy(&numa); })> histogram{ pixGetGrayHistogram(gray.get(), 1) };
+        return ocr::detail::engine_configuration{.languages = languages, .data_path = data_path};
+    }
+};
 
-        double weight_sum{ 0 };
-        double sum{ 0 };
+using recognized_messages = std::vector<message_ptr>;
 
-        constexpr int shadeScale{ 256 }; // where 0 - black, 255 - white
-        for(int i{ 0 }; i < shadeScale; ++i)
-        {
-            // calculating weighted average of shade
-            sum += (i+1) * histogram->array[i];
-            weight_sum += histogram->array[i];
-        }
+template <typename T>
+void add_message(recognized_messages& messages, T&& object)
+{
+    messages.push_back(make_message(std::forward<T>(object)));
+}
 
-        if(static_cast<int>(sum / weight_sum) <= shadeScale / 2)
-        {
-            inverted.reset(pixInvert(nullptr, gray.get()));
-        }
-        else
-        {
-            inverted.reset(gray.release());
-        }
-    }
-    catch(const std::exception& e)
+struct cancel_check
+{
+    std::function<bool()> should_cancel;
+
+    static bool cancel(void* data, int /*words*/)
     {
-        throw;
+        return reinterpret_cast<cancel_check*>(data)->should_cancel();
     }
+};
+
+// Recognizes one strip and returns messages to emit: Block -> Paragraph -> Line -> Word.
+recognized_messages recognize(tesseract::TessBaseAPI* api, const ocr_strip& strip, const recognition_settings& settings,
+    std::function<bool()> should_cancel)
+{
+    log_scope(strip.top);
+    recognized_messages messages;
 
-    api->SetImage(inverted.get());
+    api->SetImage(strip.pix.get());
     tesseract::ETEXT_DESC monitor;
-    if (impl().m_ocr_timeout.v)
+    if (settings.deadline)
     {
-        monitor.set_deadline_msecs(*impl().m_ocr_timeout.v);
+        auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(*settings.deadline - std::chrono::steady_clock::now());
+        // Zero would disable the deadline, so strips started after it pass get the shortest one.
+        monitor.set_deadline_msecs(static_cast<int32_t>(std::max(remaining.count(), std::chrono::milliseconds::rep{1})));
     }
-    monitor.cancel = &pimpl_impl<ocr_parser>::cancel;
-    monitor.cancel_this = reinterpret_cast<void*>(&impl().m_context_stack.top());
+    cancel_check cancel{std::move(should_cancel)};
+    monitor.cancel = &cancel_check::cancel;
+    monitor.cancel_this = &cancel;
 
     // Recognize the image
     api->Recognize(&monitor);
 
-    // Iterate through results and emit messages: Block -> Paragraph -> Line -> Word
-    const float confidence_threshold = impl().m_ocr_confidence_threshold.v.value_or(75.0f);
-
     std::unique_ptr<tesseract::ResultIterator> rit(api->GetIterator());
     if (!rit) {
         log_entry();
-        return;
+        return messages;
     }
 
     rit->Begin(); // Start at page level
     do { // Iterate Blocks (RIL_BLOCK)
         // TODO: Add styling attributes from rit->BoundingBox(RIL_BLOCK, ...) if needed
-        impl().emit_message(document::section{});
+        add_message(messages, document::section{});
 
         do { // Iterate Paragraphs (RIL_PARA) within the current Block
             // TODO: Add styling attributes from rit->BoundingBox(RIL_PARA, ...) if needed
-            impl().emit_message(document::paragraph{});
+            add_message(messages, document::paragraph{});
             bool current_line_had_high_confidence_text = false; // Used for BreakLine logic
 
             do { // Iterate TextLines (RIL_TEXTLINE) within the current Paragraph
@@ -356,11 +483,22 @@ void ocr_parser::parse(const data_source& data, const std::vector<language>& lan
                     }
                     if (!current_word_str.empty()) {
                         float conf = rit->Confidence(tesseract::RIL_WORD);
-                        if (conf >= confidence_threshold) {
+                        if (conf >= settings.confidence_threshold) {
                             if (previous_word_on_line_was_high_confidence) {
-                                impl().emit_message(document::text{" "}); // Add space before the current word
+                                add_message(messages, document::text{" "}); // Add space before the current word
                             }
-                            impl().emit_message(document::text{current_word_str});
+                            // Pixel coordinates in the frame, not in the strip
+                            int left, top, right, bottom;
+                            rit->BoundingBox(tesseract::RIL_WORD, &left, &top, &right, &bottom);
+                            add_message(messages, document::text{
+                                .text = current_word_str,
+                                .position = {
+                                    .x = std::optional<double>{static_cast<double>(left)},
+                                    .y = std::optional<double>{static_cast<double>(strip.top + bottom)},
+                                    .width = std::optional<double>{static_cast<double>(right - left)},
+                                    .height = std::optional<double>{static_cast<double>(bottom - top)}
+                                }
+                            });
                             current_line_had_high_confidence_text = true;
                             previous_word_on_line_was_high_confidence = true;
                         } else {
@@ -384,7 +522,7 @@ void ocr_parser::parse(const data_source& data, const std::vector<language>& lan
                     // Add BreakLine if not the last line of the current paragraph
                     if (!rit->IsAtFinalElement(tesseract::RIL_PARA, tesseract::RIL_TEXTLINE)) {
                         // TODO: Add styling attributes from rit->BoundingBox(RIL_TEXTLINE, ...) to BreakLine if needed
-                        impl().emit_message(document::break_line{});
+                        add_message(messages, document::break_line{});
                     }
                 }
                 // Check if this was the last line in the current paragraph before trying to advance to the next line.
@@ -394,7 +532,7 @@ void ocr_parser::parse(const data_source& data, const std::vector<language>& lan
             } while (rit->Next(tesseract::RIL_TEXTLINE)); // Advances to next line in this paragraph
 
             // End of Paragraph processing
-            impl().emit_message(document::close_paragraph{});
+            add_message(messages, document::close_paragraph{});
             // Check if this was the last paragraph in the current block before trying to advance to the next paragraph.
             if (rit->IsAtFinalElement(tesseract::RIL_BLOCK, tesseract::RIL_PARA)) {
                 break; // Break from RIL_PARA loop; Next(RIL_BLOCK) will be called.
@@ -402,8 +540,298 @@ void ocr_parser::parse(const data_source& data, const std::vector<language>& lan
         } while (rit->Next(tesseract::RIL_PARA)); // Advances to next paragraph in this block
 
         // End of Block processing
-        impl().emit_message(document::close_section{});
+        add_message(messages, document::close_section{});
     } while (rit->Next(tesseract::RIL_BLOCK)); // Advances to next block on the page
+    return messages;
+}
+
+/*
+ * Recognizes frames and strips on worker threads while the caller emits the results in reading order.
+ * Workers take strips of already prepared frames before preparing the next frame, so only a few
+ * gray-scale frames are kept in memory at once. Every worker leases its own engine from the pool.
+ */
+class parallel_recognition
+{
+public:
+    using strip_futures = std::vector<std::shared_future<recognized_messages>>;
+
+    struct queued_frame
+    {
+        std::future<strip_futures> strips; ///< Ready when the frame is cut into strips.
+        std::shared_ptr<std::atomic<bool>> skipped;
+
+        /// Strips of a skipped frame that are not recognized yet are left empty and recognition in progress is cancelled.
+        void skip() { skipped->store(true); }
+    };
+
+    parallel_recognition(const recognition_settings& settings, size_t worker_count)
+        : m_settings{settings}
+    {
+        for (size_t i = 0; i < worker_count; ++i)
+            m_workers.push_back(std::async(std::launch::async, [this]() { work(); }));
+    }
+
+    ~parallel_recognition()
+    {
+        {
+            std::lock_guard<std::mutex> lock{m_mutex};
+            m_abandoned = true;
+        }
+        m_cancelled = true;
+        m_task_available.notify_all();
+        for (std::future<void>& worker : m_workers)
+            worker.wait();
+    }
+
+    // Queues the frame for recognition.
+    queued_frame add(std::shared_ptr<PIX> frame)
+    {
+        frame_task task{std::move(frame), std::make_shared<std::atomic<bool>>(false), {}};
+        queued_frame queued{task.promise.get_future(), task.skipped};
+        {
+            std::lock_guard<std::mutex> lock{m_mutex};
+            m_frame_tasks.push_back(std::move(task));
+        }
+        m_task_available.notify_one();
+        return queued;
+    }
+
+    void cancel() { m_cancelled = true; }
+
+    bool cancelled() const { return m_cancelled; }
+
+private:
+    struct frame_task
+    {
+        std::shared_ptr<PIX> frame;
+        std::shared_ptr<std::atomic<bool>> skipped;
+        std::promise<strip_futures> promise;
+    };
+
+    struct strip_task
+    {
+        ocr_strip strip;
+        std::shared_ptr<std::atomic<bool>> skipped;
+        std::promise<recognized_messages> promise;
+    };
+
+    void work()
+    {
+        std::unique_ptr<ocr::detail::engine_lease> engine;
+        for (;;)
+        {
+            std::unique_lock<std::mutex> lock{m_mutex};
+            if (engine && !m_abandoned && m_strip_tasks.empty() && m_frame_tasks.empty())
+            {
+                // The pool may have fewer engines than there are workers, so an idle worker gives its engine back.
+                lock.unlock();
+                engine.reset();
+                continue;
+            }
+            m_task_available.wait(lock, [this]() { return m_abandoned || !m_strip_tasks.empty() || !m_frame_tasks.empty(); });
+            if (m_abandoned)
+                return;
+            if (!m_strip_tasks.empty())
+            {
+                strip_task task = std::move(m_strip_tasks.front());
+                m_strip_tasks.pop_front();
+                lock.unlock();
+                run(task, engine);
+                continue;
+            }
+            frame_task frame = std::move(m_frame_tasks.front());
+            m_frame_tasks.pop_front();
+            lock.unlock();
+            if (frame.skipped->load())
+            {
+                frame.promise.set_value({});
+                continue;
+            }
+            std::deque<strip_task> tasks;
+            try
+            {
+                for (ocr_strip& strip : cut_into_strips(prepare_pix(frame.frame.get()), m_settings.strip_height))
+                    tasks.push_back(strip_task{std::move(strip), frame.skipped, {}});
+            }
+            catch (const std::exception&)
+            {
+                frame.promise.set_exception(std::current_exception());
+                continue;
+            }
+            strip_futures futures;
+            for (strip_task& task : tasks)
+                futures.push_back(task.promise.get_future().share());
+            frame.promise.set_value(std::move(futures));
+            strip_task first = std::move(tasks.front());
+            tasks.pop_front();
+            if (!tasks.empty())
+            {
+                lock.lock();
+                std::move(tasks.begin(), tasks.end(), std::back_inserter(m_strip_tasks));
+                lock.unlock();
+                m_task_available.notify_all();
+            }
+            run(first, engine);
+        }
+    }
+
+    void run(strip_task& task, std::unique_ptr<ocr::detail::engine_lease>& engine)
+    {
+        try
+        {
+            if (task.skipped->load())
+            {
+                task.promise.set_value({});
+                return;
+            }
+            if (!engine)
+                engine = ocr::detail::lease_engine(m_settings.engine_configuration());
+            const std::atomic<bool>& skipped = *task.skipped;
+            task.promise.set_value(recognize(engine->get(), task.strip, m_settings,
+                [this, &skipped]() { return m_cancelled.load() || skipped.load(); }));
+        }
+        catch (const std::exception&)
+        {
+            task.promise.set_exception(std::current_exception());
+        }
+    }
+
+    const recognition_settings& m_settings;
+    std::mutex m_mutex;
+    std::condition_variable m_task_available;
+    std::deque<frame_task> m_frame_tasks;
+    std::deque<strip_task> m_strip_tasks;
+    std::atomic<bool> m_cancelled{false};
+    bool m_abandoned = false;
+    std::vector<std::future<void>> m_workers;
+};
+
+} // anonymous namespace
+
+ocr_parser::ocr_parser(const std::vector<language>& languages,
+                     ocr_confidence_threshold ocr_confidence_threshold_arg,
+                     ocr_timeout ocr_timeout_arg,
+                     ocr_data_path ocr_data_path_arg,
+                     ocr_worker_count ocr_worker_count_arg,
+                     ocr_strip_height ocr_strip_height_arg)
+{
+    log_scope(languages, ocr_confidence_threshold_arg, ocr_timeout_arg, ocr_data_path_arg, ocr_worker_count_arg, ocr_strip_height_arg);
+    impl().m_languages = languages;
+    impl().m_ocr_confidence_threshold = ocr_confidence_threshold_arg;
+    impl().m_ocr_timeout = ocr_timeout_arg;
+    impl().m_ocr_data_path = ocr_data_path_arg.v.empty() ? ocr::detail::default_tessdata_path() : ocr_data_path_arg;
+    impl().m_ocr_worker_count = ocr_worker_count_arg.v == 0 ? ocr_worker_count{std::max<size_t>(std::thread::hardware_concurrency(), 1)} : ocr_worker_count_arg;
+    impl().m_ocr_strip_height = ocr_strip_height_arg;
+}
+
+void ocr_parser::parse(const data_source& data, const std::vector<language>& languages)
+{
+    log_scope(data, languages);
+
+    frame_reader frames{data};
+    const recognition_settings settings
+    {
+        .languages = languages,
+        .data_path = impl().m_ocr_data_path.v,
+        .confidence_threshold = impl().m_ocr_confidence_threshold.v.value_or(75.0f),
+        .deadline = impl().m_ocr_timeout.v ?
+            std::optional{std::chrono::steady_clock::now() + std::chrono::milliseconds{*impl().m_ocr_timeout.v}} :
+            std::nullopt,
+        .strip_height = impl().m_ocr_strip_height.v
+    };
+    // Frames of multi-page images are emitted as pages, single images keep their flat structure.
+    const bool emit_pages = frames.multi_frame();
+    auto emit_messages = [this](const recognized_messages& messages)
+    {
+        for (const message_ptr& msg : messages)
+            if (impl().emit_message(msg) == continuation::stop)
+                return continuation::stop;
+        return continuation::proceed;
+    };
+    // Without strips there is at most one task per frame.
+    const size_t worker_count = settings.strip_height || emit_pages ? impl().m_ocr_worker_count.v : 1;
+
+    if (worker_count <= 1)
+    {
+        // Engines with traineddata already loaded are reused from the pool and returned to it when the lease goes out of scope.
+        std::unique_ptr<ocr::detail::engine_lease> engine = ocr::detail::lease_engine(settings.engine_configuration());
+        bool stopped = false;
+        auto should_cancel = [this, &stopped]()
+        {
+            stopped = stopped || impl().emit_message(ocr::please_wait{}) == continuation::stop;
+            return stopped;
+        };
+        // A skipped frame is still decoded, multi-page TIFFs are read sequentially, but it is not recognized.
+        for (std::shared_ptr<PIX> frame = frames.next(); frame; frame = frames.next())
+        {
+            if (emit_pages)
+            {
+                continuation response = impl().emit_message(document::page{});
+                if (response == continuation::skip)
+                    continue;
+                if (response == continuation::stop)
+                    return;
+            }
+            for (const ocr_strip& strip : cut_into_strips(prepare_pix(frame.get()), settings.strip_height))
+            {
+                recognized_messages messages = recognize(engine->get(), strip, settings, should_cancel);
+                if (stopped || emit_messages(messages) == continuation::stop)
+                    return;
+            }
+            if (emit_pages && impl().emit_message(document::close_page{}) == continuation::stop)
+                return;
+        }
+        return;
+    }
+
+    parallel_recognition recognition{settings, worker_count};
+    // Recognition runs on workers, so the chain is asked whether to continue while waiting for them.
+    auto wait_for = [this, &recognition](const auto& future)
+    {
+        while (future.wait_for(std::chrono::milliseconds{100}) != std::future_status::ready)
+        {
+            if (!recognition.cancelled() && impl().emit_message(ocr::please_wait{}) == continuation::stop)
+                recognition.cancel();
+        }
+        return recognition.cancelled() ? continuation::stop : continuation::proceed;
+    };
+    // Frames are decoded only a few pages ahead of the one being emitted.
+    std::deque<parallel_recognition::queued_frame> frames_ahead;
+    auto read_ahead = [&]()
+    {
+        while (frames_ahead.size() < worker_count)
+        {
+            std::shared_ptr<PIX> frame = frames.next();
+            if (!frame)
+                break;
+            frames_ahead.push_back(recognition.add(std::move(frame)));
+        }
+    };
+    for (read_ahead(); !frames_ahead.empty(); read_ahead())
+    {
+        parallel_recognition::queued_frame frame = std::move(frames_ahead.front());
+        frames_ahead.pop_front();
+        if (emit_pages)
+        {
+            continuation response = impl().emit_message(document::page{});
+            if (response == continuation::skip)
+            {
+                frame.skip();
+                continue;
+            }
+            if (response == continuation::stop)
+                return;
+        }
+        if (wait_for(frame.strips) == continuation::stop)
+            return;
+        for (const std::shared_future<recognized_messages>& strip : frame.strips.get())
+        {
+            if (wait_for(strip) == continuation::stop || emit_messages(strip.get()) == continuation::stop)
+                return;
+        }
+        if (emit_pages && impl().emit_message(document::close_page{}) == continuation::stop)
+            return;
+    }
 }
 
 continuation ocr_parser::operator()(message_ptr msg, const message_callbacks& emit_message)
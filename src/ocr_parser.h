@@ -36,6 +36,15 @@ struct ocr_confidence_threshold { std::optional<float> v; };
 struct ocr_data_path { std::filesystem::path v; };
 struct ocr_timeout { std::optional<int32_t> v; };
 
+/// Number of threads recognizing frames and strips of one image. 0 means std::thread::hardware_concurrency().
+struct ocr_worker_count { size_t v; };
+
+/**
+ * Approximate height in pixels of strips that tall pages are cut into, so they can be recognized in parallel.
+ * Pages are cut only at blank rows spanning the whole width, so text lines are never split.
+ */
+struct ocr_strip_height { std::optional<int> v; };
+
 class DOCWIRE_OCR_EXPORT ocr_parser : public chain_element, public with_pimpl<ocr_parser>
 {
 private:
@@ -47,7 +56,9 @@ public:
     ocr_parser(const std::vector<language>& languages = {},
         ocr_confidence_threshold ocr_confidence_threshold_arg = {},
         ocr_timeout ocr_timeout_arg = {},
-        ocr_data_path ocr_data_path_arg = {});
+        ocr_data_path ocr_data_path_arg = {},
+        ocr_worker_count ocr_worker_count_arg = {1},
+        ocr_strip_height ocr_strip_height_arg = {});
 
     continuation operator()(message_ptr msg, const message_callbacks& emit_message) override;
 
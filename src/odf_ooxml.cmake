@@ -1,9 +1,11 @@
 add_library(docwire_odf_ooxml SHARED
     common_xml_document_parser.cpp
     odf_ooxml_parser.cpp
-    odfxml_parser.cpp)
+    odfxml_parser.cpp
+    xlsx_scanner.cpp)
 
 target_link_libraries(docwire_odf_ooxml PRIVATE docwire_xml docwire_core)
+docwire_perfect_hash_index_sources(common_xml_document_parser.cpp)
 
 install(TARGETS docwire_odf_ooxml EXPORT docwire_targets)
 if(MSVC)
@@ -35,6 +35,7 @@
 #include <string.h>
 #include "throw_if.h"
 #include "xml_root_element.h"
+#include "xlsx_scanner.h"
 
 namespace docwire
 {
@@ -59,6 +60,10 @@ static string locate_main_file(const zip_reader& zipfile)
 namespace
 {
 
+// In PARSE_XML mode parts larger than this are parsed while they are decompressed, so memory use does not grow
+// with the size of huge spreadsheets.
+constexpr unsigned long streaming_threshold = 16 * 1024 * 1024;
+
 struct context
 {
 	const message_callbacks& emit_message;
@@ -66,26 +71,6 @@ struct context
 	int last_ooxml_row_num = 0;
 };
 
-const std::vector<mime_type> supported_mime_types =
-{
-	mime_type{"application/vnd.oasis.opendocument.text"},
-	mime_type{"application/vnd.oasis.opendocument.spreadsheet"},
-	mime_type{"application/vnd.oasis.opendocument.presentation"},
-	mime_type{"application/vnd.oasis.opendocument.graphics"},
-	mime_type{"application/vnd.oasis.opendocument.text-template"},
-	mime_type{"application/vnd.oasis.opendocument.spreadsheet-template"},
-	mime_type{"application/vnd.oasis.opendocument.presentation-template"},
-	mime_type{"application/vnd.oasis.opendocument.graphics-template"},
-	mime_type{"application/vnd.oasis.opendocument.text-web"},
-	mime_type{"application/vnd.openxmlformats-officedocument.wordprocessingml.document"},
-	mime_type{"application/vnd.openxmlformats-officedocument.spreadsheetml.sheet"},
-	mime_type{"application/vnd.openxmlformats-officedocument.presentationml.presentation"},
-	mime_type{"application/vnd.openxmlformats-officedocument.wordprocessingml.template"},
-	mime_type{"application/vnd.openxmlformats-officedocument.spreadsheetml.template"},
-	mime_type{"application/vnd.openxmlformats-officedocument.presentationml.template"},
-	mime_type{"application/vnd.openxmlformats-officedocument.presentationml.slideshow"}
-};
-
 } // anonymous namespace
 
 template <safety_policy safety_level>
@@ -500,6 +485,16 @@ void odf_ooxml_parser<safety_level>::parse(const data_source& data, xml_parse_mo
 		{
 			std::throw_with_nested(make_error("Invalid file structure"));
 		}
+		auto is_streamed = [&zipfile, mode](const std::string& file_name)
+		{
+			unsigned long file_size;
+			return mode == PARSE_XML && zipfile.getFileSize(file_name, file_size) && file_size > streaming_threshold;
+		};
+		// Parts are parsed one after another, but the ones read later can be decompressed in the meantime.
+		// The main part is not among them: it is read right away, or never as a whole for presentations and workbooks.
+		std::vector<std::string> prefetched_files {"word/comments.xml", "word/_rels/document.xml.rels", "styles.xml", "xl/sharedStrings.xml"};
+		std::erase_if(prefetched_files, is_streamed);
+		zipfile.prefetch(prefetched_files);
 		emit_message(document::document{.metadata=[this, &zipfile](){ return metaData(zipfile);}});
 	//according to the ODF specification, we must skip blank nodes. Otherwise output may be messed up.
 	if (main_file_name == "content.xml")
@@ -532,86 +527,159 @@ void odf_ooxml_parser<safety_level>::parse(const data_source& data, xml_parse_mo
 	if (zipfile.exists("styles.xml"))
 		impl().readStyles(zipfile, mode, emit_message);
 	string content;
+	// Returns false if the part cannot be read.
+	auto extract_part_text = [&](const std::string& file_name)
+	{
+		std::string text;
+		if (is_streamed(file_name))
+		{
+			std::optional<xml::reader_input> input = zipfile.read_stream(file_name);
+			if (!input)
+				return false;
+			extractText(std::move(*input), mode, &zipfile, text);
+		}
+		else
+		{
+			std::optional<std::string_view> part = zipfile.read_view(file_name, content);
+			if (!part)
+				return false;
+			extractText(*part, mode, &zipfile, text);
+		}
+		return true;
+	};
 	if (main_file_name == "ppt/presentation.xml")
 	{
-		throw_if (!zipfile.loadDirectory());
-		for (int i = 1; zipfile.read("ppt/slides/slide" + stringify(i) + ".xml", &content) && i < 2500; i++)
+		for (int i = 1; i < 2500; i++)
 		{
+			std::string file_name = "ppt/slides/slide" + stringify(i) + ".xml";
 			try
 			{
-				std::string text;
-				extractText(content, mode, &zipfile, text);
+				if (!extract_part_text(file_name))
+					break;
 			}
 			catch (const std::exception& e)
 			{
-				std::throw_with_nested(make_error(std::make_pair("file_name", "ppt/slides/slide" + stringify(i) + ".xml")));
+				std::throw_with_nested(make_error(std::make_pair("file_name", file_name)));
 			}
 		}
 	}
 	else if (main_file_name == "xl/workbook.xml")
 	{
-		if (!zipfile.read("xl/sharedStrings.xml", &content))
+		auto parse_shared_strings = [&](xml::reader<safety_level>&& xml_reader)
+		{
+			for (auto node: children(root_element(xml_reader)))
+			{
+				if (node.name() == "si")
+				{
+					shared_string shared_string;
+					activeEmittingSignals(false);
+					shared_string.m_text = parseXmlChildren(node, mode, &zipfile);
+					activeEmittingSignals(true);
+					getSharedStrings().push_back(shared_string);
+				}
+			}
+		};
+		// SpreadsheetML parts are read by xlsx_scanner unless they have to be fixed or are not encoded in UTF-8.
+		// Then the XML reader reads them.
+		auto read_part = [&](const std::string& file_name) -> std::optional<xlsx_scanner::part_content>
+		{
+			if (is_streamed(file_name))
+				return zipfile.read_stream(file_name);
+			return zipfile.read_view(file_name, content);
+		};
+		std::optional<shared_string_pool> scanned_strings;
+		if (mode == PARSE_XML && getRelationships().empty())
+		{
+			try
+			{
+				std::optional<xlsx_scanner::part_content> part = read_part("xl/sharedStrings.xml");
+				throw_if (!part && is_streamed("xl/sharedStrings.xml"), "Error reading XML file from ZIP file");
+				scanned_strings = part ? xlsx_scanner::scan_shared_strings(std::move(*part)) : shared_string_pool{};
+			}
+			catch (const std::exception& e)
+			{
+				std::throw_with_nested(make_error(std::make_pair("file_name", "xl/sharedStrings.xml")));
+			}
+		}
+		if (scanned_strings)
+			log_entry(scanned_strings->size());
+		else if (is_streamed("xl/sharedStrings.xml"))
+		{
+			try
+			{
+				std::optional<xml::reader_input> input = zipfile.read_stream("xl/sharedStrings.xml");
+				throw_if (!input, "Error reading XML file from ZIP file");
+				parse_shared_strings(xml::reader<safety_level>{std::move(*input), blanks()});
+			}
+			catch (const std::exception& e)
+			{
+				std::throw_with_nested(make_error(std::make_pair("file_name", "xl/sharedStrings.xml")));
+			}
+		}
+		else if (!zipfile.read("xl/sharedStrings.xml", &content))
 		{
 			//file may not exist, but this is not reason to report an error.
 			log_entry();
 		}
 		else
 		{
-			std::string xml;
+			std::string fixed_xml;
+			std::string_view xml = content;
 			if (mode == FIX_XML)
 			{
 				xml_fixer xml_fixer;
-				xml = xml_fixer.fix(content);
+				fixed_xml = xml_fixer.fix(content);
+				xml = fixed_xml;
 			}
-			else if (mode == PARSE_XML)
-				xml = content;
 			else
 				throw_if(mode == STRIP_XML, "Stripping XML is not possible for xlsx files", errors::program_logic{});
 			try
 			{
-				xml::reader<safety_level> xml_reader(xml, blanks());
-				for (auto node: children(root_element(xml_reader)))
-				{
-					if (node.name() == "si")
-					{
-						shared_string shared_string;
-            			activeEmittingSignals(false);
-						shared_string.m_text = parseXmlChildren(node, mode, &zipfile);
-            			activeEmittingSignals(true);
-						getSharedStrings().push_back(shared_string);
-					}
-				}
+				parse_shared_strings(xml::reader<safety_level>{xml, blanks()});
 			}
 			catch (const std::exception& e)
 			{
 				std::throw_with_nested(make_error(std::make_pair("file_name", "xl/sharedStrings.xml")));
 			}
 		}
-		for (int i = 1; zipfile.read("xl/worksheets/sheet" + stringify(i) + ".xml", &content); i++)
+		for (int i = 1; ; i++)
 		{
+			std::string file_name = "xl/worksheets/sheet" + stringify(i) + ".xml";
 			try
 			{
-				std::string text;
-				extractText(content, mode, &zipfile, text);
+				if (scanned_strings)
+				{
+					std::optional<xlsx_scanner::part_content> part = read_part(file_name);
+					if (!part)
+						break;
+					if (xlsx_scanner::scan_sheet(std::move(*part), *scanned_strings, emit_message))
+						continue;
+					// Shared strings are passed to the XML reader path, which reads this and the following sheets.
+					for (size_t index = 0; index < scanned_strings->size(); ++index)
+						getSharedStrings().push_back(shared_string{.m_text = std::string{(*scanned_strings)[index]}});
+					scanned_strings.reset();
+				}
+				if (!extract_part_text(file_name))
+					break;
 			}
 			catch (const std::exception& e)
 			{
-				std::throw_with_nested(make_error(std::make_pair("file_name", "xl/worksheets/sheet" + stringify(i) + ".xml")));
+				std::throw_with_nested(make_error(std::make_pair("file_name", file_name)));
 			}
 		}
 	}
 	else
 	{
-		throw_if(!zipfile.read(main_file_name, &content), "Error reading XML file from ZIP file", main_file_name);
+		bool main_file_read;
 		try
 		{
-			std::string text;
-			extractText(content, mode, &zipfile, text);
+			main_file_read = extract_part_text(main_file_name);
 		}
 		catch (const std::exception& e)
 		{
 			std::throw_with_nested(make_error(main_file_name));
 		}
+		throw_if(!main_file_read, "Error reading XML file from ZIP file", main_file_name);
 	}
 	emit_message(document::close_document{});
 	}
@@ -723,6 +791,31 @@ void odf_ooxml_parser<safety_level>::parse(const data_source& data, const messag
 	parse(data, xml_parse_mode::PARSE_XML, emit_message);
 }
 
+template <safety_policy safety_level>
+const std::vector<mime_type>& odf_ooxml_parser<safety_level>::supported_mime_types()
+{
+	static const std::vector<mime_type> mime_types =
+	{
+		mime_type{"application/vnd.oasis.opendocument.text"},
+		mime_type{"application/vnd.oasis.opendocument.spreadsheet"},
+		mime_type{"application/vnd.oasis.opendocument.presentation"},
+		mime_type{"application/vnd.oasis.opendocument.graphics"},
+		mime_type{"application/vnd.oasis.opendocument.text-template"},
+		mime_type{"application/vnd.oasis.opendocument.spreadsheet-template"},
+		mime_type{"application/vnd.oasis.opendocument.presentation-template"},
+		mime_type{"application/vnd.oasis.opendocument.graphics-template"},
+		mime_type{"application/vnd.oasis.opendocument.text-web"},
+		mime_type{"application/vnd.openxmlformats-officedocument.wordprocessingml.document"},
+		mime_type{"application/vnd.openxmlformats-officedocument.spreadsheetml.sheet"},
+		mime_type{"application/vnd.openxmlformats-officedocument.presentationml.presentation"},
+		mime_type{"application/vnd.openxmlformats-officedocument.wordprocessingml.template"},
+		mime_type{"application/vnd.openxmlformats-officedocument.spreadsheetml.template"},
+		mime_type{"application/vnd.openxmlformats-officedocument.presentationml.template"},
+		mime_type{"application/vnd.openxmlformats-officedocument.presentationml.slideshow"}
+	};
+	return mime_types;
+}
+
 template <safety_policy safety_level>
 continuation odf_ooxml_parser<safety_level>::operator()(message_ptr msg, const message_callbacks& emit_message)
 {
@@ -733,7 +826,7 @@ continuation odf_ooxml_parser<safety_level>::operator()(message_ptr msg, const m
 	auto& data = msg->get<data_source>();
 	data.assert_not_encrypted();
 
-	if (!data.has_highest_confidence_mime_type_in(supported_mime_types))
+	if (!data.has_highest_confidence_mime_type_in(supported_mime_types()))
 	{
 		return emit_message(std::move(msg));
 	}
@@ -16,6 +16,7 @@
 #include "data_source.h"
 #include "odf_ooxml_export.h"
 #include "safety_policy.h"
+#include <vector>
 
 namespace docwire
 {
@@ -38,6 +39,7 @@ class DOCWIRE_ODF_OOXML_EXPORT odf_ooxml_parser : public common_xml_document_par
     using base_type::parseODFMetadata;
     using base_type::parseXmlChildren;
     using base_type::getSharedStrings;
+    using base_type::getRelationships;
     using base_type::activeEmittingSignals;
     using shared_string = base_type::shared_string;
     using scoped_context_stack_push = base_type::scoped_context_stack_push;
@@ -68,6 +70,8 @@ class DOCWIRE_ODF_OOXML_EXPORT odf_ooxml_parser : public common_xml_document_par
      * @return The continuation status.
      */
     continuation operator()(message_ptr msg, const message_callbacks& emit_message) override;
+    /// MIME types of the data sources parsed by this parser. Other data sources are passed on.
+    static const std::vector<mime_type>& supported_mime_types();
     bool is_leaf() const override { return false; }
 };
 
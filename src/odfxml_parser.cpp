@@ -22,18 +22,6 @@
 namespace docwire
 {
 
-namespace
-{
-
-const std::vector<mime_type> supported_mime_types =
-{
-	mime_type{"application/vnd.oasis.opendocument.text-flat-xml"},
-	mime_type{"application/vnd.oasis.opendocument.spreadsheet-flat-xml"},
-	mime_type{"application/vnd.oasis.opendocument.presentation-flat-xml"},
-	mime_type{"application/vnd.oasis.opendocument.graphics-flat-xml"}
-};
-
-} // anonymous namespace
 	
 template <safety_policy safety_level>
 struct pimpl_impl<odfxml_parser<safety_level>> : with_pimpl_owner<odfxml_parser<safety_level>>
@@ -152,6 +140,19 @@ attributes::metadata pimpl_impl<odfxml_parser<safety_level>>::extract_metadata(s
 	return metadata;
 }
 
+template <safety_policy safety_level>
+const std::vector<mime_type>& odfxml_parser<safety_level>::supported_mime_types()
+{
+	static const std::vector<mime_type> mime_types =
+	{
+		mime_type{"application/vnd.oasis.opendocument.text-flat-xml"},
+		mime_type{"application/vnd.oasis.opendocument.spreadsheet-flat-xml"},
+		mime_type{"application/vnd.oasis.opendocument.presentation-flat-xml"},
+		mime_type{"application/vnd.oasis.opendocument.graphics-flat-xml"}
+	};
+	return mime_types;
+}
+
 template <safety_policy safety_level>
 continuation odfxml_parser<safety_level>::operator()(message_ptr msg, const message_callbacks& emit_message)
 {
@@ -163,7 +164,7 @@ continuation odfxml_parser<safety_level>::operator()(message_ptr msg, const mess
 	auto& data = msg->get<data_source>();
 	data.assert_not_encrypted(); // General check on data_source
 
-	if (!data.has_highest_confidence_mime_type_in(supported_mime_types))
+	if (!data.has_highest_confidence_mime_type_in(supported_mime_types()))
 	{
 		return emit_message(std::move(msg));
 	}
@@ -16,10 +16,13 @@
 #include "odf_ooxml_export.h"
 #include "pimpl.h"
 #include "safety_policy.h"
+#include <vector>
 
 namespace docwire
 {
 
+struct mime_type;
+
 /**
  * @brief A parser for flat ODF XML documents.
  * @tparam safety_level The safety policy to use.
@@ -51,6 +54,8 @@ class DOCWIRE_ODF_OOXML_EXPORT odfxml_parser : public common_xml_document_parser
 		 * @return The continuation status.
 		 */
 		continuation operator()(message_ptr msg, const message_callbacks& emit_message) override;
+		/// MIME types of the data sources parsed by this parser. Other data sources are passed on.
+		static const std::vector<mime_type>& supported_mime_types();
 		bool is_leaf() const override { return false; }
 };
 
@@ -21,7 +21,7 @@
 #include "xls_parser.h"
 #include "xlsb_parser.h"
 #include "odf_ooxml_parser.h"
-#include "parsing_chain.h"
+#include "mime_type_dispatcher.h"
 #include "ppt_parser.h"
 #include "rtf_parser.h"
 #include "txt_parser.h"
@@ -35,25 +35,28 @@ namespace docwire
  * @tparam safety_level The safety policy to use.
  */
 template <safety_policy safety_level = default_safety_level>
-class office_formats_parser : public parsing_chain
+class office_formats_parser : public mime_type_dispatcher
 {
     public:
         /**
-         * @brief Constructs the composite parser with a predefined chain of format parsers.
+         * @brief Constructs the composite parser with a predefined list of format parsers.
+         *
+         * Parsers are tried in the order of the list, so for MIME types supported by more than one of them
+         * (e.g. text/html) the earlier parser is selected.
          */
         office_formats_parser()
-            : parsing_chain{
-                html_parser{} |
-                doc_parser{} |
-                pdf_parser{} |
-                xls_parser{} |
-                xlsb_parser{} |
-                iwork_parser{} |
-                ppt_parser{} |
-                rtf_parser{} |
-                odf_ooxml_parser<safety_level>{} |
-                odfxml_parser<safety_level>{} |
-                xml_parser<safety_level>{} |
+            : mime_type_dispatcher{
+                html_parser{},
+                doc_parser{},
+                pdf_parser{},
+                xls_parser{},
+                xlsb_parser{},
+                iwork_parser{},
+                ppt_parser{},
+                rtf_parser{},
+                odf_ooxml_parser<safety_level>{},
+                odfxml_parser<safety_level>{},
+                xml_parser<safety_level>{},
                 txt_parser{}
             }
         {}
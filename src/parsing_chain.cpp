@@ -102,7 +102,7 @@ parsing_chain operator|(ref_or_owned<chain_element> lhs, ref_or_owned<chain_elem
   parsing_chain chain{lhs, rhs};
   if (chain.is_complete())
   {
-    chain(std::make_shared<message<pipeline::start_processing>>(pipeline::start_processing{}));
+    chain(make_message(pipeline::start_processing{}));
   }
   return chain;
 }
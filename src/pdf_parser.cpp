@@ -19,7 +19,9 @@
 #include "log_entry.h"
 #include "log_scope.h"
 #include "make_error.h"
+#include <future>
 #include <leptonica/allheaders.h>
+#include <map>
 #include <mutex>
 #include "nested_exception.h"
 #ifdef _WIN32
@@ -151,11 +153,6 @@ struct context
 	scoped_fpdf_document_with_custom_deleter pdf_document;
 };
 
-const std::vector<mime_type> supported_mime_types =
-{
-	mime_type{"application/pdf"}
-};
-
 using page_element_variant = std::variant<document::text, document::image>;
 
 // Helper to get a characteristic height for an element, prioritizing font_size for text.
@@ -218,6 +215,26 @@ struct page_element_variant_comparator
 	}
 };
 
+struct pending_image
+{
+	int object_index;
+	pix_unique_ptr pix;
+	attributes::position position;
+};
+
+data_source encode_png(PIX* pix)
+{
+	l_uint8* png_data_raw = nullptr;
+	size_t png_size = 0;
+	throw_if (pixWriteMemPng(&png_data_raw, &png_size, pix, 0.0f) != 0);
+	throw_if (!png_data_raw);
+	leptonica_data_ptr png_data(png_data_raw, lept_free);
+	throw_if (png_size <= 0);
+	std::vector<std::byte> image_data(png_size);
+	memcpy(image_data.data(), png_data.get(), png_size);
+	return data_source(std::move(image_data), mime_type { "image/png" }, confidence::highest);
+}
+
 bool ends_with_whitespace(const std::string& s) {
 	return !s.empty() && std::isspace(static_cast<unsigned char>(s.back()));
 }
@@ -231,6 +248,11 @@ bool begins_with_whitespace(const std::string& s) {
 template<>
 struct pimpl_impl<pdf_parser> : pimpl_impl_base
 {
+	explicit pimpl_impl(pdf_page_prefetch page_prefetch)
+		: m_page_prefetch{page_prefetch.v}
+	{}
+
+	size_t m_page_prefetch;
 	std::stack<context> m_context_stack;
 
 	template <typename T>
@@ -250,288 +272,344 @@ struct pimpl_impl<pdf_parser> : pimpl_impl_base
 		return m_context_stack.top().pdf_document.get();
 	}
 
-	void parseText()
+	/// Everything read from a single page, ready to be emitted without holding the PDFium lock.
+	struct extracted_page
 	{
-		log_scope();
+		std::multiset<page_element_variant, page_element_variant_comparator> elements;
+		std::vector<pending_image> images;
+		std::vector<std::exception_ptr> errors;
+	};
+
+	// The only part of page processing that calls PDFium. Does not use the context stack, so it can run on a prefetch thread.
+	static void read_page_objects(FPDF_DOCUMENT pdf_doc, size_t page_num, extracted_page& page)
+	{
+		// Declared before the page handles so they are closed while the lock is still held.
 		std::lock_guard<std::mutex> pdfium_mutex_lock(pdfium_mutex);
-		int page_count = FPDF_GetPageCount(pdf_document());
-		log_entry(page_count);
-		for (size_t page_num = 0; page_num < page_count; page_num++)
+		ScopedFPDFPage pdf_page { FPDF_LoadPage(pdf_doc, page_num) };
+		throw_if(!pdf_page);
+		// text_page is only needed for FPDFTextObj_GetText, so load it if/when a text object is found.
+		ScopedFPDFTextPage text_page { nullptr };
+
+		int object_count = FPDFPage_CountObjects(pdf_page.get());
+		throw_if (object_count < 0, "FPDFPage_CountObjects returned negative count");
+		thread_local charset_converter conv("UTF-16LE", "UTF-8");
+		for (int i = 0; i < object_count; ++i)
 		{
-			log_scope(page_num);
-			auto response = emit_message(document::page{});
-			if (response == continuation::skip)
-			{
-				continue;
-			}
-			else if (response == continuation::stop)
-			{
-				break;
-			}
 			try
 			{
-				std::multiset<page_element_variant, page_element_variant_comparator> page_elements;
-				ScopedFPDFPage page { FPDF_LoadPage(pdf_document(), page_num) };
-				throw_if(!page);
-				// text_page is only needed for FPDFTextObj_GetText, so load it if/when a text object is found.
-				ScopedFPDFTextPage text_page { nullptr };
-
-				int object_count = FPDFPage_CountObjects(page.get());
-				throw_if (object_count < 0, "FPDFPage_CountObjects returned negative count");
-				thread_local charset_converter conv("UTF-16LE", "UTF-8");
-				bool stop_processing = false;
-				for (int i = 0; i < object_count; ++i)
-				{
-					try
-					{
-    				FPDF_PAGEOBJECT object = FPDFPage_GetObject(page.get(), i);
-    				throw_if (!object);
-    				int object_type = FPDFPageObj_GetType(object);
-    				switch (object_type)
-					{
-        				case FPDF_PAGEOBJ_TEXT:
-        				{
-							if (!text_page) { // Load text_page on demand
-								text_page.reset(FPDFText_LoadPage(page.get()));
-								throw_if(!text_page, "FPDFText_LoadPage failed");
-							}
-							unsigned long buffer_size = FPDFTextObj_GetText(object, text_page.get(), nullptr, 0);
-            				std::string utf8_text;
-							if (buffer_size > 0) { // FPDFTextObj_GetText needs at least 2 bytes for empty string (null terminator)
-                				std::vector<unsigned short> buffer(buffer_size / sizeof(unsigned short)); // buffer_size is in bytes
-                				unsigned long bytes_returned = FPDFTextObj_GetText(object, text_page.get(), buffer.data(), buffer_size);
-                				throw_if(bytes_returned > buffer_size || (bytes_returned == 0 && buffer_size >0) , "FPDFTextObj_GetText failed to retrieve text or returned unexpected size");
-                    			if (bytes_returned > 0) { // bytes_returned includes the null terminator(s)
-									utf8_text = conv.convert(std::string{
-										reinterpret_cast<const char*>(buffer.data()),
-										bytes_returned - sizeof(unsigned short) // Exclude UTF-16LE NULL terminator
-									});
-								}
-							}
-
-							float left, bottom, right, top;
-							throw_if(!FPDFPageObj_GetBounds(object, &left, &bottom, &right, &top));
-
-							float font_size_val = 0.0f;
-							FPDF_FONT font = FPDFTextObj_GetFont(object);
-							if (font)
-							{
-								log_scope();
-								if (!FPDFTextObj_GetFontSize(object, &font_size_val) || font_size_val <= 0) {
-            						log_entry();
-									font_size_val = 10.0f; // Default if not found
-								}
-    						}
-							page_elements.insert(document::text{
-								.text = utf8_text,
-								.position = {
-									.x = std::optional<double>{static_cast<double>(left)},
-									.y = std::optional<double>{static_cast<double>(bottom)},
-									.width = std::optional<double>{static_cast<double>(right - left)},
-									.height = std::optional<double>{static_cast<double>(top - bottom)}
-								},
-								.font_size = static_cast<double>(font_size_val)
+    		FPDF_PAGEOBJECT object = FPDFPage_GetObject(pdf_page.get(), i);
+    		throw_if (!object);
+    		int object_type = FPDFPageObj_GetType(object);
+    		switch (object_type)
+			{
+        		case FPDF_PAGEOBJ_TEXT:
+        		{
+					if (!text_page) { // Load text_page on demand
+						text_page.reset(FPDFText_LoadPage(pdf_page.get()));
+						throw_if(!text_page, "FPDFText_LoadPage failed");
+					}
+					unsigned long buffer_size = FPDFTextObj_GetText(object, text_page.get(), nullptr, 0);
+            		std::string utf8_text;
+					if (buffer_size > 0) { // FPDFTextObj_GetText needs at least 2 bytes for empty string (null terminator)
+                		std::vector<unsigned short> buffer(buffer_size / sizeof(unsigned short)); // buffer_size is in bytes
+                		unsigned long bytes_returned = FPDFTextObj_GetText(object, text_page.get(), buffer.data(), buffer_size);
+                		throw_if(bytes_returned > buffer_size || (bytes_returned == 0 && buffer_size >0) , "FPDFTextObj_GetText failed to retrieve text or returned unexpected size");
+                    	if (bytes_returned > 0) { // bytes_returned includes the null terminator(s)
+							utf8_text = conv.convert(std::string{
+								reinterpret_cast<const char*>(buffer.data()),
+								bytes_returned - sizeof(unsigned short) // Exclude UTF-16LE NULL terminator
 							});
-            				break;
-        				}
-						case FPDF_PAGEOBJ_IMAGE:
-						{
-							ScopedFPDFBitmap bitmap { FPDFImageObj_GetBitmap(object) };
-							int width = FPDFBitmap_GetWidth(bitmap.get());
-							int height = FPDFBitmap_GetHeight(bitmap.get());
-							int stride = FPDFBitmap_GetStride(bitmap.get());
-							const unsigned char* pixels = (const unsigned char*)FPDFBitmap_GetBuffer(bitmap.get());
-        					int format = FPDFBitmap_GetFormat(bitmap.get());
-
-							FPDF_IMAGEOBJ_METADATA image_metadata;
-							l_int32 h_res = 72; // Default DPI
-							l_int32 v_res = 72;   // Default DPI
-							if (FPDFImageObj_GetImageMetadata(object, page.get(), &image_metadata)) {
-								if (image_metadata.horizontal_dpi > 0.0f)
-									h_res = static_cast<l_int32>(image_metadata.horizontal_dpi);
-								if (image_metadata.vertical_dpi > 0.0f)
-									v_res = static_cast<l_int32>(image_metadata.vertical_dpi);
-							}
-
-            				pix_unique_ptr pix = create_pix_from_fpdf_bitmap(width, height, stride, format, pixels, h_res, v_res);
-			                l_uint8* png_data_raw = nullptr;
-            			    size_t png_size = 0;
-                			leptonica_data_ptr png_data(nullptr, lept_free);
-                			throw_if (pixWriteMemPng(&png_data_raw, &png_size, pix.get(), 0.0f) != 0);
-							throw_if (!png_data_raw);
-							throw_if (png_size <= 0);
-                    		png_data.reset(png_data_raw);
-							std::vector<std::byte> image_data;
-                    		image_data.resize(png_size);
-							memcpy(image_data.data(), png_data.get(), png_size);
-                			data_source image_source(std::move(image_data), mime_type { "image/png" }, confidence::highest);
-
-							float left, bottom, right, top;
-							throw_if(!FPDFPageObj_GetBounds(object, &left, &bottom, &right, &top));
-							page_elements.insert(document::image{
-                                .source = std::move(image_source),
-                                .alt = std::nullopt, // PDFium does not easily provide this for FPDF_PAGEOBJ_IMAGE
-                                .position = {
-                                    .x = std::optional<double>{static_cast<double>(left)},
-                                    .y = std::optional<double>{static_cast<double>(bottom)},
-                                    .width = std::optional<double>{static_cast<double>(right - left)},
-                                    .height = std::optional<double>{static_cast<double>(top - bottom)}
-                                }
-                            });
-							break;
 						}
-						default:
-							break;
 					}
-					}
-					catch (const std::exception&)
+
+					float left, bottom, right, top;
+					throw_if(!FPDFPageObj_GetBounds(object, &left, &bottom, &right, &top));
+
+					float font_size_val = 0.0f;
+					FPDF_FONT font = FPDFTextObj_GetFont(object);
+					if (font)
 					{
-						emit_message(errors::make_nested_ptr(std::current_exception(), make_error("Failed to process object", i)));
+						log_scope();
+						if (!FPDFTextObj_GetFontSize(object, &font_size_val) || font_size_val <= 0) {
+            				log_entry();
+							font_size_val = 10.0f; // Default if not found
+						}
+    				}
+					page.elements.insert(document::text{
+						.text = utf8_text,
+						.position = {
+							.x = std::optional<double>{static_cast<double>(left)},
+							.y = std::optional<double>{static_cast<double>(bottom)},
+							.width = std::optional<double>{static_cast<double>(right - left)},
+							.height = std::optional<double>{static_cast<double>(top - bottom)}
+						},
+						.font_size = static_cast<double>(font_size_val)
+					});
+            		break;
+        		}
+				case FPDF_PAGEOBJ_IMAGE:
+				{
+					ScopedFPDFBitmap bitmap { FPDFImageObj_GetBitmap(object) };
+					int width = FPDFBitmap_GetWidth(bitmap.get());
+					int height = FPDFBitmap_GetHeight(bitmap.get());
+					int stride = FPDFBitmap_GetStride(bitmap.get());
+					const unsigned char* pixels = (const unsigned char*)FPDFBitmap_GetBuffer(bitmap.get());
+        			int format = FPDFBitmap_GetFormat(bitmap.get());
+
+					FPDF_IMAGEOBJ_METADATA image_metadata;
+					l_int32 h_res = 72; // Default DPI
+					l_int32 v_res = 72;   // Default DPI
+					if (FPDFImageObj_GetImageMetadata(object, pdf_page.get(), &image_metadata)) {
+						if (image_metadata.horizontal_dpi > 0.0f)
+							h_res = static_cast<l_int32>(image_metadata.horizontal_dpi);
+						if (image_metadata.vertical_dpi > 0.0f)
+							v_res = static_cast<l_int32>(image_metadata.vertical_dpi);
 					}
-					if (stop_processing) break;
+
+            		pix_unique_ptr pix = create_pix_from_fpdf_bitmap(width, height, stride, format, pixels, h_res, v_res);
+					float left, bottom, right, top;
+					throw_if(!FPDFPageObj_GetBounds(object, &left, &bottom, &right, &top));
+					page.images.push_back(pending_image{
+						.object_index = i,
+						.pix = std::move(pix),
+						.position = {
+							.x = std::optional<double>{static_cast<double>(left)},
+							.y = std::optional<double>{static_cast<double>(bottom)},
+							.width = std::optional<double>{static_cast<double>(right - left)},
+							.height = std::optional<double>{static_cast<double>(top - bottom)}
+						}
+					});
+					break;
 				}
-				if (stop_processing)
+				default:
 					break;
+			}
+			}
+			catch (const std::exception&)
+			{
+				page.errors.push_back(errors::make_nested_ptr(std::current_exception(), make_error("Failed to process object", i)));
+			}
+		}
+	}
 
-				const page_element_variant* prev_element_variant = nullptr;
-				for (const auto& element : page_elements)
-				{
-					if (prev_element_variant)
-					{
+	static extracted_page extract_page(FPDF_DOCUMENT pdf_doc, size_t page_num)
+	{
+		log_scope(page_num);
+		extracted_page page;
+		read_page_objects(pdf_doc, page_num, page);
+		// PNG compression does not need PDFium, so it is done after the lock is released.
+		for (pending_image& image : page.images)
+		{
+			try
+			{
+				page.elements.insert(document::image{
+					.source = encode_png(image.pix.get()),
+					.alt = std::nullopt, // PDFium does not easily provide this for FPDF_PAGEOBJ_IMAGE
+					.position = image.position
+				});
+			}
+			catch (const std::exception&)
+			{
+				page.errors.push_back(errors::make_nested_ptr(std::current_exception(), make_error("Failed to process object", image.object_index)));
+			}
+		}
+		page.images.clear();
+		return page;
+	}
+
+	// Returns true if processing should stop.
+	bool emit_page(extracted_page& page, size_t page_num)
+	{
+		for (std::exception_ptr& error : page.errors)
+			emit_message(std::move(error));
+		bool stop_processing = false;
+		const page_element_variant* prev_element_variant = nullptr;
+		for (const auto& element : page.elements)
+		{
+			if (prev_element_variant)
+			{
+				std::visit(
+					[&](const auto& prev_el_concrete) {
 						std::visit(
-							[&](const auto& prev_el_concrete) {
-								std::visit(
-									[&](const auto& current_el_concrete) {
-										// Ensure all elements have necessary positional attributes
-										if (!prev_el_concrete.position.y || !prev_el_concrete.position.height ||
-											!prev_el_concrete.position.x || !prev_el_concrete.position.width ||
-											!current_el_concrete.position.y || !current_el_concrete.position.height ||
-											!current_el_concrete.position.x) {
-											// If either element lacks position info, skip detailed spacing logic.
-											return;
-										}
+							[&](const auto& current_el_concrete) {
+								// Ensure all elements have necessary positional attributes
+								if (!prev_el_concrete.position.y || !prev_el_concrete.position.height ||
+									!prev_el_concrete.position.x || !prev_el_concrete.position.width ||
+									!current_el_concrete.position.y || !current_el_concrete.position.height ||
+									!current_el_concrete.position.x) {
+									// If either element lacks position info, skip detailed spacing logic.
+									return;
+								}
 
-										double prev_y_center = *prev_el_concrete.position.y + *prev_el_concrete.position.height / 2.0;
-										double current_y_center = *current_el_concrete.position.y + *current_el_concrete.position.height / 2.0;
-										double y_diff = prev_y_center - current_y_center;
-
-										// Helper to determine a reasonable space threshold based on element properties
-										auto get_space_threshold = [](const auto& el) -> double {
-											double threshold_val = 2.0; // Default small threshold if other properties are missing
-											if constexpr (std::is_same_v<std::decay_t<decltype(el)>, document::text>) {
-												if (el.font_size && *el.font_size > 0) {
-													threshold_val = *el.font_size / 3.5; // Approx 1/3.5 of font size
-												} else if (el.position.height && *el.position.height > 0) {
-													threshold_val = *el.position.height / 3.0; // Approx 1/3 of height as fallback
-												}
-											} else if constexpr (std::is_same_v<std::decay_t<decltype(el)>, document::image>) {
-												if (el.position.height && *el.position.height > 0) {
-													threshold_val = *el.position.height / 4.0; // Heuristic for images
-												}
-											}
-											return std::max(1.0, threshold_val); // Ensure threshold is at least 1.0pt
-										};
-
-										auto get_effective_line_height = [](const auto& el) -> double {
-											double h = 10.0; // Default height
-											if constexpr (std::is_same_v<std::decay_t<decltype(el)>, document::text>) {
-												if (el.font_size && *el.font_size > 0) h = *el.font_size;
-												else if (el.position.height && *el.position.height > 0) h = *el.position.height;
-											} else if constexpr (std::is_same_v<std::decay_t<decltype(el)>, document::image>) {
-												if (el.position.height && *el.position.height > 0) h = *el.position.height;
-											}
-											return std::max(1.0, h); // Ensure at least 1.0
-										};
-
-										double prev_eff_h = get_effective_line_height(prev_el_concrete);
-										double curr_eff_h = get_effective_line_height(current_el_concrete);
-										double max_relevant_line_height = std::max(prev_eff_h, curr_eff_h);
-										
-										// Threshold for needing at least one newline
-										double single_newline_threshold = max_relevant_line_height * 0.65;
-
-										if (y_diff > single_newline_threshold) {
-											int num_newlines_to_emit = static_cast<int>(std::round(y_diff / max_relevant_line_height));
-											if (num_newlines_to_emit < 1) num_newlines_to_emit = 1;
-											for (int k = 0; k < num_newlines_to_emit; ++k) {
-												if (emit_message(document::break_line{}) == continuation::stop) { stop_processing = true; break; }
-											}
-										} else if (*current_el_concrete.position.x < *prev_el_concrete.position.x && std::abs(y_diff) < single_newline_threshold) {
-											if (emit_message(document::break_line{}) == continuation::stop) { stop_processing = true; }
-										} else if (std::holds_alternative<document::text>(*prev_element_variant) && std::holds_alternative<document::text>(element)) {
-											const auto& prev_text_el = std::get<document::text>(*prev_element_variant);
-											const auto& current_text_el = std::get<document::text>(element);
-											// Ensure necessary fields have values
-											if (!prev_text_el.position.x || !prev_text_el.position.width || !current_text_el.position.x) return;
-
-											double space_threshold = get_space_threshold(current_text_el); // Base threshold on current element
-											double x_gap = *current_text_el.position.x - (*prev_text_el.position.x + *prev_text_el.position.width);
-											if (x_gap > space_threshold &&
-												!ends_with_whitespace(prev_text_el.text) &&
-												!begins_with_whitespace(current_text_el.text)) {
-												if (emit_message(document::text{" "}) == continuation::stop) { stop_processing = true; }
-											}
-										} else if (prev_element_variant->index() != element.index() && std::abs(y_diff) < single_newline_threshold) {
-											// Different types (Text and Image) on the same visual line
-											// Ensure necessary fields have values
-											if (!prev_el_concrete.position.x || !prev_el_concrete.position.width ||
-												!current_el_concrete.position.x) {
-												return;
+								double prev_y_center = *prev_el_concrete.position.y + *prev_el_concrete.position.height / 2.0;
+								double current_y_center = *current_el_concrete.position.y + *current_el_concrete.position.height / 2.0;
+								double y_diff = prev_y_center - current_y_center;
+
+								// Helper to determine a reasonable space threshold based on element properties
+								auto get_space_threshold = [](const auto& el) -> double {
+									double threshold_val = 2.0; // Default small threshold if other properties are missing
+									if constexpr (std::is_same_v<std::decay_t<decltype(el)>, document::text>) {
+										if (el.font_size && *el.font_size > 0) {
+											threshold_val = *el.font_size / 3.5; // Approx 1/3.5 of font size
+										} else if (el.position.height && *el.position.height > 0) {
+											threshold_val = *el.position.height / 3.0; // Approx 1/3 of height as fallback
+										}
+									} else if constexpr (std::is_same_v<std::decay_t<decltype(el)>, document::image>) {
+										if (el.position.height && *el.position.height > 0) {
+											threshold_val = *el.position.height / 4.0; // Heuristic for images
+										}
+									}
+									return std::max(1.0, threshold_val); // Ensure threshold is at least 1.0pt
+								};
+
+								auto get_effective_line_height = [](const auto& el) -> double {
+									double h = 10.0; // Default height
+									if constexpr (std::is_same_v<std::decay_t<decltype(el)>, document::text>) {
+										if (el.font_size && *el.font_size > 0) h = *el.font_size;
+										else if (el.position.height && *el.position.height > 0) h = *el.position.height;
+									} else if constexpr (std::is_same_v<std::decay_t<decltype(el)>, document::image>) {
+										if (el.position.height && *el.position.height > 0) h = *el.position.height;
+									}
+									return std::max(1.0, h); // Ensure at least 1.0
+								};
+
+								double prev_eff_h = get_effective_line_height(prev_el_concrete);
+								double curr_eff_h = get_effective_line_height(current_el_concrete);
+								double max_relevant_line_height = std::max(prev_eff_h, curr_eff_h);
+								
+								// Threshold for needing at least one newline
+								double single_newline_threshold = max_relevant_line_height * 0.65;
+
+								if (y_diff > single_newline_threshold) {
+									int num_newlines_to_emit = static_cast<int>(std::round(y_diff / max_relevant_line_height));
+									if (num_newlines_to_emit < 1) num_newlines_to_emit = 1;
+									for (int k = 0; k < num_newlines_to_emit; ++k) {
+										if (emit_message(document::break_line{}) == continuation::stop) { stop_processing = true; break; }
+									}
+								} else if (*current_el_concrete.position.x < *prev_el_concrete.position.x && std::abs(y_diff) < single_newline_threshold) {
+									if (emit_message(document::break_line{}) == continuation::stop) { stop_processing = true; }
+								} else if (std::holds_alternative<document::text>(*prev_element_variant) && std::holds_alternative<document::text>(element)) {
+									const auto& prev_text_el = std::get<document::text>(*prev_element_variant);
+									const auto& current_text_el = std::get<document::text>(element);
+									// Ensure necessary fields have values
+									if (!prev_text_el.position.x || !prev_text_el.position.width || !current_text_el.position.x) return;
+
+									double space_threshold = get_space_threshold(current_text_el); // Base threshold on current element
+									double x_gap = *current_text_el.position.x - (*prev_text_el.position.x + *prev_text_el.position.width);
+									if (x_gap > space_threshold &&
+										!ends_with_whitespace(prev_text_el.text) &&
+										!begins_with_whitespace(current_text_el.text)) {
+										if (emit_message(document::text{" "}) == continuation::stop) { stop_processing = true; }
+									}
+								} else if (prev_element_variant->index() != element.index() && std::abs(y_diff) < single_newline_threshold) {
+									// Different types (Text and Image) on the same visual line
+									// Ensure necessary fields have values
+									if (!prev_el_concrete.position.x || !prev_el_concrete.position.width ||
+										!current_el_concrete.position.x) {
+										return;
+									}
+									// Use the threshold of the preceding element to decide if a space is needed
+									double space_threshold = get_space_threshold(prev_el_concrete);
+									double x_gap = *current_el_concrete.position.x - (*prev_el_concrete.position.x + *prev_el_concrete.position.width);
+									if (x_gap > space_threshold) {
+										bool add_space_flag = true;
+										// Check if previous element is Text and ends with space
+										if constexpr (std::is_same_v<std::decay_t<decltype(prev_el_concrete)>, document::text>) {
+											if (ends_with_whitespace(prev_el_concrete.text)) {
+												add_space_flag = false;
 											}
-											// Use the threshold of the preceding element to decide if a space is needed
-											double space_threshold = get_space_threshold(prev_el_concrete);
-											double x_gap = *current_el_concrete.position.x - (*prev_el_concrete.position.x + *prev_el_concrete.position.width);
-											if (x_gap > space_threshold) {
-												bool add_space_flag = true;
-												// Check if previous element is Text and ends with space
-												if constexpr (std::is_same_v<std::decay_t<decltype(prev_el_concrete)>, document::text>) {
-													if (ends_with_whitespace(prev_el_concrete.text)) {
-														add_space_flag = false;
-													}
-												}
-												// Check if current element is Text and begins with space (only if not already forbidden)
-												if (add_space_flag) {
-													if constexpr (std::is_same_v<std::decay_t<decltype(current_el_concrete)>, document::text>) {
-														if (begins_with_whitespace(current_el_concrete.text)) {
-															add_space_flag = false;
-														}
-													}
-												}
-												if (add_space_flag) {
-													if (emit_message(document::text{" "}) == continuation::stop) { stop_processing = true; }
+										}
+										// Check if current element is Text and begins with space (only if not already forbidden)
+										if (add_space_flag) {
+											if constexpr (std::is_same_v<std::decay_t<decltype(current_el_concrete)>, document::text>) {
+												if (begins_with_whitespace(current_el_concrete.text)) {
+													add_space_flag = false;
 												}
 											}
 										}
-									}, element
-								);
-							}, *prev_element_variant
+										if (add_space_flag) {
+											if (emit_message(document::text{" "}) == continuation::stop) { stop_processing = true; }
+										}
+									}
+								}
+							}, element
 						);
-						if (stop_processing) break;
-					}
+					}, *prev_element_variant
+				);
+				if (stop_processing) break;
+			}
 
-					try
+			try
+			{
+				std::visit([&](auto&& concrete_element) {
+					using T = std::decay_t<decltype(concrete_element)>;
+					if constexpr (std::is_same_v<T, document::image>)
 					{
-						std::visit([&](auto&& concrete_element) {
-							using T = std::decay_t<decltype(concrete_element)>;
-							if constexpr (std::is_same_v<T, document::image>)
-							{
-								if (emit_message_back(std::move(concrete_element)) == continuation::stop) stop_processing = true;
-							}
-							else
-							{
-								if (emit_message(std::move(concrete_element)) == continuation::stop) stop_processing = true;
-							}
-						}, page_element_variant{element}); // Copy to move from const multiset element
+						if (emit_message_back(std::move(concrete_element)) == continuation::stop) stop_processing = true;
 					}
-					catch (const std::exception&)
+					else
 					{
-						emit_message(errors::make_nested_ptr(std::current_exception(), make_error("Failed to emit element on page", page_num)));
+						if (emit_message(std::move(concrete_element)) == continuation::stop) stop_processing = true;
 					}
+				}, page_element_variant{element}); // Copy to move from const multiset element
+			}
+			catch (const std::exception&)
+			{
+				emit_message(errors::make_nested_ptr(std::current_exception(), make_error("Failed to emit element on page", page_num)));
+			}
+
+			if (stop_processing) break;
+			prev_element_variant = &element;
+		}
+		return stop_processing;
+	}
 
-					if (stop_processing) break;
-					prev_element_variant = &element;
+	void parseText()
+	{
+		log_scope(m_page_prefetch);
+		FPDF_DOCUMENT pdf_doc = pdf_document();
+		size_t page_count;
+		{
+			std::lock_guard<std::mutex> pdfium_mutex_lock(pdfium_mutex);
+			page_count = FPDF_GetPageCount(pdf_doc);
+		}
+		log_entry(page_count);
+		// Pages extracted ahead of the page being emitted. Futures returned by std::async wait on destruction,
+		// so all of them are finished before the document is closed.
+		std::map<size_t, std::future<extracted_page>> prefetched_pages;
+		size_t next_page_to_prefetch = 0;
+		for (size_t page_num = 0; page_num < page_count; page_num++)
+		{
+			log_scope(page_num);
+			auto response = emit_message(document::page{});
+			if (response == continuation::skip)
+			{
+				prefetched_pages.erase(page_num);
+				continue;
+			}
+			else if (response == continuation::stop)
+			{
+				break;
+			}
+			for (next_page_to_prefetch = std::max(next_page_to_prefetch, page_num + 1);
+				next_page_to_prefetch < page_count && next_page_to_prefetch <= page_num + m_page_prefetch;
+				next_page_to_prefetch++)
+			{
+				prefetched_pages.emplace(next_page_to_prefetch, std::async(std::launch::async, &extract_page, pdf_doc, next_page_to_prefetch));
+			}
+			try
+			{
+				extracted_page page;
+				if (auto it = prefetched_pages.find(page_num); it != prefetched_pages.end())
+				{
+					std::future<extracted_page> page_future = std::move(it->second);
+					prefetched_pages.erase(it);
+					page = page_future.get();
 				}
-				if (stop_processing) break;
+				else
+					page = extract_page(pdf_doc, page_num);
+				if (emit_page(page, page_num))
+					break;
 			}
 			catch (const std::exception& e)
 			{
@@ -642,7 +720,9 @@ struct pimpl_impl<pdf_parser> : pimpl_impl_base
 	void parse(const data_source& data, const message_callbacks& emit_message);
 };
 
-pdf_parser::pdf_parser() = default;
+pdf_parser::pdf_parser(pdf_page_prefetch page_prefetch)
+	: with_pimpl<pdf_parser>{page_prefetch}
+{}
 
 attributes::metadata pimpl_impl<pdf_parser>::metaData(const data_source& data)
 {
@@ -672,6 +752,15 @@ void pimpl_impl<pdf_parser>::parse(const data_source& data, const message_callba
 	emit_message(document::close_document{});
 }
 
+const std::vector<mime_type>& pdf_parser::supported_mime_types()
+{
+	static const std::vector<mime_type> mime_types =
+	{
+		mime_type{"application/pdf"}
+	};
+	return mime_types;
+}
+
 continuation pdf_parser::operator()(message_ptr msg, const message_callbacks& emit_message)
 {
 	if (!msg->is<data_source>())
@@ -680,7 +769,7 @@ continuation pdf_parser::operator()(message_ptr msg, const message_callbacks& em
 	auto& data = msg->get<data_source>();
 	data.assert_not_encrypted();
 
-	if (!data.has_highest_confidence_mime_type_in(supported_mime_types))
+	if (!data.has_highest_confidence_mime_type_in(supported_mime_types()))
 		return emit_message(std::move(msg));
 
 	try
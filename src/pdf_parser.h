@@ -16,9 +16,22 @@
 #include "pdf_export.h"
 #include "pimpl.h"
 #include "message.h"
+#include <vector>
 
 namespace docwire
 {
+
+struct mime_type;
+
+/**
+ * @brief Number of pages extracted in the background while the current page is being emitted.
+ *
+ * PDFium calls are still serialized, but loading the page objects and encoding embedded images overlap
+ * with processing of the previous pages by the rest of the chain. Pages are always emitted in order.
+ * 0 (the default) processes pages one by one on the calling thread.
+ */
+struct pdf_page_prefetch { size_t v; };
+
 class DOCWIRE_PDF_EXPORT pdf_parser : public chain_element, public with_pimpl<pdf_parser>
 {
 	private:
@@ -26,8 +39,10 @@ class DOCWIRE_PDF_EXPORT pdf_parser : public chain_element, public with_pimpl<pd
 		friend pimpl_impl<pdf_parser>;
 
 	public:
-		pdf_parser();
+		explicit pdf_parser(pdf_page_prefetch page_prefetch = {0});
 		continuation operator()(message_ptr msg, const message_callbacks& emit_message) override;
+		/// MIME types of the data sources parsed by this parser. Other data sources are passed on.
+		static const std::vector<mime_type>& supported_mime_types();
 		bool is_leaf() const override { return false; }
 };
 
@@ -0,0 +1,16 @@
+# perfect_hash_index builds its tables by constant evaluation. For indexes with
+# about a thousand keys this takes more steps than MSVC and Clang allow by default
+# (about 15M GCC constexpr ops for the file extension index), so raise the limits
+# only for the sources that instantiate one.
+function(docwire_perfect_hash_index_sources)
+	if(MSVC)
+		set(option "/constexpr:steps100000000")
+	elseif(CMAKE_CXX_COMPILER_ID MATCHES "Clang")
+		set(option "-fconstexpr-steps=100000000")
+	elseif(CMAKE_CXX_COMPILER_ID STREQUAL "GNU")
+		set(option "-fconstexpr-ops-limit=100000000")
+	else()
+		return()
+	endif()
+	set_property(SOURCE ${ARGN} DIRECTORY ${CMAKE_CURRENT_SOURCE_DIR} APPEND PROPERTY COMPILE_OPTIONS "${option}")
+endfunction()
@@ -0,0 +1,259 @@
+/*********************************************************************************************************************************************/
+/*  DocWire SDK: Award-winning modern data processing in C++20. SourceForge Community Choice & Microsoft support. AI-driven processing.      */
+/*  Supports nearly 100 data formats, including email boxes and OCR. Boost efficiency in text extraction, web data extraction, data mining,  */
+/*  document analysis. Offline processing possible for security and confidentiality                                                          */
+/*                                                                                                                                           */
+/*  Copyright (c) SILVERCODERS Ltd, http://silvercoders.com                                                                                  */
+/*  Project homepage: https://github.com/docwire/docwire                                                                                     */
+/*                                                                                                                                           */
+/*  SPDX-License-Identifier: AGPL-3.0-only OR LicenseRef-DocWire-Commercial                                                                  */
+/*********************************************************************************************************************************************/
+
+#ifndef DOCWIRE_PERFECT_HASH_INDEX_H
+#define DOCWIRE_PERFECT_HASH_INDEX_H
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <string_view>
+#include <type_traits>
+
+namespace docwire
+{
+
+/**
+ * @brief Minimal perfect hash index over a fixed list of strings, built at compile time.
+ *
+ * The index is built by the hash-and-displace method: keys are hashed once and spread into buckets, and every
+ * bucket gets a displacement that moves all of its keys to free slots. The number of slots equals the number of
+ * distinct keys. A lookup hashes the key once, reads one displacement and compares one key, so it does not
+ * allocate, and a constexpr index needs no static initialization at run time.
+ *
+ * The list can contain equal keys. find() returns the position of the first of them in the list and next()
+ * the positions of the following ones, in the order of the list.
+ *
+ * @code
+ * constexpr std::array<std::string_view, 3> keys { "a", "b", "a" };
+ * constexpr perfect_hash_index<3> key_index { keys };
+ * static_assert(key_index.find("a") == 0 && key_index.next(0) == 2 && key_index.find("c") == key_index.npos);
+ * @endcode
+ *
+ * @tparam N Length of the list of keys.
+ */
+template <size_t N>
+class perfect_hash_index
+{
+	static_assert(N > 0 && N < std::numeric_limits<uint16_t>::max(), "Number of keys must fit in 16 bits");
+
+public:
+	static constexpr size_t npos = std::numeric_limits<size_t>::max();
+
+	/**
+	 * @brief Builds the index. Characters of the keys are not copied, so they must outlive the index.
+	 */
+	consteval explicit perfect_hash_index(const std::array<std::string_view, N>& keys)
+		: m_keys(keys)
+	{
+		std::array<uint64_t, N> key_hashes{};
+		for (size_t i = 0; i < N; ++i)
+			key_hashes[i] = key_hash(m_keys[i]);
+		for (uint64_t seed = 0; seed < max_seeds; ++seed)
+			if (try_build(key_hashes, seed))
+				return;
+		throw "perfect_hash_index: no seed gives a perfect hash for the keys";
+	}
+
+	/// Returns the position of the first key equal to the given one or npos if there is none.
+	constexpr size_t find(std::string_view key) const
+	{
+		uint64_t h = seeded_hash(key_hash(key), m_seed);
+		size_t index = m_slots[slot(h, m_displacements[bucket(h)])];
+		return m_keys[index] == key ? index : npos;
+	}
+
+	/// Returns the position of the next key equal to the key at the given position or npos if there is none.
+	constexpr size_t next(size_t index) const
+	{
+		return m_next[index] == none ? npos : m_next[index];
+	}
+
+private:
+	static constexpr uint16_t none = std::numeric_limits<uint16_t>::max();
+	static constexpr size_t bucket_count = N / 2 + 1;
+	static constexpr uint64_t max_seeds = 1000;
+
+	// Little-endian 8-byte word. Constant evaluation cannot reinterpret bytes, so it combines them with shifts.
+	static constexpr uint64_t load_word(const char* p)
+	{
+		if constexpr (std::endian::native == std::endian::little)
+		{
+			if (!std::is_constant_evaluated())
+			{
+				uint64_t word;
+				std::memcpy(&word, p, sizeof(word));
+				return word;
+			}
+		}
+		uint64_t word = 0;
+		for (size_t i = 0; i < 8; ++i)
+			word |= uint64_t{static_cast<unsigned char>(p[i])} << (8 * i);
+		return word;
+	}
+
+	// FNV-1a over 8-byte words
+	static constexpr uint64_t key_hash(std::string_view key)
+	{
+		uint64_t h = 0xcbf29ce484222325 ^ key.size();
+		size_t pos = 0;
+		for (; pos + 8 <= key.size(); pos += 8)
+			h = (h ^ load_word(key.data() + pos)) * 0x100000001b3;
+		for (; pos < key.size(); ++pos)
+			h = (h ^ static_cast<unsigned char>(key[pos])) * 0x100000001b3;
+		return h;
+	}
+
+	static constexpr uint64_t seeded_hash(uint64_t h, uint64_t seed)
+	{
+		h ^= seed * 0x9e3779b97f4a7c15;
+		h ^= h >> 33; // MurmurHash3 finalizer, so that all bits depend on the seed
+		h *= 0xff51afd7ed558ccd;
+		h ^= h >> 33;
+		h *= 0xc4ceb9fe1a85ec53;
+		h ^= h >> 33;
+		return h;
+	}
+
+	// Ranges are reduced by multiplication instead of division: the high half of the hash selects the bucket
+	// and the low half the first slot.
+	static constexpr size_t bucket(uint64_t h)
+	{
+		return ((h >> 32) * bucket_count) >> 32;
+	}
+
+	constexpr size_t first_slot(uint64_t h) const
+	{
+		return ((h & 0xffffffff) * m_slot_count) >> 32;
+	}
+
+	constexpr size_t slot(uint64_t h, size_t displacement) const
+	{
+		size_t s = first_slot(h) + displacement;
+		return s < m_slot_count ? s : s - m_slot_count;
+	}
+
+	consteval bool try_build(const std::array<uint64_t, N>& key_hashes, uint64_t seed)
+	{
+		std::array<uint64_t, N> hashes{};
+		for (size_t i = 0; i < N; ++i)
+			hashes[i] = seeded_hash(key_hashes[i], seed);
+
+		// Keys sorted by bucket, keeping the order of the list within a bucket.
+		std::array<uint16_t, bucket_count + 1> bucket_begin{};
+		for (size_t i = 0; i < N; ++i)
+			++bucket_begin[bucket(hashes[i]) + 1];
+		for (size_t b = 0; b < bucket_count; ++b)
+			bucket_begin[b + 1] += bucket_begin[b];
+		std::array<uint16_t, N> bucket_keys{};
+		std::array<uint16_t, bucket_count> bucket_fill{};
+		for (size_t i = 0; i < N; ++i)
+		{
+			size_t b = bucket(hashes[i]);
+			bucket_keys[bucket_begin[b] + bucket_fill[b]++] = static_cast<uint16_t>(i);
+		}
+
+		// Equal keys have equal hashes, so they are in the same bucket. Only the first of them gets a slot.
+		std::array<bool, N> is_first{};
+		std::array<uint16_t, N> last_equal{};
+		std::array<uint16_t, bucket_count> first_keys_in_bucket{};
+		size_t first_key_count = 0;
+		m_next.fill(none);
+		for (size_t b = 0; b < bucket_count; ++b)
+		{
+			for (size_t k = bucket_begin[b]; k < bucket_begin[b + 1]; ++k)
+			{
+				size_t i = bucket_keys[k];
+				size_t first = i;
+				for (size_t j = bucket_begin[b]; j < k && first == i; ++j)
+					if (is_first[bucket_keys[j]] && m_keys[bucket_keys[j]] == m_keys[i])
+						first = bucket_keys[j];
+				if (first == i)
+				{
+					is_first[i] = true;
+					last_equal[i] = static_cast<uint16_t>(i);
+					++first_keys_in_bucket[b];
+					++first_key_count;
+				}
+				else
+				{
+					m_next[last_equal[first]] = static_cast<uint16_t>(i);
+					last_equal[first] = static_cast<uint16_t>(i);
+				}
+			}
+		}
+		m_slot_count = first_key_count;
+
+		// Keys of a bucket are moved by the same displacement, so they must start in different slots.
+		for (size_t b = 0; b < bucket_count; ++b)
+			for (size_t k = bucket_begin[b]; k < bucket_begin[b + 1]; ++k)
+				for (size_t j = bucket_begin[b]; j < k; ++j)
+					if (is_first[bucket_keys[k]] && is_first[bucket_keys[j]] &&
+						first_slot(hashes[bucket_keys[k]]) == first_slot(hashes[bucket_keys[j]]))
+						return false;
+
+		// Largest buckets are placed first, while most slots are free.
+		size_t max_bucket_size = 0;
+		for (size_t b = 0; b < bucket_count; ++b)
+			max_bucket_size = std::max<size_t>(max_bucket_size, first_keys_in_bucket[b]);
+		std::array<uint16_t, bucket_count> buckets_by_size{};
+		size_t placed_buckets = 0;
+		for (size_t size = max_bucket_size; size > 0; --size)
+			for (size_t b = 0; b < bucket_count; ++b)
+				if (first_keys_in_bucket[b] == size)
+					buckets_by_size[placed_buckets++] = static_cast<uint16_t>(b);
+
+		std::array<bool, N> occupied{};
+		m_displacements.fill(0);
+		for (size_t n = 0; n < placed_buckets; ++n)
+		{
+			size_t b = buckets_by_size[n];
+			size_t displacement = 0;
+			for (; displacement < m_slot_count; ++displacement)
+			{
+				bool fits = true;
+				for (size_t k = bucket_begin[b]; k < bucket_begin[b + 1] && fits; ++k)
+					if (is_first[bucket_keys[k]])
+						fits = !occupied[slot(hashes[bucket_keys[k]], displacement)];
+				if (fits)
+					break;
+			}
+			if (displacement == m_slot_count)
+				return false;
+			m_displacements[b] = static_cast<uint16_t>(displacement);
+			for (size_t k = bucket_begin[b]; k < bucket_begin[b + 1]; ++k)
+			{
+				size_t i = bucket_keys[k];
+				if (!is_first[i])
+					continue;
+				occupied[slot(hashes[i], displacement)] = true;
+				m_slots[slot(hashes[i], displacement)] = static_cast<uint16_t>(i);
+			}
+		}
+		m_seed = seed;
+		return true;
+	}
+
+	std::array<std::string_view, N> m_keys;
+	uint64_t m_seed = 0;
+	size_t m_slot_count = 0;
+	std::array<uint16_t, N> m_slots{};
+	std::array<uint16_t, bucket_count> m_displacements{};
+	std::array<uint16_t, N> m_next{};
+};
+
+} // namespace docwire
+
+#endif // DOCWIRE_PERFECT_HASH_INDEX_H
@@ -14,7 +14,7 @@
 #include <iomanip>
 #include <ctime>
 #include <sstream>
-#include <typeindex>
+#include <cstdint>
 
 #include "mail_elements.h"
 #include "document_elements.h"
@@ -120,41 +120,41 @@ template<>
 struct pimpl_impl<plain_text_writer> : pimpl_impl_base
 {
   using handler_func = std::function<std::shared_ptr<text_element>(const message_ptr&)>;
-  const boost::container::flat_map<std::type_index, handler_func> m_handlers;
+  const boost::container::flat_map<std::uint32_t, handler_func> m_handlers;
 
   pimpl_impl(const std::string& eol_sequence,
       std::function<std::string(const document::link&)> format_link_opening,
       std::function<std::string(const document::close_link&)> format_link_closing)
     : m_handlers{
-        {typeid(mail::mail), [this](const message_ptr& msg) { return write_mail(msg->get<mail::mail>()); }},
-        {typeid(mail::attachment), [this](const message_ptr& msg) { return write_attachment(msg->get<mail::attachment>()); }},
-        {typeid(mail::folder), [this](const message_ptr& msg) { return write_folder(msg->get<mail::folder>()); }},
-        {typeid(document::text), [this](const message_ptr& msg) { return write_text(msg->get<document::text>()); }},
-        {typeid(mail::close_mail_body), [this](const message_ptr& msg) { return write_close_mail_body(msg->get<mail::close_mail_body>()); }},
-        {typeid(mail::close_attachment), [this](const message_ptr& msg) { return write_close_attachment(msg->get<mail::close_attachment>()); }},
-        {typeid(document::break_line), [this](const message_ptr& msg) { return write_new_line(msg->get<document::break_line>()); }},
-        {typeid(document::close_paragraph), [this](const message_ptr& msg) { return write_new_paragraph(msg->get<document::close_paragraph>()); }},
-        {typeid(document::close_section), [this](const message_ptr& msg) { return write_new_paragraph(document::close_paragraph()); }},
-        {typeid(document::table), [this](const message_ptr& msg) { return turn_on_table_mode(msg->get<document::table>()); }},
-        {typeid(document::close_table), [this](const message_ptr& msg) { return turn_off_table_mode(msg->get<document::close_table>()); }},
-        {typeid(document::link), [this](const message_ptr& msg) { return std::make_shared<text_element>(m_format_link_opening(msg->get<document::link>())); }},
-        {typeid(document::close_link), [this](const message_ptr& msg) { return std::make_shared<text_element>(m_format_link_closing(msg->get<document::close_link>())); }},
-        {typeid(document::image), [this](const message_ptr& msg) { return write_image(msg->get<document::image>()); }},
-        {typeid(document::list), [this](const message_ptr& msg) { return write_list(msg->get<document::list>()); }},
-        {typeid(document::close_list), [this](const message_ptr& msg) { return write_close_list(msg->get<document::close_list>()); }},
-        {typeid(document::list_item), [this](const message_ptr& msg) { return write_list_item(msg->get<document::list_item>()); }},
-        {typeid(document::close_list_item), [this](const message_ptr& msg) { return write_close_list_item(msg->get<document::close_list_item>()); }},
-        {typeid(document::header), [this](const message_ptr& msg) { return write_header(msg->get<document::header>()); }},
-        {typeid(document::close_header), [this](const message_ptr& msg) { return write_close_header(msg->get<document::close_header>()); }},
-        {typeid(document::footer), [this](const message_ptr& msg) { return write_footer(msg->get<document::footer>()); }},
-        {typeid(document::close_footer), [this](const message_ptr& msg) { return write_close_footer(msg->get<document::close_footer>()); }},
-        {typeid(document::comment), [this](const message_ptr& msg) { return write_comment(msg->get<document::comment>()); }},
-        {typeid(document::close_page), [this](const message_ptr& msg) { return write_close_page(msg->get<document::close_page>()); }},
-        {typeid(document::document), [this](const message_ptr& msg) {
+        {message_type_id<mail::mail>(), [this](const message_ptr& msg) { return write_mail(msg->get<mail::mail>()); }},
+        {message_type_id<mail::attachment>(), [this](const message_ptr& msg) { return write_attachment(msg->get<mail::attachment>()); }},
+        {message_type_id<mail::folder>(), [this](const message_ptr& msg) { return write_folder(msg->get<mail::folder>()); }},
+        {message_type_id<document::text>(), [this](const message_ptr& msg) { return write_text(msg->get<document::text>()); }},
+        {message_type_id<mail::close_mail_body>(), [this](const message_ptr& msg) { return write_close_mail_body(msg->get<mail::close_mail_body>()); }},
+        {message_type_id<mail::close_attachment>(), [this](const message_ptr& msg) { return write_close_attachment(msg->get<mail::close_attachment>()); }},
+        {message_type_id<document::break_line>(), [this](const message_ptr& msg) { return write_new_line(msg->get<document::break_line>()); }},
+        {message_type_id<document::close_paragraph>(), [this](const message_ptr& msg) { return write_new_paragraph(msg->get<document::close_paragraph>()); }},
+        {message_type_id<document::close_section>(), [this](const message_ptr& msg) { return write_new_paragraph(document::close_paragraph()); }},
+        {message_type_id<document::table>(), [this](const message_ptr& msg) { return turn_on_table_mode(msg->get<document::table>()); }},
+        {message_type_id<document::close_table>(), [this](const message_ptr& msg) { return turn_off_table_mode(msg->get<document::close_table>()); }},
+        {message_type_id<document::link>(), [this](const message_ptr& msg) { return std::make_shared<text_element>(m_format_link_opening(msg->get<document::link>())); }},
+        {message_type_id<document::close_link>(), [this](const message_ptr& msg) { return std::make_shared<text_element>(m_format_link_closing(msg->get<document::close_link>())); }},
+        {message_type_id<document::image>(), [this](const message_ptr& msg) { return write_image(msg->get<document::image>()); }},
+        {message_type_id<document::list>(), [this](const message_ptr& msg) { return write_list(msg->get<document::list>()); }},
+        {message_type_id<document::close_list>(), [this](const message_ptr& msg) { return write_close_list(msg->get<document::close_list>()); }},
+        {message_type_id<document::list_item>(), [this](const message_ptr& msg) { return write_list_item(msg->get<document::list_item>()); }},
+        {message_type_id<document::close_list_item>(), [this](const message_ptr& msg) { return write_close_list_item(msg->get<document::close_list_item>()); }},
+        {message_type_id<document::header>(), [this](const message_ptr& msg) { return write_header(msg->get<document::header>()); }},
+        {message_type_id<document::close_header>(), [this](const message_ptr& msg) { return write_close_header(msg->get<document::close_header>()); }},
+        {message_type_id<document::footer>(), [this](const message_ptr& msg) { return write_footer(msg->get<document::footer>()); }},
+        {message_type_id<document::close_footer>(), [this](const message_ptr& msg) { return write_close_footer(msg->get<document::close_footer>()); }},
+        {message_type_id<document::comment>(), [this](const message_ptr& msg) { return write_comment(msg->get<document::comment>()); }},
+        {message_type_id<document::close_page>(), [this](const message_ptr& msg) { return write_close_page(msg->get<document::close_page>()); }},
+        {message_type_id<document::document>(), [this](const message_ptr& msg) {
             m_nested_docs_counter++;
             return std::shared_ptr<text_element>();
         }},
-        {typeid(document::close_document), [this](const message_ptr& msg) {
+        {message_type_id<document::close_document>(), [this](const message_ptr& msg) {
             m_nested_docs_counter--;
             return m_nested_docs_counter == 0 ? write_close_document(msg->get<document::close_document>()) : std::shared_ptr<text_element>();
         }},
@@ -578,7 +578,7 @@ struct pimpl_impl<plain_text_writer> : pimpl_impl_base
 
     if (level == 0)
     {
-      auto it = m_handlers.find(std::type_index(msg->object_type()));
+      auto it = m_handlers.find(msg->type_id());
       std::shared_ptr<text_element> text_element;
       if (it != m_handlers.end())
       {
@@ -11,6 +11,7 @@
 
 #include "ppt_parser.h"
 
+#include <algorithm>
 #include "document_elements.h"
 #include "error_tags.h"
 #include "log_entry.h"
@@ -19,6 +20,7 @@
 #include "misc.h"
 #include "nested_exception.h"
 #include "oshared.h"
+#include <optional>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -57,12 +59,12 @@ enum record_type
 namespace
 {
 
-	U16 getU16LittleEndian(std::vector<unsigned char>::const_iterator buffer)
+	U16 getU16LittleEndian(const unsigned char* buffer)
 	{
 		return (unsigned short int)(*buffer) | ((unsigned short int)(*(buffer + 1)) << 8);
 	}
 
-	U32 getU32LittleEndian(std::vector<unsigned char>::const_iterator buffer)
+	U32 getU32LittleEndian(const unsigned char* buffer)
 	{
 		return (unsigned long)(*buffer) | ((unsigned long)(*(buffer +1 )) << 8L) | ((unsigned long)(*(buffer + 2)) << 16L) | ((unsigned long)(*(buffer + 3)) << 24L);
 	}
@@ -76,26 +78,24 @@ namespace
 			case RT_TEXT_CHARS_ATOM: 
 			{ 
 				log_scope();
-				std::vector<unsigned char> buf(2);
 				unsigned long text_len = rec_len / 2;
 				if (text_len * 2 > reader.size() - reader.tell())
 				{
 					text_len = (reader.size() - reader.tell()) / 2;
 					non_fatal_error_handler(make_error_ptr("Read past EOF"));
 				}
-				for (int i = 0; i < text_len; i++)
+				std::vector<U8> buffer;
+				std::optional<std::span<const U8>> chars = reader.read_span(text_len * 2, buffer);
+				throw_if (!chars, reader.getLastError());
+				for (unsigned long i = 0; i < text_len; i++)
 				{
-					reader.read((uint8_t*)&*buf.begin(), 2);
-					U32 u = getU16LittleEndian(buf.begin());
+					U32 u = getU16LittleEndian(chars->data() + i * 2);
 					if (u == 0x0D || u == 0x0B)
 						text += '\n';
 					else
 					{
 						if (utf16_unichar_has_4_bytes(u) && ++i < text_len)
-						{
-							reader.read((uint8_t*)&*buf.begin(), 2);
-							u = (u << 16) | getU16LittleEndian(buf.begin());
-						}
+							u = (u << 16) | getU16LittleEndian(chars->data() + i * 2);
 						text += unichar_to_utf8(u);
 					}
 				}
@@ -157,18 +157,18 @@ namespace
 			case RT_TEXT_BYTES_ATOM:
 			{ 
 				log_scope();
-				std::vector<unsigned char> buf(2);
 				unsigned long text_len = rec_len;
-				buf[0] = buf[1] = 0;
 				if (text_len > reader.size() - reader.tell())
 				{
 					text_len = reader.size() - reader.tell();
 					non_fatal_error_handler(make_error_ptr("Read past EOF"));
 				}
-				for (int i = 0; i < text_len; i++)
+				std::vector<U8> buffer;
+				std::optional<std::span<const U8>> chars = reader.read_span(text_len, buffer);
+				throw_if (!chars, reader.getLastError());
+				for (U8 ch : *chars)
 				{
-					reader.read((uint8_t*)&*buf.begin(), 1);
-					U32 u = getU16LittleEndian(buf.begin());
+					U32 u = ch;
 					if (u == 0x0B || u == 0x0D)
 						text += '\n';
 					else
@@ -239,22 +239,24 @@ namespace
 	void parsePPT(thread_safe_ole_stream_reader& reader, std::string& text, const std::function<void(std::exception_ptr)>& non_fatal_error_handler)
 	{
 		log_scope();
-		std::vector<unsigned char> rec(8);
-		bool read_status = true;
+		std::vector<U8> buffer;
 		std::stack<long> container_ends;
-		while (read_status)
+		for (;;)
 		{
 			int pos = reader.tell();
-			read_status = reader.read(&*rec.begin(), 8);
-			if (rec.size() < 8)
+			std::optional<std::span<const U8>> header = reader.read_span(std::min<size_t>(8, reader.size() - pos), buffer);
+			// A stream that cannot be read further ends the document, like a truncated record does.
+			if (!header)
 				break;
 			if (oleEof(reader))
 			{
 				parseRecord(RT_END_DOCUMENT_ATOM, 0, reader, text, non_fatal_error_handler);
 				return;
 			}
-			int rec_type = getU16LittleEndian(rec.begin() + 2);
-			U32 rec_len = getU32LittleEndian(rec.begin() + 4);
+			if (header->size() < 8)
+				break;
+			int rec_type = getU16LittleEndian(header->data() + 2);
+			U32 rec_len = getU32LittleEndian(header->data() + 4);
 			U32 rec_end = pos + rec_len + 8 - 1;
 			log_entry(rec_type, rec_len, pos, rec_end);
 			container_ends.push(rec_end);
@@ -299,6 +301,7 @@ void parse(const data_source& data, const message_callbacks& emit_message)
 	try
 	{
 		std::unique_ptr<thread_safe_ole_storage> storage = std::make_unique<thread_safe_ole_storage>(data.span());
+		data.advise(access_pattern::random);
 		throw_if (!storage->isValid(), "Error opening stream as OLE container");
 		assertFileIsNotEncrypted(*storage);
 		emit_message(document::document
@@ -370,16 +373,20 @@ attributes::metadata metaData(const std::unique_ptr<thread_safe_ole_storage>& st
 		return meta;
 }
 
-const std::vector<mime_type> supported_mime_types =
-{
-	mime_type{"application/vnd.ms-powerpoint"},
-	mime_type{"application/vnd.ms-powerpoint.presentation.macroenabled.12"},
-	mime_type{"application/vnd.ms-powerpoint.template.macroenabled.12"},
-	mime_type{"application/vnd.ms-powerpoint.slideshow.macroenabled.12"}
-};
-
 } // anonymous namespace
 
+const std::vector<mime_type>& ppt_parser::supported_mime_types()
+{
+	static const std::vector<mime_type> mime_types =
+	{
+		mime_type{"application/vnd.ms-powerpoint"},
+		mime_type{"application/vnd.ms-powerpoint.presentation.macroenabled.12"},
+		mime_type{"application/vnd.ms-powerpoint.template.macroenabled.12"},
+		mime_type{"application/vnd.ms-powerpoint.slideshow.macroenabled.12"}
+	};
+	return mime_types;
+}
+
 continuation ppt_parser::operator()(message_ptr msg, const message_callbacks& emit_message)
 {
 	if (!msg->is<data_source>())
@@ -388,7 +395,7 @@ continuation ppt_parser::operator()(message_ptr msg, const message_callbacks& em
 	auto& data = msg->get<data_source>();
 	data.assert_not_encrypted();
 
-	if (!data.has_highest_confidence_mime_type_in(supported_mime_types))
+	if (!data.has_highest_confidence_mime_type_in(supported_mime_types()))
 		return emit_message(std::move(msg));
 
 	try
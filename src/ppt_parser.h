@@ -14,17 +14,21 @@
 
 #include "ole_office_formats_export.h"
 #include "chain_element.h"
+#include <vector>
 
 namespace docwire
 {
 
 class thread_safe_ole_storage;
+struct mime_type;
 
 class DOCWIRE_OLE_OFFICE_FORMATS_EXPORT ppt_parser : public chain_element
 {
 	public:
 		ppt_parser();
 		continuation operator()(message_ptr msg, const message_callbacks& emit_message) override;
+		/// MIME types of the data sources parsed by this parser. Other data sources are passed on.
+		static const std::vector<mime_type>& supported_mime_types();
 		bool is_leaf() const override { return false; }
 };
 
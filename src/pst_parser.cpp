@@ -17,9 +17,15 @@
 #include <iomanip>
 #include <ctime>
 
+#include <condition_variable>
+#include <map>
+#include <mutex>
 #include <optional>
 #include <iostream>
+#include <span>
 #include <stack>
+#include <thread>
+#include <variant>
 extern "C"
 {
 #define LIBPFF_HAVE_BFIO
@@ -330,6 +336,247 @@ struct context
 	const message_callbacks& emit_message;
 };
 
+// Message decoded by a worker thread, with the interface of pst_message. Every getter is called once,
+// so the content is moved out.
+class decoded_message
+{
+  public:
+	explicit decoded_message(pst_message& message)
+		: m_name{message.getName()},
+		  m_creation_date{message.getCreationDate()},
+		  m_html{message.getTextAsHtml()}
+	{
+		// Attachments that cannot be read do not make the whole mail fail, like in sequential parsing.
+		try
+		{
+			m_attachments = message.getAttachments();
+		}
+		catch (const std::exception&)
+		{
+			m_attachments_error = std::current_exception();
+		}
+	}
+
+	std::string getName() { return std::move(m_name); }
+	uint32_t getCreationDate() const { return m_creation_date; }
+	std::optional<std::string> getTextAsHtml() { return std::move(m_html); }
+
+	std::vector<raw_attachment> getAttachments()
+	{
+		if (m_attachments_error)
+			std::rethrow_exception(m_attachments_error);
+		return std::move(m_attachments);
+	}
+
+  private:
+	std::string m_name;
+	uint32_t m_creation_date;
+	std::optional<std::string> m_html;
+	std::vector<raw_attachment> m_attachments;
+	std::exception_ptr m_attachments_error;
+};
+
+struct listed_folder
+{
+	std::string name;
+	int level;
+	size_t close_entry; ///< Position of the matching listed_close_folder.
+};
+
+struct listed_close_folder {};
+
+struct listed_message
+{
+	size_t message; ///< Position in pst_listing::messages.
+	int level;
+};
+
+struct message_location
+{
+	size_t folder; ///< Position in pst_listing::folder_paths.
+	int index;
+};
+
+// Folder tree in the order of emitting, read before messages are decoded.
+struct pst_listing
+{
+	std::vector<std::variant<listed_folder, listed_close_folder, listed_message>> entries;
+	std::vector<message_location> messages;
+	std::vector<std::vector<int>> folder_paths; ///< Sub-folder indexes leading from the root folder.
+};
+
+void list_folder(const folder& parent, int deep, std::vector<int>& path, pst_listing& listing)
+{
+	for (int i = 0; i < parent.getSubFolderNumber(); ++i)
+	{
+		auto sub_folder = parent.getSubFolder(i);
+		size_t folder_entry = listing.entries.size();
+		listing.entries.push_back(listed_folder{.name = sub_folder.getName(), .level = deep});
+		path.push_back(i);
+		list_folder(sub_folder, deep + 1, path, listing);
+		path.pop_back();
+		std::get<listed_folder>(listing.entries[folder_entry]).close_entry = listing.entries.size();
+		listing.entries.push_back(listed_close_folder{});
+	}
+	int message_count = parent.getMessageNumber();
+	if (message_count <= 0)
+		return;
+	listing.folder_paths.push_back(path);
+	for (int i = 0; i < message_count; ++i)
+	{
+		listing.entries.push_back(listed_message{.message = listing.messages.size(), .level = deep});
+		listing.messages.push_back(message_location{.folder = listing.folder_paths.size() - 1, .index = i});
+	}
+}
+
+// PST file opened from memory. Members are declared in the order they are opened, so they are closed in reverse.
+struct pst_file
+{
+	bfio_handle handle;
+	pff_file file;
+	std::optional<folder> root;
+};
+
+pst_file open_pst_file(std::span<const std::byte> data)
+{
+	log_scope(data.size());
+	pst_file pst;
+	bfio_error bfio_err;
+	throw_if (libbfio_memory_range_initialize(&pst.handle, &bfio_err) != 1, "libbfio_memory_range_initialize failed");
+	// libbfio does not write to the range of a handle opened for reading.
+	throw_if (libbfio_memory_range_set(pst.handle,
+		reinterpret_cast<uint8_t*>(const_cast<std::byte*>(data.data())), data.size(), &bfio_err) != 1,
+		"libbfio_memory_range_set failed");
+	throw_if (libbfio_handle_open(pst.handle, LIBBFIO_OPEN_READ, &bfio_err) != 1, "libbfio_handle_open failed");
+	pff_error error;
+	throw_if (libpff_file_initialize(&pst.file, &error) != 1, "libpff_file_initialize failed");
+	throw_if (libpff_file_open_file_io_handle(pst.file, pst.handle, LIBBFIO_OPEN_READ, &error) != 1, "libpff_file_open_file_io_handle failed");
+	pff_item root = nullptr;
+	throw_if (libpff_file_get_root_folder(pst.file, &root, &error) != 1, "libpff_file_get_root_folder failed");
+	pst.root.emplace(std::move(root));
+	return pst;
+}
+
+/**
+ * Threads decoding listed messages in order. Every thread opens the file on its own, because libpff handles
+ * cannot be shared between threads. Threads do not start a message more than `window` messages ahead of
+ * the one requested last, so only a bounded number of decoded messages is kept in memory.
+ */
+class message_decoder_pool
+{
+  public:
+	message_decoder_pool(std::span<const std::byte> data, const pst_listing& listing, size_t worker_count)
+		: m_data{data}, m_listing{listing}, m_window{2 * worker_count}
+	{
+		for (size_t i = 0; i < worker_count; ++i)
+			m_workers.emplace_back([this](std::stop_token stop) { work(stop); });
+	}
+
+	decoded_message get(size_t message)
+	{
+		std::unique_lock<std::mutex> lock{m_mutex};
+		m_requested = message;
+		m_next_to_decode = std::max(m_next_to_decode, message);
+		std::erase_if(m_decoded, [message](const auto& decoded) { return decoded.first < message; });
+		m_changed.notify_all();
+		m_changed.wait(lock, [&]() { return m_decoded.contains(message); });
+		auto decoded = m_decoded.extract(message);
+		lock.unlock();
+		if (decoded.mapped().error)
+			std::rethrow_exception(decoded.mapped().error);
+		return std::move(*decoded.mapped().message);
+	}
+
+  private:
+	struct decoding_result
+	{
+		std::optional<decoded_message> message;
+		std::exception_ptr error;
+	};
+
+	// State of one worker thread.
+	class decoder
+	{
+	  public:
+		decoder(std::span<const std::byte> data, const pst_listing& listing)
+			: m_pst{open_pst_file(data)}, m_listing{listing}
+		{}
+
+		decoded_message decode(const message_location& location)
+		{
+			log_scope(location.folder, location.index);
+			pst_message message = message_folder(location.folder).getMessage(location.index);
+			return decoded_message{message};
+		}
+
+	  private:
+		// Messages are decoded in the order of folders, so the last folder is kept open.
+		const folder& message_folder(size_t folder_id)
+		{
+			if (folder_id != m_folder_id)
+			{
+				m_folder.reset();
+				for (int index : m_listing.folder_paths[folder_id])
+					m_folder.emplace((m_folder ? *m_folder : *m_pst.root).getSubFolder(index));
+				m_folder_id = folder_id;
+			}
+			return m_folder ? *m_folder : *m_pst.root;
+		}
+
+		pst_file m_pst;
+		const pst_listing& m_listing;
+		std::optional<folder> m_folder;
+		size_t m_folder_id = std::numeric_limits<size_t>::max();
+	};
+
+	void work(std::stop_token stop)
+	{
+		std::optional<decoder> worker_decoder;
+		std::exception_ptr open_error;
+		try
+		{
+			worker_decoder.emplace(m_data, m_listing);
+		}
+		catch (const std::exception&)
+		{
+			open_error = std::current_exception();
+		}
+		std::unique_lock<std::mutex> lock{m_mutex};
+		while (m_changed.wait(lock, stop, [this]()
+				{ return m_next_to_decode < m_listing.messages.size() && m_next_to_decode < m_requested + m_window; }) &&
+			!stop.stop_requested())
+		{
+			size_t message = m_next_to_decode++;
+			lock.unlock();
+			decoding_result result;
+			try
+			{
+				if (open_error)
+					std::rethrow_exception(open_error);
+				result.message.emplace(worker_decoder->decode(m_listing.messages[message]));
+			}
+			catch (const std::exception&)
+			{
+				result.error = std::current_exception();
+			}
+			lock.lock();
+			if (message >= m_requested)
+				m_decoded.emplace(message, std::move(result));
+			m_changed.notify_all();
+		}
+	}
+
+	std::span<const std::byte> m_data;
+	const pst_listing& m_listing;
+	size_t m_window;
+	std::mutex m_mutex;
+	std::condition_variable_any m_changed;
+	size_t m_next_to_decode = 0;
+	size_t m_requested = 0;
+	std::map<size_t, decoding_result> m_decoded;
+	std::vector<std::jthread> m_workers; // Declared last, so the threads are stopped and joined first.
+};
+
 const std::vector<mime_type> supported_mime_types =
 {
 	mime_type{"application/vnd.ms-outlook-pst"},
@@ -341,6 +588,11 @@ const std::vector<mime_type> supported_mime_types =
 template<>
 struct pimpl_impl<pst_parser> : pimpl_impl_base
 {
+	explicit pimpl_impl(pst_worker_count worker_count)
+		: m_worker_count{worker_count.v}
+	{}
+
+	size_t m_worker_count;
 	std::stack<context> m_context_stack;
 
 	template <typename T>
@@ -356,10 +608,15 @@ struct pimpl_impl<pst_parser> : pimpl_impl_base
 	}
 
 	void parse(std::shared_ptr<std::istream> stream) const;
+	void parse_in_parallel(std::span<const std::byte> data) const;
 
   private:
     void parse_element(const char* buffer, size_t size, const std::string& extension="") const;
     void parse_internal(const folder& root, int deep, unsigned int &mail_counter) const;
+    void emit_listing(const pst_listing& listing, message_decoder_pool& decoders, unsigned int &mail_counter) const;
+
+    template <typename Message>
+    void emit_mail(Message& message, int index, int deep, unsigned int &mail_counter) const;
 };
 
 void pimpl_impl<pst_parser>::parse_internal(const folder& root, int deep, unsigned int &mail_counter) const
@@ -379,14 +636,34 @@ void pimpl_impl<pst_parser>::parse_internal(const folder& root, int deep, unsign
 	for (int i = 0; i < root.getMessageNumber(); ++i)
 	{
 		auto message = root.getMessage(i);
+		emit_mail(message, i, deep, mail_counter);
+	}
+}
 
-    auto html_text = message.getTextAsHtml();
+// Failures are reported as non-fatal errors of the mail, the same way with and without worker threads:
+// a mail that cannot be read is skipped, and attachments that cannot be read are left out of the mail.
+template <typename Message>
+void pimpl_impl<pst_parser>::emit_mail(Message& message, int index, int deep, unsigned int &mail_counter) const
+{
+    std::optional<std::string> html_text;
+    std::optional<mail::mail> mail_element;
+    try
+    {
+      html_text = message.getTextAsHtml();
+      if (html_text)
+        mail_element = mail::mail{.subject = message.getName(), .date = message.getCreationDate(), .level = deep};
+    }
+    catch (const std::exception&)
+    {
+      emit_message(errors::make_nested_ptr(std::current_exception(), make_error("Failed to decode mail", index)));
+      return;
+    }
     if(html_text)
     {
-      auto result = emit_message(mail::mail{.subject = message.getName(), .date = message.getCreationDate(), .level = deep});
+      auto result = emit_message(std::move(*mail_element));
       if (result == continuation::skip)
       {
-        continue;
+        return;
       }
       emit_message(mail::mail_body{});
       try
@@ -401,7 +678,15 @@ void pimpl_impl<pst_parser>::parse_internal(const folder& root, int deep, unsign
       emit_message(mail::close_mail_body{});
     }
 
-		auto attachments = message.getAttachments();
+    std::vector<raw_attachment> attachments;
+    try
+    {
+      attachments = message.getAttachments();
+    }
+    catch (const std::exception&)
+    {
+      emit_message(errors::make_nested_ptr(std::current_exception(), make_error("Failed to read attachments", index)));
+    }
     for (auto &attachment : attachments)
     {
       file_extension extension { std::filesystem::path{attachment.m_name} };
@@ -422,6 +707,40 @@ void pimpl_impl<pst_parser>::parse_internal(const folder& root, int deep, unsign
       emit_message(mail::close_attachment{});
     }
 	emit_message(mail::close_mail{});
+}
+
+void pimpl_impl<pst_parser>::emit_listing(const pst_listing& listing, message_decoder_pool& decoders, unsigned int &mail_counter) const
+{
+	log_scope(listing.entries.size(), listing.messages.size());
+	for (size_t i = 0; i < listing.entries.size(); ++i)
+	{
+		const auto& entry = listing.entries[i];
+		if (const auto* listed = std::get_if<listed_folder>(&entry))
+		{
+			auto result = emit_message(mail::folder{.name = listed->name, .level = listed->level});
+			if (result == continuation::skip)
+				i = listed->close_entry;
+		}
+		else if (std::holds_alternative<listed_close_folder>(entry))
+		{
+			emit_message(mail::close_folder{});
+		}
+		else
+		{
+			const auto& listed = std::get<listed_message>(entry);
+			const int index = listing.messages[listed.message].index;
+			std::optional<decoded_message> message;
+			try
+			{
+				message.emplace(decoders.get(listed.message));
+			}
+			catch (const std::exception&)
+			{
+				emit_message(errors::make_nested_ptr(std::current_exception(), make_error("Failed to decode mail", index)));
+				continue;
+			}
+			emit_mail(*message, index, listed.level, mail_counter);
+		}
 	}
 }
 
@@ -508,7 +827,27 @@ void pimpl_impl<pst_parser>::parse(std::shared_ptr<std::istream> stream) const
 	emit_message(document::close_document{});
 }
 
-pst_parser::pst_parser() = default;
+void pimpl_impl<pst_parser>::parse_in_parallel(std::span<const std::byte> data) const
+{
+	log_scope(m_worker_count);
+	pst_listing listing;
+	{
+		pst_file pst = open_pst_file(data);
+		std::vector<int> path;
+		list_folder(*pst.root, 0, path, listing);
+	}
+	unsigned int mail_counter = 0;
+	emit_message(document::document{.metadata = []() { return attributes::metadata{}; }});
+	{
+		message_decoder_pool decoders{data, listing, m_worker_count};
+		emit_listing(listing, decoders, mail_counter);
+	}
+	emit_message(document::close_document{});
+}
+
+pst_parser::pst_parser(pst_worker_count worker_count)
+	: with_pimpl<pst_parser>{worker_count}
+{}
 
 continuation pst_parser::operator()(message_ptr msg, const message_callbacks& emit_message)
 {
@@ -526,11 +865,16 @@ continuation pst_parser::operator()(message_ptr msg, const message_callbacks& em
     log_entry();
     try
     {
-        std::shared_ptr<std::istream> stream = data.istream();
         message_counters counters;
         auto counting_callbacks = make_counted_message_callbacks(emit_message, counters);
         scoped::stack_push<context> context_guard{impl().m_context_stack, context{counting_callbacks}};
-        impl().parse(stream);
+        if (impl().m_worker_count > 0)
+        {
+            data.advise(access_pattern::random);
+            impl().parse_in_parallel(data.span());
+        }
+        else
+            impl().parse(data.istream());
         if (counters.all_failed())
             throw make_error("No items were successfully processed", errors::uninterpretable_data{});
     }
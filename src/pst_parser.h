@@ -21,6 +21,17 @@
 namespace docwire
 {
 
+/**
+ * @brief Number of threads decoding messages and attachments.
+ *
+ * The folder tree is listed first, then messages are decoded by a pool of workers, each with its own libpff handle
+ * on the memory-mapped file, while the calling thread emits them. Folders and messages are emitted in the same
+ * order as by sequential parsing. At most two messages per worker are decoded ahead of the message being emitted,
+ * so memory use is bounded by the size of the largest messages.
+ * 0 (the default) decodes messages one by one on the calling thread.
+ */
+struct pst_worker_count { size_t v; };
+
 class DOCWIRE_MAIL_EXPORT pst_parser : public chain_element, public with_pimpl<pst_parser>
 {
 private:
@@ -28,7 +39,7 @@ private:
   friend pimpl_impl<pst_parser>;
 
 public:
-  pst_parser();
+  explicit pst_parser(pst_worker_count worker_count = {0});
   continuation operator()(message_ptr msg, const message_callbacks& emit_message) override;
   bool is_leaf() const override { return false; }
 };
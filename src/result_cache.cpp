@@ -0,0 +1,901 @@
+/*********************************************************************************************************************************************/
+/*  DocWire SDK: Award-winning modern data processing in C++20. SourceForge Community Choice & Microsoft support. AI-driven processing.      */
+/*  Supports nearly 100 data formats, including email boxes and OCR. Boost efficiency in text extraction, web data extraction, data mining,  */
+/*  document analysis. Offline processing possible for security and confidentiality                                                          */
+/*                                                                                                                                           */
+/*  Copyright (c) SILVERCODERS Ltd, http://silvercoders.com                                                                                  */
+/*  Project homepage: https://github.com/docwire/docwire                                                                                     */
+/*                                                                                                                                           */
+/*  SPDX-License-Identifier: AGPL-3.0-only OR LicenseRef-DocWire-Commercial                                                                  */
+/*********************************************************************************************************************************************/
+
+#include "result_cache.h"
+
+#include <algorithm>
+#include <array>
+#include <concepts>
+#include <cstring>
+#include "document_elements.h"
+#include "error_tags.h"
+#include <fstream>
+#include "log_entry.h"
+#include "log_scope.h"
+#include <memory>
+#include <openssl/evp.h>
+#include <random>
+#include "serialization_data_source.h" // IWYU pragma: keep
+#include "serialization_filesystem.h" // IWYU pragma: keep
+#include "serialization_message.h" // IWYU pragma: keep
+#include "throw_if.h"
+#include <tuple>
+#include <unordered_map>
+#include "version.h"
+
+namespace docwire
+{
+
+namespace
+{
+
+constexpr std::string_view entry_extension = ".dwcache";
+constexpr std::string_view entry_magic = "DWRC";
+constexpr std::uint64_t format_version = 3;
+// Set in the element tag of messages the cached element sent back instead of forward.
+constexpr std::uint8_t back_direction_flag = 0x80;
+
+using sha256_digest = std::array<std::uint8_t, 32>;
+
+// Entries are addressed by content, so the hash must be collision resistant: otherwise a crafted document
+// could take over the entry of another one.
+class sha256
+{
+public:
+	sha256() : m_context{EVP_MD_CTX_new(), EVP_MD_CTX_free}
+	{
+		throw_if(!m_context || EVP_DigestInit_ex(m_context.get(), EVP_sha256(), nullptr) != 1, "Could not initialize SHA-256");
+	}
+
+	sha256& update(std::span<const std::byte> data)
+	{
+		throw_if(EVP_DigestUpdate(m_context.get(), data.data(), data.size()) != 1, "Could not compute SHA-256");
+		return *this;
+	}
+
+	sha256& update(std::string_view data)
+	{
+		return update(std::as_bytes(std::span{data.data(), data.size()}));
+	}
+
+	// Prefixed with the size, so consecutive fields cannot be shifted into each other.
+	sha256& update_field(std::string_view data)
+	{
+		std::uint64_t size = data.size();
+		return update(std::as_bytes(std::span{&size, 1})).update(data);
+	}
+
+	sha256_digest final()
+	{
+		sha256_digest digest;
+		throw_if(EVP_DigestFinal_ex(m_context.get(), digest.data(), nullptr) != 1, "Could not compute SHA-256");
+		return digest;
+	}
+
+private:
+	std::unique_ptr<EVP_MD_CTX, decltype(&EVP_MD_CTX_free)> m_context;
+};
+
+std::string_view as_string_view(const sha256_digest& digest)
+{
+	return std::string_view{reinterpret_cast<const char*>(digest.data()), digest.size()};
+}
+
+class record_writer
+{
+public:
+	void u8(std::uint8_t v) { m_data.push_back(static_cast<char>(v)); }
+
+	void varint(std::uint64_t v)
+	{
+		while (v >= 0x80)
+		{
+			u8(static_cast<std::uint8_t>(v) | 0x80);
+			v >>= 7;
+		}
+		u8(static_cast<std::uint8_t>(v));
+	}
+
+	void i64(std::int64_t v) { varint((static_cast<std::uint64_t>(v) << 1) ^ static_cast<std::uint64_t>(v >> 63)); }
+
+	void f64(double v)
+	{
+		char bytes[sizeof(double)];
+		std::memcpy(bytes, &v, sizeof(double));
+		m_data.append(bytes, sizeof(double));
+	}
+
+	void raw(std::string_view v) { m_data.append(v); }
+
+	void string(std::string_view v)
+	{
+		varint(v.size());
+		m_data.append(v);
+	}
+
+	void bytes(std::span<const std::byte> v) { string(std::string_view{reinterpret_cast<const char*>(v.data()), v.size()}); }
+
+	std::string& data() { return m_data; }
+
+private:
+	std::string m_data;
+};
+
+class record_reader
+{
+public:
+	explicit record_reader(std::string_view data) : m_data{data} {}
+
+	std::uint8_t u8() { return static_cast<std::uint8_t>(take(1)[0]); }
+
+	std::uint64_t varint()
+	{
+		std::uint64_t v = 0;
+		for (int shift = 0; ; shift += 7)
+		{
+			throw_if(shift > 63, "Invalid number in cache entry", errors::uninterpretable_data{});
+			std::uint8_t byte = u8();
+			v |= std::uint64_t{byte & 0x7fu} << shift;
+			if (!(byte & 0x80))
+				return v;
+		}
+	}
+
+	std::int64_t i64()
+	{
+		std::uint64_t v = varint();
+		return static_cast<std::int64_t>(v >> 1) ^ -static_cast<std::int64_t>(v & 1);
+	}
+
+	double f64()
+	{
+		double v;
+		std::memcpy(&v, take(sizeof(double)).data(), sizeof(double));
+		return v;
+	}
+
+	std::string_view take(std::uint64_t size)
+	{
+		throw_if(size > m_data.size() - m_position, "Truncated cache entry", errors::uninterpretable_data{});
+		std::string_view v = m_data.substr(m_position, size);
+		m_position += size;
+		return v;
+	}
+
+	// Number of following items. Every item takes at least one byte, so larger counts come from corrupt entries.
+	size_t count()
+	{
+		std::uint64_t v = varint();
+		throw_if(v > m_data.size() - m_position, "Invalid item count in cache entry", errors::uninterpretable_data{});
+		return static_cast<size_t>(v);
+	}
+
+	std::string string() { return std::string{take(varint())}; }
+
+	std::vector<std::byte> bytes()
+	{
+		std::string_view v = take(varint());
+		const std::byte* begin = reinterpret_cast<const std::byte*>(v.data());
+		return std::vector<std::byte>{begin, begin + v.size()};
+	}
+
+	bool at_end() const { return m_position == m_data.size(); }
+
+private:
+	std::string_view m_data;
+	size_t m_position = 0;
+};
+
+// Field codecs
+
+void write(record_writer& w, const std::string& v) { w.string(v); }
+void write(record_writer& w, double v) { w.f64(v); }
+template <std::unsigned_integral T>
+void write(record_writer& w, T v) { w.varint(v); }
+void write(record_writer& w, std::chrono::sys_seconds v) { w.i64(v.time_since_epoch().count()); }
+
+template <typename T>
+void write(record_writer& w, const std::optional<T>& v)
+{
+	w.u8(v.has_value());
+	if (v)
+		write(w, *v);
+}
+
+void write(record_writer& w, const attributes::styling& v)
+{
+	w.varint(v.classes.size());
+	for (const std::string& class_name : v.classes)
+		write(w, class_name);
+	write(w, v.id);
+	write(w, v.style);
+}
+
+void write(record_writer& w, const attributes::position& v)
+{
+	write(w, v.x);
+	write(w, v.y);
+	write(w, v.width);
+	write(w, v.height);
+}
+
+void write(record_writer& w, const attributes::email& v)
+{
+	write(w, v.from);
+	write(w, v.date);
+	write(w, v.to);
+	write(w, v.subject);
+	write(w, v.reply_to);
+	write(w, v.sender);
+}
+
+void write(record_writer& w, const attributes::metadata& v)
+{
+	write(w, v.author);
+	write(w, v.creation_date);
+	write(w, v.last_modified_by);
+	write(w, v.last_modification_date);
+	write(w, v.page_count);
+	write(w, v.word_count);
+	write(w, v.email_attrs);
+}
+
+void write(record_writer& w, const data_source& v)
+{
+	w.bytes(v.span());
+	w.varint(v.mime_types.size());
+	for (const auto& [mt, mt_confidence] : v.mime_types)
+	{
+		w.string(mt.v);
+		w.u8(static_cast<std::uint8_t>(mt_confidence));
+	}
+}
+
+void read(record_reader& r, std::string& v) { v = r.string(); }
+void read(record_reader& r, double& v) { v = r.f64(); }
+template <std::unsigned_integral T>
+void read(record_reader& r, T& v) { v = static_cast<T>(r.varint()); }
+void read(record_reader& r, std::chrono::sys_seconds& v) { v = std::chrono::sys_seconds{std::chrono::seconds{r.i64()}}; }
+
+template <typename T>
+void read(record_reader& r, std::optional<T>& v)
+{
+	if (r.u8())
+		read(r, v.emplace());
+	else
+		v.reset();
+}
+
+void read(record_reader& r, attributes::styling& v)
+{
+	v.classes.resize(r.count());
+	for (std::string& class_name : v.classes)
+		read(r, class_name);
+	read(r, v.id);
+	read(r, v.style);
+}
+
+void read(record_reader& r, attributes::position& v)
+{
+	read(r, v.x);
+	read(r, v.y);
+	read(r, v.width);
+	read(r, v.height);
+}
+
+void read(record_reader& r, attributes::email& v)
+{
+	read(r, v.from);
+	read(r, v.date);
+	read(r, v.to);
+	read(r, v.subject);
+	read(r, v.reply_to);
+	read(r, v.sender);
+}
+
+void read(record_reader& r, attributes::metadata& v)
+{
+	read(r, v.author);
+	read(r, v.creation_date);
+	read(r, v.last_modified_by);
+	read(r, v.last_modification_date);
+	read(r, v.page_count);
+	read(r, v.word_count);
+	read(r, v.email_attrs);
+}
+
+data_source read_data_source(record_reader& r)
+{
+	data_source v{r.bytes()};
+	for (size_t i = r.count(); i > 0; --i)
+	{
+		mime_type mt{r.string()};
+		std::uint8_t mt_confidence = r.u8();
+		throw_if(mt_confidence > static_cast<std::uint8_t>(confidence::highest), "Invalid confidence in cache entry", errors::uninterpretable_data{});
+		v.add_mime_type(mt, static_cast<confidence>(mt_confidence));
+	}
+	return v;
+}
+
+// Element codecs. The position of a type in cached_elements is its tag in the cache entry, so new types are appended.
+
+using cached_elements = std::tuple<
+	data_source,
+	document::document, document::close_document,
+	document::page, document::close_page,
+	document::paragraph, document::close_paragraph,
+	document::section, document::close_section,
+	document::span, document::close_span,
+	document::break_line,
+	document::bold, document::close_bold,
+	document::italic, document::close_italic,
+	document::underline, document::close_underline,
+	document::table, document::close_table,
+	document::table_row, document::close_table_row,
+	document::table_cell, document::close_table_cell,
+	document::caption, document::close_caption,
+	document::text,
+	document::link, document::close_link,
+	document::image,
+	document::style,
+	document::list, document::close_list,
+	document::list_item, document::close_list_item,
+	document::header, document::close_header,
+	document::footer, document::close_footer,
+	document::comment>;
+
+template <typename T, typename... Ts>
+constexpr bool is_one_of = (std::is_same_v<T, Ts> || ...);
+
+// +1 for elements opening a range closed by another element, -1 for closing elements.
+template <typename T>
+constexpr int nesting_delta()
+{
+	if constexpr (is_one_of<T, document::document, document::page, document::paragraph, document::section, document::span,
+			document::bold, document::italic, document::underline, document::table, document::table_row, document::table_cell,
+			document::caption, document::link, document::list, document::list_item, document::header, document::footer>)
+		return 1;
+	else if constexpr (is_one_of<T, document::close_document, document::close_page, document::close_paragraph, document::close_section,
+			document::close_span, document::close_bold, document::close_italic, document::close_underline, document::close_table,
+			document::close_table_row, document::close_table_cell, document::close_caption, document::close_link, document::close_list,
+			document::close_list_item, document::close_header, document::close_footer>)
+		return -1;
+	else
+		return 0;
+}
+
+// Returns false if the element cannot be stored.
+template <typename T>
+bool encode(record_writer& w, const T& element)
+{
+	if constexpr (std::is_empty_v<T>)
+		return true;
+	else if constexpr (std::is_same_v<T, data_source>)
+		write(w, element);
+	else if constexpr (std::is_same_v<T, document::document>)
+		write(w, element.metadata());
+	else if constexpr (std::is_same_v<T, document::text>)
+	{
+		write(w, element.text);
+		write(w, element.position);
+		write(w, element.font_size);
+	}
+	else if constexpr (std::is_same_v<T, document::link>)
+	{
+		write(w, element.url);
+		write(w, element.styling);
+	}
+	else if constexpr (std::is_same_v<T, document::image>)
+	{
+		// Content recognized on demand (for example by OCR) cannot be replayed without running the recognizer.
+		if (element.structured_content_streamer)
+			return false;
+		write(w, element.source);
+		write(w, element.alt);
+		write(w, element.position);
+		write(w, element.styling);
+	}
+	else if constexpr (std::is_same_v<T, document::style>)
+		write(w, element.css_text);
+	else if constexpr (std::is_same_v<T, document::list>)
+	{
+		write(w, element.type);
+		write(w, element.styling);
+	}
+	else if constexpr (std::is_same_v<T, document::comment>)
+	{
+		write(w, element.author);
+		write(w, element.time);
+		write(w, element.comment);
+	}
+	else
+	{
+		static_assert(attributes::WithStyling<T>, "Missing codec for cached element");
+		write(w, element.styling);
+	}
+	return true;
+}
+
+template <typename T>
+T decode(record_reader& r)
+{
+	if constexpr (std::is_empty_v<T>)
+		return T{};
+	else if constexpr (std::is_same_v<T, data_source>)
+		return read_data_source(r);
+	else if constexpr (std::is_same_v<T, document::document>)
+	{
+		attributes::metadata metadata;
+		read(r, metadata);
+		return document::document{.metadata = [metadata]() { return metadata; }};
+	}
+	else if constexpr (std::is_same_v<T, document::text>)
+	{
+		document::text element;
+		read(r, element.text);
+		read(r, element.position);
+		read(r, element.font_size);
+		return element;
+	}
+	else if constexpr (std::is_same_v<T, document::link>)
+	{
+		document::link element;
+		read(r, element.url);
+		read(r, element.styling);
+		return element;
+	}
+	else if constexpr (std::is_same_v<T, document::image>)
+	{
+		document::image element{.source = read_data_source(r)};
+		read(r, element.alt);
+		read(r, element.position);
+		read(r, element.styling);
+		return element;
+	}
+	else if constexpr (std::is_same_v<T, document::style>)
+	{
+		document::style element;
+		read(r, element.css_text);
+		return element;
+	}
+	else if constexpr (std::is_same_v<T, document::list>)
+	{
+		document::list element;
+		read(r, element.type);
+		read(r, element.styling);
+		return element;
+	}
+	else if constexpr (std::is_same_v<T, document::comment>)
+	{
+		document::comment element;
+		read(r, element.author);
+		read(r, element.time);
+		read(r, element.comment);
+		return element;
+	}
+	else
+	{
+		T element;
+		read(r, element.styling);
+		return element;
+	}
+}
+
+struct element_codec
+{
+	bool (*encode)(record_writer&, const message_base&);
+	message_ptr (*decode)(record_reader&);
+	int nesting_delta;
+};
+
+template <size_t... I>
+auto make_element_codecs(std::index_sequence<I...>)
+{
+	return std::array<element_codec, sizeof...(I)>
+	{
+		element_codec
+		{
+			[](record_writer& w, const message_base& msg) { return encode(w, msg.get<std::tuple_element_t<I, cached_elements>>()); },
+			[](record_reader& r) { return make_message(decode<std::tuple_element_t<I, cached_elements>>(r)); },
+			nesting_delta<std::tuple_element_t<I, cached_elements>>()
+		}...
+	};
+}
+
+const auto& element_codecs()
+{
+	static const auto codecs = make_element_codecs(std::make_index_sequence<std::tuple_size_v<cached_elements>>{});
+	return codecs;
+}
+
+template <size_t... I>
+std::unordered_map<std::uint32_t, std::uint8_t> make_tags_by_type_id(std::index_sequence<I...>)
+{
+	return {{message_type_id<std::tuple_element_t<I, cached_elements>>(), static_cast<std::uint8_t>(I)}...};
+}
+
+const std::unordered_map<std::uint32_t, std::uint8_t>& tags_by_type_id()
+{
+	static const auto tags = make_tags_by_type_id(std::make_index_sequence<std::tuple_size_v<cached_elements>>{});
+	return tags;
+}
+
+enum class direction { forward, back };
+
+// Records messages emitted by the cached element as long as all of them can be stored.
+class stream_recorder
+{
+public:
+	void record(const message_base& msg, direction message_direction)
+	{
+		if (!m_storable)
+			return;
+		auto tag = tags_by_type_id().find(msg.type_id());
+		bool encoded = false;
+		if (tag != tags_by_type_id().end())
+		{
+			m_writer.u8(message_direction == direction::back ? tag->second | back_direction_flag : tag->second);
+			try
+			{
+				encoded = element_codecs()[tag->second].encode(m_writer, msg);
+			}
+			catch (const std::exception&)
+			{
+				log_entry();
+			}
+		}
+		if (!encoded)
+		{
+			log_entry(msg);
+			discard();
+		}
+	}
+
+	void discard()
+	{
+		m_storable = false;
+		m_writer.data() = std::string{};
+	}
+
+	bool storable() const { return m_storable; }
+
+	std::string& data() { return m_writer.data(); }
+
+private:
+	record_writer m_writer;
+	bool m_storable = true;
+};
+
+struct cached_message
+{
+	message_ptr msg;
+	int nesting_delta;
+	direction message_direction;
+};
+
+std::vector<cached_message> decode_messages(record_reader& reader)
+{
+	std::vector<cached_message> messages;
+	while (!reader.at_end())
+	{
+		std::uint8_t tag = reader.u8();
+		direction message_direction = tag & back_direction_flag ? direction::back : direction::forward;
+		tag &= ~back_direction_flag;
+		throw_if(tag >= element_codecs().size(), "Unknown element in cache entry", tag, errors::uninterpretable_data{});
+		const element_codec& codec = element_codecs()[tag];
+		messages.push_back(cached_message{codec.decode(reader), codec.nesting_delta, message_direction});
+	}
+	return messages;
+}
+
+continuation replay(std::vector<cached_message>& messages, const message_callbacks& emit_message)
+{
+	for (size_t i = 0; i < messages.size(); ++i)
+	{
+		continuation result = messages[i].message_direction == direction::back ?
+			emit_message.back(std::move(messages[i].msg)) : emit_message(std::move(messages[i].msg));
+		if (result == continuation::stop)
+			return continuation::stop;
+		if (result == continuation::skip && messages[i].nesting_delta > 0)
+		{
+			// Like parsers do, drop the children and the closing element.
+			for (int depth = 1; depth > 0 && i + 1 < messages.size(); )
+				depth += messages[++i].nesting_delta;
+		}
+	}
+	return continuation::proceed;
+}
+
+std::string to_hex(const sha256_digest& digest)
+{
+	constexpr char digits[] = "0123456789abcdef";
+	std::string hex;
+	for (std::uint8_t byte : digest)
+	{
+		hex.push_back(digits[byte >> 4]);
+		hex.push_back(digits[byte & 0xf]);
+	}
+	return hex;
+}
+
+// Entries are files named by the key. They are written to a temporary file and renamed, so other
+// processes never see partial entries. Modification time is updated on every hit and used for eviction.
+class entry_store
+{
+public:
+	entry_store(const std::filesystem::path& directory, std::uintmax_t max_size, std::chrono::seconds max_age)
+		: m_directory{directory}, m_max_size{max_size}, m_max_age{max_age}
+	{
+		std::error_code ec;
+		std::filesystem::create_directories(m_directory, ec);
+		throw_if(ec, "Could not create cache directory", m_directory, ec.message());
+	}
+
+	std::optional<std::string> load(const std::string& name)
+	{
+		std::filesystem::path path = entry_path(name);
+		std::ifstream file{path, std::ios::binary | std::ios::ate};
+		if (!file)
+			return std::nullopt;
+		std::string content(static_cast<size_t>(file.tellg()), '\0');
+		file.seekg(0);
+		if (!file.read(content.data(), content.size()))
+			return std::nullopt;
+		std::error_code ec;
+		std::filesystem::last_write_time(path, std::filesystem::file_time_type::clock::now(), ec);
+		return content;
+	}
+
+	bool store(const std::string& name, const std::string& content)
+	{
+		log_scope(name, content.size());
+		if (content.size() > m_max_size)
+			return false;
+		std::filesystem::path temporary_path = m_directory / (name + ".tmp" + std::to_string(std::random_device{}()));
+		{
+			std::ofstream file{temporary_path, std::ios::binary | std::ios::trunc};
+			file.write(content.data(), content.size());
+			if (!file)
+			{
+				log_entry(temporary_path);
+				std::error_code ec;
+				std::filesystem::remove(temporary_path, ec);
+				return false;
+			}
+		}
+		std::error_code ec;
+		std::filesystem::rename(temporary_path, entry_path(name), ec);
+		if (ec)
+		{
+			log_entry(ec.message());
+			std::filesystem::remove(temporary_path, ec);
+			return false;
+		}
+		m_size_since_sweep += content.size();
+		if (!m_last_sweep || m_size_at_sweep + m_size_since_sweep > m_max_size ||
+				std::chrono::steady_clock::now() - *m_last_sweep > std::min<std::chrono::seconds>(m_max_age, std::chrono::hours{1}))
+			sweep();
+		return true;
+	}
+
+	void remove(const std::string& name)
+	{
+		std::error_code ec;
+		std::filesystem::remove(entry_path(name), ec);
+	}
+
+	size_t evictions() const { return m_evictions; }
+
+private:
+	std::filesystem::path entry_path(const std::string& name) const
+	{
+		return m_directory / (name + std::string{entry_extension});
+	}
+
+	// Removes entries older than the age limit, then the least recently used ones until the size drops 10% below the limit.
+	void sweep()
+	{
+		log_scope(m_directory);
+		struct entry_info
+		{
+			std::filesystem::path path;
+			std::filesystem::file_time_type last_use;
+			std::uintmax_t size;
+		};
+		std::vector<entry_info> entries;
+		std::uintmax_t total_size = 0;
+		const auto now = std::filesystem::file_time_type::clock::now();
+		std::error_code ec;
+		for (const std::filesystem::directory_entry& entry : std::filesystem::directory_iterator{m_directory, ec})
+		{
+			if (entry.path().extension() != entry_extension)
+				continue;
+			std::error_code entry_ec;
+			entry_info info{entry.path(), entry.last_write_time(entry_ec), entry.file_size(entry_ec)};
+			if (entry_ec)
+				continue;
+			if (now - info.last_use > m_max_age)
+			{
+				if (std::filesystem::remove(info.path, entry_ec))
+					++m_evictions;
+				continue;
+			}
+			total_size += info.size;
+			entries.push_back(std::move(info));
+		}
+		if (total_size > m_max_size)
+		{
+			std::sort(entries.begin(), entries.end(), [](const entry_info& a, const entry_info& b) { return a.last_use < b.last_use; });
+			for (const entry_info& info : entries)
+			{
+				if (total_size <= m_max_size - m_max_size / 10)
+					break;
+				std::error_code entry_ec;
+				if (std::filesystem::remove(info.path, entry_ec))
+					++m_evictions;
+				total_size -= info.size;
+			}
+		}
+		log_entry(total_size, m_evictions);
+		m_size_at_sweep = total_size;
+		m_size_since_sweep = 0;
+		m_last_sweep = std::chrono::steady_clock::now();
+	}
+
+	std::filesystem::path m_directory;
+	std::uintmax_t m_max_size;
+	std::chrono::seconds m_max_age;
+	std::uintmax_t m_size_at_sweep = 0;
+	std::uintmax_t m_size_since_sweep = 0;
+	std::optional<std::chrono::steady_clock::time_point> m_last_sweep;
+	size_t m_evictions = 0;
+};
+
+} // anonymous namespace
+
+template<>
+struct pimpl_impl<result_cache> : pimpl_impl_base
+{
+	pimpl_impl(ref_or_owned<chain_element> cached_element, cache_directory directory, cache_fingerprint fingerprint,
+			cache_max_size max_size, cache_max_age max_age)
+		: m_cached_element{cached_element}, m_store{directory.v, max_size.v, max_age.v}
+	{
+		std::string configuration = std::string{typeid(m_cached_element.get()).name()} + '\n' + fingerprint.v + '\n' +
+			VERSION + '\n' + std::to_string(format_version);
+		m_fingerprint_hash = sha256{}.update(configuration).final();
+	}
+
+	// Parsers are chosen by the MIME type and some of them by the file extension, so the same bytes declared
+	// as another format are a different entry.
+	std::string entry_name(const data_source& source, std::span<const std::byte> data) const
+	{
+		std::optional<mime_type> type = source.highest_confidence_mime_type();
+		std::optional<file_extension> extension = source.file_extension();
+		return to_hex(sha256{}
+			.update_field(as_string_view(m_fingerprint_hash))
+			.update_field(type ? type->v : "")
+			.update_field(extension ? extension->string() : "")
+			.update_field(std::string_view{reinterpret_cast<const char*>(data.data()), data.size()})
+			.final());
+	}
+
+	std::string entry_header(size_t data_size) const
+	{
+		record_writer header;
+		header.raw(entry_magic);
+		header.varint(format_version);
+		header.raw(as_string_view(m_fingerprint_hash));
+		header.varint(data_size);
+		return header.data();
+	}
+
+	ref_or_owned<chain_element> m_cached_element;
+	entry_store m_store;
+	sha256_digest m_fingerprint_hash;
+	result_cache_statistics m_statistics {};
+};
+
+result_cache::result_cache(ref_or_owned<chain_element> cached_element, cache_directory directory, cache_fingerprint fingerprint,
+		cache_max_size max_size, cache_max_age max_age)
+	: with_pimpl<result_cache>(cached_element, directory, fingerprint, max_size, max_age)
+{
+	log_scope(directory.v, fingerprint.v, max_size.v, max_age.v.count());
+}
+
+continuation result_cache::operator()(message_ptr msg, const message_callbacks& emit_message)
+{
+	log_scope(msg);
+	chain_element& cached_element = impl().m_cached_element.get();
+	if (!msg->is<data_source>())
+		return cached_element(std::move(msg), emit_message);
+
+	const data_source& source = msg->get<data_source>();
+	// Encrypted data must fail the same way on every call, not only when the entry is created.
+	source.assert_not_encrypted();
+	std::span<const std::byte> data = source.span();
+	const std::string name = impl().entry_name(source, data);
+	const std::string header = impl().entry_header(data.size());
+
+	if (std::optional<std::string> entry = impl().m_store.load(name))
+	{
+		std::optional<std::vector<cached_message>> messages;
+		if (entry->starts_with(header))
+		{
+			try
+			{
+				record_reader reader{std::string_view{*entry}.substr(header.size())};
+				messages = decode_messages(reader);
+			}
+			catch (const std::exception&)
+			{
+				log_entry(name);
+			}
+		}
+		if (messages)
+		{
+			++impl().m_statistics.hits;
+			return replay(*messages, emit_message);
+		}
+		log_entry(name, "Invalid cache entry removed");
+		impl().m_store.remove(name);
+	}
+
+	++impl().m_statistics.misses;
+	stream_recorder recorder;
+	recorder.data() = header;
+	continuation result = cached_element(std::move(msg),
+		{
+			[&recorder, &emit_message](message_ptr msg)
+			{
+				recorder.record(*msg, direction::forward);
+				continuation result = emit_message(std::move(msg));
+				// Elements emit less after skip or stop, so the recorded stream would be incomplete.
+				if (result != continuation::proceed)
+					recorder.discard();
+				return result;
+			},
+			// Images and embedded files are sent back to be processed by the chain, so they are replayed the same way.
+			[&recorder, &emit_message](message_ptr msg)
+			{
+				recorder.record(*msg, direction::back);
+				continuation result;
+				try
+				{
+					result = emit_message.back(std::move(msg));
+				}
+				catch (const std::exception&)
+				{
+					recorder.discard();
+					throw;
+				}
+				if (result != continuation::proceed)
+					recorder.discard();
+				return result;
+			}
+		});
+	if (recorder.storable() && result != continuation::stop && impl().m_store.store(name, recorder.data()))
+		++impl().m_statistics.stores;
+	return result;
+}
+
+bool result_cache::is_leaf() const
+{
+	return impl().m_cached_element.get().is_leaf();
+}
+
+result_cache_statistics result_cache::statistics() const
+{
+	result_cache_statistics statistics = impl().m_statistics;
+	statistics.evictions = impl().m_store.evictions();
+	return statistics;
+}
+
+} // namespace docwire
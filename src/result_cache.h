@@ -0,0 +1,87 @@
+/*********************************************************************************************************************************************/
+/*  DocWire SDK: Award-winning modern data processing in C++20. SourceForge Community Choice & Microsoft support. AI-driven processing.      */
+/*  Supports nearly 100 data formats, including email boxes and OCR. Boost efficiency in text extraction, web data extraction, data mining,  */
+/*  document analysis. Offline processing possible for security and confidentiality                                                          */
+/*                                                                                                                                           */
+/*  Copyright (c) SILVERCODERS Ltd, http://silvercoders.com                                                                                  */
+/*  Project homepage: https://github.com/docwire/docwire                                                                                     */
+/*                                                                                                                                           */
+/*  SPDX-License-Identifier: AGPL-3.0-only OR LicenseRef-DocWire-Commercial                                                                  */
+/*********************************************************************************************************************************************/
+
+#ifndef DOCWIRE_RESULT_CACHE_H
+#define DOCWIRE_RESULT_CACHE_H
+
+#include "chain_element.h"
+#include <chrono>
+#include "core_export.h"
+#include <cstdint>
+#include <filesystem>
+#include "pimpl.h"
+#include "ref_or_owned.h"
+#include <string>
+
+namespace docwire
+{
+
+/// Directory where cached results are stored. It can be shared by many chains and processes.
+struct cache_directory { std::filesystem::path v; };
+
+/// Additional description of the cached element configuration (for example parser options). Part of the cache key.
+struct cache_fingerprint { std::string v; };
+
+/// Maximum total size of the cache directory in bytes.
+struct cache_max_size { std::uintmax_t v; };
+
+/// Entries not used for longer than this are removed.
+struct cache_max_age { std::chrono::seconds v; };
+
+/// Counters of a single result_cache instance.
+struct result_cache_statistics
+{
+	size_t hits; ///< Data sources answered from the cache.
+	size_t misses; ///< Data sources processed by the cached element.
+	size_t stores; ///< Results written to the cache.
+	size_t evictions; ///< Entries removed because of size or age limits.
+};
+
+/**
+ * @brief Persistent, content-addressed cache of the messages produced by a chain element.
+ *
+ * Every incoming data_source is hashed (SHA-256) together with the type of the cached element, the fingerprint and the
+ * library version. On a hit the stored message stream is replayed from the cache directory without running the
+ * cached element. On a miss the element processes the data source and the document elements it emits are
+ * recorded in a compact binary form, including those sent back to the chain (e.g. embedded images), which are
+ * replayed back as well. Streams containing messages other than document elements (for example
+ * errors or images with lazily recognized content) are passed through but not stored.
+ *
+ * Least recently used entries are removed when the directory grows over the size limit, and entries not used
+ * for longer than the age limit are removed as well.
+ *
+ * @code
+ * std::filesystem::path("1.docx") | content_type::detector{} |
+ *   result_cache{office_formats_parser{}, cache_directory{"/var/cache/docwire"}} |
+ *   plain_text_exporter{} | std::cout;
+ * @endcode
+ */
+class DOCWIRE_CORE_EXPORT result_cache : public chain_element, public with_pimpl<result_cache>
+{
+public:
+	result_cache(ref_or_owned<chain_element> cached_element, cache_directory directory,
+		cache_fingerprint fingerprint = {},
+		cache_max_size max_size = {std::uintmax_t{1024} * 1024 * 1024},
+		cache_max_age max_age = {std::chrono::hours{24 * 30}});
+
+	continuation operator()(message_ptr msg, const message_callbacks& emit_message) override;
+
+	bool is_leaf() const override;
+
+	result_cache_statistics statistics() const;
+
+private:
+	using with_pimpl<result_cache>::impl;
+};
+
+} // namespace docwire
+
+#endif // DOCWIRE_RESULT_CACHE_H
@@ -802,17 +802,21 @@ attributes::metadata extract_rtf_metadata(const data_source& data)
 	return meta;
 }
 
-const std::vector<mime_type> supported_mime_types =
-{
-	mime_type{"application/rtf"},
-	mime_type{"text/rtf"},
-	mime_type{"text/richtext"}
-};
-
 } // anonymous namespace
 
 rtf_parser::rtf_parser() = default;
 
+const std::vector<mime_type>& rtf_parser::supported_mime_types()
+{
+	static const std::vector<mime_type> mime_types =
+	{
+		mime_type{"application/rtf"},
+		mime_type{"text/rtf"},
+		mime_type{"text/richtext"}
+	};
+	return mime_types;
+}
+
 continuation rtf_parser::operator()(message_ptr msg, const message_callbacks& emit_message)
 {
 	if (!msg->is<data_source>())
@@ -821,7 +825,7 @@ continuation rtf_parser::operator()(message_ptr msg, const message_callbacks& em
 	auto& data = msg->get<data_source>();
 	data.assert_not_encrypted();
 
-	if (!data.has_highest_confidence_mime_type_in(supported_mime_types))
+	if (!data.has_highest_confidence_mime_type_in(supported_mime_types()))
 		return emit_message(std::move(msg));
 
 	try
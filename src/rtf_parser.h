@@ -14,15 +14,20 @@
 
 #include "chain_element.h"
 #include "rtf_export.h"
+#include <vector>
 
 namespace docwire
 {
 
+struct mime_type;
+
 class DOCWIRE_RTF_EXPORT rtf_parser : public chain_element
 {
 	public:
 		rtf_parser();
 		continuation operator()(message_ptr msg, const message_callbacks& emit_message) override;
+		/// MIME types of the data sources parsed by this parser. Other data sources are passed on.
+		static const std::vector<mime_type>& supported_mime_types();
 		bool is_leaf() const override { return false; }
 };
 
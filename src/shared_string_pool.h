@@ -0,0 +1,98 @@
+/*********************************************************************************************************************************************/
+/*  DocWire SDK: Award-winning modern data processing in C++20. SourceForge Community Choice & Microsoft support. AI-driven processing.      */
+/*  Supports nearly 100 data formats, including email boxes and OCR. Boost efficiency in text extraction, web data extraction, data mining,  */
+/*  document analysis. Offline processing possible for security and confidentiality                                                          */
+/*                                                                                                                                           */
+/*  Copyright (c) SILVERCODERS Ltd, http://silvercoders.com                                                                                  */
+/*  Project homepage: https://github.com/docwire/docwire                                                                                     */
+/*                                                                                                                                           */
+/*  SPDX-License-Identifier: AGPL-3.0-only OR LicenseRef-DocWire-Commercial                                                                  */
+/*********************************************************************************************************************************************/
+
+
+#ifndef DOCWIRE_SHARED_STRING_POOL_H
+#define DOCWIRE_SHARED_STRING_POOL_H
+
+#include "error_tags.h"
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <string_view>
+#include "throw_if.h"
+#include <vector>
+
+namespace docwire
+{
+
+/**
+ * @brief Shared strings of a spreadsheet, stored one after another in one UTF-8 buffer.
+ *
+ * Strings are found by a table of 32-bit offsets of their ends, so a string costs 4 bytes besides its text and
+ * adding it does not allocate, apart from growing the buffer and the table. Workbooks have up to millions of
+ * short strings, which take several times more memory as separate std::string objects.
+ *
+ * A string is added by appending its parts and ending it:
+ * @code
+ * shared_string_pool pool;
+ * pool.append("Hello, ");
+ * pool.append("World");
+ * pool.end_string();
+ * pool.push_back("second");
+ * assert(pool[0] == "Hello, World" && pool.size() == 2);
+ * @endcode
+ */
+class shared_string_pool
+{
+public:
+	size_t size() const { return m_ends.size(); }
+
+	bool empty() const { return m_ends.empty(); }
+
+	/// Returns the string at the given position. The view is valid until the next string is added.
+	std::string_view operator[](size_t index) const
+	{
+		uint32_t begin = index == 0 ? 0 : m_ends[index - 1];
+		return std::string_view{m_texts}.substr(begin, m_ends[index] - begin);
+	}
+
+	/// Reserves offsets for the given number of strings.
+	void reserve(size_t string_count) { m_ends.reserve(string_count); }
+
+	/// Appends text to the string that is being added.
+	void append(std::string_view text) { m_texts += text; }
+
+	/// Adds a string that the writer appends to the given buffer. Text appended before is part of the string too.
+	template <typename Writer>
+	void emplace_back(Writer&& write)
+	{
+		write(m_texts);
+		end_string();
+	}
+
+	/// Ends the string that is being added.
+	void end_string()
+	{
+		DOCWIRE_THROW_IF(m_texts.size() > std::numeric_limits<uint32_t>::max(), "Shared strings exceed 4 GB", errors::uninterpretable_data{});
+		m_ends.push_back(static_cast<uint32_t>(m_texts.size()));
+	}
+
+	void push_back(std::string_view text)
+	{
+		append(text);
+		end_string();
+	}
+
+	void clear()
+	{
+		m_texts.clear();
+		m_ends.clear();
+	}
+
+private:
+	std::string m_texts;
+	std::vector<uint32_t> m_ends;
+};
+
+} // namespace docwire
+
+#endif // DOCWIRE_SHARED_STRING_POOL_H
@@ -0,0 +1,106 @@
+/*********************************************************************************************************************************************/
+/*  DocWire SDK: Award-winning modern data processing in C++20. SourceForge Community Choice & Microsoft support. AI-driven processing.      */
+/*  Supports nearly 100 data formats, including email boxes and OCR. Boost efficiency in text extraction, web data extraction, data mining,  */
+/*  document analysis. Offline processing possible for security and confidentiality                                                          */
+/*                                                                                                                                           */
+/*  Copyright (c) SILVERCODERS Ltd, http://silvercoders.com                                                                                  */
+/*  Project homepage: https://github.com/docwire/docwire                                                                                     */
+/*                                                                                                                                           */
+/*  SPDX-License-Identifier: AGPL-3.0-only OR LicenseRef-DocWire-Commercial                                                                  */
+/*********************************************************************************************************************************************/
+
+#ifndef DOCWIRE_STATIC_CHAIN_H
+#define DOCWIRE_STATIC_CHAIN_H
+
+#include "chain_element.h"
+#include <cstddef>
+#include <tuple>
+#include <type_traits>
+
+namespace docwire
+{
+
+/**
+ * @brief Chain of elements with types known at compile time.
+ *
+ * Behaves like the parsing_chain built by `e1 | e2 | ... | en`, but the elements are stored by value in one object
+ * and messages are passed between them by direct, non-virtual calls. A parsing_chain node creates
+ * message_callbacks that copy the callbacks of the next node for every message; here the callbacks of each stage
+ * only refer to the next stage, so they are cheap to create and never allocate.
+ *
+ * @code
+ * static_chain chain{office_formats_parser{}, plain_text_exporter{}};
+ * std::filesystem::path("data_processing_definition.doc") | chain | std::cout;
+ * @endcode
+ *
+ * static_chain is a chain_element itself, so it can be combined with other elements using operator|.
+ */
+template <typename... Elements>
+class static_chain : public chain_element
+{
+  static_assert(sizeof...(Elements) >= 2, "static_chain needs at least two elements");
+  static_assert((std::is_base_of_v<chain_element, Elements> && ...), "static_chain elements must be chain elements");
+
+public:
+  explicit static_chain(Elements... elements)
+    : m_elements{std::move(elements)...}
+  {}
+
+  continuation operator()(message_ptr msg, const message_callbacks& emit_message) override
+  {
+    return process<0>(std::move(msg), emit_message);
+  }
+
+  /// Processes a message in a complete chain, the same way as parsing_chain::operator()(message_ptr).
+  void operator()(message_ptr msg)
+  {
+    operator()(std::move(msg),
+    {
+      [](message_ptr) { return continuation::proceed; },
+      [this](message_ptr msg) { operator()(std::move(msg)); return continuation::proceed; }
+    });
+  }
+
+  bool is_leaf() const override { return std::get<last_index>(m_elements).is_leaf(); }
+
+  bool is_generator() const override { return std::get<0>(m_elements).is_generator(); }
+
+  bool is_complete() const { return is_generator() && is_leaf(); }
+
+  template <std::size_t I>
+  auto& element() { return std::get<I>(m_elements); }
+
+private:
+  static constexpr std::size_t last_index = sizeof...(Elements) - 1;
+
+  template <std::size_t I>
+  continuation process(message_ptr msg, const message_callbacks& emit_message)
+  {
+    if constexpr (I == last_index)
+      return invoke<I>(std::move(msg), emit_message);
+    else
+      return invoke<I>(std::move(msg),
+        {
+          [this, &emit_message](message_ptr msg) { return process<I + 1>(std::move(msg), emit_message); },
+          [&emit_message](message_ptr msg) { return emit_message.back(std::move(msg)); }
+        });
+  }
+
+  template <std::size_t I>
+  continuation invoke(message_ptr msg, const message_callbacks& emit_message)
+  {
+    using element_type = std::tuple_element_t<I, std::tuple<Elements...>>;
+    element_type& element = std::get<I>(m_elements);
+    // Qualified call is not dispatched through the vtable. Elements that do not expose operator() publicly are called virtually.
+    if constexpr (requires { element.element_type::operator()(std::move(msg), emit_message); })
+      return element.element_type::operator()(std::move(msg), emit_message);
+    else
+      return static_cast<chain_element&>(element)(std::move(msg), emit_message);
+  }
+
+  std::tuple<Elements...> m_elements;
+};
+
+} // namespace docwire
+
+#endif // DOCWIRE_STATIC_CHAIN_H
@@ -11,6 +11,7 @@
 
 #include "thread_safe_ole_stream_reader.h"
 
+#include <cstring>
 #include "data_stream.h"
 
 namespace docwire
@@ -30,6 +31,47 @@ struct pimpl_impl<thread_safe_ole_stream_reader> : pimpl_impl_base
 	uint32_t m_current_sector{0};
 	std::string m_error;
 	bool m_valid{false};
+	std::span<const std::byte> m_memory;
+
+	bool read_chunk(U8* buffer, uint64_t length)
+	{
+		if (m_memory.empty())
+			return m_data_stream->read(buffer, sizeof(uint8_t), length);
+		uint64_t offset = m_sector_positions[m_current_sector] + m_chunk_position;
+		if (offset + length > m_memory.size())
+			return false;
+		std::memcpy(buffer, m_memory.data() + offset, length);
+		return true;
+	}
+
+	// Offset in m_memory of the next length bytes if all of them are stored in consecutive sectors.
+	std::optional<uint64_t> contiguous_offset(uint64_t length) const
+	{
+		if (m_memory.empty() || m_current_sector >= m_sector_positions.size())
+			return std::nullopt;
+		uint64_t available = m_sector_size - m_chunk_position;
+		for (size_t sector = m_current_sector; available < length; ++sector, available += m_sector_size)
+			if (sector + 1 >= m_sector_positions.size() || m_sector_positions[sector + 1] != m_sector_positions[sector] + m_sector_size)
+				return std::nullopt;
+		uint64_t offset = m_sector_positions[m_current_sector] + m_chunk_position;
+		if (offset + length > m_memory.size())
+			return std::nullopt;
+		return offset;
+	}
+
+	// Moves the position like read() does: a read ending at a sector boundary stays in that sector.
+	void advance(uint64_t length)
+	{
+		m_position += length;
+		uint64_t chunk_position = m_chunk_position + length;
+		if (chunk_position > m_sector_size)
+		{
+			uint64_t sectors = (chunk_position - 1) / m_sector_size;
+			m_current_sector += sectors;
+			chunk_position -= sectors * m_sector_size;
+		}
+		m_chunk_position = chunk_position;
+	}
 };
 
 thread_safe_ole_stream_reader::thread_safe_ole_stream_reader(thread_safe_ole_storage *storage, stream &stream)
@@ -43,6 +85,7 @@ thread_safe_ole_stream_reader::thread_safe_ole_stream_reader(thread_safe_ole_sto
 	impl().m_sector_size = stream.m_sector_size;
 	impl().m_valid = true;
 	impl().m_current_sector = 0;
+	impl().m_memory = impl().m_data_stream->span();
 	if (!impl().m_data_stream->open())
 	{
 		impl().m_error = "Empty file";
@@ -103,7 +146,7 @@ bool thread_safe_ole_stream_reader::read(U8* buf, size_t length)
 	{
 		if (to_read <= impl().m_sector_size - impl().m_chunk_position)
 		{
-			if (!impl().m_data_stream->read(buf + read_pos, sizeof(uint8_t), to_read))
+			if (!impl().read_chunk(buf + read_pos, to_read))
 			{
 				impl().m_valid = false;
 				impl().m_error = "Read past EOF";
@@ -118,7 +161,7 @@ bool thread_safe_ole_stream_reader::read(U8* buf, size_t length)
 			uint32_t rest = impl().m_sector_size - impl().m_chunk_position;
 			if (rest > 0)
 			{
-				if (!impl().m_data_stream->read(buf + read_pos, sizeof(uint8_t), rest))
+				if (!impl().read_chunk(buf + read_pos, rest))
 				{
 					impl().m_valid = false;
 					impl().m_error = "Read past EOF";
@@ -135,7 +178,7 @@ bool thread_safe_ole_stream_reader::read(U8* buf, size_t length)
 				impl().m_error = "Read past EOF";
 				return false;
 			}
-			if (!impl().m_data_stream->seek(impl().m_sector_positions[impl().m_current_sector], SEEK_SET))
+			if (impl().m_memory.empty() && !impl().m_data_stream->seek(impl().m_sector_positions[impl().m_current_sector], SEEK_SET))
 			{
 				impl().m_error = "Cant seek to the next sector";
 				impl().m_valid = false;
@@ -147,6 +190,26 @@ bool thread_safe_ole_stream_reader::read(U8* buf, size_t length)
 	return true;
 }
 
+std::optional<std::span<const U8>> thread_safe_ole_stream_reader::read_span(size_t length, std::vector<U8>& buffer)
+{
+	if (!impl().m_valid)
+		return std::nullopt;
+	if (length > impl().m_size - impl().m_position)
+	{
+		impl().m_error = "Requested size to read is too big";
+		return std::nullopt;
+	}
+	if (std::optional<uint64_t> offset = impl().contiguous_offset(length))
+	{
+		impl().advance(length);
+		return std::span<const U8>{ reinterpret_cast<const U8*>(impl().m_memory.data()) + *offset, length };
+	}
+	buffer.resize(length);
+	if (!read(buffer.data(), length))
+		return std::nullopt;
+	return std::span<const U8>{ buffer.data(), length };
+}
+
 bool thread_safe_ole_stream_reader::seek(int offset, int whence)
 {
 	uint64_t new_position;
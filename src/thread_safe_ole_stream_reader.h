@@ -15,7 +15,9 @@
 #include "core_export.h"
 #include <cstdint>
 #include <cstdio>
+#include <optional>
 #include "pimpl.h"
+#include <span>
 #include <string>
 #include <vector>
 #include "wv2/src/olestream.h"
@@ -59,6 +61,17 @@ class DOCWIRE_CORE_EXPORT thread_safe_ole_stream_reader : public wvWare::OLEStre
 		bool readS32(S32& data);
 		S32 readS32() override;
 		bool read(U8 *buffer, size_t length) override;
+
+		/**
+		 * @brief Reads length bytes and returns them as one contiguous view.
+		 *
+		 * If the stream is stored in memory and the requested bytes lie in consecutive sectors the view points
+		 * directly to the storage buffer. Otherwise bytes are copied to the buffer provided by the caller, which
+		 * can be reused between calls. The view is valid until the next call that uses the same buffer.
+		 *
+		 * @return std::nullopt if the requested bytes could not be read (see getLastError()).
+		 */
+		std::optional<std::span<const U8>> read_span(size_t length, std::vector<U8>& buffer);
 };
 
 } // namespace docwire
@@ -11,59 +11,360 @@
 
 #include "tracing.h"
 
-#include <stdio.h>
-#include <stdlib.h>
+#include <array>
+#include <atomic>
+#include <boost/core/demangle.hpp>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#if defined(__unix__) || defined(__APPLE__)
+	#include <dlfcn.h>
+#endif
 
-static int level = 0;
-static FILE* file = NULL;
+#if defined(__GNUC__) || defined(__clang__)
+	#define DOCWIRE_NO_INSTRUMENT __attribute__((no_instrument_function))
+#else
+	#define DOCWIRE_NO_INSTRUMENT
+#endif
 
-void docwire_init_tracing(const char* filename) __attribute__((no_instrument_function));
-static void close_tracing(void)  __attribute__((no_instrument_function, destructor));
-static void trace_func(bool call, void* func, void* caller) __attribute__((no_instrument_function));
+namespace docwire::tracing
+{
 
-void docwire_init_tracing(const char* filename)
+namespace
+{
+
+enum class event_kind : std::uint8_t
+{
+	begin_name, ///< id is a static string
+	begin_function, ///< id is a function address
+	end
+};
+
+struct event
+{
+	std::uint64_t time; ///< Nanoseconds since start of tracing.
+	const void* id;
+	event_kind kind;
+};
+
+constexpr size_t chunk_capacity = 4096;
+
+struct chunk
+{
+	std::array<event, chunk_capacity> events;
+};
+
+// Events of one thread waiting for the writer.
+struct pending_events
+{
+	std::unique_ptr<chunk> events;
+	size_t begin;
+	size_t end;
+	std::uint64_t thread_index;
+};
+
+struct thread_state
+{
+	std::unique_ptr<chunk> current;
+	std::atomic<size_t> published{0}; ///< Events of the current chunk visible to stop() and the writer.
+	size_t flushed = 0; ///< Events of the current chunk already handed to the writer. Guarded by the global mutex.
+	std::uint64_t index;
+};
+
+std::atomic<bool> g_enabled{false};
+std::atomic<bool> g_log_scopes{false};
+std::chrono::steady_clock::time_point g_start_time;
+
+std::mutex g_mutex;
+std::condition_variable g_writer_wakeup;
+std::deque<pending_events> g_pending;
+std::vector<std::unique_ptr<chunk>> g_free_chunks;
+std::vector<thread_state*> g_threads;
+std::unordered_map<std::uint64_t, std::string> g_thread_ids;
+std::uint64_t g_next_thread_index = 0;
+bool g_stop_writer = false;
+std::thread g_writer;
+std::ofstream g_file;
+
+DOCWIRE_NO_INSTRUMENT std::unique_ptr<chunk> take_chunk()
+{
+	if (g_free_chunks.empty())
+		return std::make_unique<chunk>();
+	std::unique_ptr<chunk> c = std::move(g_free_chunks.back());
+	g_free_chunks.pop_back();
+	return c;
+}
+
+// Hands events of the current chunk that were not handed yet to the writer. Requires g_mutex.
+DOCWIRE_NO_INSTRUMENT void hand_over_published(thread_state& state, bool replace_chunk)
 {
-	file = fopen(filename, "w");
-	if (file == NULL)
+	size_t published = state.published.load(std::memory_order_acquire);
+	if (replace_chunk)
 	{
-		fprintf(stderr, "Error opening %s trace file.\n", filename);
-		exit(1);
+		if (published > state.flushed)
+			g_pending.push_back(pending_events{std::move(state.current), state.flushed, published, state.index});
+		state.current = take_chunk();
+		state.flushed = 0;
+		state.published.store(0, std::memory_order_relaxed);
 	}
+	else if (published > state.flushed)
+	{
+		std::unique_ptr<chunk> copy = take_chunk();
+		std::copy(state.current->events.begin() + state.flushed, state.current->events.begin() + published, copy->events.begin());
+		g_pending.push_back(pending_events{std::move(copy), 0, published - state.flushed, state.index});
+		state.flushed = published;
+	}
+}
+
+// Set while recording, in the writer thread and during thread exit. Instrumented library functions called
+// by the tracing code itself must not record events, or they would recurse and deadlock on g_mutex.
+thread_local bool t_not_recording = false;
+
+struct thread_state_owner
+{
+	thread_state* state = nullptr;
+
+	DOCWIRE_NO_INSTRUMENT ~thread_state_owner()
+	{
+		if (!state)
+			return;
+		t_not_recording = true;
+		std::lock_guard lock{g_mutex};
+		hand_over_published(*state, false);
+		std::erase(g_threads, state);
+		delete state;
+		state = nullptr;
+		g_writer_wakeup.notify_one();
+	}
+};
+
+thread_local thread_state_owner t_state_owner;
+
+DOCWIRE_NO_INSTRUMENT thread_state* current_thread_state()
+{
+	if (!t_state_owner.state)
+	{
+		auto state = std::make_unique<thread_state>();
+		std::ostringstream thread_id;
+		thread_id << std::this_thread::get_id();
+		std::lock_guard lock{g_mutex};
+		state->current = take_chunk();
+		state->index = g_next_thread_index++;
+		g_thread_ids[state->index] = thread_id.str();
+		g_threads.push_back(state.get());
+		t_state_owner.state = state.release();
+	}
+	return t_state_owner.state;
+}
+
+DOCWIRE_NO_INSTRUMENT void record(event_kind kind, const void* id)
+{
+	if (!g_enabled.load(std::memory_order_acquire) || t_not_recording)
+		return;
+	t_not_recording = true;
+	thread_state* state = current_thread_state();
+	std::uint64_t time = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - g_start_time).count();
+	size_t position = state->published.load(std::memory_order_relaxed);
+	state->current->events[position] = event{time, id, kind};
+	state->published.store(position + 1, std::memory_order_release);
+	if (position + 1 == chunk_capacity)
+	{
+		std::lock_guard lock{g_mutex};
+		hand_over_published(*state, true);
+		g_writer_wakeup.notify_one();
+	}
+	t_not_recording = false;
 }
 
-static void close_tracing(void)
+DOCWIRE_NO_INSTRUMENT std::string symbol_name(const void* address)
 {
-	if (file != NULL)
-		fclose(file);
-	file = NULL;
+#if defined(__unix__) || defined(__APPLE__)
+	Dl_info info;
+	if (dladdr(address, &info) && info.dli_sname)
+		return boost::core::demangle(info.dli_sname);
+#endif
+	char hex[2 + sizeof(void*) * 2 + 1];
+	std::snprintf(hex, sizeof(hex), "%p", address);
+	return hex;
 }
 
-static void trace_func(bool call, void* func, void* caller)
+DOCWIRE_NO_INSTRUMENT void write_json_string(std::ostream& out, std::string_view text)
 {
-	if (!call)
-		level--;
-	if (file != NULL)
+	out << '"';
+	for (char c : text)
 	{
-		// warning TODO: Make this thread safe and add thread id to output.
-		fprintf(file, "%i %c %p %p\n", level, call ? 'C' : 'R', func, caller);
-		fflush(file);
+		if (c == '"' || c == '\\')
+			out << '\\' << c;
+		else if (static_cast<unsigned char>(c) < 0x20)
+			out << ' ';
+		else
+			out << c;
 	}
-	if (call)
-		level++;
+	out << '"';
+}
+
+DOCWIRE_NO_INSTRUMENT void run_writer()
+{
+	t_not_recording = true;
+	std::unordered_map<const void*, std::string> function_names;
+	std::unordered_set<std::uint64_t> named_threads;
+	bool first_event = true;
+	auto event_prefix = [&]() -> std::ostream&
+	{
+		g_file << (first_event ? "\n" : ",\n");
+		first_event = false;
+		return g_file;
+	};
+	std::unique_lock lock{g_mutex};
+	for (;;)
+	{
+		g_writer_wakeup.wait(lock, []() { return g_stop_writer || !g_pending.empty(); });
+		if (g_pending.empty())
+			return;
+		pending_events pending = std::move(g_pending.front());
+		g_pending.pop_front();
+		std::string thread_id = g_thread_ids[pending.thread_index];
+		lock.unlock();
+
+		if (named_threads.insert(pending.thread_index).second)
+		{
+			event_prefix() << R"({"name":"thread_name","ph":"M","pid":1,"tid":)" << pending.thread_index << R"(,"args":{"name":)";
+			write_json_string(g_file, "thread " + thread_id);
+			g_file << "}}";
+		}
+		for (size_t i = pending.begin; i < pending.end; ++i)
+		{
+			const event& e = pending.events->events[i];
+			event_prefix() << "{";
+			if (e.kind == event_kind::begin_name)
+			{
+				g_file << R"("name":)";
+				write_json_string(g_file, static_cast<const char*>(e.id));
+				g_file << R"(,"ph":"B",)";
+			}
+			else if (e.kind == event_kind::begin_function)
+			{
+				auto name = function_names.find(e.id);
+				if (name == function_names.end())
+					name = function_names.emplace(e.id, symbol_name(e.id)).first;
+				g_file << R"("name":)";
+				write_json_string(g_file, name->second);
+				g_file << R"(,"ph":"B",)";
+			}
+			else
+				g_file << R"("ph":"E",)";
+			g_file << R"("pid":1,"tid":)" << pending.thread_index << R"(,"ts":)" << e.time / 1000 << '.' << std::setfill('0') << std::setw(3) << e.time % 1000 << "}";
+		}
+
+		lock.lock();
+		g_free_chunks.push_back(std::move(pending.events));
+	}
+}
+
+struct stop_at_exit
+{
+	DOCWIRE_NO_INSTRUMENT ~stop_at_exit()
+	{
+		stop();
+	}
+} g_stop_at_exit;
+
+} // anonymous namespace
+
+void start(const std::filesystem::path& file_path, trace_log_scopes log_scopes)
+{
+	stop();
+	std::lock_guard lock{g_mutex};
+	g_file.open(file_path, std::ios::out | std::ios::trunc);
+	if (!g_file.is_open())
+	{
+		std::cerr << "Error opening trace file " << file_path << std::endl;
+		return;
+	}
+	g_file << R"({"displayTimeUnit":"ms","traceEvents":[)";
+	// Events recorded after the previous trace was stopped are not written.
+	for (thread_state* state : g_threads)
+		state->flushed = state->published.load(std::memory_order_acquire);
+	for (pending_events& pending : g_pending)
+		g_free_chunks.push_back(std::move(pending.events));
+	g_pending.clear();
+	g_start_time = std::chrono::steady_clock::now();
+	g_stop_writer = false;
+	g_writer = std::thread{run_writer};
+	g_log_scopes.store(log_scopes.v, std::memory_order_relaxed);
+	g_enabled.store(true, std::memory_order_release);
+}
+
+void stop()
+{
+	{
+		std::lock_guard lock{g_mutex};
+		if (!g_writer.joinable())
+			return;
+		g_enabled.store(false, std::memory_order_relaxed);
+		g_log_scopes.store(false, std::memory_order_relaxed);
+		for (thread_state* state : g_threads)
+			hand_over_published(*state, false);
+		g_stop_writer = true;
+	}
+	g_writer_wakeup.notify_one();
+	g_writer.join();
+	g_file << "\n]}\n";
+	g_file.close();
+}
+
+bool is_enabled()
+{
+	return g_enabled.load(std::memory_order_relaxed);
+}
+
+bool are_log_scopes_traced()
+{
+	return g_log_scopes.load(std::memory_order_relaxed);
+}
+
+void begin(const char* name)
+{
+	record(event_kind::begin_name, name);
+}
+
+void end()
+{
+	record(event_kind::end, nullptr);
+}
+
+} // namespace docwire::tracing
+
+void docwire_init_tracing(const char* filename)
+{
+	docwire::tracing::start(filename);
 }
 
+#ifdef DOCWIRE_TRACE
 extern "C"
 {
-	void __cyg_profile_func_enter(void* func,  void* caller) __attribute__((no_instrument_function));
-	void __cyg_profile_func_exit (void* func, void* caller) __attribute__((no_instrument_function));
+	DOCWIRE_CORE_EXPORT void __cyg_profile_func_enter(void* func, void* caller) DOCWIRE_NO_INSTRUMENT;
+	DOCWIRE_CORE_EXPORT void __cyg_profile_func_exit(void* func, void* caller) DOCWIRE_NO_INSTRUMENT;
 
-	void __cyg_profile_func_enter(void* func, void* caller)
+	void __cyg_profile_func_enter(void* func, void*)
 	{
-		trace_func(true, func, caller);
+		docwire::tracing::record(docwire::tracing::event_kind::begin_function, func);
 	}
 
-	void __cyg_profile_func_exit (void* func, void* caller)
+	void __cyg_profile_func_exit(void*, void*)
 	{
-		trace_func(false, func, caller);
+		docwire::tracing::record(docwire::tracing::event_kind::end, nullptr);
 	}
 }
+#endif
@@ -12,6 +12,73 @@
 #ifndef DOCWIRE_TRACING_H
 #define DOCWIRE_TRACING_H
 
-void docwire_init_tracing(const char* filename);
+#include "core_export.h"
+#include <filesystem>
+
+/**
+ * @brief Timeline tracing of spans on all threads.
+ *
+ * Events are stored in per-thread buffers with steady_clock timestamps and written to the trace file by a background
+ * thread in Chrome trace event format. The file can be opened in Perfetto UI (https://ui.perfetto.dev) or chrome://tracing.
+ *
+ * Spans come from tracing::span objects, optionally from log_scope, and in builds configured with DOCWIRE_TRACE
+ * (compiled with -finstrument-functions) from every function call. Function addresses are converted to names
+ * when they are written.
+ */
+namespace docwire::tracing
+{
+
+/// Records every log_scope as a span, including scopes of disabled log entries.
+struct trace_log_scopes { bool v; };
+
+/// Starts writing trace events to the file. Events recorded before are discarded.
+DOCWIRE_CORE_EXPORT void start(const std::filesystem::path& file_path, trace_log_scopes log_scopes = {false});
+
+/// Writes remaining events and closes the trace file. Called automatically at exit.
+DOCWIRE_CORE_EXPORT void stop();
+
+DOCWIRE_CORE_EXPORT bool is_enabled();
+
+DOCWIRE_CORE_EXPORT bool are_log_scopes_traced();
+
+/// Begins a span on the current thread. Name has to be a string with static storage duration.
+DOCWIRE_CORE_EXPORT void begin(const char* name);
+
+/// Ends the most recent span begun on the current thread.
+DOCWIRE_CORE_EXPORT void end();
+
+/**
+ * @brief RAII span.
+ * @code
+ * tracing::span s{"parse_page"};
+ * @endcode
+ */
+class span
+{
+public:
+	explicit span(const char* name)
+		: m_active{is_enabled()}
+	{
+		if (m_active)
+			begin(name);
+	}
+
+	~span()
+	{
+		if (m_active)
+			end();
+	}
+
+	span(const span&) = delete;
+	span& operator=(const span&) = delete;
+
+private:
+	bool m_active;
+};
+
+} // namespace docwire::tracing
+
+/// Same as docwire::tracing::start(filename).
+DOCWIRE_CORE_EXPORT void docwire_init_tracing(const char* filename);
 
 #endif
@@ -75,46 +75,6 @@ std::string sequences_of_printable_characters(const std::string& text, size_t mi
 	return result;
 }
 
-const std::vector<mime_type> supported_mime_types =
-{
-    mime_type{"text/x-asm"},
-    mime_type{"text/asp"},
-    mime_type{"text/aspdotnet"},
-    mime_type{"text/x-basic"},
-    mime_type{"text/x-bat"},
-    mime_type{"text/x-c"},
-    mime_type{"text/x-cmake"},
-    mime_type{"text/x-csharp"},
-    mime_type{"text/css"},
-    mime_type{"text/csv"},
-    mime_type{"text/x-d"},
-    mime_type{"text/x-fortran"},
-    mime_type{"text/x-fsharp"},
-    mime_type{"text/x-go"},
-    mime_type{"text/x-c++hdr"},
-    mime_type{"text/html"},
-    mime_type{"text/x-java-source"},
-    mime_type{"application/javascript"},
-    mime_type{"text/javascript"},
-    mime_type{"application/json"},
-    mime_type{"text/x-jsp"},
-    mime_type{"text/x-lua"},
-    mime_type{"text/markdown"},
-    mime_type{"text/x-pascal"},
-    mime_type{"application/x-httpd-php"},
-    mime_type{"text/x-perl"},
-    mime_type{"text/x-python"},
-    mime_type{"text/x-rsrc"},
-    mime_type{"application/rss+xml"},
-    mime_type{"application/x-sh"},
-    mime_type{"application/x-tcl"},
-    mime_type{"text/plain"},
-    mime_type{"text/x-vbdotnet"},
-    mime_type{"text/x-vbscript"},
-    mime_type{"application/xml"},
-    mime_type{"text/yaml"}
-};
-
 } // anonymous namespace
 
 void pimpl_impl<txt_parser>::parse(const data_source& data, const message_callbacks& emit_message)
@@ -251,6 +211,50 @@ void pimpl_impl<txt_parser>::parse(const data_source& data, const message_callba
 	emit_message(document::close_document{});
 }
 
+const std::vector<mime_type>& txt_parser::supported_mime_types()
+{
+    static const std::vector<mime_type> mime_types =
+    {
+        mime_type{"text/x-asm"},
+        mime_type{"text/asp"},
+        mime_type{"text/aspdotnet"},
+        mime_type{"text/x-basic"},
+        mime_type{"text/x-bat"},
+        mime_type{"text/x-c"},
+        mime_type{"text/x-cmake"},
+        mime_type{"text/x-csharp"},
+        mime_type{"text/css"},
+        mime_type{"text/csv"},
+        mime_type{"text/x-d"},
+        mime_type{"text/x-fortran"},
+        mime_type{"text/x-fsharp"},
+        mime_type{"text/x-go"},
+        mime_type{"text/x-c++hdr"},
+        mime_type{"text/html"},
+        mime_type{"text/x-java-source"},
+        mime_type{"application/javascript"},
+        mime_type{"text/javascript"},
+        mime_type{"application/json"},
+        mime_type{"text/x-jsp"},
+        mime_type{"text/x-lua"},
+        mime_type{"text/markdown"},
+        mime_type{"text/x-pascal"},
+        mime_type{"application/x-httpd-php"},
+        mime_type{"text/x-perl"},
+        mime_type{"text/x-python"},
+        mime_type{"text/x-rsrc"},
+        mime_type{"application/rss+xml"},
+        mime_type{"application/x-sh"},
+        mime_type{"application/x-tcl"},
+        mime_type{"text/plain"},
+        mime_type{"text/x-vbdotnet"},
+        mime_type{"text/x-vbscript"},
+        mime_type{"application/xml"},
+        mime_type{"text/yaml"}
+    };
+    return mime_types;
+}
+
 continuation txt_parser::operator()(message_ptr msg, const message_callbacks& emit_message)
 {
   if (!msg->is<data_source>())
@@ -259,7 +263,7 @@ continuation txt_parser::operator()(message_ptr msg, const message_callbacks& em
   auto& data = msg->get<data_source>();
   data.assert_not_encrypted();
 
-  if (!data.has_highest_confidence_mime_type_in(supported_mime_types))
+  if (!data.has_highest_confidence_mime_type_in(supported_mime_types()))
     return emit_message(std::move(msg));
 
   try
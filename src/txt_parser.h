@@ -14,10 +14,13 @@
 
 #include "chain_element.h"
 #include "plain_text_export.h"
+#include <vector>
 
 namespace docwire
 {
 
+struct mime_type;
+
 struct parse_paragraphs { bool v; };
 struct parse_lines { bool v; };
 
@@ -30,6 +33,8 @@ class DOCWIRE_PLAIN_TEXT_EXPORT txt_parser : public chain_element, public with_p
 		parse_lines parse_lines_arg = parse_lines{true});
     
     continuation operator()(message_ptr msg, const message_callbacks& emit_message) override;
+    /// MIME types of the data sources parsed by this parser. Other data sources are passed on.
+    static const std::vector<mime_type>& supported_mime_types();
     bool is_leaf() const override { return false; }
 
 private:
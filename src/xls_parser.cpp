@@ -11,6 +11,7 @@
 
 #include "xls_parser.h"
 
+#include <algorithm>
 #include "data_source.h"
 #include "document_elements.h"
 #include "error_tags.h"
@@ -22,11 +23,14 @@
 #include <mutex>
 #include "nested_exception.h"
 #include "oshared.h"
+#include <optional>
 #include <set>
+#include <span>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include "scoped_stack_push.h"
+#include "shared_string_pool.h"
 #include "throw_if.h"
 #include "wv2/src/textconverter.h"
 #include "wv2/src/utilities.h"
@@ -83,7 +87,7 @@ struct context
 	biff_version m_biff_version;
 	std::vector<xf_record> m_xf_records;
 	double m_date_shift;
-	std::vector<std::string> m_shared_string_table;
+	shared_string_pool m_shared_string_table;
 	std::vector<unsigned char> m_shared_string_table_buf;
 	std::vector<size_t> m_shared_string_table_record_sizes;
 	int m_prev_rec_type;
@@ -93,13 +97,6 @@ struct context
 	int m_last_row, m_last_col;
 };
 
-const std::vector<mime_type> supported_mime_types =
-{
-	mime_type{"application/vnd.ms-excel"},
-	mime_type{"application/vnd.ms-excel.sheet.macroenabled.12"},
-	mime_type{"application/vnd.ms-excel.template.macroenabled.12"}
-};
-
 } // anonymous namespace
 
 template<>
@@ -116,12 +113,12 @@ struct pimpl_impl<xls_parser> : pimpl_impl_base
 	void parse(const data_source& data, const message_callbacks& emit_message);
 	std::string parse(thread_safe_ole_storage& storage, const message_callbacks& emit_message);
 
-	U16 getU16LittleEndian(std::vector<unsigned char>::const_iterator buffer)
+	U16 getU16LittleEndian(std::span<const unsigned char>::iterator buffer)
 	{
 		return (unsigned short int)(*buffer) | ((unsigned short int)(*(buffer + 1)) << 8);
 	}
 	
-	S32 getS32LittleEndian(std::vector<unsigned char>::const_iterator buffer)
+	S32 getS32LittleEndian(std::span<const unsigned char>::iterator buffer)
 	{
 		return (long)(*buffer) | ((long)(*(buffer + 1)) << 8L) | ((long)(*(buffer + 2)) << 16L)|((long)(*(buffer + 3)) << 24L);
 	}  
@@ -195,7 +192,7 @@ struct pimpl_impl<xls_parser> : pimpl_impl_base
 		}
 	}
 
-	std::string parseXNum(std::vector<unsigned char>::const_iterator src,int xf_index)
+	std::string parseXNum(std::span<const unsigned char>::iterator src,int xf_index)
 	{
 		log_scope(xf_index);
 		union
@@ -211,7 +208,7 @@ struct pimpl_impl<xls_parser> : pimpl_impl_base
 		return formatXLSNumber(xnum_conv.num, xf_index);
 	}
 
-	std::string parseRkRec(std::vector<unsigned char>::const_iterator src, short int xf_index)
+	std::string parseRkRec(std::span<const unsigned char>::iterator src, short int xf_index)
 	{
 		log_scope(xf_index);
 		double number;
@@ -239,7 +236,8 @@ struct pimpl_impl<xls_parser> : pimpl_impl_base
 		return formatXLSNumber(number, xf_index);
 	}
 
-	std::string parseXLUnicodeString(std::vector<unsigned char>::const_iterator* src, std::vector<unsigned char>::const_iterator src_end, const std::vector<size_t>& record_sizes, size_t& record_index, size_t& record_pos)
+	// Appends the string to dest.
+	void parseXLUnicodeString(std::span<const unsigned char>::iterator* src, std::span<const unsigned char>::iterator src_end, const std::vector<size_t>& record_sizes, size_t& record_index, size_t& record_pos, std::string& dest)
 	{
 		log_scope();
 		if (record_pos >= record_sizes[record_index])
@@ -263,7 +261,7 @@ struct pimpl_impl<xls_parser> : pimpl_impl_base
 		{
 			emit_message(make_error_ptr("Unexpected end of buffer."));
 			*src = src_end;
-			return "";
+			return;
 		}
 		int count = getU16LittleEndian(*src);
 		*src += 2;
@@ -272,7 +270,7 @@ struct pimpl_impl<xls_parser> : pimpl_impl_base
 		{
 			emit_message(make_error_ptr("Unexpected end of buffer."));
 			*src = src_end;
-			return "";
+			return;
 		}
 		int flags = 0;
 		if (m_context_stack.top().m_biff_version >= BIFF8)
@@ -290,7 +288,7 @@ struct pimpl_impl<xls_parser> : pimpl_impl_base
 			{
 				emit_message(make_error_ptr("Unexpected end of buffer."));
 				*src = src_end;
-				return "";
+				return;
 			}
 			after_text_block_len += 4*getU16LittleEndian(*src);
 			*src += 2;
@@ -303,15 +301,14 @@ struct pimpl_impl<xls_parser> : pimpl_impl_base
 			{
 				emit_message(make_error_ptr("Unexpected end of buffer."));
 				*src = src_end;
-				return "";
+				return;
 			}
 			after_text_block_len += getS32LittleEndian(*src);
 			*src += 4;
 			record_pos += 4;
 		}
 		log_entry(after_text_block_len);
-		std::string dest;
-		std::vector<unsigned char>::const_iterator s = *src;
+		std::span<const unsigned char>::iterator s = *src;
 		int char_count = 0;
 		for (int i = 0; i < count; i++, s += char_size, record_pos += char_size)
 		{
@@ -319,7 +316,7 @@ struct pimpl_impl<xls_parser> : pimpl_impl_base
 			{
 				emit_message(make_error_ptr("Unexpected end of buffer."));
 				*src = src_end;
-				return dest;
+				return;
 			}
 			if (record_pos > record_sizes[record_index])
 				emit_message(make_error_ptr("Record boundary crossed.", record_pos, record_sizes[record_index]));
@@ -336,7 +333,7 @@ struct pimpl_impl<xls_parser> : pimpl_impl_base
 				{
 					emit_message(make_error_ptr("Unexpected end of buffer."));
 					*src = src_end;
-					return dest;
+					return;
 				}
 				if ((*s) != 0 && (*s) != 1)
 					emit_message(make_error_ptr("Incorrect XLUnicodeString flag.", *s));
@@ -355,7 +352,7 @@ struct pimpl_impl<xls_parser> : pimpl_impl_base
 				{
 					emit_message(make_error_ptr("Unexpected end of buffer."));
 					*src = src_end;
-					return dest;
+					return;
 				}
 				unsigned int uc = getU16LittleEndian(s);
 				// warning TODO: Find explanation (documentation) of NULL characters (OO skips them).
@@ -369,7 +366,7 @@ struct pimpl_impl<xls_parser> : pimpl_impl_base
 					{
 						emit_message(make_error_ptr("Unexpected end of buffer."));
 						*src = src_end;
-						return dest;
+						return;
 					}
 					uc = (uc << 16) | getU16LittleEndian(s);
 				}
@@ -382,7 +379,7 @@ struct pimpl_impl<xls_parser> : pimpl_impl_base
 				{
 					emit_message(make_error_ptr("Unexpected end of buffer."));
 					*src = src_end;
-					return dest;
+					return;
 				}
 				std::string c2(1, *s);
 				if (m_context_stack.top().m_codepage != "ASCII")
@@ -398,10 +395,9 @@ struct pimpl_impl<xls_parser> : pimpl_impl_base
 		}
 		*src = s + after_text_block_len;
 		record_pos += after_text_block_len;
-		return dest;
 	}
 
-	void parseSharedStringTable(const std::vector<unsigned char>& sst_buf)
+	void parseSharedStringTable(std::span<const unsigned char> sst_buf)
 	{
 		log_scope(sst_buf.size());
 		if (sst_buf.size() < 8)
@@ -410,14 +406,17 @@ struct pimpl_impl<xls_parser> : pimpl_impl_base
 			return;
 		}
 		int sst_size = getS32LittleEndian(sst_buf.begin() + 4);
-		std::vector<unsigned char>::const_iterator src = sst_buf.begin() + 8;
+		std::span<const unsigned char>::iterator src = sst_buf.begin() + 8;
 		size_t record_index = 0;
 		size_t record_pos = 8;
 		while (src < sst_buf.end() && m_context_stack.top().m_shared_string_table.size() <= sst_size)
-		m_context_stack.top().m_shared_string_table.push_back(parseXLUnicodeString(&src, sst_buf.end(), m_context_stack.top().m_shared_string_table_record_sizes, record_index, record_pos));
+			m_context_stack.top().m_shared_string_table.emplace_back([&](std::string& texts)
+			{
+				parseXLUnicodeString(&src, sst_buf.end(), m_context_stack.top().m_shared_string_table_record_sizes, record_index, record_pos, texts);
+			});
 	}	
 
-	std::string cellText(int row, int col, const std::string& s)
+	std::string cellText(int row, int col, std::string_view s)
 	{
 		log_scope(row, col, s);
 		std::string r;
@@ -438,11 +437,16 @@ struct pimpl_impl<xls_parser> : pimpl_impl_base
 		return r;
 	}
 
-	void processRecord(int rec_type, const std::vector<unsigned char>& rec, std::string& text)
+	void processRecord(int rec_type, std::span<const unsigned char> rec, std::string& text)
 	{
 		log_scope(rec_type);
 		if (rec_type != XLS_CONTINUE && m_context_stack.top().m_prev_rec_type == XLS_SST)
+		{
 			parseSharedStringTable(m_context_stack.top().m_shared_string_table_buf);
+			// Strings are in the pool now, so the copy of the records is released.
+			std::vector<unsigned char>{}.swap(m_context_stack.top().m_shared_string_table_buf);
+			m_context_stack.top().m_shared_string_table_record_sizes.clear();
+		}
 		switch (rec_type)
 		{
 			case XLS_BLANK:
@@ -586,12 +590,14 @@ struct pimpl_impl<xls_parser> : pimpl_impl_base
 				m_context_stack.top().m_last_string_formula_row = -1;
 				int row = getU16LittleEndian(rec.begin()); 
 				int col = getU16LittleEndian(rec.begin() + 2);
-				std::vector<unsigned char>::const_iterator src=rec.begin() + 6;
+				std::span<const unsigned char>::iterator src=rec.begin() + 6;
 				std::vector<size_t> sizes;
 				sizes.push_back(rec.size() - 6);
 				size_t record_index = 0;
 				size_t record_pos = 0;
-				text += cellText(row, col, parseXLUnicodeString(&src, rec.end(), sizes, record_index, record_pos));
+				std::string label;
+				parseXLUnicodeString(&src, rec.end(), sizes, record_index, record_pos, label);
+				text += cellText(row, col, label);
 				break;
 			}
 			case XLS_LABEL_SST:
@@ -694,7 +700,7 @@ struct pimpl_impl<xls_parser> : pimpl_impl_base
 			}
 			case XLS_STRING:
 			{
-				std::vector<unsigned char>::const_iterator src = rec.begin();
+				std::span<const unsigned char>::iterator src = rec.begin();
 				if (m_context_stack.top().m_last_string_formula_row < 0) {
 					emit_message(make_error_ptr("String record without preceeding string formula."));
 					break;
@@ -703,7 +709,9 @@ struct pimpl_impl<xls_parser> : pimpl_impl_base
 				sizes.push_back(rec.size());
 				size_t record_index = 0;
 				size_t record_pos = 0;
-				text += cellText(m_context_stack.top().m_last_string_formula_row, m_context_stack.top().m_last_string_formula_col, parseXLUnicodeString(&src, rec.end(), sizes, record_index, record_pos));
+				std::string string_value;
+				parseXLUnicodeString(&src, rec.end(), sizes, record_index, record_pos, string_value);
+				text += cellText(m_context_stack.top().m_last_string_formula_row, m_context_stack.top().m_last_string_formula_col, string_value);
 				break;
 			}
 			case XLS_XF:
@@ -864,7 +872,7 @@ struct pimpl_impl<xls_parser> : pimpl_impl_base
 			}
 			if (oleEof(reader))
 			{
-				processRecord(XLS_EOF, std::vector<unsigned char>(), text);
+				processRecord(XLS_EOF, {}, text);
 				return;
 			}
 			U16 rec_len;
@@ -880,21 +888,22 @@ struct pimpl_impl<xls_parser> : pimpl_impl_base
 					emit_message(errors::make_nested_ptr(std::current_exception(), make_error("Length of record could not be read")));
 				break;
 			}
+			std::span<const unsigned char> rec_data;
 			if (rec_len > 0)
 			{
-				rec.resize(rec_len);
-				read_status = reader.read(&*rec.begin(), rec_len);
-				if (!read_status)
+				std::optional<std::span<const U8>> body = reader.read_span(std::min<size_t>(rec_len, reader.size() - reader.tell()), rec);
+				read_status = body.has_value();
+				if (read_status)
+					rec_data = *body;
+				else
 					emit_message(make_error_ptr("Error while reading next record", reader.getLastError()));
 			}
-			else
-				rec.clear();
 			if (eof_rec_found)
 			{
 				if (rec_type != XLS_BOF)
 					break;
 			}
-			processRecord(rec_type, rec, text);
+			processRecord(rec_type, rec_data, text);
 			if (rec_type == XLS_EOF)
 				eof_rec_found = true;
 			else
@@ -910,6 +919,7 @@ xls_parser::xls_parser()
 void pimpl_impl<xls_parser>::parse(const data_source& data, const message_callbacks& emit_message)
 {
 	auto storage = std::make_unique<thread_safe_ole_storage>(data.span());
+	data.advise(access_pattern::random);
 	throw_if (!storage->isValid(), storage->getLastError());
 	emit_message(document::document
 		{
@@ -951,6 +961,17 @@ std::string pimpl_impl<xls_parser>::parse(thread_safe_ole_storage& storage, cons
 	}
 }
 
+const std::vector<mime_type>& xls_parser::supported_mime_types()
+{
+	static const std::vector<mime_type> mime_types =
+	{
+		mime_type{"application/vnd.ms-excel"},
+		mime_type{"application/vnd.ms-excel.sheet.macroenabled.12"},
+		mime_type{"application/vnd.ms-excel.template.macroenabled.12"}
+	};
+	return mime_types;
+}
+
 continuation xls_parser::operator()(message_ptr msg, const message_callbacks& emit_message)
 {
 	if (!msg->is<data_source>())
@@ -959,7 +980,7 @@ continuation xls_parser::operator()(message_ptr msg, const message_callbacks& em
 	auto& data = msg->get<data_source>();
 	data.assert_not_encrypted(); // This checks if the data_source itself is encrypted (e.g. encrypted ZIP)
 
-	if (!data.has_highest_confidence_mime_type_in(supported_mime_types))
+	if (!data.has_highest_confidence_mime_type_in(supported_mime_types()))
 		return emit_message(std::move(msg));
 
 	impl().parse(data, emit_message);
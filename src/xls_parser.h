@@ -16,11 +16,13 @@
 #include "chain_element.h"
 #include "pimpl.h"
 #include <string>
+#include <vector>
 
 namespace docwire
 {
 
 class thread_safe_ole_storage;
+struct mime_type;
 
 class DOCWIRE_OLE_OFFICE_FORMATS_EXPORT xls_parser : public chain_element, public with_pimpl<xls_parser>
 {
@@ -31,6 +33,8 @@ class DOCWIRE_OLE_OFFICE_FORMATS_EXPORT xls_parser : public chain_element, publi
 	public:
 		xls_parser();
 		continuation operator()(message_ptr msg, const message_callbacks& emit_message) override;
+		/// MIME types of the data sources parsed by this parser. Other data sources are passed on.
+		static const std::vector<mime_type>& supported_mime_types();
 		bool is_leaf() const override { return false; }
 		std::string parse(thread_safe_ole_storage& storage, const message_callbacks& emit_message);
 };
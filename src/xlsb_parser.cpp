@@ -28,6 +28,7 @@
 #include <map>
 #include "misc.h"
 #include "serialization_data_source.h" // IWYU pragma: keep
+#include "shared_string_pool.h"
 #include <sstream>
 #include <stack>
 #include <stdint.h>
@@ -40,11 +41,6 @@ namespace docwire
 namespace
 {
 
-const std::vector<mime_type> supported_mime_types =
-{
-	mime_type{"application/vnd.ms-excel.sheet.binary.macroenabled.12"}
-};
-
 struct rk_number
 {
 	double value;
@@ -77,30 +73,32 @@ rk_number read_rk_number(binary::reader& reader)
 	}
 }
 
-std::string read_xl_wide_string(binary::reader& reader)
+// Appends the string to the output, converted to UTF-8.
+void read_xl_wide_string(binary::reader& reader, std::string& output)
 {
 	log_scope();
 	const uint32_t num_chars = reader.read_little_endian<uint32_t>();
 	log_entry(num_chars);
 	if (num_chars == 0)
-		return "";
+		return;
 
 	// The string is stored as a raw sequence of UTF-16LE bytes.
 	// We read it as a raw buffer and pass it directly to the charset_converter,
-	// which is configured to expect "UTF-16LE".
+	// which is configured to expect "UTF-16LE". The buffer is reused by all strings.
 	const size_t buffer_byte_size = num_chars * sizeof(char16_t);
-	std::vector<char> utf16_bytes(buffer_byte_size);
+	thread_local std::string utf16_bytes;
+	utf16_bytes.resize(buffer_byte_size);
 	reader.read({reinterpret_cast<std::byte*>(utf16_bytes.data()), utf16_bytes.size()});
 
 	thread_local charset_converter conv("UTF-16LE", "UTF-8");
-	return conv.convert({utf16_bytes.data(), utf16_bytes.size()});
+	conv.convert(utf16_bytes, output);
 }
 
-std::string read_rich_str(binary::reader& reader)
+void read_rich_str(binary::reader& reader, std::string& output)
 {
 	log_scope();
 	reader.read_little_endian<uint8_t>(); // skip flags
-	return read_xl_wide_string(reader);
+	read_xl_wide_string(reader, output);
 }
 
 } // anonymous namespace
@@ -129,7 +127,7 @@ struct pimpl_impl<xlsb_parser> : pimpl_impl_base
 		};
 
 		errors_codes m_error_codes;
-		std::vector<std::string> m_shared_strings;
+		shared_string_pool m_shared_strings;
 		uint32_t m_row_start, m_row_end, m_col_start, m_col_end;
 		uint32_t m_current_column, m_current_row;
 
@@ -277,10 +275,10 @@ struct pimpl_impl<xlsb_parser> : pimpl_impl_base
 				try
 				{
 					// This record contains the total number of strings and the count of unique strings.
-					// We only need the total count to reserve space.
-					uint32_t total_strings;
-					total_strings = record_reader.read_little_endian<uint32_t>();
-					content().m_shared_strings.reserve(total_strings);
+					// Only the unique strings are stored, so their count is used to reserve space.
+					record_reader.read_little_endian<uint32_t>(); // skip total count
+					uint32_t unique_strings = record_reader.read_little_endian<uint32_t>();
+					content().m_shared_strings.reserve(unique_strings);
 				}
 				catch (const std::exception& e)
 				{
@@ -292,9 +290,7 @@ struct pimpl_impl<xlsb_parser> : pimpl_impl_base
 			{
 				try
 				{
-					content().m_shared_strings.push_back(std::string());
-					std::string* new_string = &content().m_shared_strings[content().m_shared_strings.size() - 1];
-					*new_string = read_rich_str(record_reader);
+					content().m_shared_strings.emplace_back([&record_reader](std::string& texts) { read_rich_str(record_reader, texts); });
 				}
 				catch (const std::exception& e)
 				{
@@ -394,7 +390,7 @@ struct pimpl_impl<xlsb_parser> : pimpl_impl_base
 				try
 				{
 					parseColumn(record_reader, text);
-					text += read_xl_wide_string(record_reader);
+					read_xl_wide_string(record_reader, text);
 				}
 				catch (const std::exception& e)
 				{
@@ -687,6 +683,15 @@ void pimpl_impl<xlsb_parser>::parse(const data_source& data, const message_callb
 	emit_message(document::close_document{});
 }
 
+const std::vector<mime_type>& xlsb_parser::supported_mime_types()
+{
+	static const std::vector<mime_type> mime_types =
+	{
+		mime_type{"application/vnd.ms-excel.sheet.binary.macroenabled.12"}
+	};
+	return mime_types;
+}
+
 continuation xlsb_parser::operator()(message_ptr msg, const message_callbacks& emit_message)
 {
 	if (!msg->is<data_source>())
@@ -695,7 +700,7 @@ continuation xlsb_parser::operator()(message_ptr msg, const message_callbacks& e
 	auto& data = msg->get<data_source>();
 	data.assert_not_encrypted();
 
-	if (!data.has_highest_confidence_mime_type_in(supported_mime_types))
+	if (!data.has_highest_confidence_mime_type_in(supported_mime_types()))
 		return emit_message(std::move(msg));
 
 	impl().parse(data, emit_message);
@@ -15,11 +15,13 @@
 #include "chain_element.h"
 #include "message.h"
 #include "xlsb_export.h"
+#include <vector>
 
 namespace docwire
 {
 
 class zip_reader;
+struct mime_type;
 
 class DOCWIRE_XLSB_EXPORT xlsb_parser : public chain_element, public with_pimpl<xlsb_parser>
 {
@@ -30,6 +32,8 @@ class DOCWIRE_XLSB_EXPORT xlsb_parser : public chain_element, public with_pimpl<
 	public:
 		xlsb_parser();
 		continuation operator()(message_ptr msg, const message_callbacks& emit_message) override;
+		/// MIME types of the data sources parsed by this parser. Other data sources are passed on.
+		static const std::vector<mime_type>& supported_mime_types();
 		bool is_leaf() const override { return false; }
 };
 
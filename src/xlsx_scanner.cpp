@@ -0,0 +1,741 @@
+/*********************************************************************************************************************************************/
+/*  DocWire SDK: Award-winning modern data processing in C++20. SourceForge Community Choice & Microsoft support. AI-driven processing.      */
+/*  Supports nearly 100 data formats, including email boxes and OCR. Boost efficiency in text extraction, web data extraction, data mining,  */
+/*  document analysis. Offline processing possible for security and confidentiality                                                          */
+/*                                                                                                                                           */
+/*  Copyright (c) SILVERCODERS Ltd, http://silvercoders.com                                                                                  */
+/*  Project homepage: https://github.com/docwire/docwire                                                                                     */
+/*                                                                                                                                           */
+/*  SPDX-License-Identifier: AGPL-3.0-only OR LicenseRef-DocWire-Commercial                                                                  */
+/*********************************************************************************************************************************************/
+
+
+#include "xlsx_scanner.h"
+
+#include "convert_numeric.h" // IWYU pragma: keep
+#include "document_elements.h"
+#include "error_tags.h"
+#include "log_scope.h"
+#include "make_error.h"
+#include "throw_if.h"
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <cstring>
+
+namespace docwire::xlsx_scanner
+{
+
+namespace
+{
+
+constexpr size_t read_size = 256 * 1024;
+
+bool is_xml_space(char c)
+{
+	return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+std::string_view local_name(std::string_view name)
+{
+	size_t colon = name.find(':');
+	return colon == std::string_view::npos ? name : name.substr(colon + 1);
+}
+
+void append_utf8(uint32_t code_point, std::string& out)
+{
+	throw_if(code_point == 0 || code_point > 0x10ffff || (code_point >= 0xd800 && code_point <= 0xdfff),
+		"Invalid character reference", errors::uninterpretable_data{});
+	if (code_point < 0x80)
+		out += static_cast<char>(code_point);
+	else if (code_point < 0x800)
+	{
+		out += static_cast<char>(0xc0 | (code_point >> 6));
+		out += static_cast<char>(0x80 | (code_point & 0x3f));
+	}
+	else if (code_point < 0x10000)
+	{
+		out += static_cast<char>(0xe0 | (code_point >> 12));
+		out += static_cast<char>(0x80 | ((code_point >> 6) & 0x3f));
+		out += static_cast<char>(0x80 | (code_point & 0x3f));
+	}
+	else
+	{
+		out += static_cast<char>(0xf0 | (code_point >> 18));
+		out += static_cast<char>(0x80 | ((code_point >> 12) & 0x3f));
+		out += static_cast<char>(0x80 | ((code_point >> 6) & 0x3f));
+		out += static_cast<char>(0x80 | (code_point & 0x3f));
+	}
+}
+
+// Replaces references and normalizes line ends the way the XML reader does. Whitespace characters of attribute
+// values become spaces.
+std::string_view decode(std::string_view raw, std::string& buffer, bool is_attribute_value)
+{
+	if (raw.find_first_of(is_attribute_value ? "&\t\n\r" : "&\r") == std::string_view::npos)
+		return raw;
+	buffer.clear();
+	for (size_t pos = 0; pos < raw.size(); ++pos)
+	{
+		char c = raw[pos];
+		if (c == '&')
+		{
+			size_t end = raw.find(';', pos);
+			throw_if(end == std::string_view::npos, "Unterminated reference", errors::uninterpretable_data{});
+			std::string_view name = raw.substr(pos + 1, end - pos - 1);
+			if (name == "lt") buffer += '<';
+			else if (name == "gt") buffer += '>';
+			else if (name == "amp") buffer += '&';
+			else if (name == "quot") buffer += '"';
+			else if (name == "apos") buffer += '\'';
+			else
+			{
+				throw_if(name.size() < 2 || name[0] != '#', "Undefined entity", std::string{name}, errors::uninterpretable_data{});
+				bool is_hex = name[1] == 'x';
+				std::string_view digits = name.substr(is_hex ? 2 : 1);
+				uint32_t code_point = 0;
+				auto result = std::from_chars(digits.data(), digits.data() + digits.size(), code_point, is_hex ? 16 : 10);
+				throw_if(digits.empty() || result.ec != std::errc{} || result.ptr != digits.data() + digits.size(),
+					"Invalid character reference", std::string{name}, errors::uninterpretable_data{});
+				append_utf8(code_point, buffer);
+			}
+			pos = end;
+		}
+		else if (c == '\r')
+		{
+			if (pos + 1 < raw.size() && raw[pos + 1] == '\n')
+				++pos;
+			buffer += is_attribute_value ? ' ' : '\n';
+		}
+		else if (is_attribute_value && (c == '\t' || c == '\n'))
+			buffer += ' ';
+		else
+			buffer += c;
+	}
+	return buffer;
+}
+
+enum class token_type { start_element, end_element, text, other, end_of_content };
+
+// Splits the content into tags and texts. Views returned for a token are valid until the next token is read.
+class tokenizer
+{
+public:
+	explicit tokenizer(part_content content)
+	{
+		if (const std::string_view* whole = std::get_if<std::string_view>(&content))
+			m_data = *whole;
+		else
+			m_input = std::move(std::get<xml::reader_input>(content));
+	}
+
+	// Returns false for content encoded in anything else than UTF-8.
+	bool is_utf8()
+	{
+		while (m_data.size() < 3 && read_more())
+			;
+		if (m_data.starts_with("\xef\xbb\xbf"))
+			m_next = 3;
+		else if (m_data.starts_with("\xfe\xff") || m_data.starts_with("\xff\xfe"))
+			return false;
+		return true;
+	}
+
+	token_type next()
+	{
+		for (;;)
+		{
+			if (m_next == m_data.size() && !read_more())
+				return token_type::end_of_content;
+			std::optional<token_type> type = parse_token();
+			if (type)
+				return *type;
+			if (!read_more())
+			{
+				// Text after the last tag ends with the content, which is known only now.
+				type = parse_token();
+				throw_if(!type, "Unexpected end of XML content", errors::uninterpretable_data{});
+				return *type;
+			}
+		}
+	}
+
+	std::string_view name() const { return m_name; }
+
+	bool is_empty_element() const { return m_is_empty_element; }
+
+	/// Raw content of a text or of a processing instruction.
+	std::string_view raw_text() const { return m_text; }
+
+	std::string_view text(std::string& buffer) const { return decode(m_text, buffer, false); }
+
+	/// Value of the first attribute with the given local name.
+	std::optional<std::string_view> attribute(std::string_view name, std::string& buffer) const
+	{
+		for (const auto& [attribute_name, raw_value] : m_attributes)
+			if (local_name(attribute_name) == name)
+				return decode(raw_value, buffer, true);
+		return std::nullopt;
+	}
+
+private:
+	// Drops the bytes before the current token and appends more content. Returns false at the end of content.
+	bool read_more()
+	{
+		if (!m_input)
+			return false;
+		m_buffer.erase(0, m_next);
+		m_next = 0;
+		size_t size = m_buffer.size();
+		m_buffer.resize(size + read_size);
+		size_t read = m_input(m_buffer.data() + size, read_size);
+		m_buffer.resize(size + read);
+		m_data = m_buffer;
+		if (read == 0)
+			m_input = nullptr;
+		return read > 0;
+	}
+
+	// Returns std::nullopt if the token does not end in the content read so far.
+	std::optional<token_type> parse_token()
+	{
+		const char* begin = m_data.data();
+		const char* end = begin + m_data.size();
+		const char* p = begin + m_next;
+		if (*p != '<')
+		{
+			const char* text_end = static_cast<const char*>(std::memchr(p, '<', end - p));
+			if (!text_end)
+			{
+				if (m_input)
+					return std::nullopt;
+				text_end = end;
+			}
+			m_text = std::string_view{p, static_cast<size_t>(text_end - p)};
+			m_next = text_end - begin;
+			return token_type::text;
+		}
+		std::string_view rest { p, static_cast<size_t>(end - p) };
+		if (rest.size() < 2)
+			return std::nullopt;
+		if (rest[1] == '/')
+		{
+			const char* tag_end = static_cast<const char*>(std::memchr(p + 2, '>', end - p - 2));
+			if (!tag_end)
+				return std::nullopt;
+			std::string_view name { p + 2, static_cast<size_t>(tag_end - p - 2) };
+			while (!name.empty() && is_xml_space(name.back()))
+				name.remove_suffix(1);
+			m_name = name;
+			m_next = tag_end + 1 - begin;
+			return token_type::end_element;
+		}
+		if (rest[1] == '?' || rest[1] == '!')
+		{
+			std::string_view terminator = ">";
+			size_t skip = 2;
+			if (rest[1] == '?')
+				terminator = "?>";
+			else if (rest.starts_with("<!--"))
+			{
+				terminator = "-->";
+				skip = 4;
+			}
+			else if (std::string_view{"<![CDATA["}.starts_with(rest.substr(0, 9)))
+			{
+				if (rest.size() < 9)
+					return std::nullopt;
+				terminator = "]]>";
+				skip = 9;
+			}
+			size_t token_end = rest.find(terminator, skip);
+			if (token_end == std::string_view::npos)
+				return std::nullopt;
+			m_text = rest.substr(2, token_end - 2);
+			m_next += token_end + terminator.size();
+			return token_type::other;
+		}
+		// Start tag. Attribute values are skipped by searching for their closing quotes, so '>' inside them is allowed.
+		m_attributes.clear();
+		size_t pos = 1;
+		auto name_end = [&rest](size_t pos)
+		{
+			while (pos < rest.size() && !is_xml_space(rest[pos]) && rest[pos] != '/' && rest[pos] != '>' && rest[pos] != '=')
+				++pos;
+			return pos;
+		};
+		auto skip_space = [&rest](size_t pos)
+		{
+			while (pos < rest.size() && is_xml_space(rest[pos]))
+				++pos;
+			return pos;
+		};
+		size_t name_pos = name_end(pos);
+		m_name = rest.substr(pos, name_pos - pos);
+		pos = name_pos;
+		for (;;)
+		{
+			pos = skip_space(pos);
+			if (pos >= rest.size())
+				return std::nullopt;
+			if (rest[pos] == '>')
+			{
+				m_is_empty_element = false;
+				break;
+			}
+			if (rest[pos] == '/')
+			{
+				if (pos + 1 >= rest.size())
+					return std::nullopt;
+				throw_if(rest[pos + 1] != '>', "Malformed tag", errors::uninterpretable_data{});
+				m_is_empty_element = true;
+				++pos;
+				break;
+			}
+			size_t attribute_name_end = name_end(pos);
+			std::string_view attribute_name = rest.substr(pos, attribute_name_end - pos);
+			pos = skip_space(attribute_name_end);
+			if (pos >= rest.size())
+				return std::nullopt;
+			throw_if(attribute_name.empty() || rest[pos] != '=', "Malformed attribute", errors::uninterpretable_data{});
+			pos = skip_space(pos + 1);
+			if (pos >= rest.size())
+				return std::nullopt;
+			char quote = rest[pos];
+			throw_if(quote != '"' && quote != '\'', "Malformed attribute", errors::uninterpretable_data{});
+			size_t value_end = rest.find(quote, pos + 1);
+			if (value_end == std::string_view::npos)
+				return std::nullopt;
+			m_attributes.emplace_back(attribute_name, rest.substr(pos + 1, value_end - pos - 1));
+			pos = value_end + 1;
+		}
+		throw_if(m_name.empty(), "Malformed tag", errors::uninterpretable_data{});
+		m_next += pos + 1;
+		return token_type::start_element;
+	}
+
+	xml::reader_input m_input;
+	std::string m_buffer;
+	std::string_view m_data;
+	size_t m_next = 0;
+	std::string_view m_name;
+	std::string_view m_text;
+	bool m_is_empty_element = false;
+	std::vector<std::pair<std::string_view, std::string_view>> m_attributes;
+};
+
+// Returns false if the XML declaration names an encoding other than UTF-8.
+bool declares_utf8(std::string_view declaration)
+{
+	size_t pos = declaration.find("encoding");
+	if (pos == std::string_view::npos)
+		return true;
+	size_t quote = declaration.find_first_of("\"'", pos);
+	if (quote == std::string_view::npos)
+		return true;
+	size_t quote_end = declaration.find(declaration[quote], quote + 1);
+	std::string encoding { declaration.substr(quote + 1, quote_end - quote - 1) };
+	std::transform(encoding.begin(), encoding.end(), encoding.begin(), [](unsigned char c) { return std::tolower(c); });
+	return encoding == "utf-8" || encoding == "utf8";
+}
+
+// Names of open elements, kept to check that end tags match. Strings are reused, so short names do not allocate.
+template <typename Kind>
+class element_stack
+{
+public:
+	void push(std::string_view name, Kind kind)
+	{
+		if (m_size == m_elements.size())
+			m_elements.emplace_back();
+		m_elements[m_size].name.assign(name);
+		m_elements[m_size].kind = kind;
+		++m_size;
+	}
+
+	Kind pop(std::string_view name)
+	{
+		throw_if(m_size == 0 || m_elements[m_size - 1].name != name, "Mismatched end tag", std::string{name}, errors::uninterpretable_data{});
+		return m_elements[--m_size].kind;
+	}
+
+	size_t size() const { return m_size; }
+
+private:
+	struct element
+	{
+		std::string name;
+		Kind kind;
+	};
+	std::vector<element> m_elements;
+	size_t m_size = 0;
+};
+
+// Ignored by odf_ooxml_parser together with their content.
+bool is_skipped_element(std::string_view name)
+{
+	return name == "headerFooter" || name == "instrText" || name == "tableStyleId" || name == "attrName" || name == "fldData";
+}
+
+// Same as std::regex_search with ([A-Z]+)([0-9]+), used by odf_ooxml_parser: the first letters followed by digits.
+bool parse_cell_address(std::string_view address, int& col_num)
+{
+	auto is_letter = [](char c) { return c >= 'A' && c <= 'Z'; };
+	auto is_digit = [](char c) { return c >= '0' && c <= '9'; };
+	for (size_t pos = 0; pos < address.size(); ++pos)
+	{
+		if (!is_letter(address[pos]))
+			continue;
+		size_t letters_end = pos;
+		while (letters_end < address.size() && is_letter(address[letters_end]))
+			++letters_end;
+		if (letters_end < address.size() && is_digit(address[letters_end]))
+		{
+			size_t digits_end = letters_end;
+			while (digits_end < address.size() && is_digit(address[digits_end]))
+				++digits_end;
+			int row_num;
+			auto result = std::from_chars(address.data() + letters_end, address.data() + digits_end, row_num);
+			throw_if(result.ec != std::errc{}, "Row number out of range", std::string{address}, errors::uninterpretable_data{});
+			col_num = 0;
+			for (size_t i = pos; i < letters_end; ++i)
+				col_num = col_num * 26 + (address[i] - 'A') + 1;
+			return true;
+		}
+		pos = letters_end;
+	}
+	return false;
+}
+
+enum class sheet_element { other, sheet_data, row, cell, shared_string_cell, run, run_properties };
+
+class sheet_scanner
+{
+public:
+	sheet_scanner(const shared_string_pool& strings, const message_callbacks& emit_message)
+		: m_strings{strings}, m_emit_message{emit_message}
+	{}
+
+	void start_element(const tokenizer& tokens)
+	{
+		std::string_view name = local_name(tokens.name());
+		if (m_skipped_depth > 0 || is_skipped_element(name))
+		{
+			if (!tokens.is_empty_element())
+			{
+				m_elements.push(tokens.name(), sheet_element::other);
+				++m_skipped_depth;
+			}
+			return;
+		}
+		bool space_preserve_before = m_space_preserve;
+		std::optional<std::string_view> space = tokens.attribute("space", m_attribute_buffer);
+		if (space == "preserve")
+			m_space_preserve = true;
+		else if (space == "default")
+			m_space_preserve = false;
+		sheet_element kind = sheet_element::other;
+		if (name == "sheetData")
+		{
+			m_last_row_num = 0;
+			m_emit_message(document::table{});
+			kind = sheet_element::sheet_data;
+		}
+		else if (name == "row")
+			kind = start_row(tokens);
+		else if (name == "c")
+			kind = start_cell(tokens);
+		else if (name == "r")
+			kind = sheet_element::run;
+		else if (name == "rPr")
+		{
+			reset_format();
+			kind = sheet_element::run_properties;
+			++m_run_properties_depth;
+		}
+		else if (name == "b")
+			m_is_bold = tokens.attribute("val", m_attribute_buffer).value_or("") != "false";
+		else if (name == "i")
+			m_is_italic = tokens.attribute("val", m_attribute_buffer).value_or("") != "false";
+		else if (name == "u")
+			m_is_underline = tokens.attribute("val", m_attribute_buffer).value_or("") != "none";
+		else if (name == "hyperlink")
+		{
+			// Relationships of hyperlinks are read only for word processing documents.
+			std::string rid { tokens.attribute("id", m_attribute_buffer).value_or("") };
+			m_emit_message(make_error_ptr("Relationship not found, skipping", rid));
+		}
+		if (tokens.is_empty_element())
+		{
+			end_element(kind);
+			m_space_preserve = space_preserve_before;
+		}
+		else
+		{
+			m_elements.push(tokens.name(), kind);
+			m_space_preserve_stack.push_back(space_preserve_before);
+		}
+	}
+
+	void end_element(const tokenizer& tokens)
+	{
+		sheet_element kind = m_elements.pop(tokens.name());
+		if (m_skipped_depth > 0)
+		{
+			--m_skipped_depth;
+			return;
+		}
+		end_element(kind);
+		m_space_preserve = m_space_preserve_stack.back();
+		m_space_preserve_stack.pop_back();
+	}
+
+	void text(const tokenizer& tokens)
+	{
+		if (m_skipped_depth > 0)
+			return;
+		std::string_view text = tokens.text(m_text_buffer);
+		if (m_shared_string_cell_depth > 0)
+		{
+			if (m_run_properties_depth == 0)
+				m_shared_string_index += text;
+		}
+		else if (m_space_preserve || !std::all_of(text.begin(), text.end(), [](auto c){return isspace(static_cast<unsigned char>(c));}))
+			m_emit_message(document::text{.text = std::string{text}});
+	}
+
+private:
+	bool is_emitting_formatting() const { return m_shared_string_cell_depth == 0; }
+
+	void reset_format()
+	{
+		m_is_bold = false;
+		m_is_italic = false;
+		m_is_underline = false;
+	}
+
+	sheet_element start_row(const tokenizer& tokens)
+	{
+		m_last_col_num = 0;
+		const int expected_row_num = m_last_row_num + 1;
+		int row_num = expected_row_num;
+		if (std::optional<std::string_view> r = tokens.attribute("r", m_attribute_buffer))
+			row_num = convert::try_to<int>(*r).value_or(expected_row_num);
+		for (int i = expected_row_num; i < row_num; ++i)
+		{
+			m_emit_message(document::table_row{});
+			m_emit_message(document::close_table_row{});
+		}
+		m_last_row_num = row_num;
+		m_emit_message(document::table_row{});
+		return sheet_element::row;
+	}
+
+	sheet_element start_cell(const tokenizer& tokens)
+	{
+		int expected_col_num = m_last_col_num + 1;
+		int col_num;
+		if (parse_cell_address(tokens.attribute("r", m_attribute_buffer).value_or(""), col_num))
+		{
+			for (int i = expected_col_num; i < col_num; ++i)
+			{
+				m_emit_message(document::table_cell{});
+				m_emit_message(document::close_table_cell{});
+			}
+			m_last_col_num = col_num;
+		}
+		else
+			m_last_col_num = expected_col_num;
+		m_emit_message(document::table_cell{});
+		if (tokens.attribute("t", m_attribute_buffer) == "s")
+		{
+			if (m_shared_string_cell_depth++ == 0)
+				m_shared_string_index.clear();
+			return sheet_element::shared_string_cell;
+		}
+		return sheet_element::cell;
+	}
+
+	void end_element(sheet_element kind)
+	{
+		switch (kind)
+		{
+			case sheet_element::sheet_data:
+				m_emit_message(document::close_table{});
+				break;
+			case sheet_element::row:
+				m_emit_message(document::close_table_row{});
+				break;
+			case sheet_element::cell:
+				m_emit_message(document::close_table_cell{});
+				break;
+			case sheet_element::shared_string_cell:
+				if (--m_shared_string_cell_depth == 0)
+				{
+					int index = convert::to<int>(m_shared_string_index);
+					if (static_cast<size_t>(index) < m_strings.size())
+						m_emit_message(document::text{.text = std::string{m_strings[index]}});
+				}
+				m_emit_message(document::close_table_cell{});
+				break;
+			case sheet_element::run:
+				if (is_emitting_formatting())
+				{
+					if (m_is_underline)
+						m_emit_message(document::close_underline{});
+					if (m_is_italic)
+						m_emit_message(document::close_italic{});
+					if (m_is_bold)
+						m_emit_message(document::close_bold{});
+				}
+				reset_format();
+				break;
+			case sheet_element::run_properties:
+				--m_run_properties_depth;
+				if (is_emitting_formatting())
+				{
+					if (m_is_bold)
+						m_emit_message(document::bold{});
+					if (m_is_italic)
+						m_emit_message(document::italic{});
+					if (m_is_underline)
+						m_emit_message(document::underline{});
+				}
+				break;
+			case sheet_element::other:
+				break;
+		}
+	}
+
+	const shared_string_pool& m_strings;
+	const message_callbacks& m_emit_message;
+	element_stack<sheet_element> m_elements;
+	std::vector<bool> m_space_preserve_stack;
+	bool m_space_preserve = false;
+	size_t m_skipped_depth = 0;
+	int m_last_row_num = 0;
+	int m_last_col_num = 0;
+	bool m_is_bold = false;
+	bool m_is_italic = false;
+	bool m_is_underline = false;
+	size_t m_shared_string_cell_depth = 0;
+	size_t m_run_properties_depth = 0;
+	std::string m_shared_string_index;
+	std::string m_attribute_buffer;
+	std::string m_text_buffer;
+};
+
+// Reads tokens of a part and passes them to the handler. Returns false if the part is not encoded in UTF-8.
+template <typename Handler>
+bool scan(part_content content, Handler& handler)
+{
+	tokenizer tokens { std::move(content) };
+	if (!tokens.is_utf8())
+		return false;
+	bool is_first_token = true;
+	bool has_root = false;
+	size_t depth = 0;
+	for (;;)
+	{
+		token_type type = tokens.next();
+		switch (type)
+		{
+			case token_type::start_element:
+				throw_if(depth == 0 && has_root, "Extra content at the end of the document", errors::uninterpretable_data{});
+				has_root = true;
+				handler.start_element(tokens);
+				if (!tokens.is_empty_element())
+					++depth;
+				break;
+			case token_type::end_element:
+				handler.end_element(tokens);
+				--depth;
+				break;
+			case token_type::text:
+				if (depth > 0)
+					handler.text(tokens);
+				else
+					throw_if(!std::all_of(tokens.raw_text().begin(), tokens.raw_text().end(), is_xml_space),
+						"Text outside of the root element", errors::uninterpretable_data{});
+				break;
+			case token_type::other:
+				if (is_first_token && tokens.raw_text().starts_with("xml ") && !declares_utf8(tokens.raw_text()))
+					return false;
+				break;
+			case token_type::end_of_content:
+				throw_if(!has_root || depth > 0, "Unexpected end of XML content", errors::uninterpretable_data{});
+				return true;
+		}
+		is_first_token = false;
+	}
+}
+
+// Collects the texts of the si elements of the root element, leaving out run properties, as the XML reader path
+// does.
+class shared_strings_scanner
+{
+public:
+	void start_element(const tokenizer& tokens)
+	{
+		std::string_view name = local_name(tokens.name());
+		bool is_string = m_elements.size() == 1 && name == "si";
+		bool is_ignored = m_ignored_depth > 0 || (m_string_depth > 0 && (name == "rPr" || is_skipped_element(name)));
+		if (tokens.is_empty_element())
+		{
+			if (is_string)
+				m_strings.end_string();
+			return;
+		}
+		m_elements.push(tokens.name(), false);
+		if (is_string)
+			m_string_depth = 1;
+		else if (m_string_depth > 0)
+			++m_string_depth;
+		if (is_ignored)
+			++m_ignored_depth;
+	}
+
+	void end_element(const tokenizer& tokens)
+	{
+		m_elements.pop(tokens.name());
+		if (m_ignored_depth > 0)
+			--m_ignored_depth;
+		if (m_string_depth > 0 && --m_string_depth == 0)
+			m_strings.end_string();
+	}
+
+	void text(const tokenizer& tokens)
+	{
+		if (m_string_depth > 0 && m_ignored_depth == 0)
+			m_strings.append(tokens.text(m_text_buffer));
+	}
+
+	shared_string_pool& strings() { return m_strings; }
+
+private:
+	shared_string_pool m_strings;
+	element_stack<bool> m_elements;
+	size_t m_string_depth = 0;
+	size_t m_ignored_depth = 0;
+	std::string m_text_buffer;
+};
+
+} // anonymous namespace
+
+std::optional<shared_string_pool> scan_shared_strings(part_content content)
+{
+	log_scope();
+	shared_strings_scanner scanner;
+	if (!scan(std::move(content), scanner))
+		return std::nullopt;
+	return std::move(scanner.strings());
+}
+
+bool scan_sheet(part_content content, const shared_string_pool& strings, const message_callbacks& emit_message)
+{
+	log_scope();
+	sheet_scanner scanner { strings, emit_message };
+	return scan(std::move(content), scanner);
+}
+
+} // namespace docwire::xlsx_scanner
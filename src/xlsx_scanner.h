@@ -0,0 +1,51 @@
+/*********************************************************************************************************************************************/
+/*  DocWire SDK: Award-winning modern data processing in C++20. SourceForge Community Choice & Microsoft support. AI-driven processing.      */
+/*  Supports nearly 100 data formats, including email boxes and OCR. Boost efficiency in text extraction, web data extraction, data mining,  */
+/*  document analysis. Offline processing possible for security and confidentiality                                                          */
+/*                                                                                                                                           */
+/*  Copyright (c) SILVERCODERS Ltd, http://silvercoders.com                                                                                  */
+/*  Project homepage: https://github.com/docwire/docwire                                                                                     */
+/*                                                                                                                                           */
+/*  SPDX-License-Identifier: AGPL-3.0-only OR LicenseRef-DocWire-Commercial                                                                  */
+/*********************************************************************************************************************************************/
+
+
+#ifndef DOCWIRE_XLSX_SCANNER_H
+#define DOCWIRE_XLSX_SCANNER_H
+
+#include "message.h"
+#include "shared_string_pool.h"
+#include "xml_reader.h"
+#include <optional>
+#include <string_view>
+#include <variant>
+
+/**
+ * @brief Forward-only scanning of the worksheet and shared strings parts of XLSX files.
+ *
+ * Worksheets are a flat grid of rows and cells, so the scanner reads their markup directly, looking for tags with
+ * memchr, instead of going through the XML reader and a handler per node. It emits the same messages as
+ * odf_ooxml_parser does for the elements of SpreadsheetML. Elements of other vocabularies are treated as unknown
+ * wrappers: their text is emitted.
+ */
+namespace docwire::xlsx_scanner
+{
+
+/// Content of a part: all of it, or a function supplying it part by part for parts too large to keep in memory.
+using part_content = std::variant<std::string_view, xml::reader_input>;
+
+/**
+ * @brief Reads the strings of a shared strings part (xl/sharedStrings.xml).
+ * @return The strings, or std::nullopt if the part is not encoded in UTF-8 and has to be read by the XML reader.
+ */
+std::optional<shared_string_pool> scan_shared_strings(part_content content);
+
+/**
+ * @brief Emits the tables of a worksheet part (xl/worksheets/sheetN.xml).
+ * @return false, with nothing emitted, if the part is not encoded in UTF-8 and has to be read by the XML reader.
+ */
+bool scan_sheet(part_content content, const shared_string_pool& strings, const message_callbacks& emit_message);
+
+} // namespace docwire::xlsx_scanner
+
+#endif // DOCWIRE_XLSX_SCANNER_H
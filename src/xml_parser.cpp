@@ -52,14 +52,19 @@ void parseXmlData(const message_callbacks& emit_message, xml::children_view<safe
 	}
 }
 
-const std::vector<mime_type> supported_mime_types =
-{
-	mime_type{"application/xml"},
-	mime_type{"text/xml"}
-};
-
 } // anonymous namespace
 
+template <safety_policy safety_level>
+const std::vector<mime_type>& xml_parser<safety_level>::supported_mime_types()
+{
+	static const std::vector<mime_type> mime_types =
+	{
+		mime_type{"application/xml"},
+		mime_type{"text/xml"}
+	};
+	return mime_types;
+}
+
 template <safety_policy safety_level>
 continuation xml_parser<safety_level>::operator()(message_ptr msg, const message_callbacks& emit_message)
 {
@@ -71,7 +76,7 @@ continuation xml_parser<safety_level>::operator()(message_ptr msg, const message
 	auto& data = msg->get<data_source>();
 	data.assert_not_encrypted();
 
-	if (!data.has_highest_confidence_mime_type_in(supported_mime_types))
+	if (!data.has_highest_confidence_mime_type_in(supported_mime_types()))
 		return emit_message(std::move(msg));
 
 	log_entry();
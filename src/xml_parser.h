@@ -15,10 +15,13 @@
 #include "safety_policy.h"
 #include "chain_element.h"
 #include "xml_export.h"
+#include <vector>
 
 namespace docwire
 {
 
+struct mime_type;
+
 /**
  * @brief A parser for generic XML documents.
  * @tparam safety_level The safety policy to use.
@@ -32,6 +35,8 @@ public:
 	 * @return The continuation status.
 	 */
 	continuation operator()(message_ptr msg, const message_callbacks& emit_message) override;
+	/// MIME types of the data sources parsed by this parser. Other data sources are passed on.
+	static const std::vector<mime_type>& supported_mime_types();
 	bool is_leaf() const override { return false; }
 };
 
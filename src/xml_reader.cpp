@@ -58,6 +58,16 @@ static std::unique_ptr<xmlTextReader, decltype(&xmlFreeTextReader)> make_xml_tex
 		&xmlFreeTextReader);
 }
 
+static std::unique_ptr<xmlTextReader, decltype(&xmlFreeTextReader)> make_xml_text_reader_safely(xmlInputReadCallback read_callback, void* context, reader_blanks blanks_option)
+{
+	std::lock_guard<std::mutex> xml_parser_init_mutex_lock(xml_parser_init_mutex);
+	static lib_xml2_init_and_cleanup init_and_cleanup{};
+	const int final_options = to_libxml_parse_options(blanks_option) | XML_PARSE_NOERROR | XML_PARSE_NOWARNING;
+	return std::unique_ptr<xmlTextReader, decltype(&xmlFreeTextReader)>(
+		xmlReaderForIO(read_callback, nullptr, context, nullptr, nullptr, final_options),
+		&xmlFreeTextReader);
+}
+
 } // anonymous namespace
 
 } // namespace docwire::xml
@@ -67,11 +77,13 @@ namespace docwire
 template<safety_policy safety_level>
 struct pimpl_impl<xml::reader<safety_level>> : pimpl_impl_base
 {
+	// Declared before m_reader, because libxml2 reads the beginning of the input when the reader is created.
+	xml::reader_input m_input;
+    std::exception_ptr m_callback_exception;
 	mutable not_null<std::unique_ptr<xmlTextReader, void (*)(xmlTextReaderPtr)>, safety_level> m_reader{nullptr, &xmlFreeTextReader};
     // This buffer holds the last string allocated by libxml2 for string_value().
     // This avoids re-allocating a std::string on every call.
     mutable checked<std::unique_ptr<xmlChar, void (*)(void*)>, safety_level> m_string_value_buffer{nullptr, xmlFree};
-    std::exception_ptr m_callback_exception;
 
     pimpl_impl(std::string_view xml_sv, xml::reader_blanks blanks_option)
         : m_reader(xml::make_xml_text_reader_safely(xml_sv, blanks_option))
@@ -79,6 +91,34 @@ struct pimpl_impl<xml::reader<safety_level>> : pimpl_impl_base
 		log::scope _{ "xml_sv"_v = xml_sv, "blanks_option"_v = blanks_option };
     }
 
+	pimpl_impl(xml::reader_input input, xml::reader_blanks blanks_option)
+		: m_input(std::move(input)), m_reader(make_xml_text_reader_for_input(blanks_option))
+	{
+		log::scope _{ "blanks_option"_v = blanks_option };
+	}
+
+	std::unique_ptr<xmlTextReader, decltype(&xmlFreeTextReader)> make_xml_text_reader_for_input(xml::reader_blanks blanks_option)
+	{
+		auto reader = xml::make_xml_text_reader_safely(&read_input, this, blanks_option);
+		if (m_callback_exception)
+			std::rethrow_exception(m_callback_exception);
+		return reader;
+	}
+
+	static int read_input(void* context, char* buffer, int len)
+	{
+		pimpl_impl& impl = *static_cast<pimpl_impl*>(context);
+		try
+		{
+			return static_cast<int>(impl.m_input(buffer, static_cast<size_t>(len)));
+		}
+		catch (const std::exception&)
+		{
+			impl.m_callback_exception = std::current_exception();
+			return -1;
+		}
+	}
+
 	std::string_view name() const
 	{
 		const xmlChar* val = xmlTextReaderConstLocalName(m_reader.get());
@@ -133,6 +173,10 @@ template<safety_policy safety_level>
 reader<safety_level>::reader(std::string_view xml_sv, reader_blanks blanks_option)
 	: with_pimpl<reader<safety_level>>(xml_sv, blanks_option) {}
 
+template<safety_policy safety_level>
+reader<safety_level>::reader(reader_input input, reader_blanks blanks_option)
+	: with_pimpl<reader<safety_level>>(std::move(input), blanks_option) {}
+
 template<safety_policy safety_level>
 bool reader<safety_level>::read_next() const
 {
@@ -13,6 +13,8 @@
 #define DOCWIRE_XML_READER_H
 
 #include "safety_policy.h"
+#include <cstddef>
+#include <functional>
 #include "pimpl.h"
 #include <string_view>
 #include "ranged.h"
@@ -24,6 +26,14 @@ namespace docwire::xml
  * @brief Options for handling blank nodes in the XML reader.
  */
 enum class reader_blanks { keep, ignore };
+
+/**
+ * @brief Source of XML content read part by part.
+ *
+ * Copies at most size bytes of the content to buffer and returns their number, or 0 at the end of the content.
+ * Exceptions thrown by the function are rethrown by the reader.
+ */
+using reader_input = std::function<std::size_t(char* buffer, std::size_t size)>;
 /**
  * @brief Represents the type of an XML node.
  */
@@ -71,6 +81,15 @@ public:
 	 */
 	explicit reader(std::string_view xml_sv, reader_blanks blanks_option = reader_blanks::keep);
 
+	/**
+	 * @brief Constructs a reader that pulls the XML content from a function while parsing.
+	 *
+	 * Only a small window of the content is kept in memory, so documents larger than available memory can be read.
+	 * @param input The function supplying the XML content.
+	 * @param blanks_option Specifies whether to keep or ignore blank nodes (default: keep).
+	 */
+	explicit reader(reader_input input, reader_blanks blanks_option = reader_blanks::keep);
+
 	// Public low-level methods
 	/**
 	 * @brief Advances the reader to the next node.
@@ -11,203 +11,482 @@
 
 #include "zip_reader.h"
 
+#include <algorithm>
+#include <cstring>
+#include "error_tags.h"
+#include <exception>
+#include <future>
+#include "log_entry.h"
 #include "log_scope.h"
 #include <map>
+#include <memory>
+#include <mutex>
 #include "serialization_data_source.h" // IWYU pragma: keep
-#include <stdio.h>
-#include <stdlib.h>
-#include <string.h>
 #include "throw_if.h"
 #include <vector>
-#include "unzip.h"
+#include <zlib.h>
 
 namespace docwire
 {
 
-const int CASESENSITIVITY = 1;
+namespace
+{
+
+// Members smaller than this are decompressed faster than a thread is started.
+constexpr uint64_t min_prefetch_size = 64 * 1024;
+
+constexpr uint32_t local_header_signature = 0x04034b50;
+constexpr uint32_t central_header_signature = 0x02014b50;
+constexpr uint32_t end_of_central_directory_signature = 0x06054b50;
+constexpr uint32_t zip64_end_of_central_directory_signature = 0x06064b50;
+constexpr uint32_t zip64_end_of_central_directory_locator_signature = 0x07064b50;
+constexpr uint16_t zip64_extra_field_id = 0x0001;
 
-//data for reading from buffer (insted of file)
-struct zipped_buffer
+constexpr size_t local_header_size = 30;
+constexpr size_t central_header_size = 46;
+constexpr size_t end_of_central_directory_size = 22;
+constexpr size_t zip64_end_of_central_directory_size = 56;
+constexpr size_t zip64_end_of_central_directory_locator_size = 20;
+
+enum compression_method : uint16_t
 {
-	std::span<const std::byte> m_span;
-	size_t m_pointer;
+	stored = 0,
+	deflated = 8
 };
 
-//following static functions will be used for reading from buffer:
+constexpr uint16_t encrypted_flag = 0x0001;
 
-static voidpf buffer_open(voidpf opaque, const char* filename, int mode)
+uint16_t read_u16(std::span<const std::byte> data, size_t offset)
 {
-	log_scope(filename, mode);
-	return (voidpf)1;	//if NULL, unzip library will consider this function has failed
+	return std::to_integer<uint16_t>(data[offset]) | (std::to_integer<uint16_t>(data[offset + 1]) << 8);
 }
 
-static uLong buffer_read(voidpf opaque, voidpf stream, void* buf, uLong size)
+uint32_t read_u32(std::span<const std::byte> data, size_t offset)
 {
-	log_scope(size);
-	zipped_buffer* buffer = (zipped_buffer*)opaque;
-	if (buffer->m_span.size() < buffer->m_pointer + size)
-	{
-		size_t readed = buffer->m_span.size() - buffer->m_pointer;
-		memcpy(buf, buffer->m_span.data() + buffer->m_pointer, readed);
-		buffer->m_pointer = buffer->m_span.size();
-		return readed;
-	}
-	else
-	{
-		memcpy(buf, buffer->m_span.data() + buffer->m_pointer, size);
-		buffer->m_pointer += size;
-		return size;
-	}
-	return 0;
+	return read_u16(data, offset) | (static_cast<uint32_t>(read_u16(data, offset + 2)) << 16);
 }
 
-static uLong buffer_write(voidpf opaque, voidpf stream, const void* buf, uLong size)
+uint64_t read_u64(std::span<const std::byte> data, size_t offset)
 {
-	log_scope(size);
-	return 0;	//unimplemented, we dont need this
+	return read_u32(data, offset) | (static_cast<uint64_t>(read_u32(data, offset + 4)) << 32);
 }
 
-static long buffer_tell(voidpf opaque, voidpf stream)
+struct zip_entry
 {
-	log_scope();
-	return ((zipped_buffer*)opaque)->m_pointer;
-}
+	// Position of the name in the archive, not a view: the directory is shared by data_source copies
+	// that can hold the archive in different memory.
+	uint64_t name_offset;
+	uint16_t name_length;
+	uint16_t flags;
+	uint16_t method;
+	uint64_t compressed_size;
+	uint64_t uncompressed_size;
+	uint64_t local_header_offset;
+};
 
-static long buffer_seek(voidpf opaque, voidpf stream, uLong offset, int origin)
+// Central directory cached in the data_source, so that content type detectors and the parser read it once.
+// Directory of a damaged archive is cached with the error.
+struct zip_directory
 {
-	log_scope(offset, origin);
-	zipped_buffer* buffer = (zipped_buffer*)opaque;
-	size_t position;
-	switch (origin)
+	// Sorted by name. Entries with the same name keep the order of the central directory.
+	std::vector<zip_entry> entries;
+	std::exception_ptr error;
+};
+
+// Decompresses one member part by part. It cannot be moved, because zlib keeps a pointer to the z_stream.
+class chunk_reader
+{
+public:
+	chunk_reader(std::span<const std::byte> data, bool deflated)
+		: m_data(data), m_deflated(deflated)
 	{
-		case ZLIB_FILEFUNC_SEEK_CUR :
-			position = buffer->m_pointer + offset;
-			break;
-		case ZLIB_FILEFUNC_SEEK_END :
-			position = buffer->m_span.size() - offset;
-			break;
-		case ZLIB_FILEFUNC_SEEK_SET :
-			position = offset;
-			break;
-		default:
-			return -1;
+		if (m_deflated)
+		{
+			m_stream.next_in = reinterpret_cast<Bytef*>(const_cast<std::byte*>(m_data.data()));
+			m_stream.avail_in = static_cast<uInt>(std::min<size_t>(m_data.size(), UINT_MAX));
+			throw_if (inflateInit2(&m_stream, -MAX_WBITS) != Z_OK, "inflateInit2 failed");
+		}
 	}
-	if (position > buffer->m_span.size())
-		position = buffer->m_span.size();
-	buffer->m_pointer = position;
-	return 0;
-}
 
-static int buffer_close(voidpf opaque, voidpf stream)
-{
-	log_scope();
-	return 0;
-}
+	~chunk_reader()
+	{
+		if (m_deflated)
+			inflateEnd(&m_stream);
+	}
 
-static int buffer_error(voidpf opaque, voidpf stream)
-{
-	log_scope();
-	return 0;	//no errors at all?
-}
+	chunk_reader(const chunk_reader&) = delete;
+	chunk_reader& operator=(const chunk_reader&) = delete;
+
+	// Returns number of bytes read, which is less than size only at the end of the member, or std::nullopt on error.
+	std::optional<size_t> read(char* contents, size_t size)
+	{
+		if (!m_deflated)
+		{
+			size = std::min(size, m_data.size() - m_stored_position);
+			std::memcpy(contents, m_data.data() + m_stored_position, size);
+			m_stored_position += size;
+			return size;
+		}
+		uInt requested = static_cast<uInt>(std::min<size_t>(size, UINT_MAX));
+		m_stream.next_out = reinterpret_cast<Bytef*>(contents);
+		m_stream.avail_out = requested;
+		while (m_stream.avail_out > 0)
+		{
+			if (m_stream.avail_in == 0)
+			{
+				size_t consumed = reinterpret_cast<const std::byte*>(m_stream.next_in) - m_data.data();
+				m_stream.avail_in = static_cast<uInt>(std::min<size_t>(m_data.size() - consumed, UINT_MAX));
+			}
+			int res = inflate(&m_stream, Z_NO_FLUSH);
+			if (res == Z_STREAM_END)
+				break;
+			if (res != Z_OK)
+				return std::nullopt;
+		}
+		return requested - m_stream.avail_out;
+	}
+
+private:
+	std::span<const std::byte> m_data;
+	bool m_deflated;
+	size_t m_stored_position = 0;
+	z_stream m_stream{};
+};
+
+} // anonymous namespace
 
 template<>
 struct pimpl_impl<zip_reader> : pimpl_impl_base
 {
-	unzFile ArchiveFile;
-	std::map<std::string, unz_file_pos> m_directory;
-	bool m_opened_for_chunks;
+	const data_source& m_data;
 	std::span<const std::byte> m_span;
-	zipped_buffer* m_zipped_buffer;
+	std::shared_ptr<const zip_directory> m_directory = std::make_shared<const zip_directory>();
+
+	// Member being read by readChunk().
+	std::unique_ptr<chunk_reader> m_chunk_reader;
+
+	mutable std::mutex m_prefetch_mutex;
+	mutable std::map<std::string, std::future<std::optional<std::string>>, std::less<>> m_prefetched;
+
+	explicit pimpl_impl(const data_source& data)
+		: m_data{data}
+	{}
+
+	std::vector<zip_entry> read_central_directory() const
+	{
+		log_scope(m_span.size());
+		throw_if (m_span.size() < end_of_central_directory_size, "Could not open zip archive", "File is too small", errors::uninterpretable_data{});
+		size_t search_end = m_span.size() - end_of_central_directory_size;
+		size_t search_begin = search_end > 0xFFFF ? search_end - 0xFFFF : 0;
+		std::optional<size_t> eocd_pos;
+		for (size_t pos = search_end + 1; pos-- > search_begin;)
+			if (read_u32(m_span, pos) == end_of_central_directory_signature)
+			{
+				eocd_pos = pos;
+				break;
+			}
+		throw_if (!eocd_pos, "Could not open zip archive", "End of central directory not found", errors::uninterpretable_data{});
+		uint64_t cd_size = read_u32(m_span, *eocd_pos + 12);
+		uint64_t cd_offset = read_u32(m_span, *eocd_pos + 16);
+		size_t directory_end_pos = *eocd_pos;
+		if ((cd_size == 0xFFFFFFFF || cd_offset == 0xFFFFFFFF || read_u16(m_span, *eocd_pos + 10) == 0xFFFF) &&
+			*eocd_pos >= zip64_end_of_central_directory_locator_size &&
+			read_u32(m_span, *eocd_pos - zip64_end_of_central_directory_locator_size) == zip64_end_of_central_directory_locator_signature)
+		{
+			uint64_t zip64_eocd_pos = read_u64(m_span, *eocd_pos - zip64_end_of_central_directory_locator_size + 8);
+			throw_if (m_span.size() < zip64_end_of_central_directory_size ||
+				zip64_eocd_pos > m_span.size() - zip64_end_of_central_directory_size ||
+				read_u32(m_span, zip64_eocd_pos) != zip64_end_of_central_directory_signature,
+				"Could not open zip archive", "Invalid ZIP64 end of central directory", errors::uninterpretable_data{});
+			cd_size = read_u64(m_span, zip64_eocd_pos + 40);
+			cd_offset = read_u64(m_span, zip64_eocd_pos + 48);
+			directory_end_pos = zip64_eocd_pos;
+		}
+		throw_if (cd_size > directory_end_pos || cd_offset > directory_end_pos - cd_size,
+			"Could not open zip archive", "Invalid central directory position", cd_offset, cd_size, errors::uninterpretable_data{});
+		// Data prepended to the archive (e.g. self-extracting archives) shifts all offsets.
+		uint64_t archive_begin = directory_end_pos - (cd_offset + cd_size);
+		size_t pos = archive_begin + cd_offset;
+		size_t cd_end = pos + cd_size;
+		std::vector<zip_entry> entries;
+		while (pos + central_header_size <= cd_end && read_u32(m_span, pos) == central_header_signature)
+		{
+			uint16_t name_length = read_u16(m_span, pos + 28);
+			uint16_t extra_length = read_u16(m_span, pos + 30);
+			uint16_t comment_length = read_u16(m_span, pos + 32);
+			size_t name_pos = pos + central_header_size;
+			throw_if (name_pos + name_length + extra_length + comment_length > cd_end,
+				"Could not open zip archive", "Central directory entry exceeds the central directory", errors::uninterpretable_data{});
+			zip_entry entry
+			{
+				.name_offset = name_pos,
+				.name_length = name_length,
+				.flags = read_u16(m_span, pos + 8),
+				.method = read_u16(m_span, pos + 10),
+				.compressed_size = read_u32(m_span, pos + 20),
+				.uncompressed_size = read_u32(m_span, pos + 24),
+				.local_header_offset = read_u32(m_span, pos + 42)
+			};
+			read_zip64_extra_field(m_span.subspan(name_pos + name_length, extra_length), entry);
+			entry.local_header_offset += archive_begin;
+			entries.push_back(entry);
+			pos = name_pos + name_length + extra_length + comment_length;
+		}
+		std::stable_sort(entries.begin(), entries.end(), [this](const zip_entry& a, const zip_entry& b) { return name(a) < name(b); });
+		log_entry(entries.size());
+		return entries;
+	}
+
+	void load_central_directory()
+	{
+		log_scope();
+		m_directory = m_data.cached<zip_directory>([this]()
+		{
+			auto directory = std::make_shared<zip_directory>();
+			try
+			{
+				directory->entries = read_central_directory();
+			}
+			catch (const std::exception&)
+			{
+				directory->error = std::current_exception();
+			}
+			return directory;
+		});
+		if (m_directory->error)
+			std::rethrow_exception(m_directory->error);
+	}
+
+	static void read_zip64_extra_field(std::span<const std::byte> extra, zip_entry& entry)
+	{
+		for (size_t pos = 0; pos + 4 <= extra.size();)
+		{
+			uint16_t id = read_u16(extra, pos);
+			uint16_t size = read_u16(extra, pos + 2);
+			if (pos + 4 + size > extra.size())
+				return;
+			if (id == zip64_extra_field_id)
+			{
+				size_t field_pos = pos + 4;
+				for (uint64_t* value : { &entry.uncompressed_size, &entry.compressed_size, &entry.local_header_offset })
+					if (*value == 0xFFFFFFFF && field_pos + 8 <= pos + 4 + size)
+					{
+						*value = read_u64(extra, field_pos);
+						field_pos += 8;
+					}
+				return;
+			}
+			pos += 4 + size;
+		}
+	}
+
+	std::string_view name(const zip_entry& entry) const
+	{
+		return { reinterpret_cast<const char*>(m_span.data() + entry.name_offset), entry.name_length };
+	}
+
+	const zip_entry* find(std::string_view file_name) const
+	{
+		const std::vector<zip_entry>& entries = m_directory->entries;
+		auto it = std::lower_bound(entries.begin(), entries.end(), file_name, [this](const zip_entry& entry, std::string_view key) { return name(entry) < key; });
+		if (it == entries.end() || name(*it) != file_name)
+			return nullptr;
+		return &*it;
+	}
+
+	// Compressed data of the entry. The local header is read here, because its extra field can differ from the central one.
+	std::optional<std::span<const std::byte>> entry_data(const zip_entry& entry) const
+	{
+		if ((entry.flags & encrypted_flag) || (entry.method != stored && entry.method != deflated))
+			return std::nullopt;
+		if (entry.local_header_offset > m_span.size() || m_span.size() - entry.local_header_offset < local_header_size ||
+			read_u32(m_span, entry.local_header_offset) != local_header_signature)
+			return std::nullopt;
+		uint64_t data_offset = entry.local_header_offset + local_header_size +
+			read_u16(m_span, entry.local_header_offset + 26) + read_u16(m_span, entry.local_header_offset + 28);
+		if (data_offset > m_span.size() || m_span.size() - data_offset < entry.compressed_size)
+			return std::nullopt;
+		return m_span.subspan(data_offset, entry.compressed_size);
+	}
+
+	// Decompresses at most max_size bytes (0 means all) of the entry. Thread-safe.
+	bool inflate_entry(const zip_entry& entry, std::string& contents, size_t max_size) const
+	{
+		log_scope(name(entry), max_size);
+		std::optional<std::span<const std::byte>> data = entry_data(entry);
+		if (!data)
+			return false;
+		if (entry.method == stored)
+		{
+			size_t size = max_size > 0 ? std::min<size_t>(max_size, data->size()) : data->size();
+			contents.assign(reinterpret_cast<const char*>(data->data()), size);
+			return true;
+		}
+		// Deflate cannot compress better than about 1:1032, so a wrong size in a damaged header cannot make us
+		// allocate much more than needed.
+		uint64_t expected_size = std::min<uint64_t>(entry.uncompressed_size, data->size() * 1032 + 64);
+		if (max_size > 0)
+			expected_size = std::min<uint64_t>(expected_size, max_size);
+		contents.resize(std::max<uint64_t>(expected_size, 1));
+		z_stream stream{};
+		if (inflateInit2(&stream, -MAX_WBITS) != Z_OK)
+			return false;
+		stream.next_in = reinterpret_cast<Bytef*>(const_cast<std::byte*>(data->data()));
+		size_t produced = 0;
+		int res = Z_OK;
+		for (size_t consumed = 0; res == Z_OK;)
+		{
+			if (produced == contents.size())
+			{
+				if (max_size > 0 && produced >= max_size)
+					break;
+				size_t new_size = contents.size() * 2;
+				contents.resize(max_size > 0 ? std::min(new_size, max_size) : new_size);
+			}
+			uInt in_chunk = static_cast<uInt>(std::min<size_t>(data->size() - consumed, UINT_MAX));
+			uInt out_chunk = static_cast<uInt>(std::min<size_t>(contents.size() - produced, UINT_MAX));
+			stream.avail_in = in_chunk;
+			stream.next_out = reinterpret_cast<Bytef*>(contents.data() + produced);
+			stream.avail_out = out_chunk;
+			res = inflate(&stream, Z_NO_FLUSH);
+			consumed += in_chunk - stream.avail_in;
+			produced += out_chunk - stream.avail_out;
+			if (res == Z_BUF_ERROR && stream.avail_out > 0)
+				break;
+			if (res == Z_BUF_ERROR)
+				res = Z_OK;
+		}
+		inflateEnd(&stream);
+		contents.resize(produced);
+		return res == Z_STREAM_END || (max_size > 0 && produced >= max_size);
+	}
+
+	std::optional<std::optional<std::string>> take_prefetched(std::string_view file_name) const
+	{
+		std::future<std::optional<std::string>> future;
+		{
+			std::lock_guard<std::mutex> lock{m_prefetch_mutex};
+			auto it = m_prefetched.find(file_name);
+			if (it == m_prefetched.end())
+				return std::nullopt;
+			future = std::move(it->second);
+			m_prefetched.erase(it);
+		}
+		return future.get();
+	}
+
+	std::unique_ptr<chunk_reader> make_chunk_reader(const std::string& file_name) const
+	{
+		const zip_entry* entry = find(file_name);
+		if (!entry)
+			return nullptr;
+		std::optional<std::span<const std::byte>> data = entry_data(*entry);
+		if (!data)
+			return nullptr;
+		return std::make_unique<chunk_reader>(*data, entry->method == deflated);
+	}
 };
 
 zip_reader::zip_reader(const data_source& data)
+	: with_pimpl<zip_reader>(data)
 {
-		log_scope(data);
-		impl().m_opened_for_chunks = false;
-		impl().m_span = data.span();
-		impl().ArchiveFile = NULL;
-		impl().m_zipped_buffer = NULL;
+	log_scope(data);
+	impl().m_span = data.span();
+	// Central directory is at the end of the archive and members are read in any order.
+	data.advise(access_pattern::random);
 }
 
 zip_reader::~zip_reader()
 {
 	log_scope();
-	if (impl().ArchiveFile != NULL)
-		unzClose(impl().ArchiveFile);
-	if (impl().m_zipped_buffer != NULL)
-		delete impl().m_zipped_buffer;
 }
 
 void zip_reader::open()
 {
-		log_scope();
-		impl().m_zipped_buffer = new zipped_buffer;
-		impl().m_zipped_buffer->m_span = impl().m_span;
-		impl().m_zipped_buffer->m_pointer = 0;
-		zlib_filefunc_def read_from_buffer_functions;
-		read_from_buffer_functions.zopen_file = &buffer_open;
-		read_from_buffer_functions.zread_file = &buffer_read;
-		read_from_buffer_functions.zwrite_file = &buffer_write;
-		read_from_buffer_functions.ztell_file = &buffer_tell;
-		read_from_buffer_functions.zseek_file = &buffer_seek;
-		read_from_buffer_functions.zclose_file = &buffer_close;
-		read_from_buffer_functions.zerror_file = &buffer_error;
-		read_from_buffer_functions.opaque = impl().m_zipped_buffer;
-		//this function allows us to override default behaviour (reading from hard disc)
-		impl().ArchiveFile = unzOpen2("stream", &read_from_buffer_functions);
-	throw_if (impl().ArchiveFile == NULL, "Could not open zip archive");
+	log_scope();
+	impl().load_central_directory();
 }
 
 bool zip_reader::exists(const std::string& file_name) const
 {
 	log_scope(file_name);
-	return (unzLocateFile(impl().ArchiveFile, file_name.c_str(), CASESENSITIVITY) == UNZ_OK);
+	return impl().find(file_name) != nullptr;
 }
 
-bool zip_reader::read(const std::string& file_name, std::string* contents, int num_of_chars)
+bool zip_reader::read(const std::string& file_name, std::string* contents, int num_of_chars) const
 {
 	log_scope(file_name, num_of_chars);
-	int res;
-	if (impl().m_directory.size() > 0)
+	if (num_of_chars <= 0)
 	{
-		std::map<std::string, unz_file_pos>::iterator i = impl().m_directory.find(file_name);
-		if (i == impl().m_directory.end())
-			return false;
-		res = unzGoToFilePos(impl().ArchiveFile, &i->second);
+		if (std::optional<std::optional<std::string>> prefetched = impl().take_prefetched(file_name))
+		{
+			if (!*prefetched)
+				return false;
+			*contents = std::move(**prefetched);
+			return true;
+		}
 	}
-	else
-		res = unzLocateFile(impl().ArchiveFile, file_name.c_str(), CASESENSITIVITY);
-	if (res != UNZ_OK)
-		return false;
-	res = unzOpenCurrentFile(impl().ArchiveFile);
-	if (res != UNZ_OK)
+	const zip_entry* entry = impl().find(file_name);
+	if (!entry)
 		return false;
-	*contents = "";
-	char buffer[1024 + 1];
-	while((res = unzReadCurrentFile(impl().ArchiveFile, buffer, (num_of_chars > 0 && num_of_chars < 1024) ? num_of_chars : 1024)) > 0)
+	return impl().inflate_entry(*entry, *contents, num_of_chars > 0 ? num_of_chars : 0);
+}
+
+std::optional<std::string_view> zip_reader::read_view(const std::string& file_name, std::string& buffer) const
+{
+	log_scope(file_name);
+	const zip_entry* entry = impl().find(file_name);
+	if (!entry)
+		return std::nullopt;
+	if (entry->method == stored)
 	{
-		buffer[res] = '\0';
-		*contents += buffer;
-		if (num_of_chars > 0)
-			if (contents->length() >= num_of_chars)
-			{
-				*contents = contents->substr(0, num_of_chars);
-				break;
-			}
+		std::optional<std::span<const std::byte>> data = impl().entry_data(*entry);
+		if (!data)
+			return std::nullopt;
+		return std::string_view{ reinterpret_cast<const char*>(data->data()), data->size() };
 	}
-	if (res < 0)
+	if (!read(file_name, &buffer))
+		return std::nullopt;
+	return std::string_view{buffer};
+}
+
+void zip_reader::prefetch(const std::vector<std::string>& file_names)
+{
+	log_scope(file_names);
+	std::lock_guard<std::mutex> lock{impl().m_prefetch_mutex};
+	for (const std::string& file_name : file_names)
 	{
-		unzCloseCurrentFile(impl().ArchiveFile);
-		return false;
+		const zip_entry* entry = impl().find(file_name);
+		if (!entry || entry->method != deflated || entry->uncompressed_size < min_prefetch_size || impl().m_prefetched.contains(file_name))
+			continue;
+		impl().m_prefetched.emplace(file_name, std::async(std::launch::async, [&impl = impl(), entry]()
+		{
+			std::string contents;
+			if (!impl.inflate_entry(*entry, contents, 0))
+				return std::optional<std::string>{};
+			return std::optional<std::string>{std::move(contents)};
+		}));
 	}
-	unzCloseCurrentFile(impl().ArchiveFile);
-	return true;
+}
+
+std::optional<std::function<size_t(char* buffer, size_t size)>> zip_reader::read_stream(const std::string& file_name) const
+{
+	log_scope(file_name);
+	std::shared_ptr<chunk_reader> reader = impl().make_chunk_reader(file_name);
+	if (!reader)
+		return std::nullopt;
+	return [reader, file_name](char* buffer, size_t size)
+	{
+		std::optional<size_t> read_size = reader->read(buffer, size);
+		throw_if (!read_size, "Could not decompress file from ZIP archive", file_name, errors::uninterpretable_data{});
+		return *read_size;
+	};
 }
 
 void zip_reader::closeReadingFileForChunks()
 {
 	log_scope();
-	impl().m_opened_for_chunks = false;
+	impl().m_chunk_reader.reset();
 }
 
 bool zip_reader::readChunk(const std::string& file_name, char* contents, int num_of_chars, int& readed, bool add_null_terminator)
@@ -218,42 +497,19 @@ bool zip_reader::readChunk(const std::string& file_name, char* contents, int num
 		readed = 0;
 		return true;
 	}
-
-	if (impl().m_opened_for_chunks == false)
-	{
-		int res;
-		if (impl().m_directory.size() > 0)
-		{
-			std::map<std::string, unz_file_pos>::iterator i = impl().m_directory.find(file_name);
-			if (i == impl().m_directory.end())
-				return false;
-			res = unzGoToFilePos(impl().ArchiveFile, &i->second);
-		}
-		else
-			res = unzLocateFile(impl().ArchiveFile, file_name.c_str(), CASESENSITIVITY);
-		if (res != UNZ_OK)
-			return false;
-		res = unzOpenCurrentFile(impl().ArchiveFile);
-		if (res != UNZ_OK)
-			return false;
-		impl().m_opened_for_chunks = true;
-	}
-	readed = unzReadCurrentFile(impl().ArchiveFile, contents, num_of_chars);
-	if (readed < 0)
-	{
-		unzCloseCurrentFile(impl().ArchiveFile);
+	if (!impl().m_chunk_reader && !(impl().m_chunk_reader = impl().make_chunk_reader(file_name)))
 		return false;
-	}
-	if(readed < num_of_chars)	//end of file detected
+	std::optional<size_t> read_size = impl().m_chunk_reader->read(contents, num_of_chars);
+	if (!read_size)
 	{
-		if (add_null_terminator)
-			contents[readed] = '\0';
-		unzCloseCurrentFile(impl().ArchiveFile);
-		impl().m_opened_for_chunks = false;
-		return true;
+		impl().m_chunk_reader.reset();
+		return false;
 	}
+	readed = static_cast<int>(*read_size);
 	if (add_null_terminator)
 		contents[readed] = '\0';
+	if (readed < num_of_chars)	//end of file detected
+		impl().m_chunk_reader.reset();
 	return true;
 }
 
@@ -274,46 +530,16 @@ bool zip_reader::readChunk(const std::string& file_name, std::string* contents,
 bool zip_reader::getFileSize(const std::string& file_name, unsigned long& file_size)
 {
 	log_scope(file_name);
-	int res;
-	unz_file_info file_info;
-	if (impl().m_directory.size() > 0)
-	{
-		std::map<std::string, unz_file_pos>::iterator i = impl().m_directory.find(file_name);
-		if (i == impl().m_directory.end())
-			return false;
-		res = unzGoToFilePos(impl().ArchiveFile, &i->second);
-	}
-	else
-		res = unzLocateFile(impl().ArchiveFile, file_name.c_str(), CASESENSITIVITY);
-	if (res != UNZ_OK)
-		return false;
-	if (unzGetCurrentFileInfo(impl().ArchiveFile, &file_info, NULL, 0, NULL, 0, NULL, 0) != UNZ_OK)
+	const zip_entry* entry = impl().find(file_name);
+	if (!entry)
 		return false;
-	file_size = file_info.uncompressed_size;
+	file_size = entry->uncompressed_size;
 	return true;
 }
 
 bool zip_reader::loadDirectory()
 {
 	log_scope();
-	impl().m_directory.clear();
-	if (unzGoToFirstFile(impl().ArchiveFile) != UNZ_OK)
-		return false;
-	for (;;)
-	{
-		char name[1024];
-		if (unzGetCurrentFileInfo(impl().ArchiveFile, NULL, name, 1024, NULL, 0, NULL, 0) != UNZ_OK)
-			return false;
-		unz_file_pos pos;
-		if (unzGetFilePos(impl().ArchiveFile, &pos) != UNZ_OK)
-			return false;
-		impl().m_directory[name] = pos;
-		int res = unzGoToNextFile(impl().ArchiveFile);
-		if (res == UNZ_END_OF_LIST_OF_FILE)
-			break;
-		if (res != UNZ_OK)
-			return false;
-	}
 	return true;
 }
 
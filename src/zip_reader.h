@@ -14,12 +14,25 @@
 
 #include "core_export.h"
 #include "data_source.h"
+#include <functional>
+#include <optional>
 #include <string>
+#include <string_view>
 #include "pimpl.h"
+#include <vector>
 
 namespace docwire
 {
 
+/**
+	Reads files from a ZIP archive in memory.
+
+	open() indexes the central directory of the archive. The index is cached in the data_source, so readers opened
+	later on the same data (e.g. by the parser after content type detection) do not read the directory again.
+	The data_source must outlive the reader. Files can then be read in any order, and read() and
+	read_view() may be called from many threads at once to decompress different files concurrently.
+	readChunk() reads one file at a time and must not be used concurrently.
+**/
 class DOCWIRE_CORE_EXPORT zip_reader : public with_pimpl<zip_reader>
 {
 	public:
@@ -27,13 +40,32 @@ class DOCWIRE_CORE_EXPORT zip_reader : public with_pimpl<zip_reader>
 		~zip_reader();
 		void open();
 		bool exists(const std::string& file_name) const;
-		bool read(const std::string& file_name, std::string* contents, int num_of_chars = 0);
+		bool read(const std::string& file_name, std::string* contents, int num_of_chars = 0) const;
+		/**
+			Returns contents of the file or std::nullopt if it does not exist or cannot be decompressed.
+			Files stored without compression are returned as a view of the archive, others are decompressed to the
+			buffer, so the view is valid as long as the archive data and the buffer.
+		**/
+		std::optional<std::string_view> read_view(const std::string& file_name, std::string& buffer) const;
+		/**
+			Starts decompressing the files on background threads, so the following read() and read_view() calls
+			for them do not have to wait. Files that do not exist or are too small to benefit are skipped.
+		**/
+		void prefetch(const std::vector<std::string>& file_names);
+		/**
+			Returns a function that decompresses the file part by part, or std::nullopt if the file does not exist or
+			cannot be decompressed. Every call copies at most size bytes of the file to buffer and returns their number,
+			0 at the end of the file, so only the part being processed has to be kept in memory. Unlike readChunk(),
+			any number of files can be read this way at once. The function is valid as long as the archive data.
+			@throws errors::uninterpretable_data from the function if the compressed data is damaged.
+		**/
+		std::optional<std::function<size_t(char* buffer, size_t size)>> read_stream(const std::string& file_name) const;
 		bool getFileSize(const std::string& file_name, unsigned long& file_size);
 		bool readChunk(const std::string& file_name, std::string* contents, int num_of_chars);
 		bool readChunk(const std::string& file_name, char* contents, int num_of_chars, int& readed, bool add_null_terminator = true);
 		void closeReadingFileForChunks();
 		/**
-			Load and cache zip file directory. Speed up locating files dramatically. Use before multiple read() calls.
+			Kept for compatibility. The directory is indexed by open().
 		**/
 		bool loadDirectory();
 };
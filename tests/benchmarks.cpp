@@ -0,0 +1,403 @@
+/*********************************************************************************************************************************************/
+/*  DocWire SDK: Award-winning modern data processing in C++20. SourceForge Community Choice & Microsoft support. AI-driven processing.      */
+/*  Supports nearly 100 data formats, including email boxes and OCR. Boost efficiency in text extraction, web data extraction, data mining,  */
+/*  document analysis. Offline processing possible for security and confidentiality                                                          */
+/*                                                                                                                                           */
+/*  Copyright (c) SILVERCODERS Ltd, http://silvercoders.com                                                                                  */
+/*  Project homepage: https://github.com/docwire/docwire                                                                                     */
+/*                                                                                                                                           */
+/*  SPDX-License-Identifier: AGPL-3.0-only OR LicenseRef-DocWire-Commercial                                                                  */
+/*********************************************************************************************************************************************/
+
+#include <benchmark/benchmark.h>
+#include "content_type.h"
+#include "data_source.h"
+#include "document_elements.h"
+#include <filesystem>
+#include <fstream>
+#include "input.h"
+#include <map>
+#include "office_formats_parser.h"
+#include "output.h"
+#include "parsing_chain.h"
+#include "pdf_parser.h"
+#include "plain_text_exporter.h"
+#include "ppt_parser.h"
+#include <stdexcept>
+#include <set>
+#include "static_chain.h"
+#include <thread>
+#include "transformer_func.h"
+#include <zlib.h>
+
+using namespace docwire;
+
+// Performance benchmarks based on the speed.*.gz documents. Not run by ctest, because results depend on the machine:
+//   ./docwire_benchmarks --benchmark_filter=pdf
+//   ./docwire_benchmarks --benchmark_filter=ppt
+//   ./docwire_benchmarks --benchmark_filter=chain_messages
+//   ./docwire_benchmarks --benchmark_filter=content_type_detection
+//   ./docwire_benchmarks --benchmark_filter=spreadsheet_elements
+//   ./docwire_benchmarks --benchmark_filter=xlsx_cells
+
+namespace
+{
+
+std::vector<std::byte> read_gzipped_file(const char* file_name)
+{
+	gzFile file = gzopen(file_name, "rb");
+	if (!file)
+		throw std::runtime_error(std::string{"Cannot open "} + file_name);
+	std::vector<std::byte> content;
+	std::byte buffer[64 * 1024];
+	int bytes_read;
+	while ((bytes_read = gzread(file, buffer, sizeof(buffer))) > 0)
+		content.insert(content.end(), buffer, buffer + bytes_read);
+	gzclose(file);
+	if (bytes_read < 0)
+		throw std::runtime_error(std::string{"Cannot decompress "} + file_name);
+	return content;
+}
+
+const std::vector<std::byte>& speed_pdf()
+{
+	static const std::vector<std::byte> content = read_gzipped_file("speed.pdf.gz");
+	return content;
+}
+
+size_t parse_pdf(pdf_page_prefetch page_prefetch)
+{
+	size_t page_count = 0;
+	std::vector<message_ptr> output;
+	input_chain_element{data_source{std::span<const std::byte>{speed_pdf()}, mime_type{"application/pdf"}, confidence::highest}} |
+		pdf_parser{page_prefetch} |
+		transformer_func{[&](message_ptr msg, const message_callbacks& emit_message)
+		{
+			if (msg->is<document::page>())
+				page_count++;
+			return emit_message(std::move(msg));
+		}} |
+		plain_text_exporter{} |
+		output_chain_element{output};
+	benchmark::DoNotOptimize(output);
+	return page_count;
+}
+
+// One document, pages extracted ahead of the chain by a growing number of background threads.
+void pdf_page_prefetch_scaling(benchmark::State& state)
+{
+	size_t page_count = 0;
+	for (auto _ : state)
+		page_count += parse_pdf(pdf_page_prefetch{static_cast<size_t>(state.range(0))});
+	state.SetItemsProcessed(page_count);
+}
+
+// Independent documents parsed concurrently, one per benchmark thread.
+void pdf_concurrent_documents(benchmark::State& state)
+{
+	size_t page_count = 0;
+	for (auto _ : state)
+		page_count += parse_pdf(pdf_page_prefetch{0});
+	state.SetItemsProcessed(page_count);
+}
+
+// Text extraction from speed.ppt, dominated by reading records from the OLE streams.
+void ppt_text_extraction(benchmark::State& state)
+{
+	static const std::vector<std::byte> content = read_gzipped_file("speed.ppt.gz");
+	for (auto _ : state)
+	{
+		std::vector<message_ptr> output;
+		input_chain_element{data_source{std::span<const std::byte>{content}, mime_type{"application/vnd.ms-powerpoint"}, confidence::highest}} |
+			ppt_parser{} | plain_text_exporter{} | output_chain_element{output};
+		benchmark::DoNotOptimize(output);
+	}
+	state.SetBytesProcessed(state.iterations() * content.size());
+}
+
+// Elements of the chain overhead benchmarks. They do almost nothing, so the time is spent passing messages.
+struct generate_texts { size_t count; };
+
+class text_generator final : public chain_element
+{
+public:
+	continuation operator()(message_ptr msg, const message_callbacks& emit_message) override
+	{
+		if (!msg->is<generate_texts>())
+			return emit_message(std::move(msg));
+		for (size_t i = 0; i < msg->get<generate_texts>().count; ++i)
+			if (emit_message(document::text{.text = "cell"}) == continuation::stop)
+				return continuation::stop;
+		return continuation::proceed;
+	}
+	bool is_leaf() const override { return false; }
+};
+
+class pass_through final : public chain_element
+{
+public:
+	continuation operator()(message_ptr msg, const message_callbacks& emit_message) override
+	{
+		return emit_message(std::move(msg));
+	}
+	bool is_leaf() const override { return false; }
+};
+
+class text_counter final : public chain_element
+{
+public:
+	explicit text_counter(size_t& count) : m_count{count} {}
+	continuation operator()(message_ptr msg, const message_callbacks& emit_message) override
+	{
+		if (msg->is<document::text>())
+			++m_count;
+		return continuation::proceed;
+	}
+	bool is_leaf() const override { return true; }
+private:
+	size_t& m_count;
+};
+
+constexpr size_t texts_per_run = 100000;
+
+// Messages per second through generator | pass_through | pass_through | counter built with operator|.
+void dynamic_chain_messages(benchmark::State& state)
+{
+	size_t count = 0;
+	parsing_chain chain = text_generator{} | pass_through{} | pass_through{} | text_counter{count};
+	for (auto _ : state)
+		chain(make_message(generate_texts{texts_per_run}));
+	state.SetItemsProcessed(count);
+}
+
+// The same elements in a static_chain.
+void static_chain_messages(benchmark::State& state)
+{
+	size_t count = 0;
+	static_chain chain{text_generator{}, pass_through{}, pass_through{}, text_counter{count}};
+	for (auto _ : state)
+		chain(make_message(generate_texts{texts_per_run}));
+	state.SetItemsProcessed(count);
+}
+
+// Documents of the test corpus loaded to memory, without file names, as they arrive from network streams.
+const std::vector<std::vector<std::byte>>& detection_corpus()
+{
+	static const std::vector<std::vector<std::byte>> corpus = []()
+	{
+		const std::set<std::string> extensions { ".doc", ".docx", ".xls", ".xlsx", ".xlsb", ".ppt", ".pptx",
+			".odt", ".ods", ".odp", ".odg", ".fodt", ".fods", ".fodp", ".fodg", ".rtf", ".pdf", ".pages", ".numbers",
+			".key", ".eml", ".pst", ".html", ".png", ".jpg", ".tiff", ".bmp", ".webp", ".zip", ".tar", ".rar", ".7z" };
+		std::vector<std::vector<std::byte>> corpus;
+		for (const auto& entry : std::filesystem::directory_iterator{"."})
+			if (entry.is_regular_file() && extensions.contains(entry.path().extension().string()))
+			{
+				std::ifstream file{entry.path(), std::ios::binary};
+				std::vector<std::byte> content(entry.file_size());
+				file.read(reinterpret_cast<char*>(content.data()), content.size());
+				corpus.push_back(std::move(content));
+			}
+		return corpus;
+	}();
+	return corpus;
+}
+
+// Full content type detection of every corpus document. ZIP-based documents are inspected by several detectors.
+void content_type_detection(benchmark::State& state)
+{
+	const std::vector<std::vector<std::byte>>& corpus = detection_corpus();
+	content_type::by_signature::database signatures_db;
+	for (auto _ : state)
+		for (const std::vector<std::byte>& content : corpus)
+		{
+			data_source data{std::span<const std::byte>{content}};
+			content_type::detect(data, signatures_db);
+			benchmark::DoNotOptimize(data.mime_types);
+		}
+	state.SetItemsProcessed(state.iterations() * corpus.size());
+}
+
+class element_counter final : public chain_element
+{
+public:
+	explicit element_counter(size_t& count) : m_count{count} {}
+	continuation operator()(message_ptr msg, const message_callbacks& emit_message) override
+	{
+		++m_count;
+		return continuation::proceed;
+	}
+	bool is_leaf() const override { return true; }
+private:
+	size_t& m_count;
+};
+
+// Spreadsheets emit many small elements, so the cost of passing them out of the composite parser is visible.
+const std::vector<std::pair<std::vector<std::byte>, mime_type>>& spreadsheet_corpus()
+{
+	static const std::vector<std::pair<std::vector<std::byte>, mime_type>> corpus
+	{
+		{ read_gzipped_file("speed.xls.gz"), mime_type{"application/vnd.ms-excel"} },
+		{ read_gzipped_file("speed.xlsx.gz"), mime_type{"application/vnd.openxmlformats-officedocument.spreadsheetml.sheet"} },
+		{ read_gzipped_file("speed.xlsb.gz"), mime_type{"application/vnd.ms-excel.sheet.binary.macroenabled.12"} },
+		{ read_gzipped_file("speed.ods.gz"), mime_type{"application/vnd.oasis.opendocument.spreadsheet"} }
+	};
+	return corpus;
+}
+
+void parse_spreadsheets(benchmark::State& state, chain_element& parser)
+{
+	size_t count = 0;
+	for (auto _ : state)
+		for (const auto& [content, type] : spreadsheet_corpus())
+			input_chain_element{data_source{std::span<const std::byte>{content}, type, confidence::highest}} |
+				parser | element_counter{count};
+	state.SetItemsProcessed(count);
+}
+
+// Elements per second of the office formats parsers joined into a linear chain, as office_formats_parser was before.
+void spreadsheet_elements_linear_chain(benchmark::State& state)
+{
+	parsing_chain parser = html_parser{} | doc_parser{} | pdf_parser{} | xls_parser{} | xlsb_parser{} |
+		iwork_parser{} | ppt_parser{} | rtf_parser{} | odf_ooxml_parser{} | odfxml_parser{} | xml_parser{} |
+		txt_parser{};
+	parse_spreadsheets(state, parser);
+}
+
+// The same parsers behind the MIME type dispatcher of office_formats_parser.
+void spreadsheet_elements_dispatcher(benchmark::State& state)
+{
+	office_formats_parser parser;
+	parse_spreadsheets(state, parser);
+}
+
+void append_u16(std::string& zip, uint16_t value)
+{
+	zip += static_cast<char>(value & 0xff);
+	zip += static_cast<char>(value >> 8);
+}
+
+void append_u32(std::string& zip, uint32_t value)
+{
+	append_u16(zip, value & 0xffff);
+	append_u16(zip, value >> 16);
+}
+
+// ZIP archive with uncompressed members, so that generating large workbooks takes little time.
+std::string stored_zip(const std::vector<std::pair<std::string, std::string>>& members)
+{
+	std::string zip;
+	std::string central_directory;
+	for (const auto& [name, content] : members)
+	{
+		uint32_t crc = crc32(0, reinterpret_cast<const Bytef*>(content.data()), static_cast<uInt>(content.size()));
+		uint32_t offset = static_cast<uint32_t>(zip.size());
+		append_u32(zip, 0x04034b50);
+		for (uint16_t field : {20, 0, 0, 0, 0})
+			append_u16(zip, field);
+		append_u32(zip, crc);
+		append_u32(zip, static_cast<uint32_t>(content.size()));
+		append_u32(zip, static_cast<uint32_t>(content.size()));
+		append_u16(zip, static_cast<uint16_t>(name.size()));
+		append_u16(zip, 0);
+		zip += name;
+		zip += content;
+		append_u32(central_directory, 0x02014b50);
+		for (uint16_t field : {20, 20, 0, 0, 0, 0})
+			append_u16(central_directory, field);
+		append_u32(central_directory, crc);
+		append_u32(central_directory, static_cast<uint32_t>(content.size()));
+		append_u32(central_directory, static_cast<uint32_t>(content.size()));
+		append_u16(central_directory, static_cast<uint16_t>(name.size()));
+		for (uint16_t field : {0, 0, 0, 0})
+			append_u16(central_directory, field);
+		append_u32(central_directory, 0);
+		append_u32(central_directory, offset);
+		central_directory += name;
+	}
+	uint32_t central_directory_offset = static_cast<uint32_t>(zip.size());
+	zip += central_directory;
+	append_u32(zip, 0x06054b50);
+	append_u16(zip, 0);
+	append_u16(zip, 0);
+	append_u16(zip, static_cast<uint16_t>(members.size()));
+	append_u16(zip, static_cast<uint16_t>(members.size()));
+	append_u32(zip, static_cast<uint32_t>(central_directory.size()));
+	append_u32(zip, central_directory_offset);
+	append_u16(zip, 0);
+	return zip;
+}
+
+constexpr int xlsx_columns = 10;
+
+// Workbook with one sheet of the given number of rows. Every second cell refers to a shared string.
+const std::string& generated_xlsx(int row_count)
+{
+	static std::map<int, std::string> workbooks;
+	auto it = workbooks.find(row_count);
+	if (it != workbooks.end())
+		return it->second;
+	constexpr int shared_string_count = 1000;
+	std::string shared_strings = "<?xml version=\"1.0\" encoding=\"UTF-8\" standalone=\"yes\"?>\n"
+		"<sst xmlns=\"http://schemas.openxmlformats.org/spreadsheetml/2006/main\">";
+	for (int i = 0; i < shared_string_count; ++i)
+		shared_strings += "<si><t>Shared string " + std::to_string(i) + "</t></si>";
+	shared_strings += "</sst>";
+	std::string sheet = "<?xml version=\"1.0\" encoding=\"UTF-8\" standalone=\"yes\"?>\n"
+		"<worksheet xmlns=\"http://schemas.openxmlformats.org/spreadsheetml/2006/main\"><sheetData>";
+	for (int row = 1; row <= row_count; ++row)
+	{
+		sheet += "<row r=\"" + std::to_string(row) + "\" spans=\"1:" + std::to_string(xlsx_columns) + "\">";
+		for (int col = 0; col < xlsx_columns; ++col)
+		{
+			std::string address = static_cast<char>('A' + col) + std::to_string(row);
+			if (col % 2 == 0)
+				sheet += "<c r=\"" + address + "\" t=\"s\"><v>" + std::to_string((row * xlsx_columns + col) % shared_string_count) + "</v></c>";
+			else
+				sheet += "<c r=\"" + address + "\" s=\"1\"><v>" + std::to_string(row * col) + ".5</v></c>";
+		}
+		sheet += "</row>";
+	}
+	sheet += "</sheetData></worksheet>";
+	return workbooks.emplace(row_count, stored_zip({
+		{ "[Content_Types].xml", "<?xml version=\"1.0\" encoding=\"UTF-8\"?>"
+			"<Types xmlns=\"http://schemas.openxmlformats.org/package/2006/content-types\">"
+			"<Override PartName=\"/xl/workbook.xml\" ContentType=\"application/vnd.openxmlformats-officedocument.spreadsheetml.sheet.main+xml\"/>"
+			"</Types>" },
+		{ "xl/workbook.xml", "<?xml version=\"1.0\" encoding=\"UTF-8\"?>"
+			"<workbook xmlns=\"http://schemas.openxmlformats.org/spreadsheetml/2006/main\"><sheets><sheet name=\"Sheet1\" sheetId=\"1\"/></sheets></workbook>" },
+		{ "xl/sharedStrings.xml", shared_strings },
+		{ "xl/worksheets/sheet1.xml", sheet }
+	})).first->second;
+}
+
+// Cells per second of XLSX parsing for growing sheets. Sheets over 16 MB are decompressed and parsed part by part.
+void xlsx_cells(benchmark::State& state)
+{
+	const std::string& content = generated_xlsx(static_cast<int>(state.range(0)));
+	size_t count = 0;
+	for (auto _ : state)
+		input_chain_element{data_source{std::string_view{content}, mime_type{"application/vnd.openxmlformats-officedocument.spreadsheetml.sheet"}, confidence::highest}} |
+			odf_ooxml_parser{} | element_counter{count};
+	benchmark::DoNotOptimize(count);
+	state.SetItemsProcessed(state.iterations() * state.range(0) * xlsx_columns);
+	state.SetBytesProcessed(state.iterations() * content.size());
+}
+
+int max_threads()
+{
+	return std::max(1u, std::thread::hardware_concurrency());
+}
+
+} // anonymous namespace
+
+BENCHMARK(pdf_page_prefetch_scaling)->RangeMultiplier(2)->Range(0, max_threads())->UseRealTime()->Unit(benchmark::kMillisecond);
+BENCHMARK(pdf_concurrent_documents)->ThreadRange(1, max_threads())->UseRealTime()->Unit(benchmark::kMillisecond);
+BENCHMARK(ppt_text_extraction)->Unit(benchmark::kMillisecond);
+BENCHMARK(dynamic_chain_messages)->Unit(benchmark::kMillisecond);
+BENCHMARK(static_chain_messages)->Unit(benchmark::kMillisecond);
+BENCHMARK(content_type_detection)->Unit(benchmark::kMillisecond);
+BENCHMARK(spreadsheet_elements_linear_chain)->Unit(benchmark::kMillisecond);
+BENCHMARK(spreadsheet_elements_dispatcher)->Unit(benchmark::kMillisecond);
+BENCHMARK(xlsx_cells)->RangeMultiplier(8)->Range(1 << 9, 1 << 18)->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
@@ -26,6 +26,7 @@
 #include <exception>
 #include <filesystem>
 #include <fstream>
+#include <future>
 #include <iostream>
 #include <memory>
 #include <optional>
@@ -52,6 +53,26 @@ TEST(content_type, by_file_extension)
     ));
 }
 
+TEST(content_type, by_file_extension_with_many_mime_types)
+{
+    data_source mp4 { std::filesystem::path{"CLIP.MP4"} };
+    content_type::by_file_extension::detect(mp4);
+    ASSERT_THAT(mp4.mime_types, testing::UnorderedElementsAre(
+        std::pair { mime_type { "application/mp4" }, confidence::high },
+        std::pair { mime_type { "video/mp4" }, confidence::high }
+    ));
+
+    data_source xls { std::filesystem::path{"1.xls"} };
+    content_type::by_file_extension::detect(xls);
+    ASSERT_THAT(xls.mime_types, testing::ElementsAre(
+        std::pair { mime_type { "application/vnd.ms-excel" }, confidence::medium }
+    ));
+
+    data_source unknown { std::filesystem::path{"1.unknown-extension"} };
+    content_type::by_file_extension::detect(unknown);
+    ASSERT_TRUE(unknown.mime_types.empty());
+}
+
 TEST(content_type, to_extension)
 {
     using namespace docwire::content_type::by_file_extension;
@@ -111,6 +132,27 @@ TEST(content_type, by_signature)
     }
 }
 
+TEST(content_type, by_signature_from_many_threads)
+{
+    content_type::by_signature::database db;
+    std::vector<std::future<std::vector<std::string>>> results;
+    for (int i = 0; i < 4; ++i)
+        results.push_back(std::async(std::launch::async, [&db]()
+        {
+            std::vector<std::string> mime_types;
+            for (const char* file_name : {"1.doc", "1.pdf", "1.xls", "1.odt"})
+            {
+                data_source data { seekable_stream_ptr { std::make_shared<std::ifstream>(file_name, std::ios_base::binary) } };
+                content_type::by_signature::detect(data, db);
+                mime_types.push_back(data.highest_confidence_mime_type().value_or(mime_type{""}).v);
+            }
+            return mime_types;
+        }));
+    for (auto& result : results)
+        EXPECT_THAT(result.get(), testing::ElementsAre("application/msword", "application/pdf",
+            "application/vnd.ms-excel", "application/vnd.oasis.opendocument.text"));
+}
+
 TEST(content_type, html)
 {
     data_source data { seekable_stream_ptr { std::make_shared<std::ifstream>("1.html", std::ios_base::binary) }};
@@ -13,20 +13,32 @@
 #include "convert_chrono.h" // IWYU pragma: keep
 #include "ensure.h"
 #include "lru_memory_cache.h"
+#include "message.h"
+#include "mime_type_dispatcher.h"
 #include "named.h"
 #include "not_null.h"
+#include "thread_safe_ole_storage.h"
+#include "thread_safe_ole_stream_reader.h"
+#include "tracing.h"
 #include "unique_identifier.h"
+#include "zip_reader.h"
 #include "tuple_utils.h"
 #include "ref_or_owned.h"
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
+#include <atomic>
 #include <string>
+#include <thread>
 #include <vector>
 #include <tuple>
 #include <optional>
 #include <memory>
 #include <functional>
 #include <chrono>
+#include <boost/json.hpp>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
 
 using namespace docwire;
 
@@ -59,6 +71,269 @@ TEST(lru_cache, storing_and_retrieving_values)
         ASSERT_EQ(cache.get_or_create("key" + std::to_string(i), [](const std::string& key) { return key + " new value"; }), "key" + std::to_string(i) + " cached value");
 }
 
+TEST(lru_cache, cost_budget_evicts_least_recently_used)
+{
+    lru_memory_cache<std::string, std::string> cache{10, [](const std::string& value) { return value.size(); }, 1};
+    auto produce = [](const std::string& key) { return key + key; };
+    cache.get_or_create("aa", produce); // cost 4
+    cache.get_or_create("bb", produce); // cost 4
+    cache.get_or_create("aa", produce); // "bb" is now least recently used
+    cache.get_or_create("cc", produce); // cost 4, over budget
+    auto stats = cache.stats();
+    EXPECT_EQ(stats.hits, 1);
+    EXPECT_EQ(stats.misses, 3);
+    EXPECT_EQ(stats.evictions, 1);
+    EXPECT_EQ(stats.total_cost, 8);
+    cache.get_or_create("aa", produce);
+    EXPECT_EQ(cache.stats().hits, 2);
+    cache.get_or_create("bb", produce);
+    EXPECT_EQ(cache.stats().misses, 4);
+}
+
+TEST(lru_cache, concurrent_misses_produce_once)
+{
+    lru_memory_cache<int, std::shared_ptr<int>> cache;
+    std::atomic<int> producer_calls { 0 };
+    std::vector<std::thread> threads;
+    std::vector<std::shared_ptr<int>> results(8);
+    for (size_t i = 0; i < results.size(); i++)
+        threads.emplace_back([&, i]()
+        {
+            results[i] = cache.get_or_create(42, [&](int key)
+            {
+                ++producer_calls;
+                std::this_thread::sleep_for(std::chrono::milliseconds(50));
+                return std::make_shared<int>(key);
+            });
+        });
+    for (auto& thread : threads)
+        thread.join();
+    EXPECT_EQ(producer_calls, 1);
+    for (const auto& result : results)
+        EXPECT_EQ(result, results[0]);
+    EXPECT_EQ(cache.stats().misses, 1);
+    EXPECT_EQ(cache.stats().hits, results.size() - 1);
+}
+
+TEST(message, type_tag)
+{
+    message_ptr msg = make_message(std::string{"text"});
+    EXPECT_TRUE(msg->is<std::string>());
+    EXPECT_TRUE(msg->is<const std::string>());
+    EXPECT_FALSE(msg->is<int>());
+    EXPECT_EQ(msg->type_id(), message_type_id<std::string>());
+    EXPECT_EQ(msg->object_type(), typeid(std::string));
+    EXPECT_EQ(msg->get<std::string>(), "text");
+    EXPECT_NE(message_type_id<std::string>(), message_type_id<int>());
+}
+
+TEST(message, memory_is_recycled)
+{
+    message_ptr msg = make_message(std::string{"first"});
+    const message_base* first_address = msg.get();
+    msg.reset();
+    msg = make_message(std::string{"second"});
+    EXPECT_EQ(msg.get(), first_address);
+    EXPECT_EQ(msg->get<std::string>(), "second");
+}
+
+namespace
+{
+
+class recording_parser : public chain_element
+{
+public:
+    recording_parser(std::string name, std::vector<std::string>& calls, std::optional<mime_type> embedded = std::nullopt)
+        : m_name{std::move(name)}, m_calls{calls}, m_embedded{std::move(embedded)}
+    {}
+
+    continuation operator()(message_ptr msg, const message_callbacks& emit_message) override
+    {
+        m_calls.push_back(m_name);
+        if (m_embedded)
+            emit_message(data_source{std::string{"embedded"}, *m_embedded, confidence::highest});
+        return emit_message(m_name);
+    }
+
+    bool is_leaf() const override { return false; }
+
+private:
+    std::string m_name;
+    std::vector<std::string>& m_calls;
+    std::optional<mime_type> m_embedded;
+};
+
+} // anonymous namespace
+
+TEST(mime_type_dispatcher, routes_like_linear_chain)
+{
+    std::vector<std::string> calls;
+    mime_type_dispatcher dispatcher{{
+        {{mime_type{"text/html"}}, recording_parser{"html", calls, mime_type{"text/html"}}},
+        {{mime_type{"application/pdf"}}, recording_parser{"pdf", calls}},
+        {{mime_type{"text/plain"}, mime_type{"text/html"}}, recording_parser{"txt", calls}}
+    }};
+    std::vector<message_ptr> emitted;
+    message_callbacks emit_message
+    {
+        [&](message_ptr msg) { emitted.push_back(msg); return continuation::proceed; },
+        [](message_ptr) { return continuation::proceed; }
+    };
+
+    dispatcher(make_message(data_source{std::string{"%PDF"}, mime_type{"application/pdf"}, confidence::highest}), emit_message);
+    EXPECT_THAT(calls, ::testing::ElementsAre("pdf"));
+
+    // Overlapping type goes to the first parser; data sources it emits go only to the parsers following it.
+    calls.clear();
+    emitted.clear();
+    dispatcher(make_message(data_source{std::string{"<html>"}, mime_type{"text/html"}, confidence::highest}), emit_message);
+    EXPECT_THAT(calls, ::testing::ElementsAre("html", "txt"));
+    ASSERT_EQ(emitted.size(), 2);
+    EXPECT_EQ(emitted[0]->get<std::string>(), "txt");
+    EXPECT_EQ(emitted[1]->get<std::string>(), "html");
+
+    calls.clear();
+    emitted.clear();
+    dispatcher(make_message(data_source{std::string{"GIF89a"}, mime_type{"image/gif"}, confidence::highest}), emit_message);
+    dispatcher(make_message(std::string{"not a data source"}), emit_message);
+    EXPECT_TRUE(calls.empty());
+    ASSERT_EQ(emitted.size(), 2);
+    EXPECT_TRUE(emitted[0]->is<data_source>());
+    EXPECT_TRUE(emitted[1]->is<std::string>());
+
+    EXPECT_THROW(dispatcher(make_message(data_source{std::string{"?"}}), emit_message), std::exception);
+}
+
+TEST(thread_safe_ole_stream_reader, read_span_matches_read)
+{
+    std::ifstream file{"2.ppt", std::ios::binary};
+    std::vector<char> content{std::istreambuf_iterator<char>{file}, std::istreambuf_iterator<char>{}};
+    thread_safe_ole_storage file_storage{"2.ppt"};
+    thread_safe_ole_storage memory_storage{std::span<const std::byte>{reinterpret_cast<const std::byte*>(content.data()), content.size()}};
+    std::unique_ptr<thread_safe_ole_stream_reader> file_reader { static_cast<thread_safe_ole_stream_reader*>(file_storage.createStreamReader("PowerPoint Document")) };
+    std::unique_ptr<thread_safe_ole_stream_reader> memory_reader { static_cast<thread_safe_ole_stream_reader*>(memory_storage.createStreamReader("PowerPoint Document")) };
+    ASSERT_TRUE(file_reader);
+    ASSERT_TRUE(memory_reader);
+    std::vector<U8> expected(file_reader->size());
+    ASSERT_TRUE(file_reader->read(expected.data(), expected.size()));
+
+    for (size_t chunk_size : {1, 7, 500, 4096, 10000})
+    {
+        memory_reader->seek(0);
+        std::vector<U8> actual, buffer;
+        size_t zero_copy_reads = 0;
+        while (memory_reader->tell() < memory_reader->size())
+        {
+            std::optional<std::span<const U8>> view = memory_reader->read_span(std::min<size_t>(chunk_size, memory_reader->size() - memory_reader->tell()), buffer);
+            ASSERT_TRUE(view) << memory_reader->getLastError();
+            if (view->data() != buffer.data())
+                ++zero_copy_reads;
+            actual.insert(actual.end(), view->begin(), view->end());
+        }
+        EXPECT_EQ(actual, expected) << chunk_size;
+        EXPECT_GT(zero_copy_reads, 0u) << chunk_size;
+    }
+    std::vector<U8> buffer;
+    EXPECT_FALSE(memory_reader->read_span(1, buffer));
+}
+
+TEST(zip_reader, stored_views_and_parallel_reads)
+{
+    data_source data{std::filesystem::path{"1.odt"}};
+    zip_reader zipfile{data};
+    zipfile.open();
+
+    std::string buffer;
+    std::optional<std::string_view> mimetype = zipfile.read_view("mimetype", buffer);
+    ASSERT_TRUE(mimetype);
+    EXPECT_EQ(*mimetype, "application/vnd.oasis.opendocument.text");
+    EXPECT_TRUE(buffer.empty()); // stored member is a view of the archive
+    EXPECT_FALSE(zipfile.read_view("missing.xml", buffer));
+
+    std::string expected;
+    ASSERT_TRUE(zipfile.read("content.xml", &expected));
+    EXPECT_NE(expected.find("office:document-content"), std::string::npos);
+    zipfile.prefetch({"content.xml", "styles.xml"});
+    std::vector<std::string> contents(4);
+    std::vector<std::thread> threads;
+    for (std::string& content : contents)
+        threads.emplace_back([&zipfile, &content]() { zipfile.read("content.xml", &content); });
+    for (std::thread& thread : threads)
+        thread.join();
+    for (const std::string& content : contents)
+        EXPECT_EQ(content, expected);
+    std::string beginning;
+    ASSERT_TRUE(zipfile.read("content.xml", &beginning, 10));
+    EXPECT_EQ(beginning, expected.substr(0, 10));
+}
+
+TEST(zip_reader, shared_directory_outlives_original_data)
+{
+    std::ifstream file{"1.odt", std::ios::binary};
+    std::string archive{std::istreambuf_iterator<char>{file}, std::istreambuf_iterator<char>{}};
+    auto original = std::make_unique<data_source>(archive);
+    {
+        zip_reader zipfile{*original};
+        zipfile.open();
+    }
+    data_source copy = *original; // shares the cached central directory, but not the archive memory
+    original.reset();
+    zip_reader zipfile{copy};
+    zipfile.open();
+    std::string buffer;
+    std::optional<std::string_view> mimetype = zipfile.read_view("mimetype", buffer);
+    ASSERT_TRUE(mimetype);
+    EXPECT_EQ(*mimetype, "application/vnd.oasis.opendocument.text");
+    EXPECT_TRUE(zipfile.exists("content.xml"));
+}
+
+TEST(zip_reader, truncated_zip64_end_of_central_directory)
+{
+    // ZIP64 end of central directory signature, ZIP64 locator pointing at it and end of central directory
+    // with ZIP64 markers: 46 bytes, shorter than the ZIP64 end of central directory record itself.
+    std::string archive{"PK\x06\x06", 4};
+    archive += std::string{"PK\x06\x07", 4} + std::string(16, '\0');
+    archive += std::string{"PK\x05\x06", 4} + std::string(6, '\0') + std::string(4, '\xFF') + std::string(4, '\xFF') + std::string(4, '\0');
+    ASSERT_EQ(archive.size(), 46u);
+    data_source data{archive};
+    zip_reader zipfile{data};
+    EXPECT_THROW(zipfile.open(), std::exception);
+}
+
+TEST(tracing, spans_from_many_threads)
+{
+    std::filesystem::path trace_path = std::filesystem::temp_directory_path() / "docwire_tracing_test.json";
+    tracing::start(trace_path);
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 3; ++i)
+        threads.emplace_back([]()
+        {
+            for (int j = 0; j < 5000; ++j)
+            {
+                tracing::span outer{"outer"};
+                tracing::span inner{"inner"};
+            }
+        });
+    for (auto& thread : threads)
+        thread.join();
+    tracing::stop();
+
+    std::ifstream trace_file{trace_path};
+    boost::json::array events = boost::json::parse(std::string{std::istreambuf_iterator<char>{trace_file}, {}}).at("traceEvents").as_array();
+    size_t begins = 0, ends = 0, thread_names = 0;
+    for (const auto& event : events)
+    {
+        std::string_view phase = event.at("ph").as_string();
+        begins += phase == "B";
+        ends += phase == "E";
+        thread_names += phase == "M";
+    }
+    EXPECT_EQ(begins, 3u * 5000 * 2);
+    EXPECT_EQ(ends, begins);
+    EXPECT_EQ(thread_names, 3u);
+    std::filesystem::remove(trace_path);
+}
+
 TEST(Convert, Chrono)
 {
     using namespace docwire::serialization;
@@ -2,6 +2,8 @@
 #include "file_extension.h"
 #include "gtest/gtest.h"
 #include <cstddef>
+#include <filesystem>
+#include <fstream>
 #include <memory>
 #include <sstream>
 #include <string>
@@ -120,3 +122,48 @@ TEST(DataSource, incremental_seekable_stream_ptr)
 {
     test_data_source_incremental<seekable_stream_ptr>();
 }
+
+TEST(DataSource, path_memory_mapped)
+{
+    std::string test_data_str = create_datasource_test_data_str();
+    std::filesystem::path path{"data_source_path_memory_mapped.bin"};
+    std::ofstream{path, std::ios::binary} << test_data_str;
+    {
+        data_source data{path};
+        std::string_view limited = data.string_view(length_limit{256});
+        ASSERT_EQ(limited, test_data_str.substr(0, 256));
+        data.advise(access_pattern::random);
+        std::string_view full = data.string_view();
+        ASSERT_EQ(full, test_data_str);
+        // Both views point into the same mapping, no buffer was reallocated after the limited read.
+        ASSERT_EQ(limited.data(), full.data());
+        ASSERT_EQ(data.string(length_limit{4}), test_data_str.substr(0, 4));
+    }
+    std::filesystem::remove(path);
+}
+
+TEST(DataSource, path_empty_file)
+{
+    std::filesystem::path path{"data_source_path_empty_file.bin"};
+    std::ofstream{path, std::ios::binary}.close();
+    {
+        data_source data{path};
+        ASSERT_TRUE(data.span().empty());
+        ASSERT_EQ(data.string(), "");
+    }
+    std::filesystem::remove(path);
+}
+
+TEST(DataSource, cached_structure_is_shared_by_copies)
+{
+    data_source data{std::string{"cached"}};
+    int builds = 0;
+    auto build = [&builds]() { ++builds; return std::make_shared<const size_t>(42); };
+    std::shared_ptr<const size_t> first = data.cached<size_t>(build);
+    data_source copy = data;
+    std::shared_ptr<const size_t> second = copy.cached<size_t>(build);
+    ASSERT_EQ(builds, 1);
+    ASSERT_EQ(first, second);
+    ASSERT_EQ(*second, 42u);
+    ASSERT_EQ(*data.cached<int>([]() { return std::make_shared<const int>(7); }), 7);
+}
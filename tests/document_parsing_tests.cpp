@@ -37,6 +37,7 @@
 #include "ocr_parser.h"
 #include "office_formats_parser.h"
 #include "output.h"
+#include "pdf_parser.h"
 #include "plain_text_exporter.h"
 #include "transformer_func.h"
 #include "input.h"
@@ -521,3 +522,232 @@ INSTANTIATE_TEST_SUITE_P(
           std::string name = std::string{ std::get<2>(info.param) } + "_multi_page_filter_tests";
           return name;
         });
+
+TEST(pdf_parser, page_prefetch_emits_pages_in_order)
+{
+    auto parse = [](const std::string& file_name, size_t page_prefetch, int max_pages)
+    {
+        std::ostringstream output_stream{};
+        std::filesystem::path{file_name} |
+            content_type::by_file_extension::detector{} |
+            pdf_parser{pdf_page_prefetch{page_prefetch}} |
+            [max_pages, counter = 0](message_ptr msg, const message_callbacks& emit_message) mutable
+            {
+                if (msg->is<document::page>() && ++counter > max_pages)
+                    return continuation::stop;
+                return emit_message(std::move(msg));
+            } |
+            plain_text_exporter() |
+            output_stream;
+        return output_stream.str();
+    };
+    for (const std::string file_name : {"multi_pages_1.pdf", "1.pdf", "7.pdf", "embedded_images.pdf"})
+    {
+        SCOPED_TRACE("file_name = " + file_name);
+        std::string sequential = parse(file_name, 0, std::numeric_limits<int>::max());
+        EXPECT_EQ(sequential, parse(file_name, 3, std::numeric_limits<int>::max()));
+        EXPECT_EQ(parse(file_name, 0, 2), parse(file_name, 8, 2));
+    }
+}
+
+TEST(pst_parser, workers_emit_messages_in_order)
+{
+    auto parse = [](size_t worker_count, bool filter)
+    {
+        std::ostringstream output_stream{};
+        std::filesystem::path{"1.pst"} |
+            content_type::by_file_extension::detector{} |
+            pst_parser{pst_worker_count{worker_count}} |
+            [filter, min_time_filter = standard_filter::filterByMailMinCreationTime(1644216799)](message_ptr msg, const message_callbacks& emit_message)
+            {
+                return filter ? min_time_filter(std::move(msg), emit_message) : emit_message(std::move(msg));
+            } |
+            office_formats_parser{} |
+            plain_text_exporter() |
+            output_stream;
+        return output_stream.str();
+    };
+    for (bool filter : {false, true})
+    {
+        SCOPED_TRACE("filter = " + std::to_string(filter));
+        std::string sequential = parse(0, filter);
+        EXPECT_FALSE(sequential.empty());
+        EXPECT_EQ(sequential, parse(1, filter));
+        EXPECT_EQ(sequential, parse(4, filter));
+    }
+}
+
+TEST(pst_parser, unreadable_attachment_keeps_the_mail)
+{
+    std::ifstream file{"1.pst", std::ios::binary};
+    const std::string pst{std::istreambuf_iterator<char>{file}, std::istreambuf_iterator<char>{}};
+    // The attachment of the second mail is stored in two data blocks listed by the XBLOCK at offset 19392.
+    // Point it to blocks missing from the file and update the CRC in the block trailer, so only reading
+    // of the attachment data fails.
+    std::string damaged = pst;
+    auto write_le = [&damaged](size_t offset, std::uint64_t value, size_t size)
+    {
+        for (size_t i = 0; i < size; ++i)
+            damaged[offset + i] = static_cast<char>(value >> (8 * i));
+    };
+    write_le(19392 + 8, 0x7ff0, 8);
+    write_le(19392 + 16, 0x7ff4, 8);
+    write_le(19444, 0xfaddd6ed, 4);
+    auto parse = [](const std::string& data, size_t worker_count)
+    {
+        std::vector<std::string> events;
+        std::vector<message_ptr> msgs;
+        data_source{data, mime_type{"application/vnd.ms-outlook-pst"}, confidence::highest} |
+            pst_parser{pst_worker_count{worker_count}} |
+            [&events](message_ptr msg, const message_callbacks& emit_message)
+            {
+                if (msg->is<mail::mail>())
+                    events.push_back("mail " + msg->get<mail::mail>().subject.value_or(""));
+                else if (msg->is<mail::attachment>())
+                    events.push_back("attachment " + msg->get<mail::attachment>().name.value_or(""));
+                else if (msg->is<std::exception_ptr>())
+                    events.push_back("error " + errors::diagnostic_message(msg->get<std::exception_ptr>()));
+                return emit_message(std::move(msg));
+            } |
+            msgs;
+        return events;
+    };
+    for (size_t worker_count : {0, 1, 4})
+    {
+        SCOPED_TRACE("worker_count = " + std::to_string(worker_count));
+        EXPECT_EQ(parse(pst, worker_count), (std::vector<std::string>{
+            "mail Pierwszy html", "attachment 1DAEC~1.HTM", "mail Drugi plik html", "attachment 25922~1.HTM"}));
+        EXPECT_EQ(parse(damaged, worker_count), (std::vector<std::string>{
+            "mail Pierwszy html", "attachment 1DAEC~1.HTM", "mail Drugi plik html"}));
+    }
+}
+
+TEST(eml_parser, attachments_are_decoded_only_when_accepted)
+{
+    const std::string eml =
+        "From: sender@example.com\r\n"
+        "Subject: Attachments\r\n"
+        "MIME-Version: 1.0\r\n"
+        "Content-Type: multipart/mixed; boundary=\"part\"\r\n"
+        "\r\n"
+        "--part\r\n"
+        "Content-Type: text/plain\r\n"
+        "Content-Transfer-Encoding: quoted-printable\r\n"
+        "\r\n"
+        "Body with a soft=\r\n"
+        " line break =3D\r\n"
+        "--part\r\n"
+        "Content-Type: application/octet-stream; name=\"accepted.bin\"\r\n"
+        "Content-Disposition: attachment; filename=\"accepted.bin\"\r\n"
+        "Content-Transfer-Encoding: base64\r\n"
+        "\r\n"
+        "SGVsbG8g\r\n"
+        "V29ybGQh\r\n"
+        "--part\r\n"
+        "Content-Type: application/octet-stream; name=\"skipped.bin\"\r\n"
+        "Content-Disposition: attachment; filename=\"skipped.bin\"\r\n"
+        "Content-Transfer-Encoding: base64\r\n"
+        "\r\n"
+        "c2tpcHBlZA==\r\n"
+        "--part--\r\n";
+    std::vector<std::pair<std::string, size_t>> attachments;
+    std::vector<std::string> contents;
+    std::vector<message_ptr> msgs;
+    data_source{eml, mime_type{"message/rfc822"}, confidence::highest} |
+        mail_parser{} |
+        [&](message_ptr msg, const message_callbacks& emit_message)
+        {
+            if (msg->is<mail::attachment>())
+            {
+                const auto& attachment = msg->get<mail::attachment>();
+                attachments.emplace_back(attachment.name.value_or(""), attachment.size);
+                if (attachment.name == "skipped.bin")
+                    return continuation::skip;
+            }
+            else if (msg->is<data_source>())
+                contents.emplace_back(msg->get<data_source>().string_view());
+            return emit_message(std::move(msg));
+        } |
+        msgs;
+    EXPECT_EQ(attachments, (std::vector<std::pair<std::string, size_t>>{{"accepted.bin", 12}, {"skipped.bin", 7}}));
+    EXPECT_EQ(contents, (std::vector<std::string>{"Body with a soft line break =", "Hello World!"}));
+}
+
+TEST(eml_parser, identity_attachments_keep_trailing_line_breaks)
+{
+    // Only the line break before the boundary line is removed; the blank line that ends the attachment is its content.
+    const std::string eml =
+        "From: sender@example.com\r\n"
+        "Subject: Blank line\r\n"
+        "MIME-Version: 1.0\r\n"
+        "Content-Type: multipart/mixed; boundary=\"part\"\r\n"
+        "\r\n"
+        "--part\r\n"
+        "Content-Type: text/plain\r\n"
+        "\r\n"
+        "Body\r\n"
+        "--part\r\n"
+        "Content-Type: application/octet-stream; name=\"lines.txt\"\r\n"
+        "Content-Disposition: attachment; filename=\"lines.txt\"\r\n"
+        "Content-Transfer-Encoding: 7bit\r\n"
+        "\r\n"
+        "line\r\n"
+        "\r\n"
+        "--part--\r\n";
+    std::vector<size_t> sizes;
+    std::vector<std::string> contents;
+    std::vector<message_ptr> msgs;
+    data_source{eml, mime_type{"message/rfc822"}, confidence::highest} |
+        mail_parser{} |
+        [&](message_ptr msg, const message_callbacks& emit_message)
+        {
+            if (msg->is<mail::attachment>())
+                sizes.push_back(msg->get<mail::attachment>().size);
+            else if (msg->is<data_source>())
+                contents.emplace_back(msg->get<data_source>().string_view());
+            return emit_message(std::move(msg));
+        } |
+        msgs;
+    EXPECT_EQ(sizes, (std::vector<size_t>{6}));
+    EXPECT_EQ(contents, (std::vector<std::string>{"Body", "line\r\n"}));
+}
+
+TEST(odf_ooxml_parser, utf8_sheets_are_scanned_like_other_sheets)
+{
+    // The first sheet is scanned directly, the second one is the same sheet encoded in UTF-16, which is read by
+    // the XML reader.
+    std::vector<message_ptr> msgs;
+    std::filesystem::path{"sheet_encodings.xlsx"} |
+        content_type::by_file_extension::detector{} |
+        office_formats_parser{} |
+        msgs;
+    std::vector<std::string> elements;
+    for (const message_ptr& msg : msgs)
+    {
+        if (msg->is<document::text>())
+            elements.push_back("text: " + msg->get<document::text>().text);
+        else if (!msg->is<document::document>() && !msg->is<document::close_document>())
+            elements.push_back(msg->object_type().name());
+    }
+    ASSERT_EQ(elements.size() % 2, 0);
+    std::vector<std::string> first_sheet { elements.begin(), elements.begin() + elements.size() / 2 };
+    std::vector<std::string> second_sheet { elements.begin() + elements.size() / 2, elements.end() };
+    EXPECT_EQ(first_sheet, second_sheet);
+    EXPECT_NE(std::find(first_sheet.begin(), first_sheet.end(), "text: bold restPH"), first_sheet.end());
+}
+
+TEST(odf_ooxml_parser, streamed_parts_end_with_trailing_whitespace)
+{
+    // Both parts are above the streaming threshold, so they are scanned in chunks that split tokens. Their root
+    // elements are followed by whitespace, which ends only with the content.
+    std::vector<message_ptr> msgs;
+    std::filesystem::path{"streamed_parts.xlsx"} |
+        content_type::by_file_extension::detector{} |
+        office_formats_parser{} |
+        msgs;
+    std::vector<std::string> texts;
+    for (const message_ptr& msg : msgs)
+        if (msg->is<document::text>())
+            texts.push_back(msg->get<document::text>().text);
+    EXPECT_EQ(texts, (std::vector<std::string>{"first", "last"}));
+}
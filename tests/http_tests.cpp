@@ -119,13 +119,13 @@ protected:
     const http::address addr{"127.0.0.1"};
     const std::string route_path = "/test";
 
-    void run_server_test(const http::port& port, bool is_https)
+    void run_server_test(const http::port& port, bool is_https, http::streaming streaming_mode = {false})
     {
         const std::string url = (is_https ? "https://" : "http://") + addr.v + ":" + std::to_string(port.v) + route_path;
 
         http::server server = is_https ?
-            http::server(addr, port, http::generate_self_signed_cert(addr.v, "US", "DocWire Test"), create_routes()) :
-            http::server(addr, port, create_routes());
+            http::server(addr, port, http::generate_self_signed_cert(addr.v, "US", "DocWire Test"), create_routes(), {0}, {}, {1024 * 1024 * 1024}, streaming_mode) :
+            http::server(addr, port, create_routes(), {0}, {}, {1024 * 1024 * 1024}, streaming_mode);
 
         scoped_server server_runner{std::move(server)};
     
@@ -198,6 +198,74 @@ TEST_F(http_server_test, HttpsServerAndpost)
     }
 }
 
+TEST_F(http_server_test, StreamingServerAndpost)
+{
+    run_server_test({8084}, false, http::streaming{true});
+}
+
+TEST_F(http_server_test, StreamingHttpsServerAndpost)
+{
+    run_server_test({8085}, true, http::streaming{true});
+}
+
+TEST(Http, StreamingServerChunkedResponse)
+{
+    const http::address addr{"127.0.0.1"};
+    const http::port port{8086};
+    http::server::route_list routes;
+    // Emits the request body back in small pieces, each of them sent as soon as it is produced.
+    routes.push_back({"/chunks", []() -> parsing_chain {
+        return transformer_func{[](message_ptr msg, const message_callbacks& emit_message) {
+            std::string body = msg->get<data_source>().string();
+            for (size_t pos = 0; pos < body.size(); pos += 1000)
+                if (emit_message(data_source{body.substr(pos, 1000), mime_type{"text/plain"}, confidence::highest}) == continuation::stop)
+                    return continuation::stop;
+            return continuation::proceed;
+        }} | [](message_ptr msg, const message_callbacks& emit_message) {
+            return emit_message(std::move(msg));
+        };
+    }});
+    scoped_server server_runner{http::server(addr, port, std::move(routes), http::thread_num{1}, {}, {1024 * 1024 * 1024}, http::streaming{true})};
+
+    std::string request_body(3 * 1024 * 1024 + 17, ' ');
+    for (size_t i = 0; i < request_body.size(); ++i)
+        request_body[i] = static_cast<char>('a' + i % 26);
+    std::ostringstream response_stream;
+    ASSERT_NO_THROW({
+        docwire::data_source{request_body} | http::post("http://" + addr.v + ":" + std::to_string(port.v) + "/chunks") | response_stream;
+    });
+    EXPECT_EQ(response_stream.str(), request_body);
+}
+
+TEST(Http, StreamingServerOutputBeforeBody)
+{
+    const http::address addr{"127.0.0.1"};
+    const http::port port{8087};
+    const std::string prefix(2 * 1024 * 1024, 'x');
+    http::server::route_list routes;
+    // Produces more output than the response buffer holds before it starts reading the request body.
+    routes.push_back({"/prefix", [&prefix]() -> parsing_chain {
+        return transformer_func{[&prefix](message_ptr msg, const message_callbacks& emit_message) {
+            for (size_t pos = 0; pos < prefix.size(); pos += 64 * 1024)
+                if (emit_message(data_source{prefix.substr(pos, 64 * 1024), mime_type{"text/plain"}, confidence::highest}) == continuation::stop)
+                    return continuation::stop;
+            return emit_message(data_source{msg->get<data_source>().string(), mime_type{"text/plain"}, confidence::highest});
+        }} | [](message_ptr msg, const message_callbacks& emit_message) {
+            return emit_message(std::move(msg));
+        };
+    }});
+    scoped_server server_runner{http::server(addr, port, std::move(routes), http::thread_num{1}, {}, {1024 * 1024 * 1024}, http::streaming{true})};
+
+    std::string request_body(3 * 1024 * 1024, ' ');
+    for (size_t i = 0; i < request_body.size(); ++i)
+        request_body[i] = static_cast<char>('a' + i % 26);
+    std::ostringstream response_stream;
+    ASSERT_NO_THROW({
+        docwire::data_source{request_body} | http::post("http://" + addr.v + ":" + std::to_string(port.v) + "/prefix") | response_stream;
+    });
+    EXPECT_EQ(response_stream.str(), prefix + request_body);
+}
+
 TEST(Http, ServerErrorHandling)
 {
     // Using an invalid address is a reliable way to test startup error handling
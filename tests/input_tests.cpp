@@ -9,9 +9,11 @@
 /*  SPDX-License-Identifier: AGPL-3.0-only OR LicenseRef-DocWire-Commercial                                                                  */
 /*********************************************************************************************************************************************/
 
+#include <algorithm>
 #include <boost/algorithm/string.hpp>
 #include <boost/config.hpp>
 #include <boost/json.hpp>
+#include "batch_runner.h"
 #include "content_type_by_file_extension.h"
 #include "content_type_by_signature.h"
 #include "data_source.h"
@@ -22,8 +24,11 @@
 #include <magic_enum/magic_enum_iostream.hpp>
 #include "office_formats_parser.h"
 #include "output.h"
+#include "pdf_parser.h"
 #include "plain_text_exporter.h"
 #include "input.h"
+#include "result_cache.h"
+#include "static_chain.h"
 
 using namespace docwire;
 
@@ -202,3 +207,121 @@ TEST(Input, stream_temp)
         doc_parser{} | plain_text_exporter{} | output_stream;
     ASSERT_EQ(output_stream.str(), read_test_file("1.doc.out"));
 }
+
+namespace
+{
+std::string data_sources_to_string(const std::vector<message_ptr>& output)
+{
+    std::string text;
+    for (const message_ptr& msg : output)
+        if (msg->is<data_source>())
+            text += msg->get<data_source>().string();
+    return text;
+}
+}
+
+TEST(Input, batch_runner_input_order)
+{
+    std::vector<std::filesystem::path> paths{"1.doc", "2.docx", "3.odt", "4.xls", "5.html", "6.rtf", "7.pptx", "8.xlsb"};
+    batch_runner runner{[]() { return content_type::by_file_extension::detector{} | office_formats_parser{} | plain_text_exporter{}; },
+        worker_count{3}};
+    std::vector<size_t> delivered;
+    runner(paths, [&](size_t index, std::vector<message_ptr>&& output)
+    {
+        delivered.push_back(index);
+        ASSERT_EQ(data_sources_to_string(output), read_test_file(paths[index].string() + ".out"));
+    });
+    ASSERT_EQ(delivered, (std::vector<size_t>{0, 1, 2, 3, 4, 5, 6, 7}));
+}
+
+TEST(Input, batch_runner_completion_order_and_errors)
+{
+    std::vector<data_source> inputs;
+    for (int i = 1; i <= 9; i++)
+        inputs.emplace_back(std::filesystem::path{std::to_string(i) + ".docx"});
+    inputs.emplace_back(std::filesystem::path{"not_existing_file.docx"});
+    batch_runner runner{[]() { return content_type::by_file_extension::detector{} | office_formats_parser{} | plain_text_exporter{}; },
+        worker_count{4}, result_order::completion};
+    std::vector<size_t> delivered;
+    runner(inputs, [&](size_t index, std::vector<message_ptr>&& output)
+    {
+        delivered.push_back(index);
+        if (index == 9)
+            ASSERT_TRUE(std::any_of(output.begin(), output.end(), [](const message_ptr& msg) { return msg->is<std::exception_ptr>(); }));
+        else
+            ASSERT_EQ(data_sources_to_string(output), read_test_file(std::to_string(index + 1) + ".docx.out"));
+    });
+    std::sort(delivered.begin(), delivered.end());
+    ASSERT_EQ(delivered, (std::vector<size_t>{0, 1, 2, 3, 4, 5, 6, 7, 8, 9}));
+}
+
+TEST(Input, static_chain)
+{
+    std::ostringstream output_stream{};
+    static_chain chain{content_type::by_file_extension::detector{}, office_formats_parser{}, plain_text_exporter{}};
+    std::filesystem::path{"1.docx"} | chain | output_stream;
+    ASSERT_EQ(output_stream.str(), read_test_file("1.docx.out"));
+}
+
+TEST(Input, result_cache)
+{
+    std::filesystem::path cache_path = std::filesystem::temp_directory_path() / "docwire_result_cache_test";
+    std::filesystem::remove_all(cache_path);
+    result_cache cache{office_formats_parser{}, cache_directory{cache_path}};
+    for (int i = 0; i < 2; ++i)
+    {
+        std::ostringstream output_stream{};
+        std::filesystem::path{"1.docx"} | content_type::by_file_extension::detector{} | cache | plain_text_exporter{} | output_stream;
+        ASSERT_EQ(output_stream.str(), read_test_file("1.docx.out"));
+    }
+    result_cache_statistics statistics = cache.statistics();
+    EXPECT_EQ(statistics.misses, 1u);
+    EXPECT_EQ(statistics.hits, 1u);
+    EXPECT_EQ(statistics.stores, 1u);
+
+    // The same bytes declared as another format are not answered from the entry above.
+    std::vector<message_ptr> as_text;
+    data_source{std::filesystem::path{"1.docx"}, mime_type{"text/plain"}, confidence::highest} | cache | as_text;
+    EXPECT_EQ(cache.statistics().misses, 2u);
+    EXPECT_EQ(cache.statistics().hits, 1u);
+
+    result_cache other_configuration{office_formats_parser{}, cache_directory{cache_path}, cache_fingerprint{"other"}};
+    std::ostringstream output_stream{};
+    std::filesystem::path{"1.docx"} | content_type::by_file_extension::detector{} | other_configuration | plain_text_exporter{} | output_stream;
+    ASSERT_EQ(output_stream.str(), read_test_file("1.docx.out"));
+    EXPECT_EQ(other_configuration.statistics().misses, 1u);
+    std::filesystem::remove_all(cache_path);
+}
+
+TEST(Input, result_cache_replays_messages_sent_back)
+{
+    std::filesystem::path cache_path = std::filesystem::temp_directory_path() / "docwire_result_cache_back_test";
+    std::filesystem::remove_all(cache_path);
+    result_cache cache{pdf_parser{}, cache_directory{cache_path}};
+    auto run = [&cache]()
+    {
+        std::vector<std::string> messages;
+        cache(make_message(data_source{std::filesystem::path{"embedded_images.pdf"}, mime_type{"application/pdf"}, confidence::highest}),
+        {
+            [&messages](message_ptr msg)
+            {
+                if (msg->is<document::text>())
+                    messages.push_back("text " + msg->get<document::text>().text);
+                return continuation::proceed;
+            },
+            [&messages](message_ptr msg)
+            {
+                if (msg->is<document::image>())
+                    messages.push_back("image " + std::to_string(msg->get<document::image>().source.span().size()));
+                return continuation::proceed;
+            }
+        });
+        return messages;
+    };
+    std::vector<std::string> parsed = run();
+    ASSERT_TRUE(std::ranges::any_of(parsed, [](const std::string& msg) { return msg.starts_with("image "); }));
+    EXPECT_EQ(run(), parsed);
+    EXPECT_EQ(cache.statistics().hits, 1u);
+    EXPECT_EQ(cache.statistics().stores, 1u);
+    std::filesystem::remove_all(cache_path);
+}
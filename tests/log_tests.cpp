@@ -22,10 +22,13 @@
 #include <string>
 #include <vector>
 #include <list>
+#include <map>
 #include <optional>
 #include <memory>
 #include "serialization.h" // IWYU pragma: keep
 #include <sstream>
+#include <thread>
+#include <tuple>
 
 using namespace docwire;
 
@@ -343,6 +346,112 @@ TEST(Logging, Filtering)
 #endif
 }
 
+TEST(Logging, FilterChangeReevaluatesCallSite)
+{
+    std::stringstream log_stream;
+    log::state_saver saver;
+    log::set_sink(log::json_stream_sink(log_stream));
+
+    // The same call sites are evaluated for different filters, so decisions cached for previous filters must not be used.
+    for (const std::string filter : {"include_me", "-include_me", "*", "scope_enter", "include_me"})
+    {
+        log::set_filter(filter);
+        log_stream.str("");
+        {
+            log_scope();
+            log_entry(log::audit{}, include_me{}, "cached_call_site");
+        }
+        std::string log_text = log_stream.str();
+        EXPECT_EQ(log_text.find("cached_call_site") != std::string::npos, filter == "include_me" || filter == "*") << filter;
+#ifndef NDEBUG
+        EXPECT_EQ(log_text.find("scope_enter") != std::string::npos, filter == "scope_enter" || filter == "*") << filter;
+#endif
+    }
+}
+
+TEST(Logging, AsyncBinarySink)
+{
+    std::stringstream binary_log;
+    {
+        log::state_saver saver;
+        log::async_binary_sink sink{binary_log};
+        log::set_sink(sink);
+        log::set_filter("*");
+        std::vector<std::thread> threads;
+        for (int thread_number = 0; thread_number < 4; ++thread_number)
+            threads.emplace_back([thread_number]() { for (int i = 0; i < 100; ++i) log_entry(log::audit{}, "binary_log_record", thread_number, i); });
+        for (std::thread& thread : threads)
+            thread.join();
+        sink.flush();
+        log::async_sink_statistics statistics = sink.statistics();
+        EXPECT_EQ(statistics.records, 400u);
+        EXPECT_EQ(statistics.dropped, 0u);
+    }
+    std::ostringstream json_log;
+    log::binary_log_to_json(binary_log, json_log);
+    boost::json::array records = boost::json::parse(json_log.str()).as_array();
+    ASSERT_EQ(records.size(), 400u);
+    EXPECT_EQ(records[0].at("log").at(1), "binary_log_record");
+    EXPECT_TRUE(records[0].as_object().contains("timestamp"));
+    EXPECT_EQ(records[0].at("file"), "log_tests.cpp");
+}
+
+TEST(Logging, AsyncBinarySinkDropsWhenFull)
+{
+    std::stringstream binary_log;
+    {
+        log::state_saver saver;
+        log::async_binary_sink sink{binary_log, log::sink_buffer_size{256}, log::sink_overflow_policy{log::overflow_policy::drop}};
+        log::set_sink(sink);
+        log::set_filter("*");
+        for (int i = 0; i < 1000; ++i)
+            log_entry(log::audit{}, "record that fills the buffer quickly", i);
+        sink.flush();
+        log::async_sink_statistics statistics = sink.statistics();
+        EXPECT_GT(statistics.dropped, 0u);
+        EXPECT_EQ(statistics.records + statistics.dropped, 1000u);
+    }
+    std::ostringstream json_log;
+    log::binary_log_to_json(binary_log, json_log);
+    EXPECT_THAT(json_log.str(), testing::HasSubstr("dropped_records"));
+}
+
+namespace
+{
+
+template <typename T>
+void log_from_long_function_name(const T&)
+{
+    log_entry(log::audit{}, "record from a function with a long name");
+}
+
+} // anonymous namespace
+
+TEST(Logging, AsyncBinarySinkLongLocationInSmallBuffer)
+{
+    using long_type = std::tuple<std::map<std::string, std::vector<std::string>>, std::map<std::string, std::vector<std::string>>,
+        std::map<std::string, std::vector<std::string>>, std::map<std::string, std::vector<std::string>>,
+        std::map<std::string, std::vector<std::string>>, std::map<std::string, std::vector<std::string>>>;
+    std::stringstream binary_log;
+    {
+        log::state_saver saver;
+        log::async_binary_sink sink{binary_log, log::sink_buffer_size{64}, log::sink_overflow_policy{log::overflow_policy::block}};
+        log::set_sink(sink);
+        log::set_filter("*");
+        for (int i = 0; i < 10; ++i)
+            log_from_long_function_name(long_type{});
+        sink.flush();
+        log::async_sink_statistics statistics = sink.statistics();
+        EXPECT_EQ(statistics.records, 10u);
+        EXPECT_EQ(statistics.dropped, 0u);
+    }
+    std::ostringstream json_log;
+    ASSERT_NO_THROW(log::binary_log_to_json(binary_log, json_log));
+    boost::json::array records = boost::json::parse(json_log.str()).as_array();
+    ASSERT_EQ(records.size(), 10u);
+    EXPECT_THAT(std::string{records[0].at("function").as_string()}, testing::HasSubstr("log_from_long_function_name"));
+}
+
 TEST(Logging, AuditInRelease)
 {
 	std::stringstream log_stream;
@@ -9,12 +9,17 @@
 /*  SPDX-License-Identifier: AGPL-3.0-only OR LicenseRef-DocWire-Commercial                                                                  */
 /*********************************************************************************************************************************************/
 
+#include <algorithm>
 #include "contains_type.h" // IWYU pragma: keep
+#include "content_type_by_file_extension.h"
+#include "document_elements.h"
 #include "error_tags.h"
 #include "message_matchers.h" // IWYU pragma: keep
+#include "ocr_engine_pool.h"
 #include "ocr_parser.h"
 #include "input.h"
 #include "output.h"
+#include "transformer_func.h"
 
 using namespace docwire;
 using namespace testing;
@@ -36,3 +41,81 @@ TEST(ocr_parser, leptonica_stderr_capturer)
             "with context \"leptonica_stderr_capturer.contents(): Error in pixReadMem: Unknown format: no pix returned\""));
     }
 }
+
+TEST(ocr_parser, engine_pool_reuses_prewarmed_engines)
+{
+    ocr::prewarm_engines({language::pol}, 1);
+    ocr::engine_pool_statistics before = ocr::get_engine_pool_statistics();
+    ASSERT_GE(before.engines_idle, 1);
+    for (int i = 0; i < 2; ++i)
+    {
+        std::vector<message_ptr> output;
+        std::filesystem::path{"diacritical_marks-pol.png"} | content_type::by_file_extension::detector{} |
+            ocr_parser{{language::pol}} | output;
+        EXPECT_TRUE(std::any_of(output.begin(), output.end(), [](const message_ptr& msg) { return msg->is<document::text>(); }));
+    }
+    ocr::engine_pool_statistics after = ocr::get_engine_pool_statistics();
+    EXPECT_EQ(after.engines_created, before.engines_created);
+    EXPECT_EQ(after.leases, before.leases + 2);
+    EXPECT_EQ(after.engines_idle, before.engines_idle);
+}
+
+TEST(ocr_parser, parallel_strips_keep_reading_order)
+{
+    auto recognized_words = [](ocr_parser&& parser)
+    {
+        std::vector<message_ptr> output;
+        std::filesystem::path{"paragraphs-eng.png"} | content_type::by_file_extension::detector{} | std::move(parser) | output;
+        std::vector<std::string> words;
+        for (const message_ptr& msg : output)
+        {
+            if (!msg->is<document::text>() || msg->get<document::text>().text == " ")
+                continue;
+            const document::text& text = msg->get<document::text>();
+            EXPECT_TRUE(text.position.x && text.position.y && text.position.width && text.position.height) << text.text;
+            words.push_back(text.text);
+        }
+        return words;
+    };
+    std::vector<std::string> sequential = recognized_words(ocr_parser{{language::eng}});
+    std::vector<std::string> parallel = recognized_words(ocr_parser{{language::eng}, {}, {}, {}, ocr_worker_count{4}, ocr_strip_height{150}});
+    ASSERT_FALSE(sequential.empty());
+    EXPECT_EQ(parallel, sequential);
+}
+
+TEST(ocr_parser, multipage_tiff_pages_honor_continuations)
+{
+    // Every page is recognized unless the chain skips it, and nothing is recognized after a stop.
+    auto recognized_pages = [](continuation first_page_response, size_t worker_count)
+    {
+        std::vector<std::string> pages;
+        bool first_page = true;
+        std::filesystem::path{"multipage_ocr-eng.tiff"} | content_type::by_file_extension::detector{} |
+            ocr_parser{{language::eng}, {}, {}, {}, ocr_worker_count{worker_count}} |
+            [&](message_ptr msg, const message_callbacks& emit_message)
+            {
+                if (msg->is<document::page>())
+                {
+                    if (std::exchange(first_page, false) && first_page_response != continuation::proceed)
+                        return first_page_response;
+                    pages.emplace_back();
+                }
+                else if (msg->is<document::text>() && !pages.empty())
+                    pages.back() += msg->get<document::text>().text;
+                return emit_message(std::move(msg));
+            } |
+            std::vector<message_ptr>{};
+        return pages;
+    };
+    for (size_t worker_count : {1, 2})
+    {
+        std::vector<std::string> pages = recognized_pages(continuation::proceed, worker_count);
+        ASSERT_EQ(pages.size(), 2) << worker_count;
+        EXPECT_THAT(pages[0], HasSubstr("Testing"));
+        EXPECT_THAT(pages[1], HasSubstr("European"));
+        pages = recognized_pages(continuation::skip, worker_count);
+        ASSERT_EQ(pages.size(), 1) << worker_count;
+        EXPECT_THAT(pages[0], HasSubstr("European"));
+        EXPECT_THAT(recognized_pages(continuation::stop, worker_count), IsEmpty()) << worker_count;
+    }
+}
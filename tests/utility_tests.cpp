@@ -13,12 +13,14 @@
 #include <boost/algorithm/string.hpp>
 #include <boost/config.hpp>
 #include <boost/json.hpp>
+#include "charset_converter.h"
 #include "convert_chrono.h" // IWYU pragma: keep
 #include "error_hash.h" // IWYU pragma: keep
 #include "fuzzy_match.h"
 #include "gtest/gtest.h"
 #include <magic_enum/magic_enum_iostream.hpp>
 #include "serialization_document_elements.h" // IWYU pragma: keep
+#include "shared_string_pool.h"
 
 using namespace docwire;
 
@@ -43,3 +45,29 @@ TEST(base64, decode)
     std::string decoded_str { reinterpret_cast<char*>(decoded.data()), decoded.size() };
     ASSERT_EQ(decoded_str, "test");
 }
+
+TEST(shared_string_pool, strings_share_one_buffer)
+{
+    shared_string_pool pool;
+    pool.push_back("first");
+    pool.append("sec");
+    pool.append("ond");
+    pool.end_string();
+    pool.push_back("");
+    pool.emplace_back([](std::string& texts) { texts += "fourth"; });
+    ASSERT_EQ(pool.size(), 4);
+    EXPECT_EQ(pool[0], "first");
+    EXPECT_EQ(pool[1], "second");
+    EXPECT_EQ(pool[2], "");
+    EXPECT_EQ(pool[3], "fourth");
+    EXPECT_EQ(pool[1].data(), pool[0].data() + 5);
+}
+
+TEST(charset_converter, appends_to_output)
+{
+    charset_converter converter { "UTF-16LE", "UTF-8" };
+    std::string output = "Text: ";
+    converter.convert(std::string_view{"Z\0\xf3\0\x7c\x01", 6}, output);
+    EXPECT_EQ(output, "Text: Z\xc3\xb3\xc5\xbc");
+    EXPECT_EQ(converter.convert(std::string_view{"a\0", 2}), "a");
+}
@@ -1,5 +1,8 @@
+#include "common_xml_document_parser.h"
 #include "docwire.h"
+#include "document_elements.h"
 #include "gtest/gtest.h"
+#include <algorithm>
 #include <iostream>
 
 using namespace docwire;
@@ -192,3 +195,95 @@ TEST(XmlTests, CDataHandling)
     auto root = xml::root_element(reader);
     EXPECT_EQ(root.string_value(), "<escaped>");
 }
+
+TEST(XmlTests, ReadFromInputInParts)
+{
+    std::string xml = "<root>";
+    for (int i = 0; i < 10000; i++)
+        xml += "<item>" + std::to_string(i) + "</item>";
+    xml += "</root>";
+    size_t position = 0;
+    size_t max_part_size = 0;
+    xml::reader reader([&](char* buffer, size_t size)
+    {
+        max_part_size = std::max(max_part_size, size);
+        size = std::min(size, xml.size() - position);
+        std::copy_n(xml.data() + position, size, buffer);
+        position += size;
+        return size;
+    });
+
+    int count = 0;
+    for (auto node : xml::children(xml::root_element(reader)))
+    {
+        EXPECT_EQ(node.string_value(), std::to_string(count));
+        count++;
+    }
+    EXPECT_EQ(count, 10000);
+    EXPECT_LT(max_part_size, xml.size());
+}
+
+TEST(XmlTests, InputExceptionIsRethrown)
+{
+    std::string xml = "<root><item>A</item>";
+    bool first_part = true;
+    xml::reader reader([&](char* buffer, size_t size) -> size_t
+    {
+        if (!first_part)
+            throw std::runtime_error("Input failed");
+        first_part = false;
+        std::copy_n(xml.data(), xml.size(), buffer);
+        return xml.size();
+    });
+    EXPECT_THROW(while (reader.read_next()) {}, std::runtime_error);
+}
+
+namespace
+{
+
+class tag_recording_parser : public common_xml_document_parser<strict>
+{
+public:
+    tag_recording_parser()
+    {
+        auto record = [this](xml::node_ref<strict>& xml_node, xml_parse_mode mode, zip_reader* zipfile, std::string& text,
+            bool& children_processed, std::string& level_suffix, bool first_on_level)
+        {
+            tags.push_back(std::string{xml_node.full_name()});
+            children_processed = true;
+        };
+        registerODFOOXMLCommandHandler("tab", record); // tag of the parsers of this library
+        registerODFOOXMLCommandHandler("custom-tag", record); // other tag
+    }
+
+    continuation operator()(message_ptr msg, const message_callbacks& emit_message) override
+    {
+        scoped_context_stack_push context{*this, emit_message};
+        std::string text;
+        extractText(msg->get<std::string>(), PARSE_XML, nullptr, text);
+        return continuation::proceed;
+    }
+
+    bool is_leaf() const override { return false; }
+
+    std::vector<std::string> tags;
+};
+
+} // anonymous namespace
+
+TEST(XmlTests, CommandHandlersByLocalName)
+{
+    tag_recording_parser parser;
+    std::vector<message_ptr> emitted;
+    parser(make_message(std::string{"<w:document xmlns:w='w' xmlns:x='x'><w:p><w:tab/><x:custom-tag>A</x:custom-tag><w:unknown>B</w:unknown></w:p></w:document>"}),
+        {
+            [&](message_ptr msg) { emitted.push_back(msg); return continuation::proceed; },
+            [](message_ptr) { return continuation::proceed; }
+        });
+    EXPECT_EQ(parser.tags, (std::vector<std::string>{"w:tab", "x:custom-tag"}));
+    std::vector<std::string> texts;
+    for (const message_ptr& msg : emitted)
+        if (msg->is<document::text>())
+            texts.push_back(msg->get<document::text>().text);
+    EXPECT_EQ(texts, std::vector<std::string>{"B"});
+}
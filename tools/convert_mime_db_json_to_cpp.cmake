@@ -3,7 +3,7 @@ file(READ "db.json" json_data)
 string(JSON length LENGTH ${json_data})
 math(EXPR last "${length}-1")
 file(WRITE "db.json.cpp"
-    "const std::unordered_multimap<std::string, std::string> file_extension_to_mime_type = {\n"
+    "constexpr std::pair<std::string_view, std::string_view> file_extension_to_mime_type_list[] = {\n"
     "\t// this part is generated by tools/convert_mime_db_json_to_cpp.cmake\n"
     "\t// from https://github.com/jshttp/mime-db (MIT license)\n"
 )
@@ -149,7 +149,7 @@ endfunction()
 function(docwire_modules_using_dependency port_name out_var)
 	if(NOT DEFINED docwire_modules_using_dependency_cached_result_${port_name})
 		message("Searching for docwire modules using dependency ${port_name}")
-		set(docwire_core_deps vcpkg-cmake wv2 boost-filesystem boost-dll boost-json magic-enum minizip zlib gtest)
+		set(docwire_core_deps vcpkg-cmake wv2 boost-filesystem boost-dll boost-json magic-enum zlib gtest)
 		set(docwire_html_deps lexbor libcharsetdetect)
 		set(docwire_pdf_deps pdfium leptonica)
 		set(docwire_ocr_deps tesseract tessdata-fast leptonica)